@@ -80,6 +80,12 @@ std::string getEffectCategoryString(EffectCategory effectCategory)
     }
 }
 
+StreamConvertMode getStreamConvertMode(AudioStreamType srcType, AudioStreamType destType)
+{
+    if (srcType == destType) { return StreamConvertMode::NO_CONVERSION; }
+    return (srcType == AudioStreamType::INT16) ? StreamConvertMode::INT16_TO_FLOAT : StreamConvertMode::FLOAT_TO_INT16;
+}
+
 std::string EffectControl::typeToString(Type type) {
     switch(type) {
     case EffectControl::Type::SWITCH_LATCHING   : return "Switch, latching";
@@ -66,6 +66,8 @@ enum class StreamConvertMode : unsigned {
 
 EffectCategory getEffectCategoryEnum(std::string categoryStr);
 std::string    getEffectCategoryString(EffectCategory);
+// The conversion needed where an effect of srcType feeds one of destType, see SampleConvert::convert()
+StreamConvertMode getStreamConvertMode(AudioStreamType srcType, AudioStreamType destType);
 
 struct EffectControl {
     enum class Type : unsigned {
@@ -0,0 +1,158 @@
+/*
+ * AsrcBridge.cpp
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "Util/ErrorMessage.h"
+#include "AsrcBridge.h"
+
+namespace stride {
+
+AsrcBridge::AsrcBridge()
+: AsrcBridge(Config())
+{
+}
+
+AsrcBridge::AsrcBridge(const Config& config)
+: m_config(config),
+  m_writeIndex(0),
+  m_readIndex(0),
+  m_primed(false),
+  m_lastPullTime(0.0),
+  m_lastPullSize(0),
+  m_correctionPpm(0.0),
+  m_numUnderruns(0),
+  m_numOverruns(0)
+{
+    m_config.numChannels  = std::max(m_config.numChannels, 1U);
+    m_config.maxBlockSize = std::max(m_config.maxBlockSize, 1U);
+    m_config.maxCorrectionPpm = std::min(m_config.maxCorrectionPpm, r8b::CDSPFracInterpolator::getMaxAsyncDev() * 1e6);
+
+    if (m_config.targetFill * 2 > m_config.fifoSize) {
+        warningMessage("AsrcBridge::AsrcBridge(): FIFO size " + std::to_string(m_config.fifoSize) + " increased to twice the target fill");
+        m_config.fifoSize = m_config.targetFill * 2;
+    }
+
+    // Second order loop with 0.707 damping at the natural frequency, it acts on the fill error in samples and
+    // its output is a relative rate correction
+    const double wn = 2.0 * R8B_PI * m_config.loopBandwidthHz;
+    m_kp = 2.0 * 0.707 * wn;
+    m_ki = wn * wn;
+
+    for (unsigned channel=0; channel < m_config.numChannels; channel++) {
+        m_resamplers.emplace_back(new r8b::CDSPAsyncResampler(m_config.srcSampleRate, m_config.dstSampleRate,
+                                                              (int)m_config.maxBlockSize, 2.0, m_config.reqAtten));
+        m_fifo.emplace_back(m_config.fifoSize);
+    }
+    m_inBuffer.resize(m_config.maxBlockSize);
+    m_fillAvg = m_config.targetFill;
+}
+
+void AsrcBridge::push(const float* const* in, unsigned numSamples)
+{
+    for (unsigned offset=0; offset < numSamples; ) {
+        const unsigned blockSize = std::min(numSamples - offset, m_config.maxBlockSize);
+        m_updateLoop(blockSize);
+
+        const uint64_t writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+        const uint64_t readIndex  = m_readIndex.load(std::memory_order_acquire);
+        const size_t   space      = m_config.fifoSize - (size_t)(writeIndex - readIndex);
+
+        int numOut = 0;
+        for (unsigned channel=0; channel < m_config.numChannels; channel++) {
+            for (unsigned i=0; i < blockSize; i++) { m_inBuffer[i] = in[channel][offset + i]; }
+
+            double* op;
+            numOut = m_resamplers[channel]->process(m_inBuffer.data(), (int)blockSize, op);
+
+            std::vector<float>& fifo = m_fifo[channel];
+            const size_t numWrite = std::min((size_t)numOut, space);
+            for (size_t i=0; i < numWrite; i++) { fifo[(writeIndex + i) % m_config.fifoSize] = (float)op[i]; }
+        }
+
+        if ((size_t)numOut > space) { m_numOverruns.fetch_add(1, std::memory_order_relaxed); }
+        m_writeIndex.store(writeIndex + std::min((size_t)numOut, space), std::memory_order_release);
+        offset += blockSize;
+    }
+}
+
+void AsrcBridge::pull(float* const* out, unsigned numSamples)
+{
+    const double now = m_now();
+    const uint64_t readIndex  = m_readIndex.load(std::memory_order_relaxed);
+    const uint64_t writeIndex = m_writeIndex.load(std::memory_order_acquire);
+    const size_t   available  = (size_t)(writeIndex - readIndex);
+
+    if (!m_primed.load(std::memory_order_relaxed)) {
+        if (available < m_config.targetFill) {
+            for (unsigned channel=0; channel < m_config.numChannels; channel++) { std::fill(out[channel], out[channel] + numSamples, 0.0f); }
+            return;
+        }
+        m_primed.store(true, std::memory_order_relaxed);
+    }
+
+    const size_t numRead = std::min((size_t)numSamples, available);
+    for (unsigned channel=0; channel < m_config.numChannels; channel++) {
+        const std::vector<float>& fifo = m_fifo[channel];
+        for (size_t i=0; i < numRead; i++) { out[channel][i] = fifo[(readIndex + i) % m_config.fifoSize]; }
+        std::fill(out[channel] + numRead, out[channel] + numSamples, 0.0f);
+    }
+
+    if (numRead < numSamples) { m_numUnderruns.fetch_add(1, std::memory_order_relaxed); }
+    m_readIndex.store(readIndex + numRead, std::memory_order_release);
+    m_lastPullSize.store(numSamples, std::memory_order_relaxed);
+    m_lastPullTime.store(now, std::memory_order_release);
+}
+
+void AsrcBridge::reset()
+{
+    for (auto& resampler : m_resamplers) { resampler->clear(); }
+    m_writeIndex.store(0);
+    m_readIndex.store(0);
+    m_primed.store(false);
+    m_fillAvg  = m_config.targetFill;
+    m_integral = 0.0;
+    m_correctionPpm.store(0.0);
+}
+
+double AsrcBridge::m_now() const
+{
+    if (m_config.clock) { return m_config.clock(); }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+unsigned AsrcBridge::getFill() const
+{
+    return (unsigned)(m_writeIndex.load(std::memory_order_acquire) - m_readIndex.load(std::memory_order_acquire));
+}
+
+void AsrcBridge::m_updateLoop(unsigned numSamples)
+{
+    // Hold the loop until the destination starts pulling, the fill only means something after that
+    if (!m_primed.load(std::memory_order_relaxed)) { return; }
+
+    const double dt = numSamples / m_config.srcSampleRate;
+    const double alpha = 1.0 - std::exp(-dt / m_config.fillSmoothSecs);
+
+    // The codec keeps draining between pulls, at most one pull period is accounted for
+    const double sincePull = m_now() - m_lastPullTime.load(std::memory_order_acquire);
+    const double drained = std::max(0.0, std::min(sincePull * m_config.dstSampleRate, (double)m_lastPullSize.load(std::memory_order_relaxed)));
+    m_fillAvg += alpha * ((double)getFill() - drained - m_fillAvg);
+
+    const double error = m_fillAvg - m_config.targetFill;
+    const double maxCorrection = m_config.maxCorrectionPpm * 1e-6;
+
+    // Anti-windup, only integrate while the output is not clamped
+    double correction = -(m_kp * error + m_ki * (m_integral + error * dt)) / m_config.dstSampleRate;
+    if (std::fabs(correction) < maxCorrection) { m_integral += error * dt; }
+    correction = std::max(-maxCorrection, std::min(correction, maxCorrection));
+
+    for (auto& resampler : m_resamplers) { resampler->setDstSampleRate(m_config.dstSampleRate * (1.0 + correction)); }
+    m_correctionPpm.store(correction * 1e6, std::memory_order_relaxed);
+}
+
+}
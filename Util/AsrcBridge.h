@@ -0,0 +1,92 @@
+/*
+ * AsrcBridge.h
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "Util/r8b/CDSPAsyncResampler.h"
+
+namespace stride {
+
+// Bridges an audio stream between two unrelated clocks, e.g. the USB audio endpoints and the codec on the
+// host side. The source thread pushes samples at its own rate, they are resampled and queued in a FIFO,
+// and the destination thread pulls them at the codec rate. A PI loop on the FIFO fill level steers the
+// resampler's ratio so the fill level, and therefore the latency, stays at the target. One thread may
+// push and one thread may pull, neither locks.
+//
+// The fill is sampled on the source side, corrected for the time since the last pull, so the loop sees
+// how far the codec has actually drained the FIFO rather than the block granularity of the pulls.
+class AsrcBridge
+{
+public:
+    struct Config {
+        double   srcSampleRate   = 48000.0;
+        double   dstSampleRate   = 48000.0;
+        unsigned numChannels     = 2;
+        unsigned maxBlockSize    = 512;    // largest push, in source samples
+        unsigned targetFill      = 256;    // FIFO fill to hold, in destination samples
+        unsigned fifoSize        = 2048;   // in destination samples
+        double   loopBandwidthHz = 0.02;   // PI loop natural frequency
+        double   fillSmoothSecs  = 0.5;    // time constant of the fill level filter
+        double   maxCorrectionPpm = 1000.0;
+        double   reqAtten        = 180.15; // resampler stop-band attenuation
+        std::function<double()> clock;     // in seconds, defaults to std::chrono::steady_clock
+    };
+
+    AsrcBridge();
+    explicit AsrcBridge(const Config& config);
+    virtual ~AsrcBridge() = default;
+
+    // Source thread. Samples that don't fit in the FIFO are dropped and counted as an overrun.
+    void push(const float* const* in, unsigned numSamples);
+
+    // Destination thread. Outputs silence until the FIFO first reaches the target fill, missing samples
+    // after that are zero filled and counted as an underrun.
+    void pull(float* const* out, unsigned numSamples);
+
+    // Clears the resampler state and the FIFO. Call while neither thread is running.
+    void reset();
+
+    unsigned getFill() const;
+    double   getCorrectionPpm() const { return m_correctionPpm.load(std::memory_order_relaxed); } // applied to the output rate
+    double   getEstimatedDriftPpm() const { return -getCorrectionPpm(); }                          // source clock against the codec
+    unsigned getNumUnderruns() const { return m_numUnderruns.load(std::memory_order_relaxed); }
+    unsigned getNumOverruns() const { return m_numOverruns.load(std::memory_order_relaxed); }
+    const Config& getConfig() const { return m_config; }
+
+private:
+    Config m_config;
+    double m_kp;
+    double m_ki;
+
+    std::vector<std::unique_ptr<r8b::CDSPAsyncResampler>> m_resamplers;
+    std::vector<double> m_inBuffer;
+
+    // FIFO of planar channels, indices count samples since reset
+    std::vector<std::vector<float>> m_fifo;
+    std::atomic<uint64_t> m_writeIndex;
+    std::atomic<uint64_t> m_readIndex;
+    std::atomic<bool>     m_primed;
+    std::atomic<double>   m_lastPullTime;
+    std::atomic<unsigned> m_lastPullSize;
+
+    // Owned by the source thread
+    double m_fillAvg  = 0.0;
+    double m_integral = 0.0;
+
+    std::atomic<double>   m_correctionPpm;
+    std::atomic<unsigned> m_numUnderruns;
+    std::atomic<unsigned> m_numOverruns;
+
+    double m_now() const;
+    void   m_updateLoop(unsigned numSamples);
+};
+
+}
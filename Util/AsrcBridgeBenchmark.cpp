@@ -0,0 +1,102 @@
+/*
+ * AsrcBridgeBenchmark.cpp
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include "AsrcBridgeBenchmark.h"
+
+namespace stride {
+
+AsrcBridgeBenchmark::AsrcDriftResult AsrcBridgeBenchmark::runAsrcDrift(double driftPpm, double simulatedSecs, const AsrcBridge::Config& config,
+                                                                       unsigned pushBlockSize, unsigned pullBlockSize)
+{
+    // The bridge runs on simulated time
+    double simTime = 0.0;
+    AsrcBridge::Config simConfig = config;
+    simConfig.clock = [&simTime]() { return simTime; };
+
+    AsrcBridge bridge(simConfig);
+    const unsigned numChannels = bridge.getConfig().numChannels;
+    const double   srcRate     = config.srcSampleRate * (1.0 + driftPpm * 1e-6);
+    const double   pushPeriod  = pushBlockSize / srcRate;
+    const double   pullPeriod  = pullBlockSize / config.dstSampleRate;
+    const unsigned tolerance   = pushBlockSize + pullBlockSize;
+
+    std::vector<std::vector<float>> inBuffers(numChannels, std::vector<float>(pushBlockSize));
+    std::vector<std::vector<float>> outBuffers(numChannels, std::vector<float>(pullBlockSize));
+    std::vector<float*> inPtrs, outPtrs;
+    for (unsigned channel=0; channel < numChannels; channel++) {
+        inPtrs.push_back(inBuffers[channel].data());
+        outPtrs.push_back(outBuffers[channel].data());
+    }
+
+    AsrcDriftResult result = {};
+    result.driftPpm   = driftPpm;
+    result.settleSecs = simulatedSecs;
+
+    std::vector<double> corrections;
+    unsigned minFill = ~0U, maxFill = 0;
+    double   phase = 0.0, pushTime = 0.0, pullTime = 0.0, processSecs = 0.0;
+    size_t   numPushed = 0;
+    bool     settled = false;
+
+    // Events happen in clock order, pushes and pulls interleave the way the two threads would
+    while (pullTime < simulatedSecs) {
+        if (pushTime <= pullTime) {
+            for (unsigned i=0; i < pushBlockSize; i++) {
+                const float sample = (float)(0.5 * std::sin(phase));
+                phase += R8B_2PI * 997.0 / srcRate;
+                for (auto& buffer : inBuffers) { buffer[i] = sample; }
+            }
+            simTime = pushTime;
+            auto start = std::chrono::steady_clock::now();
+            bridge.push(inPtrs.data(), pushBlockSize);
+            processSecs += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            numPushed += pushBlockSize;
+            pushTime += pushPeriod;
+            continue;
+        }
+
+        simTime = pullTime;
+        bridge.pull(outPtrs.data(), pullBlockSize);
+        pullTime += pullPeriod;
+
+        const unsigned fill = bridge.getFill();
+        const bool inTolerance = (fill + tolerance >= config.targetFill) && (fill <= config.targetFill + tolerance);
+        if (!inTolerance || pullTime < 1.0) {
+            settled = false;
+            result.settleSecs = simulatedSecs;
+            minFill = ~0U;
+            maxFill = 0;
+        } else if (!settled) {
+            settled = true;
+            result.settleSecs = pullTime;
+        }
+        minFill = std::min(minFill, fill);
+        maxFill = std::max(maxFill, fill);
+
+        if (pullTime > simulatedSecs * 0.75) { corrections.push_back(bridge.getCorrectionPpm()); }
+    }
+
+    double mean = 0.0, variance = 0.0;
+    for (double correction : corrections) { mean += correction; }
+    mean /= std::max(corrections.size(), (size_t)1);
+    for (double correction : corrections) { variance += (correction - mean) * (correction - mean); }
+    variance /= std::max(corrections.size(), (size_t)1);
+
+    result.estimatedDriftPpm   = -mean;
+    result.correctionJitterPpm = std::sqrt(variance);
+    result.minFill      = settled ? minFill : 0;
+    result.maxFill      = settled ? maxFill : 0;
+    result.numUnderruns = bridge.getNumUnderruns();
+    result.numOverruns  = bridge.getNumOverruns();
+    result.nsPerSample  = processSecs * 1e9 / std::max(numPushed, (size_t)1);
+    return result;
+}
+
+}
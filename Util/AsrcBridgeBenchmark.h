@@ -0,0 +1,37 @@
+/*
+ * AsrcBridgeBenchmark.h
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+
+#pragma once
+
+#include "Util/AsrcBridge.h"
+
+namespace stride {
+
+// Clock drift tracking of the AsrcBridge, on simulated time
+class AsrcBridgeBenchmark
+{
+public:
+    struct AsrcDriftResult {
+        double   driftPpm;          // simulated source clock error
+        double   estimatedDriftPpm; // averaged over the last quarter of the run
+        double   correctionJitterPpm; // standard deviation over the last quarter
+        double   settleSecs;        // time until the fill stays within one push and pull block of the target
+        unsigned minFill;           // after settling
+        unsigned maxFill;
+        unsigned numUnderruns;
+        unsigned numOverruns;
+        double   nsPerSample;       // wall time per source sample, all channels
+    };
+
+    // Simulates an AsrcBridge between a source clock that is off by driftPpm and the codec clock, with
+    // the source pushing pushBlockSize samples and the codec pulling pullBlockSize samples at a time.
+    static AsrcDriftResult runAsrcDrift(double driftPpm, double simulatedSecs = 120.0,
+                                        const AsrcBridge::Config& config = AsrcBridge::Config(),
+                                        unsigned pushBlockSize = 48, unsigned pullBlockSize = 32);
+};
+
+}
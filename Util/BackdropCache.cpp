@@ -0,0 +1,288 @@
+/*
+ * BackdropCache.cpp
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+#include "Util/Gin/imageBlur.h"
+#include "BackdropCache.h"
+
+namespace stride {
+
+namespace {
+
+constexpr int TILE_SIZE   = 32; // pixels, the resolution of detectChanges
+constexpr int MAX_REGIONS = 16; // blurred separately, more are merged into their bounding box
+constexpr int GRID_ALIGN  = 4;  // the largest downsample factor, regions start on its grid
+
+int alignDown(int value) { return value - (value % GRID_ALIGN); }
+int alignUp(int value)   { return alignDown(value + GRID_ALIGN - 1); }
+
+// Copies area of src to dst at dstPos, both images must have the same format
+void copyPixels(const juce::Image& src, juce::Rectangle<int> area, juce::Image& dst, juce::Point<int> dstPos)
+{
+    juce::Image::BitmapData srcData(src, area.getX(), area.getY(), area.getWidth(), area.getHeight(),
+                                    juce::Image::BitmapData::readOnly);
+    juce::Image::BitmapData dstData(dst, dstPos.getX(), dstPos.getY(), area.getWidth(), area.getHeight(),
+                                    juce::Image::BitmapData::writeOnly);
+    const size_t lineBytes = (size_t)area.getWidth() * srcData.pixelStride;
+    for (int y=0; y < area.getHeight(); y++) {
+        memcpy(dstData.getLinePointer(y), srcData.getLinePointer(y), lineBytes);
+    }
+}
+
+// A copy in memory the blur can write to, whatever kind of image the source is
+juce::Image softwareCopy(const juce::Image& src)
+{
+    juce::Image dst(src.getFormat(), src.getWidth(), src.getHeight(), false, juce::SoftwareImageType());
+    copyPixels(src, src.getBounds(), dst, {0, 0});
+    return dst;
+}
+
+// Adds the tiles that differ between the two images, which must have the same size and format
+void addChangedTiles(const juce::Image& a, const juce::Image& b, juce::RectangleList<int>& dirty)
+{
+    juce::Image::BitmapData dataA(a, juce::Image::BitmapData::readOnly);
+    juce::Image::BitmapData dataB(b, juce::Image::BitmapData::readOnly);
+
+    for (int tileY=0; tileY < a.getHeight(); tileY += TILE_SIZE) {
+        const int tileHeight = std::min(TILE_SIZE, a.getHeight() - tileY);
+        for (int tileX=0; tileX < a.getWidth(); tileX += TILE_SIZE) {
+            const int tileWidth = std::min(TILE_SIZE, a.getWidth() - tileX);
+            const size_t offset    = (size_t)tileX * dataA.pixelStride;
+            const size_t lineBytes = (size_t)tileWidth * dataA.pixelStride;
+
+            for (int y=tileY; y < tileY + tileHeight; y++) {
+                if (memcmp(dataA.getLinePointer(y) + offset, dataB.getLinePointer(y) + offset, lineBytes) != 0) {
+                    dirty.add(juce::Rectangle<int>(tileX, tileY, tileWidth, tileHeight));
+                    break;
+                }
+            }
+        }
+    }
+}
+
+}
+
+BackdropCache::BackdropCache()
+: BackdropCache(Config())
+{
+}
+
+BackdropCache::BackdropCache(const Config& config)
+: m_config(config)
+{
+}
+
+BackdropCache::~BackdropCache()
+{
+    if (m_componentPtr) { m_componentPtr->removeComponentListener(this); }
+    // The job uses this, so it must be finished however long it takes. Blurs take milliseconds.
+    m_threadPool.removeAllJobs(true, -1);
+    cancelPendingUpdate();
+}
+
+void BackdropCache::setConfig(const Config& config)
+{
+    m_config = config;
+    invalidateAll();
+}
+
+void BackdropCache::setComponent(juce::Component* componentPtr)
+{
+    if (componentPtr == m_componentPtr) { return; }
+
+    if (m_componentPtr) { m_componentPtr->removeComponentListener(this); }
+    m_componentPtr = componentPtr;
+    if (m_componentPtr) { m_componentPtr->addComponentListener(this); }
+
+    m_image    = juce::Image();
+    m_snapshot = juce::Image();
+    invalidateAll();
+}
+
+void BackdropCache::invalidate(juce::Rectangle<int> area)
+{
+    m_dirty.add(area);
+    m_generation++;
+}
+
+void BackdropCache::invalidateAll()
+{
+    m_isAllDirty = true;
+    m_dirty.clear();
+    m_generation++;
+}
+
+void BackdropCache::update(juce::Rectangle<int> area)
+{
+    if (!m_componentPtr || area.isEmpty()) { return; }
+
+    if (m_isUpdating) {
+        m_isUpdatePending = true;
+        m_pendingArea     = area;
+        return;
+    }
+
+    const bool isNewArea = m_isAllDirty || (area != m_area) || !m_image.isValid();
+    if (!isNewArea && !m_config.detectChanges && (m_generation == m_imageGeneration)) { return; }
+
+    m_isTakingSnapshot = true;
+    // Native (e.g. GPU backed) images can't be read on the blur thread, the snapshot is converted here
+    juce::Image snapshot = juce::SoftwareImageType().convert(m_componentPtr->createComponentSnapshot(area));
+    m_isTakingSnapshot = false;
+
+    Job job;
+    job.config           = m_config;
+    job.downsampleFactor = m_getDownsampleFactor(area);
+    job.area             = area;
+    job.generation       = m_generation;
+    job.snapshot         = snapshot;
+    if (!isNewArea) {
+        job.previousSnapshot = m_snapshot;
+        job.previousImage    = m_image;
+        job.dirty            = m_dirty;
+        job.dirty.offsetAll(-area.getX(), -area.getY());
+        job.dirty.clipTo(snapshot.getBounds());
+    }
+
+    m_dirty.clear();
+    m_isAllDirty = false;
+    m_snapshot   = snapshot;
+    m_isUpdating = true;
+
+    m_threadPool.addJob([this, job]() {
+        Result result = m_blur(job);
+        {
+            juce::ScopedLock lock(m_resultLock);
+            m_result = result;
+        }
+        triggerAsyncUpdate();
+    });
+}
+
+int BackdropCache::m_getDownsampleFactor(juce::Rectangle<int> area) const
+{
+    if (m_config.downsampleFactor > 0) { return m_config.downsampleFactor; }
+    return getStackBlurDownsampleFactor(area.getWidth(), area.getHeight(), m_config.blurRadius);
+}
+
+BackdropCache::Result BackdropCache::m_blur(const Job& job) const
+{
+    auto start = std::chrono::steady_clock::now();
+
+    Result result;
+    result.area       = job.area;
+    result.generation = job.generation;
+
+    const juce::Rectangle<int> bounds = job.snapshot.getBounds();
+    const double totalArea = (double)bounds.getWidth() * bounds.getHeight();
+    const int radius = job.config.blurRadius;
+    const int factor = job.downsampleFactor;
+
+    // How far a changed pixel spreads in the blurred image, the same distance of source pixels around a
+    // region makes its blur identical to blurring the whole snapshot
+    const int margin = (factor <= 1) ? juce::jlimit(2, 254, radius)
+                                     : (juce::jlimit(2, 254, (radius + factor / 2) / factor) + 2) * factor;
+
+    bool isFullBlur = !job.previousImage.isValid() || !job.previousSnapshot.isValid() ||
+                      (job.previousSnapshot.getBounds() != bounds) ||
+                      (job.previousSnapshot.getFormat() != job.snapshot.getFormat()) ||
+                      (job.previousImage.getFormat() != job.snapshot.getFormat());
+
+    struct Region {
+        juce::Rectangle<int> source; // the snapshot pixels blurred
+        juce::Rectangle<int> output; // copied into the image
+    };
+    std::vector<Region> regions;
+
+    if (!isFullBlur) {
+        juce::RectangleList<int> dirty = job.dirty;
+        if (job.config.detectChanges) { addChangedTiles(job.previousSnapshot, job.snapshot, dirty); }
+        dirty.consolidate();
+        if (dirty.getNumRectangles() > MAX_REGIONS) { dirty = juce::RectangleList<int>(dirty.getBounds()); }
+
+        double sourceArea = 0.0;
+        for (const juce::Rectangle<int>& rect : dirty) {
+            Region region;
+            region.output = rect.expanded(margin).getIntersection(bounds);
+            if (region.output.isEmpty()) { continue; }
+
+            region.source = juce::Rectangle<int>::leftTopRightBottom(
+                                std::max(0, alignDown(region.output.getX() - margin)),
+                                std::max(0, alignDown(region.output.getY() - margin)),
+                                std::min(bounds.getRight(),  alignUp(region.output.getRight() + margin)),
+                                std::min(bounds.getBottom(), alignUp(region.output.getBottom() + margin)));
+            sourceArea += (double)region.source.getWidth() * region.source.getHeight();
+            regions.push_back(region);
+        }
+        result.stats.dirtyFraction = sourceArea / totalArea;
+        isFullBlur = (result.stats.dirtyFraction > job.config.maxDirtyFraction);
+    }
+
+    if (isFullBlur) {
+        result.image = softwareCopy(job.snapshot);
+        applyStackBlurDownsampled(result.image, radius, factor);
+        result.stats.isFullBlur    = true;
+        result.stats.numRegions    = 1;
+        result.stats.dirtyFraction = 1.0;
+    } else if (regions.empty()) {
+        result.image = job.previousImage;
+    } else {
+        result.image = softwareCopy(job.previousImage);
+        for (const Region& region : regions) {
+            juce::Image patch(job.snapshot.getFormat(), region.source.getWidth(), region.source.getHeight(), false,
+                              juce::SoftwareImageType());
+            copyPixels(job.snapshot, region.source, patch, {0, 0});
+            applyStackBlurDownsampled(patch, radius, factor);
+            copyPixels(patch, region.output - region.source.getPosition(), result.image, region.output.getPosition());
+        }
+        result.stats.numRegions = (int)regions.size();
+    }
+
+    result.stats.blurMs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1000.0;
+    return result;
+}
+
+void BackdropCache::handleAsyncUpdate()
+{
+    Result result;
+    {
+        juce::ScopedLock lock(m_resultLock);
+        std::swap(result, m_result);
+    }
+
+    m_image           = result.image;
+    m_area            = result.area;
+    m_imageGeneration = result.generation;
+    m_lastUpdateStats = result.stats;
+    m_isUpdating      = false;
+
+    if (m_isUpdatePending) {
+        m_isUpdatePending = false;
+        update(m_pendingArea);
+    }
+    if (onReady) { onReady(); }
+}
+
+void BackdropCache::componentMovedOrResized(juce::Component& component, bool wasMoved, bool wasResized)
+{
+    if (wasResized) { invalidateAll(); }
+}
+
+void BackdropCache::componentChildrenChanged(juce::Component& component)
+{
+    invalidateAll();
+}
+
+void BackdropCache::componentBeingDeleted(juce::Component& component)
+{
+    component.removeComponentListener(this);
+    m_componentPtr = nullptr;
+}
+
+}
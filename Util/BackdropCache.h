@@ -0,0 +1,128 @@
+/*
+ * BackdropCache.h
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <JuceHeader.h>
+
+namespace stride {
+
+// A blurred snapshot of a component to draw behind modal windows. The blurred image is kept from one
+// modal to the next and only the parts of the component that changed are blurred again. Snapshots are
+// taken on the message thread, the blurring runs on a background thread and onReady is called back on
+// the message thread when a new image is available. Everything but the blurring is message thread only.
+//
+// A change is anything passed to invalidate(), a resize or a child being added or removed. With
+// detectChanges each update() also compares the new snapshot with the last one tile by tile, so changes
+// the owner doesn't report are found too, at the cost of painting a snapshot on every update().
+class BackdropCache : private juce::AsyncUpdater,
+                      private juce::ComponentListener
+{
+public:
+    struct Config {
+        int   blurRadius       = 5;
+        int   downsampleFactor = 0;     // as applyStackBlurDownsampled(), 0 picks from the radius and size
+        bool  detectChanges    = true;  // compare snapshots, otherwise only invalidate() marks changes
+        float maxDirtyFraction = 0.5f;  // of the area, above which it is all blurred again
+    };
+
+    struct UpdateStats {
+        bool   isFullBlur    = false;
+        int    numRegions    = 0;   // blurred separately, 0 if nothing had changed
+        double dirtyFraction = 0.0; // of the area blurred again, including the margins
+        double blurMs        = 0.0; // on the background thread
+    };
+
+    BackdropCache();
+    explicit BackdropCache(const Config& config);
+    virtual ~BackdropCache();
+
+    const Config& getConfig() const { return m_config; }
+    void setConfig(const Config& config); // the next update() blurs everything again
+
+    // The component to snapshot, nullptr to stop
+    void setComponent(juce::Component* componentPtr);
+
+    // Marks an area of the component, in its own coordinates, as changed since the last update().
+    // Each call advances the generation; the cached image is reused while the area and generation
+    // match and detectChanges finds nothing.
+    void invalidate(juce::Rectangle<int> area);
+    void invalidateAll();
+    uint64_t getGeneration() const { return m_generation; }
+
+    // Brings the backdrop up to date with the given area of the component and returns immediately,
+    // onReady is called when the blurred image changes. A call while a blur is running is deferred
+    // until it finishes.
+    void update(juce::Rectangle<int> area);
+
+    // The latest blurred image of getArea(), possibly older than the component while isUpdating().
+    // Invalid until the first update has finished.
+    juce::Image getImage() const { return m_image; }
+    juce::Rectangle<int> getArea() const { return m_area; }
+    bool isUpdating() const { return m_isUpdating; }
+
+    // True while update() paints the component, so a window covering it can skip drawing the backdrop
+    bool isTakingSnapshot() const { return m_isTakingSnapshot; }
+
+    const UpdateStats& getLastUpdateStats() const { return m_lastUpdateStats; }
+
+    std::function<void()> onReady;
+
+private:
+    struct Job {
+        Config               config;
+        int                  downsampleFactor = 1;
+        juce::Rectangle<int> area;
+        uint64_t             generation = 0;
+        juce::Image          snapshot;
+        juce::Image          previousSnapshot; // invalid to blur everything
+        juce::Image          previousImage;
+        juce::RectangleList<int> dirty;        // relative to the area
+    };
+
+    struct Result {
+        juce::Rectangle<int> area;
+        uint64_t             generation = 0;
+        juce::Image          image;
+        UpdateStats          stats;
+    };
+
+    Config                   m_config;
+    juce::Component*         m_componentPtr = nullptr;
+
+    uint64_t                 m_generation        = 0;
+    uint64_t                 m_imageGeneration   = 0;
+    bool                     m_isAllDirty        = true;
+    juce::RectangleList<int> m_dirty;            // in component coordinates
+
+    juce::Image              m_image;
+    juce::Image              m_snapshot;          // the one m_image was blurred from
+    juce::Rectangle<int>     m_area;
+    UpdateStats              m_lastUpdateStats;
+
+    bool                     m_isUpdating        = false;
+    bool                     m_isUpdatePending   = false;
+    bool                     m_isTakingSnapshot  = false;
+    juce::Rectangle<int>     m_pendingArea;
+
+    juce::CriticalSection    m_resultLock;
+    Result                   m_result;
+
+    juce::ThreadPool         m_threadPool { 1 };
+
+    Result m_blur(const Job& job) const;
+    int    m_getDownsampleFactor(juce::Rectangle<int> area) const;
+
+    void handleAsyncUpdate() override;
+    void componentMovedOrResized(juce::Component& component, bool wasMoved, bool wasResized) override;
+    void componentChildrenChanged(juce::Component& component) override;
+    void componentBeingDeleted(juce::Component& component) override;
+};
+
+}
@@ -0,0 +1,228 @@
+/*
+ * FFTBenchmark.cpp
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include "Util/ErrorMessage.h"
+#include "Util/r8b/CDSPResampler.h"
+#include "Util/r8b/pffft.h"
+#include "FFTBenchmark.h"
+
+namespace stride {
+
+namespace {
+
+constexpr int FFT_BLOCK_SIZE     = 1024;
+constexpr int FFT_CHECK_SECONDS  = 2;
+constexpr int PFFFT_MIN_LEN_BITS = 6;
+constexpr int PFFFT_MAX_LEN_BITS = 17;
+
+std::vector<double> resampleOneshot(double srcRate, double dstRate, bool useFloatFFT, const std::vector<double>& input)
+{
+    r8b::CDSPResampler24 resampler(srcRate, dstRate, FFT_BLOCK_SIZE, 2.0, useFloatFFT);
+    std::vector<double> output((size_t)(input.size() * dstRate / srcRate));
+    resampler.oneshot(input.data(), (int)input.size(), output.data(), (int)output.size());
+    return output;
+}
+
+double timeResampler(double srcRate, double dstRate, bool useFloatFFT, const std::vector<double>& input, double seconds)
+{
+    r8b::CDSPResampler24 resampler(srcRate, dstRate, FFT_BLOCK_SIZE, 2.0, useFloatFFT);
+    std::vector<double> inBlock(input.begin(), input.begin() + FFT_BLOCK_SIZE);
+
+    size_t numSamples = 0;
+    double elapsedSecs = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    while (elapsedSecs < seconds) {
+        for (unsigned i=0; i < 16; i++) {
+            double* op;
+            resampler.process(inBlock.data(), FFT_BLOCK_SIZE, op);
+        }
+        numSamples += 16 * FFT_BLOCK_SIZE;
+        elapsedSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return elapsedSecs * 1e9 / numSamples;
+}
+
+double toDb(double value)
+{
+    return 20.0 * std::log10(std::max(value, 1e-15));
+}
+
+// RMS of the output, skipping the filter ramps at either end, relative to the tone's RMS
+double stopBandResidualDb(double srcRate, double dstRate, bool useFloatFFT)
+{
+    const double toneFreq = dstRate * 0.5 + (srcRate - dstRate) * 0.25; // halfway into the stop band
+    std::vector<double> tone((size_t)srcRate * FFT_CHECK_SECONDS);
+    for (size_t i=0; i < tone.size(); i++) { tone[i] = std::sin(R8B_2PI * toneFreq * i / srcRate); }
+
+    std::vector<double> output = resampleOneshot(srcRate, dstRate, useFloatFFT, tone);
+    const size_t skip = output.size() / 4;
+    double energy = 0.0;
+    for (size_t i=skip; i < output.size() - skip; i++) { energy += output[i] * output[i]; }
+    return toDb(std::sqrt(energy / (output.size() - 2 * skip)) * std::sqrt(2.0));
+}
+
+#if R8B_PFFFT_RUNTIME
+double timePffft(PFFFT_Setup* setup, int fftLen, double seconds)
+{
+    r8b::CFixedBuffer<float> data(fftLen), spectrum(fftLen), work(fftLen);
+    for (int i=0; i < fftLen; i++) { data[i] = (float)std::sin(i * 0.1); }
+
+    size_t numSamples = 0;
+    double elapsedSecs = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    while (elapsedSecs < seconds) {
+        for (unsigned i=0; i < 16; i++) {
+            // The backward transform works in place on a copy, the unscaled round trip would grow the input
+            pffft_transform_ordered(setup, data, spectrum, work, PFFFT_FORWARD);
+            pffft_transform_ordered(setup, spectrum, spectrum, work, PFFFT_BACKWARD);
+        }
+        numSamples += 16 * (size_t)fftLen;
+        elapsedSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return elapsedSecs * 1e9 / numSamples;
+}
+
+// Circular convolution of x and h through the pffft z-domain, scaled like the double path
+std::vector<double> convolvePffft(PFFFT_Setup* setup, const std::vector<double>& x, const std::vector<double>& h)
+{
+    const int fftLen = (int)x.size();
+    r8b::CFixedBuffer<float> xf(fftLen), hf(fftLen), yf(fftLen), work(fftLen);
+    for (int i=0; i < fftLen; i++) {
+        xf[i] = (float)x[i];
+        hf[i] = (float)h[i];
+        yf[i] = 0.0f;
+    }
+    pffft_transform(setup, xf, xf, work, PFFFT_FORWARD);
+    pffft_transform(setup, hf, hf, work, PFFFT_FORWARD);
+    pffft_zconvolve_accumulate(setup, xf, hf, yf, 1.0f / fftLen);
+    pffft_transform(setup, yf, yf, work, PFFFT_BACKWARD);
+    return std::vector<double>(&yf[0], &yf[0] + fftLen);
+}
+
+std::vector<double> convolveDouble(int lenBits, const std::vector<double>& x, const std::vector<double>& h)
+{
+    r8b::CDSPRealFFTKeeper fft(lenBits);
+    const int fftLen = 1 << lenBits;
+    r8b::CFixedBuffer<double> xd(fftLen), hd(fftLen), yd(fftLen);
+    for (int i=0; i < fftLen; i++) {
+        xd[i] = x[i];
+        hd[i] = h[i];
+    }
+    fft->forward(xd);
+    fft->forward(hd);
+    fft->multiplyBlocks(xd, hd, yd);
+    fft->inverse(yd);
+    for (int i=0; i < fftLen; i++) { yd[i] *= fft->getInvMulConst(); }
+    return std::vector<double>(&yd[0], &yd[0] + fftLen);
+}
+
+double maxRelativeError(const std::vector<double>& values, const std::vector<double>& reference)
+{
+    double maxError = 0.0, peak = 0.0;
+    for (size_t i=0; i < values.size(); i++) {
+        maxError = std::max(maxError, std::fabs(values[i] - reference[i]));
+        peak     = std::max(peak, std::fabs(reference[i]));
+    }
+    return (peak > 0.0) ? maxError / peak : maxError;
+}
+#endif
+
+}
+
+std::vector<FFTBenchmark::FFTResult> FFTBenchmark::runFFTBackends(double secondsPerCase)
+{
+    static const double RATE_PAIRS[][2] = {
+        {44100.0, 48000.0}, {48000.0, 44100.0}, {48000.0, 96000.0}, {96000.0, 48000.0}, {44100.0, 96000.0}, {96000.0, 44100.0}
+    };
+
+    std::vector<FFTResult> results;
+    for (auto& ratePair : RATE_PAIRS) {
+        const double srcRate = ratePair[0];
+        const double dstRate = ratePair[1];
+
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        std::vector<double> input((size_t)srcRate * FFT_CHECK_SECONDS);
+        for (auto& sample : input) { sample = dist(rng); }
+
+        const std::vector<double> reference = resampleOneshot(srcRate, dstRate, false, input);
+
+        for (bool useFloatFFT : {false, true}) {
+            double maxDiff = 0.0;
+            if (useFloatFFT) {
+                std::vector<double> output = resampleOneshot(srcRate, dstRate, true, input);
+                for (size_t i=0; i < output.size(); i++) { maxDiff = std::max(maxDiff, std::fabs(output[i] - reference[i])); }
+            }
+
+            FFTResult result;
+            result.srcRate     = srcRate;
+            result.dstRate     = dstRate;
+            result.fftType     = useFloatFFT ? "float" : "double";
+            result.nsPerSample = (secondsPerCase > 0.0) ? timeResampler(srcRate, dstRate, useFloatFFT, input, secondsPerCase) : 0.0;
+            result.maxDiffDb   = toDb(maxDiff);
+            // The stop band only exists when downsampling
+            result.stopBandDb  = (dstRate < srcRate) ? stopBandResidualDb(srcRate, dstRate, useFloatFFT) : 0.0;
+            results.push_back(result);
+        }
+    }
+    return results;
+}
+
+std::vector<FFTBenchmark::PffftResult> FFTBenchmark::runPffftSizes(double secondsPerCase)
+{
+    std::vector<PffftResult> results;
+#if R8B_PFFFT_RUNTIME
+    for (int lenBits=PFFFT_MIN_LEN_BITS; lenBits <= PFFFT_MAX_LEN_BITS; lenBits++) {
+        const int fftLen = 1 << lenBits;
+
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        std::vector<double> x(fftLen), h(fftLen);
+        for (auto& sample : x) { sample = dist(rng); }
+        for (auto& sample : h) { sample = dist(rng); }
+        const std::vector<double> reference = convolveDouble(lenBits, x, h);
+
+        PFFFT_Setup* defaultSetup = pffft_new_setup(fftLen, PFFFT_REAL);
+        const int defaultSimdSize = pffft_setup_simd_size(defaultSetup);
+        pffft_destroy_setup(defaultSetup);
+
+        std::vector<double> sseSpectrum;
+        for (int simdSize=pffft_simd_size(); simdSize <= pffft_simd_size_max(); simdSize *= 2) {
+            PFFFT_Setup* setup = pffft_new_setup_simd(fftLen, PFFFT_REAL, simdSize);
+            if (pffft_setup_simd_size(setup) != simdSize) {
+                // The length is too short for this width
+                pffft_destroy_setup(setup);
+                continue;
+            }
+
+            r8b::CFixedBuffer<float> data(fftLen), work(fftLen);
+            for (int i=0; i < fftLen; i++) { data[i] = (float)x[i]; }
+            pffft_transform_ordered(setup, data, data, work, PFFFT_FORWARD);
+            const std::vector<double> spectrum(&data[0], &data[0] + fftLen);
+            if (sseSpectrum.empty()) { sseSpectrum = spectrum; }
+
+            PffftResult result;
+            result.fftLen           = fftLen;
+            result.simdSize         = simdSize;
+            result.isDefault        = (simdSize == defaultSimdSize);
+            result.nsPerSample      = (secondsPerCase > 0.0) ? timePffft(setup, fftLen, secondsPerCase) : 0.0;
+            result.maxErrorVsSse    = maxRelativeError(spectrum, sseSpectrum);
+            result.maxErrorVsDouble = maxRelativeError(convolvePffft(setup, x, h), reference);
+            results.push_back(result);
+            pffft_destroy_setup(setup);
+        }
+    }
+#else
+    warningMessage("FFTBenchmark::runPffftSizes(): pffft is not compiled in");
+#endif
+    return results;
+}
+
+}
@@ -0,0 +1,45 @@
+/*
+ * FFTBenchmark.h
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace stride {
+
+// Accuracy and timings of the r8b FFT backends, through the resampler and on their own
+class FFTBenchmark
+{
+public:
+    struct FFTResult {
+        double      srcRate;
+        double      dstRate;
+        std::string fftType;     // "double" or "float"
+        double      nsPerSample; // per input sample, streaming in blocks
+        double      maxDiffDb;   // peak difference against the double path, relative to full scale
+        double      stopBandDb;  // residual of a tone above the destination Nyquist, relative to the tone
+    };
+
+    struct PffftResult {
+        int      fftLen;
+        int      simdSize;          // floats per vector, 4 (SSE), 8 (AVX2) or 16 (AVX-512)
+        bool     isDefault;         // the width pffft_new_setup() picks for this length
+        double   nsPerSample;       // ordered forward and backward transform, per real sample
+        double   maxErrorVsSse;     // ordered spectrum against the SSE setup, relative to its peak
+        double   maxErrorVsDouble;  // circular convolution against r8b's double FFT (fft4g by default), relative to its peak
+    };
+
+    // Compares the double and float FFT block convolution paths of the 24-bit resampler for common
+    // rate conversions.
+    static std::vector<FFTResult> runFFTBackends(double secondsPerCase = 0.25);
+
+    // Runs the real pffft transforms over a sweep of lengths for each vector width this CPU supports
+    static std::vector<PffftResult> runPffftSizes(double secondsPerCase = 0.05);
+};
+
+}
@@ -0,0 +1,80 @@
+/*
+ * FilterCacheBenchmark.cpp
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include "Util/r8b/CDSPResampler.h"
+#include "FilterCacheBenchmark.h"
+
+namespace stride {
+
+namespace {
+
+constexpr int BLOCK_SIZE = 1024;
+
+// Runs work(threadIndex) repeatedly on numThreads threads for the given time, returns the calls per second
+template <typename Work>
+double runConcurrently(unsigned numThreads, double seconds, Work work)
+{
+    std::vector<std::thread> threads;
+    std::vector<size_t> numCalls(numThreads, 0);
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned threadIndex=0; threadIndex < numThreads; threadIndex++) {
+        threads.emplace_back([&, threadIndex]() {
+            while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < seconds) {
+                for (unsigned i=0; i < 16; i++) { work(threadIndex); }
+                numCalls[threadIndex] += 16;
+            }
+        });
+    }
+    for (auto& thread : threads) { thread.join(); }
+
+    const double elapsedSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    size_t totalCalls = 0;
+    for (size_t calls : numCalls) { totalCalls += calls; }
+    return totalCalls / elapsedSecs;
+}
+
+}
+
+std::vector<FilterCacheBenchmark::CacheConcurrencyResult> FilterCacheBenchmark::runCacheConcurrency(unsigned maxThreads, double secondsPerCase)
+{
+    static const double RATE_PAIRS[][2] = {
+        {44100.0, 48000.0}, {48000.0, 44100.0}, {48000.0, 96000.0}, {96000.0, 48000.0}
+    };
+    constexpr unsigned NUM_RATE_PAIRS = sizeof(RATE_PAIRS) / sizeof(RATE_PAIRS[0]);
+
+    // Warm the caches so the lookups measure hits
+    for (auto& ratePair : RATE_PAIRS) { r8b::CDSPResampler24 resampler(ratePair[0], ratePair[1], BLOCK_SIZE); }
+
+    std::vector<CacheConcurrencyResult> results;
+    for (unsigned numThreads=1; numThreads <= std::max(maxThreads, 1U); numThreads *= 2) {
+        r8b::CDSPFIRFilterCache::resetStats();
+        r8b::CDSPFracDelayFilterBankCache::resetStats();
+
+        CacheConcurrencyResult result;
+        result.numThreads    = numThreads;
+        result.lookupsPerSec = runConcurrently(numThreads, secondsPerCase, [](unsigned threadIndex) {
+            r8b::CDSPFIRFilterCache::getLPFilter(0.5, 2.0, 180.15, r8b::fprLinearPhase, 2.0 + (threadIndex & 1)).unref();
+            r8b::CDSPFracDelayFilterBankCache::getFilterBank(-1, 3, 8, 180.15, false, true).unref();
+        }) * 2.0;
+        result.resamplersPerSec = runConcurrently(numThreads, secondsPerCase, [](unsigned threadIndex) {
+            const double* ratePair = RATE_PAIRS[threadIndex % NUM_RATE_PAIRS];
+            r8b::CDSPResampler24 resampler(ratePair[0], ratePair[1], BLOCK_SIZE);
+        });
+
+        const r8b::CObjCacheStats filterStats = r8b::CDSPFIRFilterCache::getStats();
+        const r8b::CObjCacheStats bankStats   = r8b::CDSPFracDelayFilterBankCache::getStats();
+        result.hits      = filterStats.Hits + bankStats.Hits;
+        result.misses    = filterStats.Misses + bankStats.Misses;
+        result.evictions = filterStats.Evictions + bankStats.Evictions;
+        results.push_back(result);
+    }
+    return results;
+}
+
+}
@@ -0,0 +1,31 @@
+/*
+ * FilterCacheBenchmark.h
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+
+#pragma once
+
+#include <vector>
+
+namespace stride {
+
+// Contention on the r8b filter and filter bank caches from concurrent lookups and resampler constructions
+class FilterCacheBenchmark
+{
+public:
+    struct CacheConcurrencyResult {
+        unsigned  numThreads;
+        double    lookupsPerSec;    // filter and filter bank lookups of cached objects, all threads
+        double    resamplersPerSec; // 24-bit resampler constructions, all threads
+        long long hits;             // cache counters over the run, filters and filter banks
+        long long misses;
+        long long evictions;
+    };
+
+    // Looks up cached filters and constructs resamplers from 1, 2, 4... up to maxThreads threads at once
+    static std::vector<CacheConcurrencyResult> runCacheConcurrency(unsigned maxThreads = 8, double secondsPerCase = 0.5);
+};
+
+}
@@ -4,8 +4,23 @@
  For more information visit www.rabiensoftware.com
 
  ==============================================================================*/
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+#include <vector>
 #include "Util/Gin/imageBlur.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define STACKBLUR_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define STACKBLUR_NEON 1
+#endif
+
 static unsigned short const stackblur_mul[255] =
 {
     512,512,456,512,328,456,335,512,405,328,271,456,388,335,292,512,
@@ -715,4 +730,597 @@ void applyStackBlur (juce::Image& img, int radius)
     if (img.getFormat() == juce::Image::ARGB)          applyStackBlurARGB (img, (unsigned int)radius);
     if (img.getFormat() == juce::Image::RGB)           applyStackBlurRGB (img, (unsigned int)radius);
     if (img.getFormat() == juce::Image::SingleChannel) applyStackBlurBW (img, (unsigned int)radius);
-}
\ No newline at end of file
+}
+
+//==============================================================================
+// Parallel version. Every line, horizontal or vertical, is blurred by the same
+// kernel as above, so the result is identical. The channels of a pixel are kept
+// together in one SIMD register of four 32-bit sums (the largest sum, 255 * 255^2,
+// fits), the rows are shared between threads, then the columns are transposed a
+// strip at a time into a contiguous buffer, blurred as rows and transposed back.
+
+static constexpr unsigned int STACKBLUR_ROWS_PER_JOB      = 8;
+static constexpr unsigned int STACKBLUR_COLUMNS_PER_STRIP = 16; // a 64 byte cache line of ARGB pixels
+
+#if defined(STACKBLUR_SSE2)
+
+struct StackBlurPixel
+{
+    using Type = __m128i;
+
+    template <unsigned int channels>
+    static inline Type load (const unsigned char* p)
+    {
+        int32_t v = 0;
+        memcpy (&v, p, channels);
+        const __m128i zero = _mm_setzero_si128();
+        return _mm_unpacklo_epi16 (_mm_unpacklo_epi8 (_mm_cvtsi32_si128 (v), zero), zero);
+    }
+
+    static inline Type zero()                 { return _mm_setzero_si128(); }
+    static inline Type add (Type a, Type b)   { return _mm_add_epi32 (a, b); }
+    static inline Type sub (Type a, Type b)   { return _mm_sub_epi32 (a, b); }
+
+    // (unsigned char) ((sum * mul_sum) >> shr_sum) of each channel, with 64-bit products
+    template <unsigned int channels>
+    static inline void store (unsigned char* p, Type sum, unsigned int mul_sum, unsigned char shr_sum)
+    {
+        const __m128i mul   = _mm_set1_epi32 ((int) mul_sum);
+        const __m128i shift = _mm_cvtsi32_si128 (shr_sum);
+        __m128i even = _mm_srl_epi64 (_mm_mul_epu32 (sum, mul), shift);
+        __m128i odd  = _mm_srl_epi64 (_mm_mul_epu32 (_mm_srli_epi64 (sum, 32), mul), shift);
+        __m128i res  = _mm_and_si128 (_mm_or_si128 (even, _mm_slli_epi64 (odd, 32)), _mm_set1_epi32 (0xFF));
+        res = _mm_packus_epi16 (_mm_packs_epi32 (res, res), res);
+        int32_t v = _mm_cvtsi128_si32 (res);
+        memcpy (p, &v, channels);
+    }
+};
+
+#elif defined(STACKBLUR_NEON)
+
+struct StackBlurPixel
+{
+    using Type = uint32x4_t;
+
+    template <unsigned int channels>
+    static inline Type load (const unsigned char* p)
+    {
+        uint64_t v = 0;
+        memcpy (&v, p, channels);
+        return vmovl_u16 (vget_low_u16 (vmovl_u8 (vcreate_u8 (v))));
+    }
+
+    static inline Type zero()                 { return vdupq_n_u32 (0); }
+    static inline Type add (Type a, Type b)   { return vaddq_u32 (a, b); }
+    static inline Type sub (Type a, Type b)   { return vsubq_u32 (a, b); }
+
+    template <unsigned int channels>
+    static inline void store (unsigned char* p, Type sum, unsigned int mul_sum, unsigned char shr_sum)
+    {
+        const uint32x2_t mul   = vdup_n_u32 (mul_sum);
+        const int64x2_t  shift = vdupq_n_s64 (-(int64_t) shr_sum);
+        uint64x2_t lo = vshlq_u64 (vmull_u32 (vget_low_u32 (sum), mul), shift);
+        uint64x2_t hi = vshlq_u64 (vmull_u32 (vget_high_u32 (sum), mul), shift);
+        uint16x4_t res = vmovn_u32 (vcombine_u32 (vmovn_u64 (lo), vmovn_u64 (hi)));
+        uint8x8_t  res8 = vmovn_u16 (vcombine_u16 (res, res));
+        uint32_t v = vget_lane_u32 (vreinterpret_u32_u8 (res8), 0);
+        memcpy (p, &v, channels);
+    }
+};
+
+#endif
+
+// Portable fallback, also used for single channel images
+template <unsigned int channels>
+struct StackBlurPixelScalar
+{
+    struct Type { uint32_t c[channels]; };
+
+    template <unsigned int>
+    static inline Type load (const unsigned char* p)
+    {
+        Type t;
+        for (unsigned int i = 0; i < channels; ++i)
+            t.c[i] = p[i];
+        return t;
+    }
+
+    static inline Type zero()
+    {
+        Type t;
+        for (unsigned int i = 0; i < channels; ++i)
+            t.c[i] = 0;
+        return t;
+    }
+
+    static inline Type add (Type a, Type b)
+    {
+        for (unsigned int i = 0; i < channels; ++i)
+            a.c[i] += b.c[i];
+        return a;
+    }
+
+    static inline Type sub (Type a, Type b)
+    {
+        for (unsigned int i = 0; i < channels; ++i)
+            a.c[i] -= b.c[i];
+        return a;
+    }
+
+    template <unsigned int>
+    static inline void store (unsigned char* p, Type sum, unsigned int mul_sum, unsigned char shr_sum)
+    {
+        for (unsigned int i = 0; i < channels; ++i)
+            p[i] = (unsigned char)(((uint64_t) sum.c[i] * mul_sum) >> shr_sum);
+    }
+};
+
+#if defined(STACKBLUR_SSE2) || defined(STACKBLUR_NEON)
+template <unsigned int channels>
+using StackBlurPixelFor = typename std::conditional<channels == 1, StackBlurPixelScalar<1>, StackBlurPixel>::type;
+#else
+template <unsigned int channels>
+using StackBlurPixelFor = StackBlurPixelScalar<channels>;
+#endif
+
+// Blurs one line of contiguous pixels in place, the same steps as the loops above.
+// stack must hold radius * 2 + 1 entries.
+template <unsigned int channels, typename P>
+static void stackBlurLine (unsigned char* line, unsigned int len, unsigned int radius,
+                           typename P::Type* stack)
+{
+    const unsigned int wm = len - 1;
+    const unsigned int div = radius * 2 + 1;
+    const unsigned int mul_sum = stackblur_mul[radius];
+    const unsigned char shr_sum = stackblur_shr[radius];
+
+    typename P::Type sum = P::zero(), sum_in = P::zero(), sum_out = P::zero();
+
+    // sum of px * (i + 1) for i = 0..radius, and of src[i] * (radius + 1 - i) for
+    // i = 1..radius, built by repeated addition as SSE2 has no 32-bit multiply
+    const unsigned char* src_ptr = line;
+    const typename P::Type first = P::template load<channels> (src_ptr);
+
+    for (unsigned int i = 0; i <= radius; ++i)
+    {
+        stack[i] = first;
+        sum_out = P::add (sum_out, first);
+        sum = P::add (sum, sum_out);
+    }
+
+    for (unsigned int i = 1; i <= radius; ++i)
+    {
+        if (i <= wm)
+            src_ptr += channels;
+
+        const typename P::Type px = P::template load<channels> (src_ptr);
+        stack[i + radius] = px;
+        sum_in = P::add (sum_in, px);
+        sum = P::add (sum, sum_in);
+    }
+
+    unsigned int sp = radius;
+    unsigned int xp = std::min (radius, wm);
+
+    src_ptr = line + channels * xp;
+    unsigned char* dst_ptr = line;
+
+    for (unsigned int x = 0; x < len; ++x)
+    {
+        P::template store<channels> (dst_ptr, sum, mul_sum, shr_sum);
+        dst_ptr += channels;
+
+        sum = P::sub (sum, sum_out);
+
+        unsigned int stack_start = sp + div - radius;
+        if (stack_start >= div)
+            stack_start -= div;
+
+        sum_out = P::sub (sum_out, stack[stack_start]);
+
+        if (xp < wm)
+        {
+            src_ptr += channels;
+            ++xp;
+        }
+
+        const typename P::Type px = P::template load<channels> (src_ptr);
+        stack[stack_start] = px;
+
+        sum_in = P::add (sum_in, px);
+        sum    = P::add (sum, sum_in);
+
+        ++sp;
+        if (sp >= div)
+            sp = 0;
+
+        sum_out = P::add (sum_out, stack[sp]);
+        sum_in  = P::sub (sum_in, stack[sp]);
+    }
+}
+
+// Runs job (index) for index = 0..numJobs-1 on numThreads threads, the caller included
+template <typename Job>
+static void stackBlurParallelFor (unsigned int numJobs, unsigned int numThreads, const Job& job)
+{
+    numThreads = std::max (1u, std::min (numThreads, numJobs));
+
+    std::atomic<unsigned int> nextJob { 0 };
+    auto work = [&]()
+    {
+        for (unsigned int index = nextJob++; index < numJobs; index = nextJob++)
+            job (index);
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < numThreads; ++t)
+        threads.emplace_back (work);
+    work();
+    for (auto& thread : threads)
+        thread.join();
+}
+
+template <unsigned int channels>
+static void stackBlurPixelsParallel (unsigned char* pixels, unsigned int w, unsigned int h, size_t lineStride,
+                                     unsigned int radius, unsigned int numThreads)
+{
+    using P = StackBlurPixelFor<channels>;
+
+    const unsigned int numRowJobs = (h + STACKBLUR_ROWS_PER_JOB - 1) / STACKBLUR_ROWS_PER_JOB;
+    stackBlurParallelFor (numRowJobs, numThreads, [&](unsigned int job)
+    {
+        typename P::Type stack[254 * 2 + 1];
+        const unsigned int y1 = std::min (h, (job + 1) * STACKBLUR_ROWS_PER_JOB);
+
+        for (unsigned int y = job * STACKBLUR_ROWS_PER_JOB; y < y1; ++y)
+            stackBlurLine<channels, P> (pixels + lineStride * y, w, radius, stack);
+    });
+
+    const unsigned int numStrips = (w + STACKBLUR_COLUMNS_PER_STRIP - 1) / STACKBLUR_COLUMNS_PER_STRIP;
+    stackBlurParallelFor (numStrips, numThreads, [&](unsigned int strip)
+    {
+        typename P::Type stack[254 * 2 + 1];
+        std::vector<unsigned char> columns ((size_t) STACKBLUR_COLUMNS_PER_STRIP * h * channels);
+
+        const unsigned int x0 = strip * STACKBLUR_COLUMNS_PER_STRIP;
+        const unsigned int numColumns = std::min (STACKBLUR_COLUMNS_PER_STRIP, w - x0);
+        const size_t columnStride = (size_t) h * channels;
+
+        // Each image row of the strip is one cache line read, spread over one
+        // write stream per column
+        for (unsigned int y = 0; y < h; ++y)
+        {
+            const unsigned char* src = pixels + lineStride * y + (size_t) x0 * channels;
+            unsigned char* dst = columns.data() + (size_t) y * channels;
+
+            for (unsigned int c = 0; c < numColumns; ++c)
+                memcpy (dst + columnStride * c, src + c * channels, channels);
+        }
+
+        for (unsigned int c = 0; c < numColumns; ++c)
+            stackBlurLine<channels, P> (columns.data() + columnStride * c, h, radius, stack);
+
+        for (unsigned int y = 0; y < h; ++y)
+        {
+            const unsigned char* src = columns.data() + (size_t) y * channels;
+            unsigned char* dst = pixels + lineStride * y + (size_t) x0 * channels;
+
+            for (unsigned int c = 0; c < numColumns; ++c)
+                memcpy (dst + c * channels, src + columnStride * c, channels);
+        }
+    });
+}
+
+void applyStackBlurParallel (juce::Image& img, int radius, unsigned int numThreads)
+{
+    const unsigned int w = (unsigned int)img.getWidth();
+    const unsigned int h = (unsigned int)img.getHeight();
+
+    if (w == 0 || h == 0)
+        return;
+
+    juce::Image::BitmapData data (img, juce::Image::BitmapData::readWrite);
+
+    const unsigned int r = juce::jlimit (2u, 254u, (unsigned int)radius);
+    const size_t lineStride = (size_t)data.lineStride;
+
+    if (numThreads == 0)
+        numThreads = std::max (1u, std::thread::hardware_concurrency());
+
+    if (img.getFormat() == juce::Image::ARGB)          stackBlurPixelsParallel<4> (data.data, w, h, lineStride, r, numThreads);
+    if (img.getFormat() == juce::Image::RGB)           stackBlurPixelsParallel<3> (data.data, w, h, lineStride, r, numThreads);
+    if (img.getFormat() == juce::Image::SingleChannel) stackBlurPixelsParallel<1> (data.data, w, h, lineStride, r, numThreads);
+}
+
+//==============================================================================
+// Multi-resolution approximation for large radii. The image is box filtered down
+// by the factor, blurred with the radius scaled down by the same factor and
+// scaled back up bilinearly. Below a few pixels of radius at low resolution the
+// bilinear steps start to show, so the factor is only raised while the scaled
+// radius stays above STACKBLUR_MIN_DOWNSAMPLED_RADIUS.
+
+static constexpr int       STACKBLUR_MAX_RADIUS             = 254;
+static constexpr int       STACKBLUR_MIN_DOWNSAMPLED_RADIUS = 6;
+static constexpr int       STACKBLUR_MAX_DOWNSAMPLE_FACTOR  = 4;
+static constexpr long long STACKBLUR_LARGE_IMAGE_PIXELS     = 1920 * 1080; // below this 2x is enough
+static constexpr int       STACKBLUR_WEIGHT_BITS            = 3;            // of the bilinear weights, exact for 2x and 4x
+static constexpr unsigned  STACKBLUR_UPSAMPLE_ROWS_PER_JOB  = 32;
+
+int getStackBlurDownsampleFactor (int width, int height, int radius)
+{
+    const bool isLarge = (long long) width * height >= STACKBLUR_LARGE_IMAGE_PIXELS;
+    const int maxFactor = isLarge ? STACKBLUR_MAX_DOWNSAMPLE_FACTOR : 2;
+
+    int factor = 1;
+    while (factor < maxFactor && radius >= factor * 2 * STACKBLUR_MIN_DOWNSAMPLED_RADIUS)
+        factor *= 2;
+
+    // Radii above the stack blur's limit can only be reached at low resolution
+    while (factor < STACKBLUR_MAX_DOWNSAMPLE_FACTOR && radius > factor * STACKBLUR_MAX_RADIUS)
+        factor *= 2;
+
+    return factor;
+}
+
+// sums[i] += src[i], the vertical step of the box filter
+static void addBytesToWords (uint16_t* sums, const unsigned char* src, size_t n)
+{
+    size_t i = 0;
+#if defined(STACKBLUR_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16)
+    {
+        const __m128i bytes = _mm_loadu_si128 ((const __m128i*) (src + i));
+        __m128i* out = (__m128i*) (sums + i);
+        _mm_storeu_si128 (out,     _mm_add_epi16 (_mm_loadu_si128 (out),     _mm_unpacklo_epi8 (bytes, zero)));
+        _mm_storeu_si128 (out + 1, _mm_add_epi16 (_mm_loadu_si128 (out + 1), _mm_unpackhi_epi8 (bytes, zero)));
+    }
+#elif defined(STACKBLUR_NEON)
+    for (; i + 8 <= n; i += 8)
+        vst1q_u16 (sums + i, vaddw_u8 (vld1q_u16 (sums + i), vld1_u8 (src + i)));
+#endif
+    for (; i < n; ++i)
+        sums[i] = (uint16_t) (sums[i] + src[i]);
+}
+
+// dst[i] = (top[i] * topWeight + bottom[i] * bottomWeight) / 64 rounded, the
+// vertical step of the bilinear upsampling
+static void interpolateWords (unsigned char* dst, const uint16_t* top, const uint16_t* bottom,
+                              uint16_t topWeight, uint16_t bottomWeight, size_t n)
+{
+    constexpr int shift = 2 * STACKBLUR_WEIGHT_BITS;
+    size_t i = 0;
+#if defined(STACKBLUR_SSE2)
+    const __m128i wt = _mm_set1_epi16 ((short) topWeight);
+    const __m128i wb = _mm_set1_epi16 ((short) bottomWeight);
+    const __m128i round = _mm_set1_epi16 (1 << (shift - 1));
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i lo = _mm_add_epi16 (_mm_mullo_epi16 (_mm_loadu_si128 ((const __m128i*) (top + i)), wt),
+                                    _mm_mullo_epi16 (_mm_loadu_si128 ((const __m128i*) (bottom + i)), wb));
+        __m128i hi = _mm_add_epi16 (_mm_mullo_epi16 (_mm_loadu_si128 ((const __m128i*) (top + i + 8)), wt),
+                                    _mm_mullo_epi16 (_mm_loadu_si128 ((const __m128i*) (bottom + i + 8)), wb));
+        lo = _mm_srli_epi16 (_mm_add_epi16 (lo, round), shift);
+        hi = _mm_srli_epi16 (_mm_add_epi16 (hi, round), shift);
+        _mm_storeu_si128 ((__m128i*) (dst + i), _mm_packus_epi16 (lo, hi));
+    }
+#elif defined(STACKBLUR_NEON)
+    for (; i + 8 <= n; i += 8)
+    {
+        const uint16x8_t sum = vmlaq_n_u16 (vmulq_n_u16 (vld1q_u16 (top + i), topWeight), vld1q_u16 (bottom + i), bottomWeight);
+        vst1_u8 (dst + i, vrshrn_n_u16 (sum, shift));
+    }
+#endif
+    for (; i < n; ++i)
+        dst[i] = (unsigned char) ((top[i] * topWeight + bottom[i] * bottomWeight + (1 << (shift - 1))) >> shift);
+}
+
+// Bilinear source position of each output pixel, the low resolution pixel
+// centres fall at (i + 0.5) * factor
+struct StackBlurUpsampleTap
+{
+    unsigned int i0, i1;
+    unsigned int weight; // of i1, out of 1 << STACKBLUR_WEIGHT_BITS
+};
+
+static std::vector<StackBlurUpsampleTap> getUpsampleTaps (unsigned int len, unsigned int lowLen, unsigned int factor)
+{
+    std::vector<StackBlurUpsampleTap> taps (len);
+
+    for (unsigned int i = 0; i < len; ++i)
+    {
+        // position * 2 * factor, exact in integers
+        const int pos = (int) (2 * i + 1) - (int) factor;
+        StackBlurUpsampleTap& tap = taps[i];
+
+        if (pos <= 0)
+        {
+            tap.i0 = tap.i1 = 0;
+            tap.weight = 0;
+            continue;
+        }
+
+        tap.i0 = (unsigned int) pos / (2 * factor);
+        tap.i1 = std::min (tap.i0 + 1, lowLen - 1);
+        tap.weight = (((unsigned int) pos - tap.i0 * 2 * factor) << STACKBLUR_WEIGHT_BITS) / (2 * factor);
+    }
+    return taps;
+}
+
+// Horizontal step of the bilinear upsampling, one low resolution row to the full
+// width. Between two low resolution pixel centres the weights repeat every factor
+// pixels, so they are constants.
+template <unsigned int channels, unsigned int factor>
+static void upsampleRow (const unsigned char* src, unsigned int lw, uint16_t* dst, unsigned int w)
+{
+    constexpr unsigned int one = 1u << STACKBLUR_WEIGHT_BITS;
+    constexpr unsigned int half = factor / 2;
+
+    unsigned int x = 0;
+    for (; x < std::min (w, half); ++x)
+        for (unsigned int c = 0; c < channels; ++c)
+            dst[x * channels + c] = (uint16_t) (src[c] * one);
+
+    for (unsigned int i = 0; i + 1 < lw && x + factor <= w; ++i, x += factor)
+    {
+        const unsigned char* left  = src + (size_t) i * channels;
+        const unsigned char* right = left + channels;
+        uint16_t* out = dst + (size_t) x * channels;
+
+        for (unsigned int k = 0; k < factor; ++k)
+        {
+            const unsigned int weight = (2 * k + 1) * one / (2 * factor);
+            for (unsigned int c = 0; c < channels; ++c)
+                out[k * channels + c] = (uint16_t) (left[c] * (one - weight) + right[c] * weight);
+        }
+    }
+
+    // A partial group at the right edge, then the pixels beyond the last centre
+    for (; x < w; ++x)
+    {
+        const unsigned int pos = 2 * x + 1 - factor;
+        const unsigned int i0 = pos / (2 * factor);
+        const unsigned int i1 = std::min (i0 + 1, lw - 1);
+        const unsigned int weight = ((pos - i0 * 2 * factor) << STACKBLUR_WEIGHT_BITS) / (2 * factor);
+
+        for (unsigned int c = 0; c < channels; ++c)
+            dst[x * channels + c] = (uint16_t) (src[i0 * channels + c] * (one - weight) + src[i1 * channels + c] * weight);
+    }
+}
+
+template <unsigned int channels, unsigned int factor>
+static void stackBlurPixelsDownsampled (unsigned char* pixels, unsigned int w, unsigned int h, size_t lineStride,
+                                        unsigned int radius, unsigned int numThreads)
+{
+    const unsigned int lw = (w + factor - 1) / factor;
+    const unsigned int lh = (h + factor - 1) / factor;
+    const size_t lowStride = (size_t) lw * channels;
+    std::vector<unsigned char> low (lowStride * lh);
+
+    // Box filter, the factor source rows of each low resolution row are summed
+    // into a row of 16-bit values first, then its pixels in groups of factor
+    const unsigned int numLowJobs = (lh + STACKBLUR_ROWS_PER_JOB - 1) / STACKBLUR_ROWS_PER_JOB;
+    stackBlurParallelFor (numLowJobs, numThreads, [&](unsigned int job)
+    {
+        std::vector<uint16_t> sums ((size_t) w * channels);
+        const unsigned int ly1 = std::min (lh, (job + 1) * STACKBLUR_ROWS_PER_JOB);
+
+        for (unsigned int ly = job * STACKBLUR_ROWS_PER_JOB; ly < ly1; ++ly)
+        {
+            const unsigned int y0 = ly * factor;
+            const unsigned int y1 = std::min (h, y0 + factor);
+
+            std::fill (sums.begin(), sums.end(), (uint16_t) 0);
+            for (unsigned int y = y0; y < y1; ++y)
+                addBytesToWords (sums.data(), pixels + lineStride * y, sums.size());
+
+            // Whole blocks divide by a power of two, the partial ones at the right
+            // and bottom edges by their pixel count
+            constexpr unsigned int countBits = factor == 4 ? 4u : 2u;
+            const unsigned int wholeBlocks = (y1 - y0) == factor ? w / factor : 0;
+            const uint16_t* src = sums.data();
+            unsigned char* dst = low.data() + lowStride * ly;
+
+            for (unsigned int lx = 0; lx < wholeBlocks; ++lx)
+            {
+                for (unsigned int c = 0; c < channels; ++c)
+                {
+                    unsigned int sum = 0;
+                    for (unsigned int i = 0; i < factor; ++i)
+                        sum += src[i * channels + c];
+                    dst[c] = (unsigned char) ((sum + (1u << (countBits - 1))) >> countBits);
+                }
+                src += factor * channels;
+                dst += channels;
+            }
+
+            for (unsigned int lx = wholeBlocks; lx < lw; ++lx)
+            {
+                const unsigned int x0 = lx * factor;
+                const unsigned int x1 = std::min (w, x0 + factor);
+                const unsigned int count = (y1 - y0) * (x1 - x0);
+                src = sums.data() + (size_t) x0 * channels;
+
+                for (unsigned int c = 0; c < channels; ++c)
+                {
+                    unsigned int sum = 0;
+                    for (unsigned int x = 0; x < x1 - x0; ++x)
+                        sum += src[x * channels + c];
+                    dst[c] = (unsigned char) ((sum + count / 2) / count);
+                }
+                dst += channels;
+            }
+        }
+    });
+
+    const unsigned int lowRadius = juce::jlimit (2u, (unsigned int) STACKBLUR_MAX_RADIUS, (radius + factor / 2) / factor);
+    stackBlurPixelsParallel<channels> (low.data(), lw, lh, lowStride, lowRadius, numThreads);
+
+    // Each low resolution row a job needs is interpolated horizontally to the full
+    // width once, then each output row is interpolated vertically between two of
+    // them. All the weights are multiples of 1 / (2 * factor), so both steps are
+    // exact in 16 bits.
+    const std::vector<StackBlurUpsampleTap> yTaps = getUpsampleTaps (h, lh, factor);
+    const uint16_t one = 1u << STACKBLUR_WEIGHT_BITS;
+    const size_t rowSize = (size_t) w * channels;
+
+    const unsigned int numRowJobs = (h + STACKBLUR_UPSAMPLE_ROWS_PER_JOB - 1) / STACKBLUR_UPSAMPLE_ROWS_PER_JOB;
+    stackBlurParallelFor (numRowJobs, numThreads, [&](unsigned int job)
+    {
+        const unsigned int y0 = job * STACKBLUR_UPSAMPLE_ROWS_PER_JOB;
+        const unsigned int y1 = std::min (h, y0 + STACKBLUR_UPSAMPLE_ROWS_PER_JOB);
+        const unsigned int firstLow = yTaps[y0].i0;
+        const unsigned int lastLow  = yTaps[y1 - 1].i1;
+
+        std::vector<uint16_t> rows ((size_t) (lastLow - firstLow + 1) * rowSize);
+        for (unsigned int ly = firstLow; ly <= lastLow; ++ly)
+            upsampleRow<channels, factor> (low.data() + lowStride * ly, lw, rows.data() + (ly - firstLow) * rowSize, w);
+
+        for (unsigned int y = y0; y < y1; ++y)
+        {
+            const StackBlurUpsampleTap& yTap = yTaps[y];
+            const uint16_t* top    = rows.data() + (yTap.i0 - firstLow) * rowSize;
+            const uint16_t* bottom = rows.data() + (yTap.i1 - firstLow) * rowSize;
+
+            interpolateWords (pixels + lineStride * y, top, bottom, (uint16_t) (one - yTap.weight), (uint16_t) yTap.weight, rowSize);
+        }
+    });
+}
+
+void applyStackBlurDownsampled (juce::Image& img, int radius, int downsampleFactor, unsigned int numThreads)
+{
+    const unsigned int w = (unsigned int)img.getWidth();
+    const unsigned int h = (unsigned int)img.getHeight();
+
+    if (w == 0 || h == 0)
+        return;
+
+    const int factor = downsampleFactor > 0 ? downsampleFactor : getStackBlurDownsampleFactor ((int) w, (int) h, radius);
+
+    if (factor < 2)
+    {
+        applyStackBlurParallel (img, radius, numThreads);
+        return;
+    }
+
+    juce::Image::BitmapData data (img, juce::Image::BitmapData::readWrite);
+
+    const unsigned int r = juce::jlimit (2u, (unsigned int) (STACKBLUR_MAX_RADIUS * STACKBLUR_MAX_DOWNSAMPLE_FACTOR), (unsigned int)radius);
+    const size_t lineStride = (size_t)data.lineStride;
+
+    if (numThreads == 0)
+        numThreads = std::max (1u, std::thread::hardware_concurrency());
+
+    if (factor < 4)
+    {
+        if (img.getFormat() == juce::Image::ARGB)          stackBlurPixelsDownsampled<4, 2> (data.data, w, h, lineStride, r, numThreads);
+        if (img.getFormat() == juce::Image::RGB)           stackBlurPixelsDownsampled<3, 2> (data.data, w, h, lineStride, r, numThreads);
+        if (img.getFormat() == juce::Image::SingleChannel) stackBlurPixelsDownsampled<1, 2> (data.data, w, h, lineStride, r, numThreads);
+    }
+    else
+    {
+        if (img.getFormat() == juce::Image::ARGB)          stackBlurPixelsDownsampled<4, 4> (data.data, w, h, lineStride, r, numThreads);
+        if (img.getFormat() == juce::Image::RGB)           stackBlurPixelsDownsampled<3, 4> (data.data, w, h, lineStride, r, numThreads);
+        if (img.getFormat() == juce::Image::SingleChannel) stackBlurPixelsDownsampled<1, 4> (data.data, w, h, lineStride, r, numThreads);
+    }
+}
@@ -11,3 +11,29 @@
  \param radius from 2 to 254
  */
 void applyStackBlur (juce::Image& img, int radius);
+
+/** The same result as applyStackBlur(), for large images. The rows and then the
+    columns are shared between threads, the channels of each pixel are blurred
+    together in one SIMD register (SSE2 or NEON) and the columns are transposed in
+    cache line wide strips so the vertical pass reads memory in order.
+ *
+ \param radius from 2 to 254
+ \param numThreads 0 uses one per CPU, 1 blurs on the calling thread only
+ */
+void applyStackBlurParallel (juce::Image& img, int radius, unsigned int numThreads = 0);
+
+/** An approximation of applyStackBlur() for large radii and large images. The
+    image is scaled down by the factor, blurred with the radius scaled down by the
+    same amount and scaled back up bilinearly, so radii up to 1016 can be used.
+ *
+ \param downsampleFactor 1 (the full resolution applyStackBlurParallel()), 2 or 4,
+        0 picks one with getStackBlurDownsampleFactor()
+ \param numThreads 0 uses one per CPU
+ */
+void applyStackBlurDownsampled (juce::Image& img, int radius, int downsampleFactor = 0, unsigned int numThreads = 0);
+
+/** The largest factor that keeps the blur at low resolution smooth after
+    upscaling, only 2 for images smaller than 1920x1080 where the full resolution
+    blur is already cheap, unless the radius is above 254.
+ */
+int getStackBlurDownsampleFactor (int width, int height, int radius);
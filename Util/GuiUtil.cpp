@@ -10,7 +10,7 @@
 #include "Util/AppLookAndFeel.h"
 #include "Util/FileUtil.h"
 #include "Util/GuiUtil.h"
-#include "Util/Gin/imageBlur.h"
+#include "Util/ImageAtlas.h"
 
 using namespace juce;
 
@@ -105,8 +105,8 @@ void HourGlass::paint(Graphics& g) {
     AffineTransform rotateTransform;
     rotateTransform = rotateTransform.rotated(rotation, getWidth()/2.0f, getHeight()/2.0f);
     g.addTransform(rotateTransform);
-    g.drawImage(image, 0,0, getWidth(), getHeight(),
-                0,0, image.getWidth(), image.getHeight());
+    // Scaled once in the image atlas rather than on every frame of the animation, at the display's pixel size
+    ImageAtlas::getInstance()->getForContext(image, g, getWidth(), getHeight()).draw(g, getLocalBounds());
 }
 
 ///////////////////////////////////////
@@ -259,10 +259,24 @@ void LicenseAcceptWindow::buttonClicked (Button* buttonThatWasClicked)
 JUCE_IMPLEMENT_SINGLETON(BlockingWindowSingleton)
 BlockingWindow::BlockingWindow() {
     m_blockingColour = Colour((uint8_t)128,(uint8_t)128,(uint8_t)128,0.40f);  // translucent grey
+    m_backdrop.onReady = [this]() { if (isVisible()) { repaint(); } };
 }
 
 void BlockingWindow::paint(juce::Graphics &g) {
 
+    // The blurred parent is prepared in the background. Until it's ready the previous one is drawn, or
+    // the blocking colour if the size changed.
+    if (m_parentPtr && !m_imagePtr && m_blurEnabled) {
+        if (m_backdrop.isTakingSnapshot()) { return; }
+        Image backdrop = m_backdrop.getImage();
+        if (backdrop.isValid() && (m_backdrop.getArea() == getLocalBounds())) {
+            g.drawImageAt(backdrop, 0, 0);
+        } else {
+            g.fillAll(m_blockingColour);
+        }
+        return;
+    }
+
     if (m_parentPtr && m_imagePtr) {
         g.fillAll(Colour());
     } else if (!m_blurEnabled) {
@@ -274,17 +288,22 @@ void BlockingWindow::paint(juce::Graphics &g) {
             g.drawSingleLineText("Invalid image file", 20,20);
             return;
         }
-        g.drawImageWithin(*m_imagePtr, 0,0, getWidth(), getHeight(), RectanglePlacement::centred);
+        Rectangle<int> area = RectanglePlacement(RectanglePlacement::centred)
+                                  .appliedTo(m_imagePtr->getBounds().toFloat(), getLocalBounds().toFloat()).toNearestInt();
+        ImageAtlas::getInstance()->getForContext(*m_imagePtr, g, area.getWidth(), area.getHeight()).draw(g, area);
     }
 }
 
 void BlockingWindow::visibilityChanged()
 {
     if (isVisible() && m_parentPtr && !m_imagePtr && m_blurEnabled) {
-        Rectangle<int> area = Rectangle<int>(0,0,getWidth(), getHeight());
-        Image img = m_parentPtr->createComponentSnapshot(area);
-        applyStackBlur(img, m_blurRadius);
-        m_imagePtr = std::make_shared<juce::Image>(img);
+        BackdropCache::Config config = m_backdrop.getConfig();
+        if ((config.blurRadius != m_blurRadius) || (config.downsampleFactor != m_blurDownsampleFactor)) {
+            config.blurRadius       = m_blurRadius;
+            config.downsampleFactor = m_blurDownsampleFactor;
+            m_backdrop.setConfig(config);
+        }
+        m_backdrop.update(getLocalBounds());
     }
     else if (!isVisible() && m_parentPtr) {
          m_imagePtr = nullptr;
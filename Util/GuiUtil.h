@@ -13,6 +13,7 @@
 #include <JuceHeader.h>
 #include "Util/CommonDefs.h"
 #include "Util/AppLookAndFeel.h"
+#include "Util/BackdropCache.h"
 
 namespace stride {
 
@@ -112,15 +113,22 @@ public:
     void mouseDrag (const juce::MouseEvent& e) override {}
     virtual void visibilityChanged() override;
     
-    void setParentComponent(juce::Component* parentPtr) { m_parentPtr = parentPtr; }
+    void setParentComponent(juce::Component* parentPtr) { m_parentPtr = parentPtr; m_backdrop.setComponent(parentPtr); }
     void setImage(std::shared_ptr<juce::Image> imagePtr) { m_imagePtr = imagePtr; }
     void setBlurMode(bool isEnabled) { m_blurEnabled = isEnabled; }
     void setBlurRadius(int radius) { m_blurRadius = radius; }
+    // 1 blurs at full resolution, 2 or 4 at a lower one, 0 picks from the radius and window size
+    void setBlurDownsampleFactor(int factor) { m_blurDownsampleFactor = factor; }
     void setBackgroundColour(juce::Colour colour) { m_blockingColour = colour; }
 
+    // The blurred parent is kept between showings, owners can report changes to it here
+    BackdropCache& getBackdropCache() { return m_backdrop; }
+
 private:
     juce::Colour m_blockingColour;
     int m_blurRadius = 5;
+    int m_blurDownsampleFactor = 0;
+    BackdropCache m_backdrop;
     bool m_blurEnabled = true;
     juce::Component* m_parentPtr = nullptr;
     std::shared_ptr<juce::Image> m_imagePtr = nullptr;
@@ -0,0 +1,175 @@
+/*
+ * HalfBandBenchmark.cpp
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <set>
+#include "Util/ErrorMessage.h"
+#include "Util/r8b/CDSPHBDownsampler.h"
+#include "HalfBandBenchmark.h"
+
+namespace stride {
+
+namespace {
+
+constexpr int HB_BLOCK_SIZE       = 256;
+constexpr int HB_CHECK_NUM_BLOCKS = 64;
+
+const char* kernelSetName(r8b::EHBKernelSet kernelSet)
+{
+    switch (kernelSet) {
+    case r8b::hbksScalar : return "scalar";
+    case r8b::hbksSIMD   : return "simd";
+    case r8b::hbksAVX2   : return "avx2";
+    default              : return "unknown";
+    }
+}
+
+struct HBFilterCase {
+    bool   isThird;
+    int    steepIndex;
+    double reqAtten;
+    int    taps;
+};
+
+// One case per distinct filter in the half-band tables
+std::vector<HBFilterCase> getHBFilterCases()
+{
+    std::vector<HBFilterCase> cases;
+    std::set<const double*> seen;
+
+    for (int isThird=0; isThird < 2; isThird++) {
+        for (int steepIndex=0; steepIndex <= 6; steepIndex++) {
+            for (double reqAtten=40.0; reqAtten <= 260.0; reqAtten += 1.0) {
+                const double* filter;
+                int taps;
+                double atten;
+                if (isThird) {
+                    r8b::CDSPHBUpsampler::getHBFilterThird(reqAtten, steepIndex, filter, taps, atten);
+                } else {
+                    r8b::CDSPHBUpsampler::getHBFilter(reqAtten, steepIndex, filter, taps, atten);
+                }
+                if (seen.insert(filter).second) {
+                    cases.push_back({isThird != 0, steepIndex, reqAtten, taps});
+                }
+            }
+        }
+    }
+    return cases;
+}
+
+// Processes the input in fixed blocks, returns all output produced
+template <typename Processor>
+std::vector<double> processHB(const HBFilterCase& filterCase, r8b::EHBKernelSet kernelSet, const std::vector<double>& input)
+{
+    r8b::setHBKernelSet(kernelSet);
+    Processor processor(filterCase.reqAtten, filterCase.steepIndex, filterCase.isThird, 0.0);
+    r8b::resetHBKernelSet();
+
+    std::vector<double> inBlock(HB_BLOCK_SIZE);
+    std::vector<double> outBlock(HB_BLOCK_SIZE * 2);
+    std::vector<double> output;
+    for (size_t offset=0; offset + HB_BLOCK_SIZE <= input.size(); offset += HB_BLOCK_SIZE) {
+        std::copy(input.begin() + offset, input.begin() + offset + HB_BLOCK_SIZE, inBlock.begin());
+        double* op = outBlock.data();
+        int numOut = processor.process(inBlock.data(), HB_BLOCK_SIZE, op);
+        output.insert(output.end(), op, op + numOut);
+    }
+    return output;
+}
+
+template <typename Processor>
+double timeHB(const HBFilterCase& filterCase, r8b::EHBKernelSet kernelSet, const std::vector<double>& input, double seconds)
+{
+    r8b::setHBKernelSet(kernelSet);
+    Processor processor(filterCase.reqAtten, filterCase.steepIndex, filterCase.isThird, 0.0);
+    r8b::resetHBKernelSet();
+
+    std::vector<double> inBlock(input.begin(), input.begin() + HB_BLOCK_SIZE);
+    std::vector<double> outBlock(HB_BLOCK_SIZE * 2);
+
+    size_t numSamples = 0;
+    double elapsedSecs = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    while (elapsedSecs < seconds) {
+        for (unsigned i=0; i < 64; i++) {
+            double* op = outBlock.data();
+            processor.process(inBlock.data(), HB_BLOCK_SIZE, op);
+        }
+        numSamples += 64 * HB_BLOCK_SIZE;
+        elapsedSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return elapsedSecs * 1e9 / numSamples;
+}
+
+template <typename Processor>
+void runHBCase(const HBFilterCase& filterCase, bool isUpsampler, const std::vector<double>& input, double seconds,
+               std::vector<HalfBandBenchmark::HBKernelResult>& results)
+{
+    const std::vector<double> reference = processHB<Processor>(filterCase, r8b::hbksScalar, input);
+
+    for (int ks=r8b::hbksScalar; ks <= r8b::getBestHBKernelSet(); ks++) {
+        r8b::EHBKernelSet kernelSet = (r8b::EHBKernelSet)ks;
+
+        double maxError = 0.0;
+        std::vector<double> output = processHB<Processor>(filterCase, kernelSet, input);
+        if (output.size() != reference.size()) {
+            maxError = INFINITY;
+        } else {
+            for (size_t i=0; i < output.size(); i++) { maxError = std::max(maxError, std::fabs(output[i] - reference[i])); }
+        }
+
+        HalfBandBenchmark::HBKernelResult result;
+        result.isUpsampler = isUpsampler;
+        result.isThird     = filterCase.isThird;
+        result.steepIndex  = filterCase.steepIndex;
+        result.taps        = filterCase.taps;
+        result.kernelSet   = kernelSetName(kernelSet);
+        result.maxError    = maxError;
+        result.nsPerSample = (seconds > 0.0) ? timeHB<Processor>(filterCase, kernelSet, input, seconds) : 0.0;
+        results.push_back(result);
+    }
+}
+
+}
+
+std::string HalfBandBenchmark::getBestKernelSetName()
+{
+    return kernelSetName(r8b::getBestHBKernelSet());
+}
+
+std::vector<HalfBandBenchmark::HBKernelResult> HalfBandBenchmark::runHBKernels(double secondsPerCase)
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<double> input(HB_BLOCK_SIZE * HB_CHECK_NUM_BLOCKS);
+    for (auto& sample : input) { sample = dist(rng); }
+
+    std::vector<HBKernelResult> results;
+    for (auto& filterCase : getHBFilterCases()) {
+        runHBCase<r8b::CDSPHBUpsampler>(filterCase, true, input, secondsPerCase, results);
+        runHBCase<r8b::CDSPHBDownsampler>(filterCase, false, input, secondsPerCase, results);
+    }
+    return results;
+}
+
+bool HalfBandBenchmark::checkHBKernels()
+{
+    bool success = true;
+    for (auto& result : runHBKernels(0.0)) {
+        if (result.maxError > HB_KERNEL_TOLERANCE) {
+            errorMessage(std::string("HalfBandBenchmark::checkHBKernels(): ") + (result.isUpsampler ? "upsampler " : "downsampler ") +
+                         result.kernelSet + " kernel with " + std::to_string(result.taps) + " taps has error " +
+                         std::to_string(result.maxError));
+            success = false;
+        }
+    }
+    return success;
+}
+
+}
@@ -0,0 +1,42 @@
+/*
+ * HalfBandBenchmark.h
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace stride {
+
+// Correctness checks and timings of the r8b half-band up and downsampler kernel sets
+class HalfBandBenchmark
+{
+public:
+    struct HBKernelResult {
+        bool        isUpsampler;
+        bool        isThird;
+        int         steepIndex;
+        int         taps;
+        std::string kernelSet;   // "scalar", "simd" or "avx2"
+        double      maxError;    // against the scalar kernels
+        double      nsPerSample; // per input sample
+    };
+
+    static constexpr double HB_KERNEL_TOLERANCE = 1e-12;
+
+    // The best kernel set of this CPU, named as in the results
+    static std::string getBestKernelSetName();
+
+    // Runs every half-band kernel set available on this CPU for every filter the half-band tables
+    // produce, comparing against the scalar kernels.
+    static std::vector<HBKernelResult> runHBKernels(double secondsPerCase = 0.05);
+
+    // Returns false and reports an error if any kernel set is outside HB_KERNEL_TOLERANCE
+    static bool checkHBKernels();
+};
+
+}
@@ -0,0 +1,383 @@
+/*
+ * ImageAtlas.cpp
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+#include <algorithm>
+#include <cstring>
+#include "Util/GuiUtil.h"
+#include "ImageAtlas.h"
+
+namespace stride {
+
+namespace {
+
+constexpr int SHELF_HEIGHT_SLACK = 4; // a shelf takes entries down to 1/4 shorter than itself
+
+bool fitsShelf(int shelfHeight, int slotHeight)
+{
+    return (shelfHeight >= slotHeight) && (shelfHeight - slotHeight <= shelfHeight / SHELF_HEIGHT_SLACK);
+}
+
+}
+
+////////////////
+// ImageAtlas::Handle
+////////////////
+bool ImageAtlas::Handle::isReady() const
+{
+    return m_entry && (m_entry->state.load() == EntryState::READY);
+}
+
+int ImageAtlas::Handle::getWidth() const
+{
+    return m_entry ? m_entry->key.width : 0;
+}
+
+int ImageAtlas::Handle::getHeight() const
+{
+    return m_entry ? m_entry->key.height : 0;
+}
+
+void ImageAtlas::Handle::draw(juce::Graphics& g, int x, int y, float opacity) const
+{
+    if (!m_entry) { return; }
+    // Same size, so this is a copy rather than a resample
+    draw(g, juce::Rectangle<int>(x, y, m_entry->key.width, m_entry->key.height), opacity);
+}
+
+void ImageAtlas::Handle::draw(juce::Graphics& g, const juce::Rectangle<int>& area, float opacity) const
+{
+    if (!m_entry) { return; }
+    const Entry& entry = *m_entry;
+
+    g.setOpacity(opacity);
+    if (entry.state.load() == EntryState::READY) {
+        g.drawImage(entry.page, area.getX(), area.getY(), area.getWidth(), area.getHeight(),
+                    entry.area.getX(), entry.area.getY(), entry.area.getWidth(), entry.area.getHeight());
+    } else {
+        g.drawImage(entry.source, area.getX(), area.getY(), area.getWidth(), area.getHeight(),
+                    0, 0, entry.source.getWidth(), entry.source.getHeight());
+    }
+}
+
+juce::Image ImageAtlas::Handle::getImage() const
+{
+    if (!isReady()) { return juce::Image(); }
+    // Not a clipped view, the slot is reused once the entry is evicted
+    return m_entry->page.getClippedImage(m_entry->area).createCopy();
+}
+
+////////////////
+// ImageAtlas
+////////////////
+JUCE_IMPLEMENT_SINGLETON(ImageAtlas)
+
+ImageAtlas::ImageAtlas()
+{
+
+}
+
+ImageAtlas::~ImageAtlas()
+{
+    m_threadPool.removeAllJobs(true, 5000);
+    cancelPendingUpdate();
+    clearSingletonInstance();
+}
+
+void ImageAtlas::setConfig(const Config& config)
+{
+    clear();
+    m_config = config;
+    m_config.pageSize = std::max(m_config.pageSize, 64);
+    m_config.padding  = std::max(m_config.padding, 0);
+}
+
+ImageAtlas::Handle ImageAtlas::get(const juce::Image& image, int width, int height)
+{
+    Handle handle;
+    if (!image.isValid() || (width <= 0) || (height <= 0)) { return handle; }
+
+    const Key key { image.getPixelData(), width, height };
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        m_lru.splice(m_lru.begin(), m_lru, it->second); // iterators stay valid
+        m_hits++;
+        m_touch(**it->second);
+        handle.m_entry = *it->second;
+        return handle;
+    }
+
+    m_misses++;
+    auto entryPtr = std::make_shared<Entry>();
+    entryPtr->key    = key;
+    entryPtr->source = image;
+    m_touch(*entryPtr);
+    if ((width > m_config.pageSize) || (height > m_config.pageSize)) {
+        // Larger than a page, scaled into an image of its own
+        entryPtr->area      = juce::Rectangle<int>(0, 0, width, height);
+        entryPtr->pageIndex = -1;
+    } else if (!m_allocate(*entryPtr)) {
+        // Every entry was used this frame, evicting one would only have it scaled again for the next one.
+        // Not cached, the handle draws the source image.
+        m_overflows++;
+        entryPtr->state.store(EntryState::EVICTED);
+        handle.m_entry = entryPtr;
+        return handle;
+    }
+
+    m_lru.push_front(entryPtr);
+    m_entries[key] = m_lru.begin();
+    m_scale(entryPtr);
+
+    handle.m_entry = entryPtr;
+    return handle;
+}
+
+ImageAtlas::Handle ImageAtlas::getForHeight(const juce::Image& image, unsigned targetHeight, unsigned maxWidth)
+{
+    if (!image.isValid()) { return Handle(); }
+    juce::Image imageRef = image;
+    unsigned width = maxWidth ? getImageWidthFromNewHeight(imageRef, targetHeight, maxWidth)
+                              : getImageWidthFromNewHeight(imageRef, targetHeight);
+    return get(image, (int)width, (int)targetHeight);
+}
+
+ImageAtlas::Handle ImageAtlas::getForContext(const juce::Image& image, juce::Graphics& g, int width, int height)
+{
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    return get(image, std::max(juce::roundToInt(width * scale), 1), std::max(juce::roundToInt(height * scale), 1));
+}
+
+void ImageAtlas::clear()
+{
+    for (auto& entryPtr : m_lru) {
+        entryPtr->state.store(EntryState::EVICTED);
+    }
+    m_lru.clear();
+    m_entries.clear();
+    m_pages.clear(); // handles still drawing from a page keep its image alive
+}
+
+ImageAtlas::Stats ImageAtlas::getStats() const
+{
+    Stats stats;
+    stats.numEntries = (unsigned)m_entries.size();
+    stats.numPages   = (unsigned)m_pages.size();
+    stats.numPending = m_numPending.load();
+    stats.hits       = m_hits;
+    stats.misses     = m_misses;
+    stats.evictions  = m_evictions;
+    stats.overflows  = m_overflows;
+    return stats;
+}
+
+// Marks the entry as used in the current frame, and starts a new frame at the next handleAsyncUpdate()
+void ImageAtlas::m_touch(Entry& entry)
+{
+    entry.lastUsedFrame = m_frame;
+    if (!m_isFrameUpdatePending) {
+        m_isFrameUpdatePending = true;
+        triggerAsyncUpdate();
+    }
+}
+
+// Finds space for the entry, which must fit in a page, evicting the least recently requested entries when
+// the pages are full. Returns false if every entry left was used in the current frame.
+bool ImageAtlas::m_allocate(Entry& entry)
+{
+    const int pageSize   = m_config.pageSize;
+    const int slotWidth  = entry.key.width + m_config.padding;
+    const int slotHeight = entry.key.height + m_config.padding;
+
+    while (true) {
+        // An existing shelf of about the right height, the shortest that fits
+        int bestPage = -1, bestShelf = -1, bestHeight = 0;
+        for (int p=0; p < (int)m_pages.size(); p++) {
+            for (int s=0; s < (int)m_pages[p].shelves.size(); s++) {
+                const Shelf& shelf = m_pages[p].shelves[s];
+                if (!fitsShelf(shelf.height, slotHeight)) { continue; }
+                if ((bestPage >= 0) && (shelf.height >= bestHeight)) { continue; }
+                bool hasRoom = (pageSize - shelf.usedWidth >= slotWidth);
+                for (const Slot& slot : shelf.freeSlots) {
+                    if (slot.width >= slotWidth) { hasRoom = true; break; }
+                }
+                if (hasRoom) { bestPage = p; bestShelf = s; bestHeight = shelf.height; }
+            }
+        }
+        if (bestPage >= 0) {
+            return m_allocateInShelf(m_pages[bestPage], bestPage, bestShelf, slotWidth, entry);
+        }
+
+        // A new shelf in a page with room below its last one
+        for (int p=0; p < (int)m_pages.size(); p++) {
+            Page& page = m_pages[p];
+            if (pageSize - page.usedHeight >= slotHeight) {
+                page.shelves.push_back(Shelf { page.usedHeight, slotHeight });
+                page.usedHeight += slotHeight;
+                return m_allocateInShelf(page, p, (int)page.shelves.size() - 1, slotWidth, entry);
+            }
+        }
+
+        // A new page
+        if (m_pages.size() < std::max(m_config.maxPages, 1U)) {
+            Page page;
+            page.image = juce::Image(juce::Image::ARGB, pageSize, pageSize, true, juce::SoftwareImageType());
+            page.shelves.push_back(Shelf { 0, slotHeight });
+            page.usedHeight = slotHeight;
+            m_pages.push_back(std::move(page));
+            return m_allocateInShelf(m_pages.back(), (int)m_pages.size() - 1, 0, slotWidth, entry);
+        }
+
+        if (m_lru.empty()) {
+            // Nothing left to evict but the shelves don't suit this size, start the pages again
+            if (m_pages.empty()) { return false; }
+            m_pages.clear();
+            continue;
+        }
+
+        // Full, evict the least recently requested entry and try again. If it was used this frame so were
+        // all the others.
+        std::shared_ptr<Entry> oldestPtr = m_lru.back();
+        if (oldestPtr->lastUsedFrame == m_frame) { return false; }
+        m_entries.erase(oldestPtr->key);
+        m_lru.pop_back();
+        m_evict(*oldestPtr);
+        m_evictions++;
+    }
+}
+
+bool ImageAtlas::m_allocateInShelf(Page& page, int pageIndex, int shelfIndex, int slotWidth, Entry& entry)
+{
+    Shelf& shelf = page.shelves[shelfIndex];
+    int x = -1;
+
+    // The narrowest free slot that fits, the rest of it stays free
+    auto best = shelf.freeSlots.end();
+    for (auto it = shelf.freeSlots.begin(); it != shelf.freeSlots.end(); ++it) {
+        if ((it->width >= slotWidth) && ((best == shelf.freeSlots.end()) || (it->width < best->width))) { best = it; }
+    }
+    if (best != shelf.freeSlots.end()) {
+        x = best->x;
+        best->x     += slotWidth;
+        best->width -= slotWidth;
+        if (best->width == 0) { shelf.freeSlots.erase(best); }
+    } else {
+        x = shelf.usedWidth;
+        shelf.usedWidth += slotWidth;
+    }
+
+    entry.page       = page.image;
+    entry.area       = juce::Rectangle<int>(x, shelf.y, entry.key.width, entry.key.height);
+    entry.pageIndex  = pageIndex;
+    entry.shelfIndex = shelfIndex;
+    entry.slotWidth  = slotWidth;
+    return true;
+}
+
+// Returns the entry's space to its shelf. The pixels are left as they are, the next entry scaled into
+// the space clears what it doesn't cover.
+void ImageAtlas::m_evict(Entry& entry)
+{
+    entry.state.store(EntryState::EVICTED);
+    if (entry.pageIndex < 0) { return; }
+
+    Shelf& shelf = m_pages[entry.pageIndex].shelves[entry.shelfIndex];
+    shelf.freeSlots.push_back(Slot { entry.area.getX(), entry.slotWidth });
+
+    // Merge neighbouring slots and give back any at the end of the shelf
+    std::sort(shelf.freeSlots.begin(), shelf.freeSlots.end(), [](const Slot& a, const Slot& b) { return a.x < b.x; });
+    std::vector<Slot> merged;
+    for (const Slot& slot : shelf.freeSlots) {
+        if (!merged.empty() && (merged.back().x + merged.back().width == slot.x)) {
+            merged.back().width += slot.width;
+        } else {
+            merged.push_back(slot);
+        }
+    }
+    if (!merged.empty() && (merged.back().x + merged.back().width == shelf.usedWidth)) {
+        shelf.usedWidth = merged.back().x;
+        merged.pop_back();
+    }
+    shelf.freeSlots = std::move(merged);
+
+    // Empty shelves at the bottom of the page can be taken again by entries of any height
+    Page& page = m_pages[entry.pageIndex];
+    while (!page.shelves.empty() && (page.shelves.back().usedWidth == 0)) {
+        page.usedHeight = page.shelves.back().y;
+        page.shelves.pop_back();
+    }
+}
+
+// Scales into an image of the entry's own on the thread pool. The pages are only written on the message
+// thread, by m_copyToPage(), as they are drawn from there.
+void ImageAtlas::m_scale(const std::shared_ptr<Entry>& entryPtr)
+{
+    m_numPending++;
+    m_threadPool.addJob([this, entryPtr]() {
+        Entry& entry = *entryPtr;
+        if (entry.state.load() == EntryState::PENDING) {
+            entry.scaled = entry.source.rescaled(entry.key.width, entry.key.height, juce::Graphics::highResamplingQuality)
+                                       .convertedToFormat(juce::Image::ARGB);
+            juce::ScopedLock lock(m_scaledLock);
+            m_scaledEntries.push_back(entryPtr);
+        } else {
+            m_numPending--;
+        }
+        triggerAsyncUpdate();
+    });
+}
+
+// Copies the entry's scaled image into its slot, unless it was evicted while it was being scaled
+void ImageAtlas::m_copyToPage(Entry& entry)
+{
+    juce::Image scaled = std::move(entry.scaled);
+    if (entry.state.load() != EntryState::PENDING) { return; }
+
+    if (entry.pageIndex < 0) {
+        entry.page = juce::SoftwareImageType().convert(scaled);
+    } else {
+        // The padding right of and below the entry is cleared too, so nothing from an evicted entry
+        // shows when the page is drawn scaled
+        const juce::Rectangle<int> slot = entry.area.withSize(entry.area.getWidth() + m_config.padding,
+                                                              entry.area.getHeight() + m_config.padding)
+                                                    .getIntersection(entry.page.getBounds());
+        juce::Image::BitmapData srcData(scaled, juce::Image::BitmapData::readOnly);
+        juce::Image::BitmapData dstData(entry.page, slot.getX(), slot.getY(), slot.getWidth(), slot.getHeight(),
+                                        juce::Image::BitmapData::writeOnly);
+        const size_t lineBytes = (size_t)entry.key.width * dstData.pixelStride;
+        const size_t slotBytes = (size_t)slot.getWidth() * dstData.pixelStride;
+        for (int y=0; y < slot.getHeight(); y++) {
+            uint8_t* dstPtr = dstData.getLinePointer(y);
+            if (y < entry.key.height) {
+                memcpy(dstPtr, srcData.getLinePointer(y), lineBytes);
+                if (slotBytes > lineBytes) { memset(dstPtr + lineBytes, 0, slotBytes - lineBytes); }
+            } else {
+                memset(dstPtr, 0, slotBytes);
+            }
+        }
+    }
+    entry.state.store(EntryState::READY);
+}
+
+void ImageAtlas::handleAsyncUpdate()
+{
+    m_frame++;
+    m_isFrameUpdatePending = false;
+
+    std::vector<std::shared_ptr<Entry>> scaledEntries;
+    {
+        juce::ScopedLock lock(m_scaledLock);
+        scaledEntries.swap(m_scaledEntries);
+    }
+    if (scaledEntries.empty()) { return; }
+
+    for (auto& entryPtr : scaledEntries) {
+        m_copyToPage(*entryPtr);
+        m_numPending--;
+    }
+    if (onImagesReady) { onImagesReady(); }
+}
+
+}
@@ -0,0 +1,190 @@
+/*
+ * ImageAtlas.h
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <JuceHeader.h>
+
+namespace stride {
+
+// Pre-scaled copies of pedal, logo and control images packed into a few large pages, so views that draw
+// many of them (e.g. the library grid) copy pixels at their final size instead of resampling full size
+// PNGs on every paint. Each requested size of an image gets its own entry. The scaling runs on a
+// background thread into an image of its own, and copied into its page on the message thread; until an
+// entry is ready its handle draws the source image scaled on the fly, the same as before. When the pages
+// are full the least recently requested entries are evicted, but never one requested since the last
+// message thread update, i.e. in the same paint. If all of them were, the new entry isn't cached and is
+// counted in Stats::overflows.
+//
+// Pages are packed in shelves (rows of similar height) and an evicted entry's space is reused by the next
+// entry of the same or smaller size, which suits a grid where most images share a few sizes.
+// All calls are message thread only.
+class ImageAtlas : private juce::AsyncUpdater
+{
+    struct Entry;
+
+public:
+    struct Config {
+        int      pageSize = 2048; // width and height of each page
+        unsigned maxPages = 4;    // 16MB each at the default size
+        int      padding  = 1;    // transparent pixels between entries
+    };
+
+    struct Stats {
+        unsigned numEntries = 0;
+        unsigned numPages   = 0;
+        unsigned numPending = 0; // entries waiting to be scaled
+        uint64_t hits       = 0;
+        uint64_t misses     = 0;
+        uint64_t evictions  = 0;
+        uint64_t overflows  = 0; // entries not cached because every entry in the pages was in use
+    };
+
+    // A sub-rectangle of one of the pages, cheap to copy. Handles stay safe to use after their entry is
+    // evicted, they go back to drawing the source image.
+    class Handle
+    {
+    public:
+        Handle() = default;
+
+        bool isValid() const { return m_entry != nullptr; }
+        bool isReady() const;
+        int  getWidth() const;
+        int  getHeight() const;
+
+        // Draws at the handle's size with the top left corner at x, y
+        void draw(juce::Graphics& g, int x, int y, float opacity = 1.0f) const;
+
+        // Draws scaled into area, e.g. a handle from getForContext() into the logical area it was sized for
+        void draw(juce::Graphics& g, const juce::Rectangle<int>& area, float opacity = 1.0f) const;
+
+        // A copy of the pre-scaled pixels, invalid unless isReady(). It stays valid after the entry is
+        // evicted, but unlike draw() each call allocates.
+        juce::Image getImage() const;
+
+    private:
+        std::shared_ptr<Entry> m_entry;
+        friend class ImageAtlas;
+    };
+
+    ImageAtlas();
+    virtual ~ImageAtlas();
+
+    const Config& getConfig() const { return m_config; }
+    void setConfig(const Config& config); // clears the atlas
+
+    // Returns the entry for image scaled to width x height, queuing the scaling if it isn't in the atlas
+    Handle get(const juce::Image& image, int width, int height);
+
+    // Same as get() with the width from getImageWidthFromNewHeight(), which may also reduce the height
+    Handle getForHeight(const juce::Image& image, unsigned targetHeight, unsigned maxWidth = 0);
+
+    // Same as get() with the size of width x height logical pixels in g's physical pixels, so the handle
+    // drawn with Handle::draw(g, area) isn't blurred on HiDPI displays
+    Handle getForContext(const juce::Image& image, juce::Graphics& g, int width, int height);
+
+    void  clear();
+    Stats getStats() const;
+
+    // Called on the message thread after entries have become ready, e.g. to repaint the views using them
+    std::function<void()> onImagesReady;
+
+    JUCE_DECLARE_SINGLETON (ImageAtlas, true)
+
+private:
+    enum class EntryState : int {
+        PENDING = 0,
+        READY,
+        EVICTED
+    };
+
+    struct Key {
+        const void* pixelData;
+        int         width;
+        int         height;
+        bool operator==(const Key& other) const {
+            return (pixelData == other.pixelData) && (width == other.width) && (height == other.height);
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return std::hash<const void*>()(key.pixelData) ^ ((size_t)key.width << 1) ^ ((size_t)key.height << 17);
+        }
+    };
+
+    struct Entry {
+        Key                     key;
+        juce::Image             source;     // keeps the pixel data, and so the key, unique while cached
+        juce::Image             page;       // or an image of its own if larger than a page
+        juce::Rectangle<int>    area;       // in the page
+        int                     pageIndex  = -1; // -1 for an image of its own
+        int                     shelfIndex = 0;
+        int                     slotWidth  = 0;  // including the padding
+        uint64_t                lastUsedFrame = 0;
+        juce::Image             scaled;     // from the thread pool, until copied into the page
+        std::atomic<EntryState> state { EntryState::PENDING };
+    };
+
+    struct Slot {
+        int x;
+        int width;
+    };
+
+    struct Shelf {
+        int y;
+        int height;
+        int usedWidth = 0;
+        std::vector<Slot> freeSlots; // from evicted entries
+    };
+
+    struct Page {
+        juce::Image        image;
+        std::vector<Shelf> shelves;
+        int                usedHeight = 0;
+    };
+
+    using LruList = std::list<std::shared_ptr<Entry>>; // most recently requested first
+
+    Config            m_config;
+    std::vector<Page> m_pages;
+    LruList           m_lru;
+    std::unordered_map<Key, LruList::iterator, KeyHash> m_entries;
+
+    uint64_t              m_hits      = 0;
+    uint64_t              m_misses    = 0;
+    uint64_t              m_evictions = 0;
+    uint64_t              m_overflows = 0;
+    std::atomic<unsigned> m_numPending { 0 };
+
+    // Each handleAsyncUpdate() starts a new frame, entries used in the current one aren't evicted
+    uint64_t              m_frame = 1;
+    bool                  m_isFrameUpdatePending = false;
+
+    juce::CriticalSection              m_scaledLock;
+    std::vector<std::shared_ptr<Entry>> m_scaledEntries; // waiting to be copied into their pages
+
+    juce::ThreadPool      m_threadPool { 1 };
+
+    void m_touch(Entry& entry);
+    bool m_allocate(Entry& entry);
+    bool m_allocateInShelf(Page& page, int pageIndex, int shelfIndex, int slotWidth, Entry& entry);
+    void m_evict(Entry& entry);
+    void m_scale(const std::shared_ptr<Entry>& entryPtr);
+    void m_copyToPage(Entry& entry);
+
+    void handleAsyncUpdate() override;
+};
+
+}
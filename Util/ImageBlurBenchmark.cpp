@@ -0,0 +1,206 @@
+/*
+ * ImageBlurBenchmark.cpp
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <JuceHeader.h>
+#include "Util/Gin/imageBlur.h"
+#include "ImageBlurBenchmark.h"
+
+namespace stride {
+
+namespace {
+
+struct ImageSize {
+    int width;
+    int height;
+};
+
+constexpr ImageSize BENCHMARK_SIZES[] = { {1920, 1080}, {3840, 2160} };
+
+juce::Image makeNoiseImage(int width, int height)
+{
+    juce::Image img(juce::Image::ARGB, width, height, false);
+    juce::Image::BitmapData data(img, juce::Image::BitmapData::writeOnly);
+
+    std::mt19937 rng(0x5eed);
+    for (int y=0; y < height; y++) {
+        uint8_t* line = data.getLinePointer(y);
+        for (int x=0; x < width * data.pixelStride; x++) { line[x] = (uint8_t)(rng() >> 24); }
+    }
+    return img;
+}
+
+// Something like a plugin window: a vertical gradient, overlapping panels and a grid of thin lines
+juce::Image makeWindowImage(int width, int height)
+{
+    juce::Image img(juce::Image::ARGB, width, height, false);
+    juce::Image::BitmapData data(img, juce::Image::BitmapData::writeOnly);
+
+    for (int y=0; y < height; y++) {
+        uint8_t* line = data.getLinePointer(y);
+        const uint8_t shade = (uint8_t)(40 + 80 * y / height);
+        for (int x=0; x < width; x++) {
+            const bool isGridLine = (x % 48 == 24) || (y % 48 == 24);
+            uint8_t* pixel = line + x * data.pixelStride;
+            pixel[0] = isGridLine ? 220 : shade;
+            pixel[1] = isGridLine ? 220 : shade;
+            pixel[2] = isGridLine ? 220 : (uint8_t)(shade / 2);
+            pixel[3] = 255;
+        }
+    }
+
+    std::mt19937 rng(0x5eed);
+    for (unsigned panel=0; panel < 40; panel++) {
+        const int x0 = (int)(rng() % (unsigned)width);
+        const int y0 = (int)(rng() % (unsigned)height);
+        const int x1 = std::min(width,  x0 + 20 + (int)(rng() % (unsigned)(width / 4)));
+        const int y1 = std::min(height, y0 + 20 + (int)(rng() % (unsigned)(height / 4)));
+        const uint32_t colour = rng();
+
+        for (int y=y0; y < y1; y++) {
+            uint8_t* pixel = data.getLinePointer(y) + x0 * data.pixelStride;
+            for (int x=x0; x < x1; x++, pixel += data.pixelStride) {
+                pixel[0] = (uint8_t)colour;
+                pixel[1] = (uint8_t)(colour >> 8);
+                pixel[2] = (uint8_t)(colour >> 16);
+            }
+        }
+    }
+    return img;
+}
+
+bool isIdentical(const juce::Image& a, const juce::Image& b)
+{
+    juce::Image::BitmapData dataA(a, juce::Image::BitmapData::readOnly);
+    juce::Image::BitmapData dataB(b, juce::Image::BitmapData::readOnly);
+    const size_t lineBytes = (size_t)a.getWidth() * dataA.pixelStride;
+
+    for (int y=0; y < a.getHeight(); y++) {
+        if (memcmp(dataA.getLinePointer(y), dataB.getLinePointer(y), lineBytes) != 0) { return false; }
+    }
+    return true;
+}
+
+void compareImages(const juce::Image& reference, const juce::Image& img, double& psnrDb, int& maxError)
+{
+    juce::Image::BitmapData dataRef(reference, juce::Image::BitmapData::readOnly);
+    juce::Image::BitmapData data(img, juce::Image::BitmapData::readOnly);
+    const int lineBytes = reference.getWidth() * dataRef.pixelStride;
+
+    double sumSquares = 0.0;
+    maxError = 0;
+    for (int y=0; y < reference.getHeight(); y++) {
+        const uint8_t* lineRef = dataRef.getLinePointer(y);
+        const uint8_t* line    = data.getLinePointer(y);
+        for (int i=0; i < lineBytes; i++) {
+            const int error = std::abs((int)line[i] - (int)lineRef[i]);
+            sumSquares += (double)(error * error);
+            maxError = std::max(maxError, error);
+        }
+    }
+    const double meanSquare = sumSquares / ((double)lineBytes * reference.getHeight());
+    psnrDb = (meanSquare > 0.0) ? 10.0 * std::log10(255.0 * 255.0 / meanSquare) : INFINITY;
+}
+
+// Mean milliseconds per blur, blurring the same image repeatedly for at least one call
+template <typename Blur>
+double timeBlur(const juce::Image& source, double seconds, const Blur& blur)
+{
+    juce::Image img = source.createCopy();
+
+    unsigned numBlurs = 0;
+    double elapsedSecs = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    while (numBlurs == 0 || elapsedSecs < seconds) {
+        blur(img);
+        numBlurs++;
+        elapsedSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return elapsedSecs * 1000.0 / numBlurs;
+}
+
+}
+
+std::vector<ImageBlurBenchmark::StackBlurResult> ImageBlurBenchmark::runStackBlur(const std::vector<int>& radii,
+                                                                                  unsigned numThreads, double secondsPerCase)
+{
+    if (numThreads == 0) { numThreads = std::max(1U, std::thread::hardware_concurrency()); }
+
+    std::vector<StackBlurResult> results;
+    for (const ImageSize& size : BENCHMARK_SIZES) {
+        const juce::Image source = makeNoiseImage(size.width, size.height);
+
+        for (int radius : radii) {
+            StackBlurResult result;
+            result.width      = size.width;
+            result.height     = size.height;
+            result.radius     = radius;
+            result.numThreads = numThreads;
+
+            juce::Image reference = source.createCopy();
+            juce::Image parallel  = source.createCopy();
+            applyStackBlur(reference, radius);
+            applyStackBlurParallel(parallel, radius, numThreads);
+            result.isIdentical = isIdentical(reference, parallel);
+
+            result.referenceMs = timeBlur(source, secondsPerCase, [radius](juce::Image& img) { applyStackBlur(img, radius); });
+            result.parallelMs  = timeBlur(source, secondsPerCase, [radius, numThreads](juce::Image& img) {
+                applyStackBlurParallel(img, radius, numThreads);
+            });
+            result.speedup = result.referenceMs / result.parallelMs;
+            results.push_back(result);
+        }
+    }
+    return results;
+}
+
+std::vector<ImageBlurBenchmark::DownsampleResult> ImageBlurBenchmark::runDownsampled(const std::vector<int>& radii,
+                                                                                    unsigned numThreads, double secondsPerCase)
+{
+    if (numThreads == 0) { numThreads = std::max(1U, std::thread::hardware_concurrency()); }
+
+    std::vector<DownsampleResult> results;
+    for (const ImageSize& size : BENCHMARK_SIZES) {
+        const juce::Image source = makeWindowImage(size.width, size.height);
+
+        for (int radius : radii) {
+            juce::Image reference = source.createCopy();
+            applyStackBlurParallel(reference, radius, numThreads);
+            const double fullResMs = timeBlur(source, secondsPerCase, [radius, numThreads](juce::Image& img) {
+                applyStackBlurParallel(img, radius, numThreads);
+            });
+            const int automaticFactor = getStackBlurDownsampleFactor(size.width, size.height, radius);
+
+            for (int factor : {2, 4}) {
+                DownsampleResult result;
+                result.width            = size.width;
+                result.height           = size.height;
+                result.radius           = radius;
+                result.downsampleFactor = factor;
+                result.isAutomatic      = (factor == automaticFactor);
+                result.fullResMs        = fullResMs;
+
+                juce::Image blurred = source.createCopy();
+                applyStackBlurDownsampled(blurred, radius, factor, numThreads);
+                compareImages(reference, blurred, result.psnrDb, result.maxError);
+
+                result.ms = timeBlur(source, secondsPerCase, [radius, factor, numThreads](juce::Image& img) {
+                    applyStackBlurDownsampled(img, radius, factor, numThreads);
+                });
+                result.speedup = result.fullResMs / result.ms;
+                results.push_back(result);
+            }
+        }
+    }
+    return results;
+}
+
+}
@@ -0,0 +1,52 @@
+/*
+ * ImageBlurBenchmark.h
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+
+#pragma once
+
+#include <vector>
+
+namespace stride {
+
+// Timings of the image blurs used behind modal windows, on full-window snapshots
+class ImageBlurBenchmark
+{
+public:
+    struct StackBlurResult {
+        int      width;
+        int      height;
+        int      radius;
+        unsigned numThreads;
+        double   referenceMs; // applyStackBlur(), single-threaded scalar
+        double   parallelMs;  // applyStackBlurParallel()
+        double   speedup;
+        bool     isIdentical; // every pixel of the parallel blur matches the reference
+    };
+
+    struct DownsampleResult {
+        int      width;
+        int      height;
+        int      radius;
+        int      downsampleFactor;
+        bool     isAutomatic; // the factor getStackBlurDownsampleFactor() picks
+        double   fullResMs;   // applyStackBlurParallel()
+        double   ms;          // applyStackBlurDownsampled() with the factor
+        double   speedup;
+        double   psnrDb;      // against the full resolution blur, over every channel
+        int      maxError;    // largest difference of any channel, out of 255
+    };
+
+    // Blurs ARGB noise at 1920x1080 and 3840x2160 with each radius. numThreads 0 uses one per CPU.
+    static std::vector<StackBlurResult> runStackBlur(const std::vector<int>& radii = {4, 16, 64, 254},
+                                                     unsigned numThreads = 0, double secondsPerCase = 0.5);
+
+    // Compares the 2x and 4x downsampled blurs with the full resolution blur at 1080p and 4K, on a
+    // synthetic window of gradients, panels and thin lines
+    static std::vector<DownsampleResult> runDownsampled(const std::vector<int>& radii = {8, 16, 32, 64, 128, 254},
+                                                        unsigned numThreads = 0, double secondsPerCase = 0.5);
+};
+
+}
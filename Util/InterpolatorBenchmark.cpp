@@ -0,0 +1,252 @@
+/*
+ * InterpolatorBenchmark.cpp
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+#include "Util/r8b/CDSPMultiResampler.h"
+#include "Util/r8b/CDSPResampler.h"
+#include "InterpolatorBenchmark.h"
+
+namespace stride {
+
+namespace {
+
+constexpr int BLOCK_SIZE        = 1024;
+constexpr int POLY_NUM_TONES    = 8;
+constexpr int POLY_SKIP_SAMPLES = 256; // interpolator's start-up, at the output rate
+
+double toDb(double value)
+{
+    return 20.0 * std::log10(std::max(value, 1e-15));
+}
+
+// Feeds the input through the interpolator in blocks. The asynchronous mode never uses whole-number stepping.
+std::vector<double> interpolate(double srcRate, double dstRate, bool fractional, const std::vector<double>& input)
+{
+    r8b::CDSPFracInterpolator interpolator(srcRate, dstRate, 180.15, false, 0.0, fractional);
+    std::vector<double> inBlock(BLOCK_SIZE);
+    std::vector<double> outBlock(interpolator.getMaxOutLen(BLOCK_SIZE));
+    std::vector<double> output;
+
+    for (size_t pos=0; pos + BLOCK_SIZE <= input.size(); pos += BLOCK_SIZE) {
+        std::copy(input.begin() + pos, input.begin() + pos + BLOCK_SIZE, inBlock.begin());
+        double* op = outBlock.data();
+        const int outLen = interpolator.process(inBlock.data(), BLOCK_SIZE, op);
+        output.insert(output.end(), op, op + outLen);
+    }
+    return output;
+}
+
+double timeInterpolator(double srcRate, double dstRate, bool fractional, double seconds)
+{
+    r8b::CDSPFracInterpolator interpolator(srcRate, dstRate, 180.15, false, 0.0, fractional);
+    std::vector<double> inBlock(BLOCK_SIZE);
+    std::vector<double> outBlock(interpolator.getMaxOutLen(BLOCK_SIZE));
+    for (size_t i=0; i < inBlock.size(); i++) { inBlock[i] = std::sin(i * 0.1); }
+
+    size_t numSamples = 0;
+    double elapsedSecs = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    while (elapsedSecs < seconds) {
+        for (unsigned i=0; i < 16; i++) {
+            double* op = outBlock.data();
+            numSamples += interpolator.process(inBlock.data(), BLOCK_SIZE, op);
+        }
+        elapsedSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return elapsedSecs * 1e9 / numSamples;
+}
+
+// Least squares fit of a sine and cosine at the normalised frequency, returns the amplitude and the RMS of
+// what is left, and what is left itself if residualPtr isn't null. Frequencies above the sample rate fit
+// where they fold to.
+void fitTone(const std::vector<double>& signal, double normFreq, double& amplitude, double& residualRms,
+             std::vector<double>* residualPtr = nullptr)
+{
+    normFreq = std::fmod(normFreq, 1.0); // keeps the sin() arguments small
+
+    double ss = 0.0, sc = 0.0, cc = 0.0, xs = 0.0, xc = 0.0;
+    for (size_t i=POLY_SKIP_SAMPLES; i < signal.size(); i++) {
+        const double s = std::sin(R8B_2PI * normFreq * i);
+        const double c = std::cos(R8B_2PI * normFreq * i);
+        ss += s * s;
+        sc += s * c;
+        cc += c * c;
+        xs += signal[i] * s;
+        xc += signal[i] * c;
+    }
+    const double det = ss * cc - sc * sc;
+    const double a   = (xs * cc - xc * sc) / det;
+    const double b   = (xc * ss - xs * sc) / det;
+    amplitude = std::sqrt(a * a + b * b);
+
+    double energy = 0.0;
+    if (residualPtr) { residualPtr->assign(signal.size(), 0.0); }
+    for (size_t i=POLY_SKIP_SAMPLES; i < signal.size(); i++) {
+        const double r = signal[i] - a * std::sin(R8B_2PI * normFreq * i) - b * std::cos(R8B_2PI * normFreq * i);
+        energy += r * r;
+        if (residualPtr) { (*residualPtr)[i] = r; }
+    }
+    residualRms = std::sqrt(energy / (signal.size() - POLY_SKIP_SAMPLES));
+}
+
+// A CDSPResampler24 per channel, fed from and back into interleaved float frames the way an application
+// without CDSPMultiResampler would. Returns the output frames produced by each call.
+class SeparateResamplers
+{
+public:
+    SeparateResamplers(double srcRate, double dstRate, int numChannels)
+        : m_numChannels(numChannels), m_inBlock(BLOCK_SIZE)
+    {
+        for (int c=0; c < numChannels; c++) {
+            m_resamplers.emplace_back(new r8b::CDSPResampler24(srcRate, dstRate, BLOCK_SIZE));
+        }
+    }
+
+    int process(const float* ip, int numFrames, float* op)
+    {
+        int outLen = 0;
+        for (int c=0; c < m_numChannels; c++) {
+            for (int i=0; i < numFrames; i++) { m_inBlock[i] = ip[i * m_numChannels + c]; }
+            double* rp;
+            outLen = m_resamplers[c]->process(m_inBlock.data(), numFrames, rp);
+            for (int i=0; i < outLen; i++) { op[i * m_numChannels + c] = (float)rp[i]; }
+        }
+        return outLen;
+    }
+
+private:
+    int m_numChannels;
+    std::vector<double> m_inBlock;
+    std::vector<std::unique_ptr<r8b::CDSPResampler24>> m_resamplers;
+};
+
+// Feeds the interleaved input through processor.process() in BLOCK_SIZE frames, for the given time
+// if seconds > 0, otherwise once. Returns the time per input frame, and the output if it's not null.
+template <typename Processor>
+double timeInterleaved(Processor& processor, const std::vector<float>& input, int numChannels, int maxOutLen,
+                       double seconds, std::vector<float>* outputPtr)
+{
+    std::vector<float> outBlock((size_t)maxOutLen * numChannels);
+    const size_t numFrames = input.size() / numChannels;
+
+    size_t numProcessed = 0;
+    double elapsedSecs = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    do {
+        for (size_t pos=0; pos + BLOCK_SIZE <= numFrames; pos += BLOCK_SIZE) {
+            const int outLen = processor.process(input.data() + pos * numChannels, BLOCK_SIZE, outBlock.data());
+            if (outputPtr) { outputPtr->insert(outputPtr->end(), outBlock.begin(), outBlock.begin() + outLen * numChannels); }
+            numProcessed += BLOCK_SIZE;
+        }
+        elapsedSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsedSecs < seconds);
+    return elapsedSecs * 1e9 / std::max(numProcessed, (size_t)1);
+}
+
+// Adapts CDSPMultiResampler to timeInterleaved()
+struct MultiResamplerProcessor {
+    r8b::CDSPMultiResampler& resampler;
+    int process(const float* ip, int numFrames, float* op) { return resampler.processInterleaved(ip, numFrames, op); }
+};
+
+}
+
+std::vector<InterpolatorBenchmark::PolyphaseResult> InterpolatorBenchmark::runPolyphase(double secondsPerCase)
+{
+    static const double RATE_PAIRS[][2] = {
+        {88200.0, 48000.0}, {96000.0, 44100.0}, {88200.0, 96000.0}, {96000.0, 88200.0}, {176400.0, 48000.0}
+    };
+
+    std::vector<PolyphaseResult> results;
+    for (auto& ratePair : RATE_PAIRS) {
+        const double srcRate = ratePair[0];
+        const double dstRate = ratePair[1];
+        // The resampler has already limited the signal to just under the lower Nyquist frequency
+        const double maxToneFreq = 0.22 * std::min(srcRate, dstRate);
+
+        for (bool fractional : {false, true}) {
+            PolyphaseResult result;
+            result.srcRate          = srcRate;
+            result.dstRate          = dstRate;
+            result.path             = fractional ? "fractional" : "polyphase";
+            result.nsPerSample      = (secondsPerCase > 0.0) ? timeInterpolator(srcRate, dstRate, fractional, secondsPerCase) : 0.0;
+            result.passBandRippleDb = 0.0;
+            result.residualDb       = -400.0;
+            result.stopBandDb       = -400.0;
+
+            for (int toneIndex=1; toneIndex <= POLY_NUM_TONES; toneIndex++) {
+                const double toneFreq = maxToneFreq * toneIndex / POLY_NUM_TONES;
+                std::vector<double> tone((size_t)srcRate);
+                for (size_t i=0; i < tone.size(); i++) { tone[i] = std::sin(R8B_2PI * toneFreq * i / srcRate); }
+
+                double amplitude, residualRms;
+                std::vector<double> residual;
+                fitTone(interpolate(srcRate, dstRate, fractional, tone), toneFreq / dstRate, amplitude, residualRms, &residual);
+                result.passBandRippleDb = std::max(result.passBandRippleDb, std::fabs(toDb(amplitude)));
+                result.residualDb       = std::max(result.residualDb, toDb(residualRms * std::sqrt(2.0) / amplitude));
+
+                // The input tone has unit amplitude
+                for (double imageFreq : {srcRate - toneFreq, srcRate + toneFreq}) {
+                    double imageAmplitude, imageResidualRms;
+                    fitTone(residual, imageFreq / dstRate, imageAmplitude, imageResidualRms);
+                    result.stopBandDb = std::max(result.stopBandDb, toDb(imageAmplitude));
+                }
+            }
+            results.push_back(result);
+        }
+    }
+    return results;
+}
+
+std::vector<InterpolatorBenchmark::MultiChannelResult> InterpolatorBenchmark::runMultiChannel(double secondsPerCase)
+{
+    static const double RATE_PAIRS[][2] = {
+        {44100.0, 48000.0}, {48000.0, 44100.0}, {96000.0, 44100.0}, {44100.0, 96000.0}, {44100.0, 47999.0}
+    };
+
+    std::vector<MultiChannelResult> results;
+    for (auto& ratePair : RATE_PAIRS) {
+        const double srcRate = ratePair[0];
+        const double dstRate = ratePair[1];
+
+        for (int numChannels : {2, 4, 8}) {
+            std::mt19937 rng(1234);
+            std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+            std::vector<float> input((size_t)BLOCK_SIZE * 64 * numChannels);
+            for (auto& sample : input) { sample = dist(rng); }
+
+            SeparateResamplers separate(srcRate, dstRate, numChannels);
+            r8b::CDSPMultiResampler multiResampler(numChannels, srcRate, dstRate, BLOCK_SIZE, 2.0, 180.15); // as CDSPResampler24
+            MultiResamplerProcessor multi { multiResampler };
+            const int maxOutLen = multiResampler.getMaxOutLen();
+
+            std::vector<float> reference, output;
+            timeInterleaved(separate, input, numChannels, maxOutLen, 0.0, &reference);
+            timeInterleaved(multi, input, numChannels, maxOutLen, 0.0, &output);
+
+            MultiChannelResult result;
+            result.srcRate            = srcRate;
+            result.dstRate            = dstRate;
+            result.numChannels        = numChannels;
+            result.interpShared       = multiResampler.isInterpShared();
+            result.separateNsPerFrame = timeInterleaved(separate, input, numChannels, maxOutLen, secondsPerCase, nullptr);
+            result.multiNsPerFrame    = timeInterleaved(multi, input, numChannels, maxOutLen, secondsPerCase, nullptr);
+            result.speedup            = result.separateNsPerFrame / std::max(result.multiNsPerFrame, 1e-9);
+            result.maxError           = (output.size() == reference.size()) ? 0.0 : 1.0;
+            for (size_t i=0; i < std::min(output.size(), reference.size()); i++) {
+                result.maxError = std::max(result.maxError, (double)std::fabs(output[i] - reference[i]));
+            }
+            results.push_back(result);
+        }
+    }
+    return results;
+}
+
+}
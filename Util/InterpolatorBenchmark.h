@@ -0,0 +1,52 @@
+/*
+ * InterpolatorBenchmark.h
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace stride {
+
+// Accuracy and timings of the r8b fractional interpolator paths, single and multichannel
+class InterpolatorBenchmark
+{
+public:
+    struct PolyphaseResult {
+        double      srcRate;          // at the interpolator, after the resampler's 2x oversampling
+        double      dstRate;
+        std::string path;             // "polyphase" (whole-number stepping) or "fractional"
+        double      nsPerSample;      // per output sample
+        double      passBandRippleDb; // largest gain deviation over the pass band tones
+        double      residualDb;       // largest residual after removing a pass band tone, relative to the tone
+        double      stopBandDb;       // largest image of a pass band tone, relative to the input tone
+    };
+
+    struct MultiChannelResult {
+        double   srcRate;
+        double   dstRate;
+        int      numChannels;
+        bool     interpShared;       // CDSPMultiResampler::isInterpShared()
+        double   separateNsPerFrame; // a CDSPResampler24 per channel, de-interleaving and interleaving float frames
+        double   multiNsPerFrame;    // CDSPMultiResampler::processInterleaved() on the same frames
+        double   speedup;
+        double   maxError;           // against the separate resamplers, relative to full scale
+    };
+
+    // Compares the polyphase interpolator used for small rational ratios with the general fractional
+    // interpolator, at the rates the interpolator sees for the 44.1k and 48k families. The input is already
+    // band-limited by the resampler, so the interpolator's stop band is where the images of the pass band
+    // lie, at srcRate -/+ the tone, above the destination Nyquist. They are measured where they fold into
+    // the output.
+    static std::vector<PolyphaseResult> runPolyphase(double secondsPerCase = 0.25);
+
+    // Resamples interleaved float frames with CDSPMultiResampler, which interpolates all channels in one
+    // pass, and with a CDSPResampler24 per channel
+    static std::vector<MultiChannelResult> runMultiChannel(double secondsPerCase = 0.25);
+};
+
+}
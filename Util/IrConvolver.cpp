@@ -0,0 +1,176 @@
+/*
+ * IrConvolver.cpp
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include "Util/ErrorMessage.h"
+#include "IrConvolver.h"
+
+namespace stride {
+
+IrConvolver::IrConvolver(size_t maxIrLength, unsigned blockSizeBits, Partitioning partitioning, unsigned maxProcessBlockSize)
+: m_maxIrLength(std::max(maxIrLength, (size_t)1)),
+  m_maxProcessBlockSize(std::max(maxProcessBlockSize, 1U)),
+  m_layout((int)blockSizeBits, (int)m_maxIrLength, partitioning == Partitioning::NON_UNIFORM),
+  m_convolver(m_layout),
+  m_pendingKernel(nullptr)
+{
+    for (auto& slot : m_retiredKernels) { slot.store(nullptr, std::memory_order_relaxed); }
+    m_inBuffer.resize(m_maxProcessBlockSize);
+    m_outBuffer.resize(m_maxProcessBlockSize);
+}
+
+IrConvolver::~IrConvolver()
+{
+    delete m_pendingKernel.exchange(nullptr);
+    collectGarbage();
+    delete m_currentKernel;
+    delete m_prevKernel;
+}
+
+bool IrConvolver::loadIr(const float* ir, size_t irLength, float gain)
+{
+    std::vector<double> irDouble(ir ? irLength : 0);
+    for (size_t i=0; i < irDouble.size(); i++) { irDouble[i] = ir[i]; }
+    return loadIr(irDouble.data(), irDouble.size(), (double)gain);
+}
+
+bool IrConvolver::loadIr(const double* ir, size_t irLength, double gain)
+{
+    if (irLength > m_maxIrLength) {
+        warningMessage("IrConvolver::loadIr(): IR length " + std::to_string(irLength) + " truncated to " + std::to_string(m_maxIrLength));
+    }
+    if (!ir) { irLength = 0; }
+
+    r8b::CDSPPartKernel* kernel = new r8b::CDSPPartKernel(m_layout, ir, (int)std::min(irLength, m_maxIrLength), gain);
+
+    // Replace any kernel the audio thread hasn't picked up yet
+    delete m_pendingKernel.exchange(kernel, std::memory_order_acq_rel);
+    collectGarbage();
+    return true;
+}
+
+void IrConvolver::collectGarbage()
+{
+    for (auto& slot : m_retiredKernels) {
+        delete slot.exchange(nullptr, std::memory_order_acquire);
+    }
+}
+
+bool IrConvolver::m_retireKernel(r8b::CDSPPartKernel* kernel)
+{
+    if (!kernel) { return true; }
+    for (auto& slot : m_retiredKernels) {
+        r8b::CDSPPartKernel* expected = nullptr;
+        if (slot.compare_exchange_strong(expected, kernel, std::memory_order_release, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false; // all slots full, try again on the next block
+}
+
+void IrConvolver::m_installPendingKernel()
+{
+    // Only one swap at a time, the previous kernel is needed until its crossfade completes
+    if (m_convolver.isXFading()) { return; }
+    if (m_prevKernel) {
+        if (!m_retireKernel(m_prevKernel)) { return; }
+        m_prevKernel = nullptr;
+    }
+
+    if (!m_pendingKernel.load(std::memory_order_relaxed)) { return; }
+    r8b::CDSPPartKernel* kernel = m_pendingKernel.exchange(nullptr, std::memory_order_acq_rel);
+    if (!kernel) { return; }
+
+    m_convolver.setKernel(kernel);
+    m_prevKernel    = m_currentKernel;
+    m_currentKernel = kernel;
+}
+
+void IrConvolver::process(const float* in, float* out, unsigned numSamples)
+{
+    unsigned offset = 0;
+    while (offset < numSamples) {
+        unsigned chunk = std::min(numSamples - offset, m_maxProcessBlockSize);
+        for (unsigned i=0; i < chunk; i++) { m_inBuffer[i] = in[offset + i]; }
+        m_processChunk(m_inBuffer.data(), m_outBuffer.data(), chunk);
+        for (unsigned i=0; i < chunk; i++) { out[offset + i] = (float)m_outBuffer[i]; }
+        offset += chunk;
+    }
+}
+
+void IrConvolver::process(const double* in, double* out, unsigned numSamples)
+{
+    if (in != out) {
+        m_processChunk(in, out, numSamples);
+        return;
+    }
+
+    // In-place, go through the scratch buffer
+    unsigned offset = 0;
+    while (offset < numSamples) {
+        unsigned chunk = std::min(numSamples - offset, m_maxProcessBlockSize);
+        std::copy(in + offset, in + offset + chunk, m_inBuffer.begin());
+        m_processChunk(m_inBuffer.data(), out + offset, chunk);
+        offset += chunk;
+    }
+}
+
+void IrConvolver::m_processChunk(const double* in, double* out, unsigned numSamples)
+{
+    m_installPendingKernel();
+    m_convolver.process(in, out, (int)numSamples);
+}
+
+void IrConvolver::reset()
+{
+    m_convolver.clear();
+}
+
+std::vector<IrConvolver::BenchmarkResult> IrConvolver::benchmark(const std::vector<size_t>& irLengths, unsigned blockSizeBits,
+                                                                 Partitioning partitioning, double secondsPerLength)
+{
+    constexpr unsigned BLOCK_SIZE         = 256;
+    constexpr double   BENCH_SAMPLE_RATE  = 48000.0;
+
+    std::vector<BenchmarkResult> results;
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    std::vector<float> input(BLOCK_SIZE);
+    std::vector<float> output(BLOCK_SIZE);
+    for (auto& sample : input) { sample = dist(rng); }
+
+    for (size_t irLength : irLengths) {
+        std::vector<float> ir(irLength);
+        for (auto& sample : ir) { sample = dist(rng) * 0.01f; }
+
+        IrConvolver convolver(irLength, blockSizeBits, partitioning, BLOCK_SIZE);
+        convolver.loadIr(ir.data(), ir.size());
+
+        // Warm up, also completes the initial crossfade
+        for (unsigned i=0; i < 64; i++) { convolver.process(input.data(), output.data(), BLOCK_SIZE); }
+
+        size_t numSamples = 0;
+        auto start = std::chrono::steady_clock::now();
+        double elapsedSecs = 0.0;
+        while (elapsedSecs < secondsPerLength) {
+            for (unsigned i=0; i < 64; i++) { convolver.process(input.data(), output.data(), BLOCK_SIZE); }
+            numSamples += 64 * BLOCK_SIZE;
+            elapsedSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        BenchmarkResult result;
+        result.irLength       = irLength;
+        result.nsPerSample    = elapsedSecs * 1e9 / numSamples;
+        result.realtimeFactor = (numSamples / BENCH_SAMPLE_RATE) / elapsedSecs;
+        results.push_back(result);
+    }
+    return results;
+}
+
+}
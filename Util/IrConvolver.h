@@ -0,0 +1,82 @@
+/*
+ * IrConvolver.h
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "Util/r8b/CDSPPartConvolver.h"
+
+namespace stride {
+
+// Low latency impulse response convolution engine for IR_SELECT controls, built on the r8b FFT layer.
+// Loading an IR (allocation and FFTs) happens on a non real-time thread, the new IR is picked up by
+// process() on the audio thread and crossfaded in without allocating or locking. Only one thread may
+// load IRs and only one thread may process.
+class IrConvolver
+{
+public:
+    enum class Partitioning : unsigned {
+        UNIFORM = 0,  // all partitions have the latency block size, lowest cost for short IRs
+        NON_UNIFORM   // partitions grow 4x per stage, much cheaper for long IRs
+    };
+
+    struct BenchmarkResult {
+        size_t irLength;
+        double nsPerSample;
+        double realtimeFactor; // at 48 kHz, how many times faster than real time
+    };
+
+    static constexpr unsigned DEFAULT_BLOCK_SIZE_BITS = 6; // 64 samples latency
+    static constexpr unsigned RETIRED_KERNEL_SLOTS    = 8;
+
+    IrConvolver(size_t maxIrLength, unsigned blockSizeBits = DEFAULT_BLOCK_SIZE_BITS,
+                Partitioning partitioning = Partitioning::UNIFORM, unsigned maxProcessBlockSize = 2048);
+    ~IrConvolver();
+
+    // Loader thread
+    bool loadIr(const float* ir, size_t irLength, float gain = 1.0f);
+    bool loadIr(const double* ir, size_t irLength, double gain = 1.0);
+    void unloadIr() { loadIr((const double*)nullptr, 0); }
+    void collectGarbage(); // frees kernels the audio thread has finished with
+
+    // Audio thread
+    void process(const float* in, float* out, unsigned numSamples);
+    void process(const double* in, double* out, unsigned numSamples);
+    void reset();
+
+    unsigned getLatency() const { return (unsigned)m_convolver.getLatency(); }
+    size_t   getMaxIrLength() const { return m_maxIrLength; }
+    bool     isXFading() const { return m_convolver.isXFading(); }
+
+    // Processing cost per sample against IR length, on random data
+    static std::vector<BenchmarkResult> benchmark(const std::vector<size_t>& irLengths, unsigned blockSizeBits,
+                                                  Partitioning partitioning, double secondsPerLength = 0.5);
+
+private:
+    size_t                 m_maxIrLength;
+    unsigned               m_maxProcessBlockSize;
+    r8b::CDSPPartLayout    m_layout;
+    r8b::CDSPPartConvolver m_convolver;
+
+    // Loader to audio thread hand-off
+    std::atomic<r8b::CDSPPartKernel*> m_pendingKernel;
+    std::atomic<r8b::CDSPPartKernel*> m_retiredKernels[RETIRED_KERNEL_SLOTS];
+
+    // Owned by the audio thread
+    r8b::CDSPPartKernel* m_currentKernel = nullptr;
+    r8b::CDSPPartKernel* m_prevKernel    = nullptr;
+    std::vector<double>  m_inBuffer;
+    std::vector<double>  m_outBuffer;
+
+    void m_installPendingKernel();
+    bool m_retireKernel(r8b::CDSPPartKernel* kernel);
+    void m_processChunk(const double* in, double* out, unsigned numSamples);
+};
+
+}
@@ -0,0 +1,468 @@
+/*
+ * IrLibrary.cpp
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_set>
+#include "Util/ErrorMessage.h"
+#include "Util/r8b/CDSPResampler.h"
+#include "IrLibrary.h"
+
+namespace stride {
+
+namespace {
+
+constexpr char     INDEX_FILENAME[]     = "index.txt";
+constexpr char     INDEX_MAGIC[]        = "SIRC-INDEX";
+constexpr char     IR_FILE_PATTERN[]    = "*.wav;*.aif;*.aiff;*.flac";
+constexpr char     CACHE_MAGIC[4]       = {'S', 'I', 'R', 'C'};
+constexpr int      RESAMPLER_BLOCK_SIZE = 4096;
+constexpr uint64_t FNV_OFFSET_BASIS     = 0xcbf29ce484222325ULL;
+constexpr uint64_t FNV_PRIME            = 0x100000001b3ULL;
+
+uint64_t fnv1a(const void* data, size_t numBytes, uint64_t hash = FNV_OFFSET_BASIS)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i=0; i < numBytes; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+juce::String hashToString(uint64_t hash)
+{
+    return juce::String::toHexString((juce::int64)hash).paddedLeft('0', 16);
+}
+
+using Channels = std::vector<std::vector<double>>;
+
+Channels resample(const juce::AudioBuffer<float>& source, double sourceRate, double targetRate)
+{
+    const int sourceLength = source.getNumSamples();
+    Channels output(source.getNumChannels());
+
+    if (sourceRate == targetRate) {
+        for (int ch=0; ch < source.getNumChannels(); ch++) {
+            output[ch].assign(source.getReadPointer(ch), source.getReadPointer(ch) + sourceLength);
+        }
+        return output;
+    }
+
+    const int outputLength = (int)std::ceil(sourceLength * targetRate / sourceRate);
+    r8b::CDSPResampler24 resampler(sourceRate, targetRate, RESAMPLER_BLOCK_SIZE);
+    for (int ch=0; ch < source.getNumChannels(); ch++) {
+        output[ch].resize(outputLength);
+        resampler.oneshot(source.getReadPointer(ch), sourceLength, output[ch].data(), outputLength);
+        resampler.clear();
+    }
+    return output;
+}
+
+double getPeak(const Channels& channels)
+{
+    double peak = 0.0;
+    for (auto& channel : channels) {
+        for (double sample : channel) { peak = std::max(peak, std::fabs(sample)); }
+    }
+    return peak;
+}
+
+// Trims leading and trailing samples below the threshold on all channels, then caps the length
+void trim(Channels& channels, const IrLibrary::Config& config)
+{
+    size_t length = channels.empty() ? 0 : channels[0].size();
+    size_t first  = 0;
+    size_t last   = length;
+
+    if (config.trimSilence) {
+        const double threshold = getPeak(channels) * std::pow(10.0, config.trimThresholdDb / 20.0);
+        first = length;
+        last  = 0;
+        for (auto& channel : channels) {
+            for (size_t i=0; i < channel.size(); i++) {
+                if (std::fabs(channel[i]) > threshold) { first = std::min(first, i); break; }
+            }
+            for (size_t i=channel.size(); i > 0; i--) {
+                if (std::fabs(channel[i-1]) > threshold) { last = std::max(last, i); break; }
+            }
+        }
+        if (first >= last) { first = 0; last = std::min(length, (size_t)1); } // silent IR, keep one sample
+    }
+
+    last = std::min(last, first + config.maxIrLength);
+    for (auto& channel : channels) {
+        channel.erase(channel.begin() + last, channel.end());
+        channel.erase(channel.begin(), channel.begin() + first);
+    }
+}
+
+double normalise(Channels& channels, IrLibrary::NormaliseMode mode)
+{
+    double level = 0.0;
+    switch (mode) {
+    case IrLibrary::NormaliseMode::PEAK :
+        level = getPeak(channels);
+        break;
+    case IrLibrary::NormaliseMode::ENERGY :
+        for (auto& channel : channels) {
+            double energy = 0.0;
+            for (double sample : channel) { energy += sample * sample; }
+            level = std::max(level, std::sqrt(energy));
+        }
+        break;
+    default :
+        return 1.0;
+    }
+
+    if (level <= 0.0) { return 1.0; }
+    const double gain = 1.0 / level;
+    for (auto& channel : channels) {
+        for (double& sample : channel) { sample *= gain; }
+    }
+    return gain;
+}
+
+bool writeCacheFile(const juce::File& target, const Channels& channels, double sampleRate, uint64_t sourceHash,
+                    bool minPhase, double gain)
+{
+    IrLibrary::CacheHeader header;
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    header.version     = IrLibrary::CACHE_VERSION;
+    header.sampleRate  = sampleRate;
+    header.sourceHash  = sourceHash;
+    header.numChannels = (uint32_t)channels.size();
+    header.numSamples  = channels.empty() ? 0 : (uint32_t)channels[0].size();
+    header.flags       = minPhase ? IrLibrary::FLAG_MIN_PHASE : 0;
+    header.gain        = (float)gain;
+
+    // Write to a temporary file then rename, so readers never map a partially written file
+    juce::TemporaryFile temporary(target);
+    {
+        juce::FileOutputStream stream(temporary.getFile());
+        if (stream.failedToOpen()) { return false; }
+
+        std::vector<float> buffer(header.numSamples);
+        bool ok = stream.write(&header, sizeof(header));
+        for (auto& channel : channels) {
+            std::transform(channel.begin(), channel.end(), buffer.begin(), [](double x) { return (float)x; });
+            ok = ok && stream.write(buffer.data(), buffer.size() * sizeof(float));
+        }
+        stream.flush();
+        if (!ok || stream.getStatus().failed()) { return false; }
+    }
+    return temporary.overwriteTargetFileWithTemporary();
+}
+
+}
+
+////////////////
+// PreparedIr
+////////////////
+IrLibrary::PreparedIr::PreparedIr(const juce::File& cacheFile)
+{
+    if (!cacheFile.existsAsFile()) { return; }
+
+    m_file = std::make_unique<juce::MemoryMappedFile>(cacheFile, juce::MemoryMappedFile::readOnly);
+    if (!m_file->getData() || m_file->getSize() < sizeof(CacheHeader)) { return; }
+
+    auto header = static_cast<const CacheHeader*>(m_file->getData());
+    if ((std::memcmp(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0) || (header->version != CACHE_VERSION)) {
+        warningMessage("IrLibrary::PreparedIr: invalid cache file " + cacheFile.getFullPathName().toStdString());
+        return;
+    }
+
+    size_t expectedSize = sizeof(CacheHeader) + (size_t)header->numChannels * header->numSamples * sizeof(float);
+    if (m_file->getSize() < expectedSize) {
+        warningMessage("IrLibrary::PreparedIr: truncated cache file " + cacheFile.getFullPathName().toStdString());
+        return;
+    }
+    m_header = header;
+}
+
+const float* IrLibrary::PreparedIr::getChannel(unsigned channel) const
+{
+    if (!m_header || channel >= m_header->numChannels) { return nullptr; }
+    auto data = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(m_header) + sizeof(CacheHeader));
+    return data + (size_t)channel * m_header->numSamples;
+}
+
+////////////////
+// IrLibrary
+////////////////
+IrLibrary::IrLibrary(const std::string& irDirectory, const std::string& cacheDirectory)
+: m_irDirectory(irDirectory)
+{
+    if (cacheDirectory.empty()) {
+        m_cacheDirectory = m_irDirectory.getSiblingFile(m_irDirectory.getFileName() + "Cache");
+    } else {
+        m_cacheDirectory = juce::File(cacheDirectory);
+    }
+    m_loadIndex();
+}
+
+IrLibrary::ScanResult IrLibrary::prepare()
+{
+    return prepare(Config());
+}
+
+IrLibrary::ScanResult IrLibrary::prepare(const Config& config)
+{
+    auto start = std::chrono::steady_clock::now();
+    ScanResult result;
+
+    if (!m_irDirectory.isDirectory()) {
+        warningMessage("IrLibrary::prepare(): IR directory " + getLibraryDirectory() + " does not exist");
+        return result;
+    }
+    if (m_cacheDirectory.createDirectory().failed()) {
+        errorMessage("IrLibrary::prepare(): unable to create cache directory " + getCacheDirectory());
+        return result;
+    }
+
+    const uint64_t paramsHash = m_hashParams(config);
+    juce::Array<juce::File> files = m_irDirectory.findChildFiles(juce::File::findFiles, true, IR_FILE_PATTERN);
+    files.removeIf([this](const juce::File& file) { return file.isAChildOf(m_cacheDirectory); });
+    result.numFiles = (unsigned)files.size();
+
+    std::vector<std::string> relPaths(files.size());
+    std::vector<IndexEntry>  entries(files.size());
+    std::vector<uint8_t>     isDone(files.size(), 0);
+    std::vector<int>         pending;
+
+    // Anything whose size and modification time match the index, with all outputs present, is skipped
+    {
+        juce::ScopedLock lock(m_indexLock);
+        const bool indexIsValid = (m_indexParamsHash == paramsHash);
+        for (int i=0; i < files.size(); i++) {
+            relPaths[i] = files[i].getRelativePathFrom(m_irDirectory).toStdString();
+            auto it = m_index.find(relPaths[i]);
+            if (indexIsValid && (it != m_index.end()) && (it->second.size == files[i].getSize()) &&
+                (it->second.modified == files[i].getLastModificationTime().toMilliseconds()) &&
+                m_cacheFilesExist(it->second.hash, config)) {
+                entries[i] = it->second;
+                isDone[i]  = 1;
+                result.numSkipped++;
+            } else {
+                pending.push_back(i);
+            }
+        }
+    }
+
+    if (!pending.empty()) {
+        unsigned numThreads = config.numThreads ? config.numThreads : (unsigned)juce::SystemStats::getNumCpus();
+        numThreads = std::max(1U, std::min(numThreads, (unsigned)pending.size()));
+
+        juce::ThreadPool      threadPool((int)numThreads);
+        std::atomic<size_t>   numRemaining { pending.size() };
+        std::atomic<unsigned> numPrepared  { 0 };
+        juce::WaitableEvent   allDone;
+
+        for (int i : pending) {
+            threadPool.addJob([this, i, &files, &config, paramsHash, &entries, &isDone, &numRemaining, &numPrepared, &allDone]() {
+                if (m_prepareFile(files[i], config, paramsHash, entries[i])) {
+                    isDone[i] = 1;
+                    numPrepared++;
+                }
+                if (--numRemaining == 0) { allDone.signal(); }
+            });
+        }
+        allDone.wait(-1);
+
+        result.numPrepared = numPrepared.load();
+        result.numFailed   = (unsigned)pending.size() - result.numPrepared;
+    }
+
+    // Failed files are left out of the index so they are retried on the next scan, but the cache files of
+    // their previous entries are kept until then, e.g. for a file that was only locked during this scan
+    std::unordered_map<std::string, IndexEntry> index;
+    std::vector<uint64_t> keepHashes;
+    {
+        juce::ScopedLock lock(m_indexLock);
+        for (size_t i=0; i < relPaths.size(); i++) {
+            if (isDone[i]) {
+                index[relPaths[i]] = entries[i];
+            } else {
+                auto it = m_index.find(relPaths[i]);
+                if (it != m_index.end()) { keepHashes.push_back(it->second.hash); }
+            }
+        }
+        m_index.swap(index);
+        m_indexParamsHash = paramsHash;
+    }
+    m_saveIndex();
+    m_pruneCache(keepHashes);
+
+    result.elapsedSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+std::unique_ptr<IrLibrary::PreparedIr> IrLibrary::openPrepared(const std::string& relPath, double sampleRate, bool minPhase) const
+{
+    uint64_t hash;
+    {
+        juce::ScopedLock lock(m_indexLock);
+        auto it = m_index.find(relPath);
+        if (it == m_index.end()) { return nullptr; }
+        hash = it->second.hash;
+    }
+
+    auto prepared = std::make_unique<PreparedIr>(m_getCacheFile(hash, sampleRate, minPhase));
+    if (!prepared->isValid()) { return nullptr; }
+    return prepared;
+}
+
+bool IrLibrary::m_prepareFile(const juce::File& file, const Config& config, uint64_t paramsHash, IndexEntry& entry) const
+{
+    const std::string filename = file.getFullPathName().toStdString();
+
+    juce::MemoryBlock data;
+    if (!file.loadFileAsData(data)) {
+        errorMessage("IrLibrary: unable to read " + filename);
+        return false;
+    }
+    entry.size     = file.getSize();
+    entry.modified = file.getLastModificationTime().toMilliseconds();
+    entry.hash     = fnv1a(data.getData(), data.getSize(), paramsHash);
+
+    // Cache is content addressed, a renamed or copied IR needs no work
+    if (m_cacheFilesExist(entry.hash, config)) { return true; }
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    std::unique_ptr<juce::AudioFormatReader> reader(
+        formatManager.createReaderFor(std::make_unique<juce::MemoryInputStream>(data, false)));
+    if (!reader || (reader->numChannels == 0) || (reader->lengthInSamples <= 0) || (reader->sampleRate <= 0.0)) {
+        errorMessage("IrLibrary: unsupported audio file " + filename);
+        return false;
+    }
+
+    const int sourceLength = (int)std::min(reader->lengthInSamples, (juce::int64)std::numeric_limits<int>::max());
+    juce::AudioBuffer<float> source((int)reader->numChannels, sourceLength);
+    if (!reader->read(&source, 0, sourceLength, 0, true, true)) {
+        errorMessage("IrLibrary: error decoding " + filename);
+        return false;
+    }
+
+    for (double rate : config.targetRates) {
+        Channels resampled = resample(source, reader->sampleRate, rate);
+
+        for (int variant=0; variant < (config.computeMinPhase ? 2 : 1); variant++) {
+            const bool minPhase = (variant == 1);
+            juce::File target = m_getCacheFile(entry.hash, rate, minPhase);
+            if (target.existsAsFile()) { continue; }
+
+            Channels channels = resampled;
+            if (minPhase) {
+                for (auto& channel : channels) {
+                    if (!channel.empty()) { r8b::calcMinPhaseTransform(channel.data(), (int)channel.size()); }
+                }
+            }
+            trim(channels, config);
+            double gain = normalise(channels, config.normalise);
+
+            if (!writeCacheFile(target, channels, rate, entry.hash, minPhase, gain)) {
+                errorMessage("IrLibrary: unable to write " + target.getFullPathName().toStdString());
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool IrLibrary::m_cacheFilesExist(uint64_t hash, const Config& config) const
+{
+    for (double rate : config.targetRates) {
+        if (!m_getCacheFile(hash, rate, false).existsAsFile()) { return false; }
+        if (config.computeMinPhase && !m_getCacheFile(hash, rate, true).existsAsFile()) { return false; }
+    }
+    return true;
+}
+
+juce::File IrLibrary::m_getCacheFile(uint64_t hash, double sampleRate, bool minPhase) const
+{
+    juce::String name = hashToString(hash) + "_" + juce::String((int)std::lround(sampleRate)) + (minPhase ? "_min" : "") + ".irc";
+    return m_cacheDirectory.getChildFile(name);
+}
+
+uint64_t IrLibrary::m_hashParams(const Config& config)
+{
+    // Target rates and min-phase only select which files are produced, they're part of the file names
+    uint64_t hash = fnv1a(&CACHE_VERSION, sizeof(CACHE_VERSION));
+    uint8_t  trimSilence = config.trimSilence ? 1 : 0;
+    uint32_t normalise   = (uint32_t)config.normalise;
+    uint64_t maxIrLength = config.maxIrLength;
+    hash = fnv1a(&trimSilence, sizeof(trimSilence), hash);
+    hash = fnv1a(&config.trimThresholdDb, sizeof(config.trimThresholdDb), hash);
+    hash = fnv1a(&normalise, sizeof(normalise), hash);
+    hash = fnv1a(&maxIrLength, sizeof(maxIrLength), hash);
+    return hash;
+}
+
+void IrLibrary::m_loadIndex()
+{
+    juce::StringArray lines;
+    m_cacheDirectory.getChildFile(INDEX_FILENAME).readLines(lines);
+    if (lines.isEmpty()) { return; }
+
+    juce::StringArray header = juce::StringArray::fromTokens(lines[0], "\t", "");
+    if ((header.size() != 3) || (header[0] != INDEX_MAGIC) || (header[1].getIntValue() != (int)CACHE_VERSION)) {
+        warningMessage("IrLibrary: ignoring invalid index in " + getCacheDirectory());
+        return;
+    }
+
+    juce::ScopedLock lock(m_indexLock);
+    m_indexParamsHash = (uint64_t)header[2].getHexValue64();
+    for (int i=1; i < lines.size(); i++) {
+        juce::StringArray fields = juce::StringArray::fromTokens(lines[i], "\t", "");
+        if (fields.size() != 4) { continue; }
+
+        IndexEntry entry;
+        entry.hash     = (uint64_t)fields[0].getHexValue64();
+        entry.size     = fields[1].getLargeIntValue();
+        entry.modified = fields[2].getLargeIntValue();
+        m_index[fields[3].toStdString()] = entry;
+    }
+}
+
+void IrLibrary::m_saveIndex() const
+{
+    juce::String text;
+    {
+        juce::ScopedLock lock(m_indexLock);
+        text << INDEX_MAGIC << "\t" << (int)CACHE_VERSION << "\t" << hashToString(m_indexParamsHash) << "\n";
+        for (auto& entry : m_index) {
+            text << hashToString(entry.second.hash) << "\t" << entry.second.size << "\t" << entry.second.modified << "\t"
+                 << juce::String(entry.first) << "\n";
+        }
+    }
+
+    if (!m_cacheDirectory.getChildFile(INDEX_FILENAME).replaceWithText(text)) {
+        errorMessage("IrLibrary: unable to write index in " + getCacheDirectory());
+    }
+}
+
+void IrLibrary::m_pruneCache(const std::vector<uint64_t>& keepHashes) const
+{
+    // Remove prepared files no longer referenced by any IR
+    std::unordered_set<std::string> referenced;
+    for (uint64_t hash : keepHashes) { referenced.insert(hashToString(hash).toStdString()); }
+    {
+        juce::ScopedLock lock(m_indexLock);
+        for (auto& entry : m_index) { referenced.insert(hashToString(entry.second.hash).toStdString()); }
+    }
+
+    for (auto& file : m_cacheDirectory.findChildFiles(juce::File::findFiles, false, "*.irc")) {
+        std::string hash = file.getFileName().upToFirstOccurrenceOf("_", false, false).toStdString();
+        if (referenced.find(hash) == referenced.end()) { file.deleteFile(); }
+    }
+}
+
+}
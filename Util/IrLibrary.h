@@ -0,0 +1,123 @@
+/*
+ * IrLibrary.h
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <JuceHeader.h>
+#include "Util/CommonDefs.h"
+
+namespace stride {
+
+// Batch preparation of the IR directory. Each IR is resampled to every target rate, trimmed, normalised
+// and optionally converted to minimum phase, then written to a content-addressed cache of flat binary
+// files that can be memory-mapped directly by the convolver. Files are processed in parallel on a thread
+// pool and re-scans only process IRs that are new or have changed since the last scan.
+class IrLibrary
+{
+public:
+    enum class NormaliseMode : unsigned {
+        NONE = 0,
+        PEAK,   // loudest sample is 0 dBFS
+        ENERGY  // loudest channel has unit energy
+    };
+
+    struct Config {
+        std::vector<double> targetRates     = {44100.0, 48000.0};
+        bool                computeMinPhase = true;
+        bool                trimSilence     = true;
+        float               trimThresholdDb = -80.0f;  // relative to the IR peak
+        NormaliseMode       normalise       = NormaliseMode::PEAK;
+        size_t              maxIrLength     = 65536;   // in samples at the target rate
+        unsigned            numThreads      = 0;       // 0 uses one thread per CPU
+    };
+
+    struct ScanResult {
+        unsigned numFiles    = 0;
+        unsigned numPrepared = 0;
+        unsigned numSkipped  = 0; // unchanged since the last scan
+        unsigned numFailed   = 0;
+        double   elapsedSecs = 0.0;
+    };
+
+    // On-disk header of a prepared IR, followed by numChannels planar blocks of numSamples floats
+    struct CacheHeader {
+        char     magic[4];
+        uint32_t version;
+        double   sampleRate;
+        uint64_t sourceHash;
+        uint32_t numChannels;
+        uint32_t numSamples;
+        uint32_t flags;
+        float    gain;       // normalisation gain that was applied
+    };
+
+    static constexpr uint32_t CACHE_VERSION     = 1;
+    static constexpr uint32_t FLAG_MIN_PHASE    = 0x1;
+
+    // A memory-mapped prepared IR. The sample data stays valid while this object exists.
+    class PreparedIr
+    {
+    public:
+        explicit PreparedIr(const juce::File& cacheFile);
+
+        bool         isValid() const { return m_header != nullptr; }
+        double       getSampleRate() const { return m_header->sampleRate; }
+        unsigned     getNumChannels() const { return m_header->numChannels; }
+        size_t       getNumSamples() const { return m_header->numSamples; }
+        bool         isMinPhase() const { return (m_header->flags & FLAG_MIN_PHASE) != 0; }
+        float        getGain() const { return m_header->gain; }
+        const float* getChannel(unsigned channel) const;
+
+    private:
+        std::unique_ptr<juce::MemoryMappedFile> m_file;
+        const CacheHeader* m_header = nullptr;
+    };
+
+    IrLibrary(const std::string& irDirectory = stride::getIrDirectory(), const std::string& cacheDirectory = "");
+    virtual ~IrLibrary() = default;
+
+    // Blocks until every IR in the directory has been prepared
+    ScanResult prepare();
+    ScanResult prepare(const Config& config);
+
+    // Opens the prepared IR for a file path relative to the IR directory, returns nullptr when not prepared
+    std::unique_ptr<PreparedIr> openPrepared(const std::string& relPath, double sampleRate, bool minPhase = false) const;
+
+    std::string getLibraryDirectory() const { return m_irDirectory.getFullPathName().toStdString(); }
+    std::string getCacheDirectory() const { return m_cacheDirectory.getFullPathName().toStdString(); }
+
+private:
+    struct IndexEntry {
+        uint64_t hash     = 0; // content hash combined with the processing parameters
+        int64_t  size     = 0;
+        int64_t  modified = 0;
+    };
+
+    juce::File m_irDirectory;
+    juce::File m_cacheDirectory;
+
+    mutable juce::CriticalSection m_indexLock;
+    std::unordered_map<std::string, IndexEntry> m_index; // keyed by relative path
+    uint64_t m_indexParamsHash = 0;
+
+    bool m_prepareFile(const juce::File& file, const Config& config, uint64_t paramsHash, IndexEntry& entry) const;
+    bool m_cacheFilesExist(uint64_t hash, const Config& config) const;
+    juce::File m_getCacheFile(uint64_t hash, double sampleRate, bool minPhase) const;
+    void m_loadIndex();
+    void m_saveIndex() const;
+    void m_pruneCache(const std::vector<uint64_t>& keepHashes) const; // keepHashes are kept as well as the index's
+
+    static uint64_t m_hashParams(const Config& config);
+
+    JUCE_DECLARE_NON_COPYABLE (IrLibrary)
+};
+
+}
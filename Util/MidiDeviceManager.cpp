@@ -11,6 +11,50 @@ MidiDeviceManager::MidiDeviceManager()
 {
     startTimer(m_MIDI_CHECK_TIMER_MS);
     memset((void*)&m_teensyUid.uid[0], 0xff, UID_SIZE_BYTES);
+
+#if STRIDE_MIDI_HOTPLUG
+    // The callback is made on the message thread
+    m_deviceListConnection = MidiDeviceListConnection::make([this]() { m_handleDeviceListChanged(); });
+    m_isHotplugActive = true;
+#endif
+    updateMidiOutputDeviceList();
+    updateMidiInputDeviceList();
+}
+
+void MidiDeviceManager::m_handleDeviceListChanged()
+{
+    updateMidiOutputDeviceList();
+    updateMidiInputDeviceList();
+
+    // Drop stale references to an unplugged Teensy
+    if (m_teensyOutDevicePtr && !m_midiOutputIndex.count(m_teensyOutDevicePtr->deviceInfo.identifier.toStdString())) {
+        m_teensyOutDevicePtr = nullptr;
+    }
+    if (m_teensyInDevicePtr && !m_midiInputIndex.count(m_teensyInDevicePtr->deviceInfo.identifier.toStdString())) {
+        m_teensyInDevicePtr = nullptr;
+    }
+
+    if (m_isMidiDisabled || isTeensyMidiOpen() || !m_isTeensyPlugged()) { return; }
+
+    // Reconnect right away rather than waiting for the next timer tick
+    if (openTeensyMidi()) {
+        sendRequestPingSync();
+        sendRequestUid();
+    }
+}
+
+bool MidiDeviceManager::m_isTeensyPlugged() const
+{
+    bool outputPlugged = false;
+    for (auto& entry : m_midiOutputIndex) {
+        if (entry.second->deviceInfo.name.contains("Teensy")) { outputPlugged = true; break; }
+    }
+
+    bool inputPlugged = false;
+    for (auto& entry : m_midiInputIndex) {
+        if (entry.second->deviceInfo.name.contains("Teensy")) { inputPlugged = true; break; }
+    }
+    return outputPlugged && inputPlugged;
 }
 
 void MidiDeviceManager::start()
@@ -47,6 +91,11 @@ void MidiDeviceManager::updateMidiOutputDeviceList()
 
         // actually update the device list
         midiDevices = newDeviceList;
+
+        m_midiOutputIndex.clear();
+        for (auto& entry : midiDevices) {
+            m_midiOutputIndex[entry->deviceInfo.identifier.toStdString()] = entry;
+        }
     }
 }
 
@@ -56,13 +105,13 @@ void MidiDeviceManager::updateMidiInputDeviceList()
     auto availableInputDevices = MidiInput::getAvailableDevices();
     {
         ReferenceCountedArray<MidiDeviceListEntry>& midiDevices = m_midiInputs;
-        closeUnpluggedMidiOutputDevices(availableInputDevices);
+        closeUnpluggedMidiInputDevices(availableInputDevices);
         ReferenceCountedArray<MidiDeviceListEntry> newDeviceList;
 
         // add all currently plugged-in devices to the device list
         for (auto& newDevice : availableInputDevices)
         {
-            MidiDeviceListEntry::Ptr entry = findMidiOutDevice (newDevice);
+            MidiDeviceListEntry::Ptr entry = findMidiInDevice (newDevice);
 
             if (entry == nullptr)
                 entry = new MidiDeviceListEntry (newDevice);
@@ -72,6 +121,11 @@ void MidiDeviceManager::updateMidiInputDeviceList()
 
         // actually update the device list
         midiDevices = newDeviceList;
+
+        m_midiInputIndex.clear();
+        for (auto& entry : midiDevices) {
+            m_midiInputIndex[entry->deviceInfo.identifier.toStdString()] = entry;
+        }
     }
 }
 
@@ -115,23 +169,19 @@ void MidiDeviceManager::closeUnpluggedMidiInputDevices (const Array<MidiDeviceIn
 
 ReferenceCountedObjectPtr<MidiDeviceListEntry> MidiDeviceManager::findMidiOutDevice (MidiDeviceInfo device) const
 {
-    const ReferenceCountedArray<MidiDeviceListEntry>& midiDevices = m_midiOutputs;
-
-    for (auto& d : midiDevices)
-        if (d->deviceInfo == device)
-            return d;
-
+    auto it = m_midiOutputIndex.find(device.identifier.toStdString());
+    if ((it != m_midiOutputIndex.end()) && (it->second->deviceInfo == device)) {
+        return it->second;
+    }
     return nullptr;
 }
 
 ReferenceCountedObjectPtr<MidiDeviceListEntry> MidiDeviceManager::findMidiInDevice (MidiDeviceInfo device) const
 {
-    const ReferenceCountedArray<MidiDeviceListEntry>& midiDevices = m_midiInputs;
-
-    for (auto& d : midiDevices)
-        if (d->deviceInfo == device)
-            return d;
-
+    auto it = m_midiInputIndex.find(device.identifier.toStdString());
+    if ((it != m_midiInputIndex.end()) && (it->second->deviceInfo == device)) {
+        return it->second;
+    }
     return nullptr;
 }
 
@@ -374,7 +424,7 @@ void MidiDeviceManager::sendRequestPingSync()
     std::memcpy(rawSysEx+SYSEX_MANUFACTURER_ID_SIZE_BYTES, messagePayload, ACTUAL_PAYLOAD_SIZE);
 
     MidiMessage sysExMsg = MidiMessage::createSysExMessage(rawSysEx,SYSEX_MANUFACTURER_ID_SIZE_BYTES + ACTUAL_PAYLOAD_SIZE);
-    m_sendMidiMessage(sysExMsg);
+    m_sendMidiMessage(sysExMsg, false); // keep-alive traffic, doesn't hold off meters
 }
 
 void MidiDeviceManager::sendRequestUid()
@@ -463,8 +513,54 @@ void MidiDeviceManager::m_sendWriteFuse(SysExMessageType type, uint8_t* fuseData
     m_sendMidiMessage(sysExMsg);
 }
 
-void MidiDeviceManager::m_sendMidiMessage(MidiMessage &message)
+void MidiDeviceManager::setSendHook(SendHook hook)
+{
+    const ScopedLock lock (m_sendHookLock);
+    m_sendHook = hook;
+}
+
+void MidiDeviceManager::setDevicePollingEnabled(bool enabled)
 {
+    if (enabled) {
+        startTimer(m_MIDI_CHECK_TIMER_MS);
+    } else {
+        stopTimer();
+    }
+}
+
+bool MidiDeviceManager::m_sendRequestAllPeaks(SysExMessageType type, unsigned numMeters)
+{
+    // Yield to control traffic
+    uint32_t nowMs = Time::getMillisecondCounter();
+    if ((nowMs - m_lastControlSendMs.load(std::memory_order_relaxed)) < m_METER_CONTROL_HOLDOFF_MS) { return false; }
+    if (m_isMidiDisabled || !m_midiConnected) { return false; }
+
+    constexpr unsigned ACTUAL_PAYLOAD_SIZE = 2*REQUEST_ALL_PEAK_SYSEX_SIZE;
+    uint8_t tempMessageBuffer[REQUEST_ALL_PEAK_SYSEX_SIZE];
+    tempMessageBuffer[0] = static_cast<uint8_t>(type);
+    tempMessageBuffer[1] = static_cast<uint8_t>(std::min(numMeters, MAX_NUM_PEAK_METERS));
+
+    uint8_t rawSysEx[SYSEX_MANUFACTURER_ID_SIZE_BYTES + ACTUAL_PAYLOAD_SIZE];
+    std::memcpy(rawSysEx, BLACKADDR_AUDIO_MANUFACTURER_MIDI_ID, SYSEX_MANUFACTURER_ID_SIZE_BYTES);
+    m_sysexMultiplexMessage(tempMessageBuffer, rawSysEx+SYSEX_MANUFACTURER_ID_SIZE_BYTES, REQUEST_ALL_PEAK_SYSEX_SIZE);
+
+    MidiMessage sysExMsg = MidiMessage::createSysExMessage(rawSysEx,SYSEX_MANUFACTURER_ID_SIZE_BYTES + ACTUAL_PAYLOAD_SIZE);
+    m_sendMidiMessage(sysExMsg, false);
+    return true;
+}
+
+void MidiDeviceManager::m_sendMidiMessage(MidiMessage &message, bool isControlMessage)
+{
+    if (isControlMessage) { m_lastControlSendMs.store(Time::getMillisecondCounter(), std::memory_order_relaxed); }
+
+    {
+        const ScopedLock lock (m_sendHookLock);
+        if (m_sendHook) {
+            if (!m_isMidiDisabled) { m_sendHook(message); }
+            return;
+        }
+    }
+
     if (!m_teensyOutDevicePtr) {
         //openTeensyMidiOutput(); // try to open
         if (!m_teensyOutDevicePtr) { return; }
@@ -599,6 +695,49 @@ void MidiDeviceManager::m_createLockFusesMessage(uint8_t messageBuffer[2*LOCK_FU
     }
 }
 
+MidiMessage MidiDeviceManager::createSysExMessage(SysExMessageType type, const uint8_t* payload, size_t payloadSize)
+{
+    const size_t messageSize = SYSEX_TYPE_SIZE_BYTES + payloadSize;
+    std::vector<uint8_t> rawSysEx(SYSEX_MANUFACTURER_ID_SIZE_BYTES + 2*messageSize);
+
+    std::memcpy(rawSysEx.data(), BLACKADDR_AUDIO_MANUFACTURER_MIDI_ID, SYSEX_MANUFACTURER_ID_SIZE_BYTES);
+
+    // Multiplex the type and payload as nibbles
+    uint8_t* nibbleMessage = rawSysEx.data() + SYSEX_MANUFACTURER_ID_SIZE_BYTES;
+    uint8_t typeByte = static_cast<uint8_t>(type);
+    nibbleMessage[0] = typeByte & 0xF;
+    nibbleMessage[1] = (typeByte & 0xF0) >> 4;
+    for (size_t i=0; i < payloadSize; i++) {
+        nibbleMessage[2*(i+1)]   = payload[i] & 0xF;
+        nibbleMessage[2*(i+1)+1] = (payload[i] & 0xF0) >> 4;
+    }
+
+    return MidiMessage::createSysExMessage(rawSysEx.data(), (int)rawSysEx.size());
+}
+
+bool MidiDeviceManager::decodeSysExMessage(const MidiMessage& message, SysExMessageType& type, std::vector<uint8_t>& payload)
+{
+    if (!message.isSysEx()) { return false; }
+
+    const uint8_t* sysExData = reinterpret_cast<const uint8_t*>(message.getSysExData());
+    size_t sysExDataLength   = message.getSysExDataSize();
+
+    if (sysExDataLength < SYSEX_MANUFACTURER_ID_SIZE_BYTES + 2*SYSEX_TYPE_SIZE_BYTES) { return false; }
+    if (std::memcmp(sysExData, BLACKADDR_AUDIO_MANUFACTURER_MIDI_ID, SYSEX_MANUFACTURER_ID_SIZE_BYTES) != 0) { return false; }
+    sysExData       += SYSEX_MANUFACTURER_ID_SIZE_BYTES;
+    sysExDataLength -= SYSEX_MANUFACTURER_ID_SIZE_BYTES;
+
+    type = static_cast<SysExMessageType>((sysExData[0] & 0xF) + ((sysExData[1] & 0xF) << 4));
+    sysExData       += 2*SYSEX_TYPE_SIZE_BYTES;
+    sysExDataLength -= 2*SYSEX_TYPE_SIZE_BYTES;
+
+    payload.resize(sysExDataLength/2);
+    for (size_t i=0; i < payload.size(); i++) {
+        payload[i] = (sysExData[2*i] & 0xF) + ((sysExData[2*i+1] & 0xF) << 4);
+    }
+    return true;
+}
+
 // MISC MIDI PROCESING
 void MidiDeviceManager::m_sysexMultiplexMessage(const uint8_t* byteMessage, uint8_t* nibbleMessage, size_t numBytes)
 {
@@ -685,10 +824,13 @@ void MidiDeviceManager::processSysEx(const uint8_t* sysExData, size_t sysExDataL
 
     case SysExMessageType::HARDWARE_PONG :
     {
+        uint32_t  signature = 0;
+        Telemetry telemetry;
+        bool isValid = m_getPong(sysExData, sysExDataLength, signature, telemetry);
+        if (isValid) { m_telemetrySeries.append(telemetry); }
+
         if (m_checksumAsSignature) {
-            uint32_t signature = 0;
-            m_getPongChecksum(sysExData, sysExDataLength, signature);
-            if (signature == m_checksumSignature) {
+            if (isValid && signature == m_checksumSignature) {
                 m_suppressSync = false;
             } else {
                 m_suppressSync = true;
@@ -700,6 +842,27 @@ void MidiDeviceManager::processSysEx(const uint8_t* sysExData, size_t sysExDataL
         {
             std::lock_guard<std::mutex> lock(m_midiSyncLock);
             m_midiWaitingForPong = false;
+
+            // Report a (re)connection as soon as the first pong arrives instead of on the next timer tick
+            if (!m_midiConnected) {
+                m_midiConnected = true;
+                if (!m_suppressSync) { // otherwise the timer reports DESYNCED
+                    m_midiStatus = MidiStatus::CONNECTED;
+                    m_midiStatusBroadcaster.sendActionMessage("CONNECTED");
+                }
+            }
+        }
+    }
+    break;
+
+    case SysExMessageType::REPLY_ALL_INPUT_PEAK :
+    case SysExMessageType::REPLY_ALL_OUTPUT_PEAK :
+    {
+        float    peaks[MAX_NUM_PEAK_METERS];
+        unsigned numMeters = 0;
+        if (m_getAllPeaks(sysExData, sysExDataLength, peaks, numMeters)) {
+            PeakMeterStream& stream = (type == SysExMessageType::REPLY_ALL_INPUT_PEAK) ? m_inputPeakStream : m_outputPeakStream;
+            stream.publishFrame(peaks, numMeters);
         }
     }
     break;
@@ -723,6 +886,8 @@ void MidiDeviceManager::processSysEx(const uint8_t* sysExData, size_t sysExDataL
     default:
         break;
     }
+
+    if (m_sysExReplyCallback) { m_sysExReplyCallback(type); }
 }
 
 void MidiDeviceManager::setUid(TeensyUid teensyUid) {
@@ -794,33 +959,71 @@ void MidiDeviceManager::m_getFuses(const uint8_t* sysExBuffer, size_t sysExBuffe
     std::memcpy((void*)&fuses.configLow, messageBuffer+FUSES_START_IDX,  FUSES_SIZE_BYTES);
 }
 
-void MidiDeviceManager::m_getPongChecksum(const uint8_t* sysExBuffer, size_t sysExBufferLength, uint32_t &pongChecksum)
+// PEAK METERS
+bool MidiDeviceManager::m_getAllPeaks(const uint8_t* sysExBuffer, size_t sysExBufferLength, float* peaks, unsigned &numMeters)
+{
+    // Variable length, the meter count is followed by that many float peak values
+    constexpr unsigned MIN_SIZE = 2*PEAK_METER_COUNT_SIZE_BYTES;
+    constexpr unsigned MAX_SIZE = 2*(REPLY_ALL_PEAK_MAX_SYSEX_SIZE - SYSEX_TYPE_SIZE_BYTES);
+    if (!sysExBuffer || !peaks || (sysExBufferLength < MIN_SIZE) || (sysExBufferLength > MAX_SIZE)) {
+        std::string errorMsg = "MidiDeviceManager::m_getAllPeaks(): SYSEX control message wrong size, received " + std::to_string(sysExBufferLength);
+        errorMessage(errorMsg);
+        return false;
+    }
+
+    uint8_t messageBuffer[MAX_SIZE/2];
+    m_sysexDeMultiplexMessage(sysExBuffer, messageBuffer, sysExBufferLength);
+
+    unsigned count = messageBuffer[0];
+    size_t expectedSize = 2*(PEAK_METER_COUNT_SIZE_BYTES + count * PEAK_METER_VALUE_SIZE_BYTES);
+    if ((count > MAX_NUM_PEAK_METERS) || (sysExBufferLength != expectedSize)) {
+        std::string errorMsg = "MidiDeviceManager::m_getAllPeaks(): SYSEX control message wrong size, expected " +
+                               std::to_string(expectedSize) + ", received " + std::to_string(sysExBufferLength);
+        errorMessage(errorMsg);
+        return false;
+    }
+
+    std::memcpy((void*)peaks, messageBuffer+PEAK_METER_COUNT_SIZE_BYTES, count * PEAK_METER_VALUE_SIZE_BYTES);
+    numMeters = count;
+    return true;
+}
+
+bool MidiDeviceManager::m_getPong(const uint8_t* sysExBuffer, size_t sysExBufferLength, uint32_t &pongChecksum, Telemetry &telemetry)
 {
     uint32_t  checksum = 0;
 
     constexpr unsigned EXPECTED_SIZE = 2*(REPLY_PONG_SYSEX_SIZE - SYSEX_TYPE_SIZE_BYTES);
     if (!sysExBuffer || (sysExBufferLength != EXPECTED_SIZE)) {
-        std::string errorMsg = "MidiManager::m_getPongChecksum(): SYSEX control message wrong size, expected " +
+        std::string errorMsg = "MidiManager::m_getPong(): SYSEX control message wrong size, expected " +
                                std::to_string(EXPECTED_SIZE) + ", received " + std::to_string(sysExBufferLength);
         errorMessage(errorMsg);
-        return;
+        return false;
     }
 
-    constexpr unsigned CHECKSUM_START_IDX  = 0;
-    constexpr unsigned CHECKSUM_SIZE_BYTES = sizeof(checksum);
+    constexpr unsigned CHECKSUM_START_IDX   = 0;
+    constexpr unsigned CHECKSUM_SIZE_BYTES  = sizeof(checksum);
+    constexpr unsigned TELEMETRY_START_IDX  = CHECKSUM_START_IDX + CHECKSUM_SIZE_BYTES;
 
     uint8_t messageBuffer[EXPECTED_SIZE];
 
     // de-multiplex the datastream
-    unsigned j=0;
-    for (unsigned i=0; i < EXPECTED_SIZE; i++) {
-        messageBuffer[i] = (sysExBuffer[j] & 0xF) + ((sysExBuffer[j+1] & 0xF) << 4);
-        j = j + 2;
-    }
+    m_sysexDeMultiplexMessage(sysExBuffer, messageBuffer, EXPECTED_SIZE);
 
-    std::memcpy((void*)&checksum, messageBuffer+CHECKSUM_START_IDX,  CHECKSUM_SIZE_BYTES);
+    std::memcpy((void*)&checksum,  messageBuffer+CHECKSUM_START_IDX,  CHECKSUM_SIZE_BYTES);
+    std::memcpy((void*)&telemetry, messageBuffer+TELEMETRY_START_IDX, TELEMETRY_SIZE);
 
     pongChecksum = checksum;
+    return true;
+}
+
+void MidiDeviceManager::setTelemetryPollingRateHz(unsigned rateHz)
+{
+    m_telemetryPollingRateHz = std::min(rateHz, m_MAX_TELEMETRY_POLLING_RATE_HZ);
+    if (m_telemetryPollingRateHz == 0) {
+        m_telemetryPoller.stopTimer();
+    } else {
+        m_telemetryPoller.startTimerHz((int)m_telemetryPollingRateHz);
+    }
 }
 
 void MidiDeviceManager::setIsMidiDisabled(bool isMidiDisabled) {
@@ -869,7 +1072,11 @@ void MidiDeviceManager::timerCallback()
 
         m_midiConnected = m_midiWaitingForPong ? false : true;
 
-        if (m_midiWaitingForPong) { // Midi did not respond to last request try re-opening
+        // With hotplug notifications there is nothing to re-open while the Teensy isn't plugged in,
+        // so skip the device enumeration that close/open would otherwise do every tick.
+        bool canReopen = !m_isHotplugActive || m_isTeensyPlugged();
+
+        if (m_midiWaitingForPong && canReopen) { // Midi did not respond to last request try re-opening
 
             // Windows does not let you close and reopen a device in the same call. Another thread in JUCE
             // needs to do some clean up, so we only attempt to open if closing() returns false (already closed previously).
@@ -1,20 +1,18 @@
 #pragma once
 
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include <JuceHeader.h>
 #include "Util/CommonDefs.h"
 #include "Util/Keys.h"
+#include "Util/TelemetrySeries.h"
+#include "Util/PeakMeterStream.h"
 
 using namespace juce;
 
 namespace stride {
 
-struct Telemetry {
-    float cpuUtilization;
-    float ram0Usage;
-    float ram1Usage;
-    float temperature;
-};
-
 constexpr unsigned NUM_FUSES             = 10;
 constexpr unsigned FUSE_SIZE_BYTES       = 4;
 
@@ -44,6 +42,22 @@ constexpr unsigned REPLY_FUSES_SYSEX_SIZE          = SYSEX_TYPE_SIZE_BYTES + FUS
 constexpr unsigned WRITE_FUSE_SIZE_SYSEX_SIZE      = SYSEX_TYPE_SIZE_BYTES + FUSE_WRITE_SIZE_BYTES;
 constexpr unsigned LOCK_FUSES_SYSEX_SIZE           = SYSEX_TYPE_SIZE_BYTES + LOCK_FUSES_SIZE_BYTES;
 
+// JUCE 7 provides device list change notifications (ALSA sequencer announce on Linux, CoreMIDI and
+// WinRT/WinMM notifications elsewhere). Older JUCE versions fall back to timer polling.
+#if !defined(STRIDE_MIDI_HOTPLUG)
+#if JUCE_MAJOR_VERSION >= 7
+#define STRIDE_MIDI_HOTPLUG 1
+#else
+#define STRIDE_MIDI_HOTPLUG 0
+#endif
+#endif
+
+// Peak meters
+constexpr unsigned PEAK_METER_COUNT_SIZE_BYTES     = 1;
+constexpr unsigned PEAK_METER_VALUE_SIZE_BYTES     = sizeof(float);
+constexpr unsigned REQUEST_ALL_PEAK_SYSEX_SIZE     = SYSEX_TYPE_SIZE_BYTES + PEAK_METER_COUNT_SIZE_BYTES;
+constexpr unsigned REPLY_ALL_PEAK_MAX_SYSEX_SIZE   = SYSEX_TYPE_SIZE_BYTES + PEAK_METER_COUNT_SIZE_BYTES + MAX_NUM_PEAK_METERS * PEAK_METER_VALUE_SIZE_BYTES;
+
 constexpr uint32_t PROVISIONING_PROGRAM_CHECKSUM_SIGNATURE = 0xBABABABAU;
 
 #define GP1_LOCK_MASK_WP (0x1U << 10) // 0x400U
@@ -159,6 +173,8 @@ public:
     bool closeMidiOutDevice(int index);
     bool closeMidiInDevice (int index);
 
+    bool isHotplugActive() const { return m_isHotplugActive; }
+
     void debugPrintMidiDeviceList();
     void debugPrintUid();
 
@@ -186,14 +202,48 @@ public:
     Fuses getFuses() { return m_fuses; }
 
     void setChecksumAsSignature(bool val)         { m_checksumAsSignature = val; }
+    bool getChecksumAsSignature() const           { return m_checksumAsSignature; }
     void setChecksumSignature(uint32_t signature) { m_checksumSignature = signature; }
 
+    // Telemetry carried in each HARDWARE_PONG
+    const TelemetrySeries& getTelemetrySeries() const { return m_telemetrySeries; }
+    void setTelemetryPollingRateHz(unsigned rateHz); // extra pings between keep-alives, 0 to disable
+    unsigned getTelemetryPollingRateHz() const { return m_telemetryPollingRateHz; }
+
+    // Peak meter streaming, subscribe from the message thread, read frames from any thread
+    PeakMeterStream& getInputPeakStream()  { return m_inputPeakStream; }
+    PeakMeterStream& getOutputPeakStream() { return m_outputPeakStream; }
+
+    // Loopback hooks, used to run the manager against an in-process endpoint instead of a real device.
+    // When a send hook is set all outgoing messages are routed to it rather than the Teensy output device.
+    using SendHook           = std::function<void(const MidiMessage&)>;
+    using SysExReplyCallback = std::function<void(SysExMessageType)>;
+    void setSendHook(SendHook hook);
+    void injectIncomingMidiMessage(const MidiMessage& message) { handleIncomingMidiMessage(nullptr, message); }
+    void registerSysExReplyCallback(SysExReplyCallback callback) { m_sysExReplyCallback = callback; }
+    void setDevicePollingEnabled(bool enabled);
+    bool isDevicePollingEnabled() const { return isTimerRunning(); }
+
+    // Generic SysEx framing, shared with the multi-pedal sessions. The payload excludes the type byte.
+    static MidiMessage createSysExMessage(SysExMessageType type, const uint8_t* payload, size_t payloadSize);
+    static bool decodeSysExMessage(const MidiMessage& message, SysExMessageType& type, std::vector<uint8_t>& payload);
+
     // use MidiDeviceManager::getInstance() to get a reference to this singleton
     JUCE_DECLARE_SINGLETON (MidiDeviceManager, true);
 
 private:
     ReferenceCountedArray<MidiDeviceListEntry> m_midiInputs;
     ReferenceCountedArray<MidiDeviceListEntry> m_midiOutputs;
+    std::unordered_map<std::string, MidiDeviceListEntry::Ptr> m_midiInputIndex;  // keyed by device identifier
+    std::unordered_map<std::string, MidiDeviceListEntry::Ptr> m_midiOutputIndex; // keyed by device identifier
+
+    // Hotplug
+    bool m_isHotplugActive = false;
+#if STRIDE_MIDI_HOTPLUG
+    MidiDeviceListConnection m_deviceListConnection;
+#endif
+    void m_handleDeviceListChanged();
+    bool m_isTeensyPlugged() const;
 
     MidiDeviceListEntry::Ptr m_teensyOutDevicePtr;
     MidiDeviceListEntry::Ptr m_teensyInDevicePtr;
@@ -210,10 +260,33 @@ private:
 
     UidCallback m_uidCallback   = nullptr;
     UidCallback m_fusesCallback = nullptr;
+    SysExReplyCallback m_sysExReplyCallback = nullptr;
+
+    CriticalSection m_sendHookLock;
+    SendHook        m_sendHook = nullptr;
 
     CriticalSection    m_midiMonitorLock;
     Array<MidiMessage> m_incomingMessageArray;
 
+    // Telemetry
+    class TelemetryPoller : public Timer {
+    public:
+        explicit TelemetryPoller(MidiDeviceManager& manager) : m_manager(manager) {}
+        void timerCallback() override { m_manager.sendRequestPingSync(); }
+    private:
+        MidiDeviceManager& m_manager;
+    };
+    static constexpr unsigned m_MAX_TELEMETRY_POLLING_RATE_HZ = 100;
+    TelemetrySeries m_telemetrySeries;
+    TelemetryPoller m_telemetryPoller { *this };
+    unsigned        m_telemetryPollingRateHz = 0;
+
+    // Peak meters. Meter requests are held off while control messages are being sent.
+    static constexpr uint32_t m_METER_CONTROL_HOLDOFF_MS = 20;
+    std::atomic<uint32_t> m_lastControlSendMs { 0 };
+    PeakMeterStream m_inputPeakStream  { [this](unsigned numMeters) { return m_sendRequestAllPeaks(SysExMessageType::REQUEST_ALL_INPUT_PEAK,  numMeters); } };
+    PeakMeterStream m_outputPeakStream { [this](unsigned numMeters) { return m_sendRequestAllPeaks(SysExMessageType::REQUEST_ALL_OUTPUT_PEAK, numMeters); } };
+
     // MIDI timer stuff
     ActionBroadcaster m_midiStatusBroadcaster;
     static constexpr unsigned m_MIDI_CHECK_TIMER_MS = 1000;
@@ -226,7 +299,8 @@ private:
     void processSysEx(const uint8_t* sysExData, size_t sysExDataLength);
     bool m_validateSysExManufacturerId(const uint8_t* sysExBuffer, size_t sysExDataLength) const;
 
-    void m_sendMidiMessage(MidiMessage &message);
+    void m_sendMidiMessage(MidiMessage &message, bool isControlMessage = true);
+    bool m_sendRequestAllPeaks(SysExMessageType type, unsigned numMeters);
     void m_sendWriteFuse(SysExMessageType type, uint8_t* fuseData);
 
     void m_sysexMultiplexMessage(const uint8_t* byteMessage, uint8_t* nibbleMessage, size_t numBytes);
@@ -240,7 +314,8 @@ private:
     void m_createRequestPingMessage(uint8_t messageBuffer[2*REQUEST_PING_SYSEX_SIZE]);
     void m_getUid(const uint8_t* sysExBuffer, size_t sysExBufferLength, stride::TeensyUid &teensyUid);
     void m_getFuses(const uint8_t* sysExBuffer, size_t sysExBufferLength, Fuses &fuses);
-    void m_getPongChecksum(const uint8_t* sysExBuffer, size_t sysExBufferLength, uint32_t &pongChecksum);
+    bool m_getAllPeaks(const uint8_t* sysExBuffer, size_t sysExBufferLength, float* peaks, unsigned &numMeters);
+    bool m_getPong(const uint8_t* sysExBuffer, size_t sysExBufferLength, uint32_t &pongChecksum, Telemetry &telemetry);
 
     void handleIncomingMidiMessage (MidiInput *source, const MidiMessage &message) override;
     void handleAsyncUpdate() override;
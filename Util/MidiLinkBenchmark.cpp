@@ -0,0 +1,354 @@
+/*
+ * MidiLinkBenchmark.cpp
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "Util/ErrorMessage.h"
+#include "MidiLinkBenchmark.h"
+
+namespace stride {
+
+using SysExMessageType = MidiDeviceManager::SysExMessageType;
+
+static double ticksToMs(int64_t ticks)
+{
+    return juce::Time::highResolutionTicksToSeconds(ticks) * 1000.0;
+}
+
+/////////////////////////////////////////////////////
+// LoopbackPedal
+/////////////////////////////////////////////////////
+LoopbackPedal::LoopbackPedal()
+: juce::Thread("LoopbackPedal"), m_rng(0x5eed)
+{
+    memset((void*)&m_teensyUid.uid[0], 0xA5, UID_SIZE_BYTES);
+    memset((void*)&m_fuses, 0, sizeof(m_fuses));
+    startThread();
+}
+
+LoopbackPedal::~LoopbackPedal()
+{
+    disconnect();
+    signalThreadShouldExit();
+    m_wakeEvent.signal();
+    stopThread(1000);
+}
+
+void LoopbackPedal::connect()
+{
+    MidiDeviceManager::getInstance()->setSendHook([this](const juce::MidiMessage& message) { receiveFromHost(message); });
+}
+
+void LoopbackPedal::disconnect()
+{
+    MidiDeviceManager::getInstance()->setSendHook(nullptr);
+}
+
+void LoopbackPedal::receiveFromHost(const juce::MidiMessage& message)
+{
+    if (!message.isSysEx()) { return; }
+
+    const uint8_t* sysExData = reinterpret_cast<const uint8_t*>(message.getSysExData());
+    size_t sysExDataLength   = message.getSysExDataSize();
+
+    if (sysExDataLength < SYSEX_MANUFACTURER_ID_SIZE_BYTES + 2*SYSEX_TYPE_SIZE_BYTES) { return; }
+    if (memcmp(sysExData, BLACKADDR_AUDIO_MANUFACTURER_MIDI_ID, SYSEX_MANUFACTURER_ID_SIZE_BYTES) != 0) { return; }
+    sysExData += SYSEX_MANUFACTURER_ID_SIZE_BYTES;
+
+    SysExMessageType type = static_cast<SysExMessageType>((sysExData[0] & 0xF) + ((sysExData[1] & 0xF) << 4));
+
+    switch (type) {
+    case SysExMessageType::HARDWARE_PING :
+    {
+        uint8_t payload[REPLY_PONG_SYSEX_SIZE];
+        payload[0] = static_cast<uint8_t>(SysExMessageType::HARDWARE_PONG);
+        std::memcpy(payload + SYSEX_TYPE_SIZE_BYTES, (void*)&m_checksum, PRESET_CHECKSUM_SIZE);
+        std::memcpy(payload + SYSEX_TYPE_SIZE_BYTES + PRESET_CHECKSUM_SIZE, (void*)&m_telemetry, TELEMETRY_SIZE);
+        m_queueReply(payload, REPLY_PONG_SYSEX_SIZE);
+    }
+    break;
+
+    case SysExMessageType::REQUEST_UID :
+    {
+        uint8_t payload[REPLY_UID_SYSEX_SIZE];
+        payload[0] = static_cast<uint8_t>(SysExMessageType::REPLY_UID);
+        std::memcpy(payload + SYSEX_TYPE_SIZE_BYTES, (void*)&m_teensyUid.uid[0], UID_SIZE_BYTES);
+        m_queueReply(payload, REPLY_UID_SYSEX_SIZE);
+    }
+    break;
+
+    case SysExMessageType::REQUEST_FUSES :
+    {
+        uint8_t payload[REPLY_FUSES_SYSEX_SIZE];
+        payload[0] = static_cast<uint8_t>(SysExMessageType::REPLY_FUSES);
+        std::memcpy(payload + SYSEX_TYPE_SIZE_BYTES, (void*)&m_fuses.configLow, FUSES_SIZE_BYTES);
+        m_queueReply(payload, REPLY_FUSES_SYSEX_SIZE);
+    }
+    break;
+
+    case SysExMessageType::REQUEST_ALL_INPUT_PEAK :
+    case SysExMessageType::REQUEST_ALL_OUTPUT_PEAK :
+    {
+        if (sysExDataLength < SYSEX_MANUFACTURER_ID_SIZE_BYTES + 2*REQUEST_ALL_PEAK_SYSEX_SIZE) { break; }
+        unsigned numMeters = std::min((unsigned)((sysExData[2] & 0xF) + ((sysExData[3] & 0xF) << 4)), MAX_NUM_PEAK_METERS);
+
+        uint8_t payload[REPLY_ALL_PEAK_MAX_SYSEX_SIZE] = {};
+        payload[0] = static_cast<uint8_t>((type == SysExMessageType::REQUEST_ALL_INPUT_PEAK) ?
+                                          SysExMessageType::REPLY_ALL_INPUT_PEAK : SysExMessageType::REPLY_ALL_OUTPUT_PEAK);
+        payload[1] = static_cast<uint8_t>(numMeters);
+        m_queueReply(payload, SYSEX_TYPE_SIZE_BYTES + PEAK_METER_COUNT_SIZE_BYTES + numMeters * PEAK_METER_VALUE_SIZE_BYTES);
+    }
+    break;
+
+    default :
+        break;
+    }
+}
+
+void LoopbackPedal::m_queueReply(const uint8_t* payload, size_t payloadSize)
+{
+    // Build the manufacturer ID followed by the nibble multiplexed payload
+    std::vector<uint8_t> rawSysEx(SYSEX_MANUFACTURER_ID_SIZE_BYTES + 2*payloadSize);
+    std::memcpy(rawSysEx.data(), BLACKADDR_AUDIO_MANUFACTURER_MIDI_ID, SYSEX_MANUFACTURER_ID_SIZE_BYTES);
+    unsigned j = SYSEX_MANUFACTURER_ID_SIZE_BYTES;
+    for (size_t i=0; i < payloadSize; i++) {
+        rawSysEx[j]   = payload[i] & 0xF; // grab the lower nibble
+        rawSysEx[j+1] = (payload[i] & 0xF0) >> 4; // grab the upper nibble
+        j = j+2;
+    }
+
+    juce::MidiMessage reply = juce::MidiMessage::createSysExMessage(rawSysEx.data(), (int)rawSysEx.size());
+
+    {
+        const juce::ScopedLock lock (m_queueLock);
+        std::uniform_real_distribution<double> jitter(0.0, m_jitterMs);
+        double delayMs = m_delayMs + (m_jitterMs > 0.0 ? jitter(m_rng) : 0.0);
+
+        // Keep replies in order, a serial link can't overtake itself
+        int64_t dueTicks = juce::Time::getHighResolutionTicks() + juce::Time::secondsToHighResolutionTicks(delayMs / 1000.0);
+        dueTicks = std::max(dueTicks, m_lastDueTicks);
+        m_lastDueTicks = dueTicks;
+        m_pendingReplies.push_back({dueTicks, reply});
+    }
+    m_wakeEvent.signal();
+}
+
+void LoopbackPedal::run()
+{
+    while (!threadShouldExit()) {
+        int waitMs = -1;
+        std::vector<juce::MidiMessage> readyReplies;
+        {
+            const juce::ScopedLock lock (m_queueLock);
+            int64_t now = juce::Time::getHighResolutionTicks();
+            while (!m_pendingReplies.empty() && m_pendingReplies.front().dueTicks <= now) {
+                readyReplies.push_back(m_pendingReplies.front().message);
+                m_pendingReplies.pop_front();
+            }
+            if (!m_pendingReplies.empty()) {
+                waitMs = std::max(0, (int)ticksToMs(m_pendingReplies.front().dueTicks - now));
+            }
+        }
+
+        for (auto& reply : readyReplies) {
+            MidiDeviceManager::getInstance()->injectIncomingMidiMessage(reply);
+        }
+
+        if (readyReplies.empty()) {
+            if (waitMs == 0) {
+                juce::Thread::yield(); // sub-millisecond wait remaining
+            } else {
+                m_wakeEvent.wait(waitMs);
+            }
+        }
+    }
+}
+
+/////////////////////////////////////////////////////
+// MidiLinkBenchmark
+/////////////////////////////////////////////////////
+MidiLinkBenchmark::Result MidiLinkBenchmark::run(const Config& config)
+{
+    Result result;
+    if (juce::MessageManager::getInstance()->isThisTheMessageThread()) {
+        errorMessage("MidiLinkBenchmark::run(): must not be called from the message thread");
+        return result;
+    }
+
+    switch (config.requestType) {
+    case RequestType::UID   : m_expectedReply = SysExMessageType::REPLY_UID; break;
+    case RequestType::FUSES : m_expectedReply = SysExMessageType::REPLY_FUSES; break;
+    case RequestType::PING  :
+    default                 : m_expectedReply = SysExMessageType::HARDWARE_PONG; break;
+    }
+
+    m_sendTicks.clear();
+    m_latenciesMs.clear();
+    m_isSettling = false;
+    m_latenciesMs.reserve(config.numMessages);
+
+    MidiDeviceManager* midiManager = MidiDeviceManager::getInstance();
+    LoopbackPedal pedal;
+    pedal.setReplyDelayMs(config.replyDelayMs, config.replyJitterMs);
+
+    // Stop the keep-alive and telemetry pings from polluting the measurement, the caller's settings are
+    // restored afterwards
+    const bool     wasDevicePollingEnabled = midiManager->isDevicePollingEnabled();
+    const bool     wasChecksumAsSignature  = midiManager->getChecksumAsSignature();
+    const unsigned telemetryPollingRateHz  = midiManager->getTelemetryPollingRateHz();
+    midiManager->setDevicePollingEnabled(false);
+    midiManager->setTelemetryPollingRateHz(0);
+    midiManager->setChecksumAsSignature(false);
+    midiManager->registerSysExReplyCallback([this](SysExMessageType type) { m_replyReceived(type); });
+    midiManager->start();
+    pedal.connect();
+
+    unsigned maxInFlight = std::max(1U, config.maxInFlight);
+    int64_t startTicks = juce::Time::getHighResolutionTicks();
+
+    while (result.numSent < config.numMessages) {
+        size_t inFlight;
+        {
+            const juce::ScopedLock lock (m_lock);
+            inFlight = m_sendTicks.size();
+        }
+
+        if (inFlight < maxInFlight) {
+            m_sendRequest(config.requestType);
+            result.numSent++;
+            continue;
+        }
+
+        if (!m_replyEvent.wait((int)config.timeoutMs)) {
+            m_settleAfterTimeout(config.timeoutMs, result);
+        }
+    }
+
+    // Drain the remaining outstanding requests
+    while (true) {
+        {
+            const juce::ScopedLock lock (m_lock);
+            if (m_sendTicks.empty()) { break; }
+        }
+        if (!m_replyEvent.wait((int)config.timeoutMs)) {
+            // Nothing is sent after this, so there's no need to wait for late replies
+            const juce::ScopedLock lock (m_lock);
+            result.numTimeouts++;
+            result.numAbandoned += (unsigned)m_sendTicks.size() - 1;
+            m_sendTicks.clear();
+            break;
+        }
+    }
+
+    double elapsedMs = ticksToMs(juce::Time::getHighResolutionTicks() - startTicks);
+
+    pedal.disconnect();
+    midiManager->registerSysExReplyCallback(nullptr);
+    midiManager->setChecksumAsSignature(wasChecksumAsSignature);
+    midiManager->setTelemetryPollingRateHz(telemetryPollingRateHz);
+    midiManager->setDevicePollingEnabled(wasDevicePollingEnabled);
+
+    std::vector<double> latenciesMs;
+    {
+        const juce::ScopedLock lock (m_lock);
+        latenciesMs.swap(m_latenciesMs);
+    }
+    std::sort(latenciesMs.begin(), latenciesMs.end());
+
+    result.numReceived = (unsigned)latenciesMs.size();
+    if (!latenciesMs.empty()) {
+        double sum = 0.0;
+        for (auto latency : latenciesMs) { sum += latency; }
+        result.minMs  = latenciesMs.front();
+        result.maxMs  = latenciesMs.back();
+        result.meanMs = sum / latenciesMs.size();
+        result.p50Ms  = getPercentile(latenciesMs, 0.50);
+        result.p99Ms  = getPercentile(latenciesMs, 0.99);
+        result.p999Ms = getPercentile(latenciesMs, 0.999);
+    }
+    if (elapsedMs > 0.0) {
+        result.messagesPerSec = result.numReceived * 1000.0 / elapsedMs;
+    }
+
+    return result;
+}
+
+double MidiLinkBenchmark::getPercentile(std::vector<double>& sortedSamplesMs, double percentile)
+{
+    if (sortedSamplesMs.empty()) { return 0.0; }
+    // nearest-rank method
+    size_t rank = (size_t)std::ceil(percentile * sortedSamplesMs.size());
+    rank = std::min(std::max(rank, (size_t)1), sortedSamplesMs.size());
+    return sortedSamplesMs[rank-1];
+}
+
+void MidiLinkBenchmark::m_sendRequest(RequestType requestType)
+{
+    MidiDeviceManager* midiManager = MidiDeviceManager::getInstance();
+    {
+        // Timestamp before sending since the reply can arrive before sendRequest*() returns
+        const juce::ScopedLock lock (m_lock);
+        m_sendTicks.push_back(juce::Time::getHighResolutionTicks());
+    }
+
+    switch (requestType) {
+    case RequestType::UID   : midiManager->sendRequestUid(); break;
+    case RequestType::FUSES : midiManager->sendRequestFuses(); break;
+    case RequestType::PING  :
+    default                 : midiManager->sendRequestPingSync(); break;
+    }
+}
+
+void MidiLinkBenchmark::m_settleAfterTimeout(unsigned timeoutMs, Result& result)
+{
+    // The oldest request timed out, the rest in flight are queued behind its reply
+    {
+        const juce::ScopedLock lock (m_lock);
+        if (m_sendTicks.empty()) { return; }
+        result.numTimeouts++;
+        result.numAbandoned += (unsigned)m_sendTicks.size() - 1;
+        m_sendTicks.clear();
+        m_isSettling = true;
+    }
+
+    // Let any late replies arrive and be ignored, so the next request's reply is its own
+    juce::Thread::sleep((int)timeoutMs);
+    {
+        const juce::ScopedLock lock (m_lock);
+        m_isSettling = false;
+    }
+    m_replyEvent.reset();
+}
+
+void MidiLinkBenchmark::m_replyReceived(SysExMessageType type)
+{
+    // This is called on the message thread
+    if (type != m_expectedReply) { return; }
+    {
+        const juce::ScopedLock lock (m_lock);
+        if (m_isSettling || m_sendTicks.empty()) { return; } // late reply after a timeout
+        int64_t now = juce::Time::getHighResolutionTicks();
+        m_latenciesMs.push_back(ticksToMs(now - m_sendTicks.front()));
+        m_sendTicks.pop_front();
+    }
+    m_replyEvent.signal();
+}
+
+std::string MidiLinkBenchmark::Result::toString() const
+{
+    char buffer[512];
+    snprintf(buffer, sizeof(buffer),
+             "sent: %u  received: %u  timeouts: %u  abandoned: %u\n"
+             "latency ms  min: %.3f  mean: %.3f  p50: %.3f  p99: %.3f  p999: %.3f  max: %.3f\n"
+             "throughput: %.1f msg/s\n",
+             numSent, numReceived, numTimeouts, numAbandoned,
+             minMs, meanMs, p50Ms, p99Ms, p999Ms, maxMs,
+             messagesPerSec);
+    return std::string(buffer);
+}
+
+}
@@ -0,0 +1,124 @@
+/*
+ * MidiLinkBenchmark.h
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+
+#pragma once
+
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+#include <JuceHeader.h>
+#include "Util/MidiDeviceManager.h"
+
+namespace stride {
+
+// In-process stand-in for the pedal. It decodes the SysEx requests sent by the MidiDeviceManager and
+// answers PING, UID and FUSES requests after a configurable delay plus uniform jitter. Replies are
+// delivered in order, the same as a real USB MIDI link.
+class LoopbackPedal : private juce::Thread
+{
+public:
+    LoopbackPedal();
+    virtual ~LoopbackPedal();
+
+    void setReplyDelayMs(double delayMs, double jitterMs) { m_delayMs = delayMs; m_jitterMs = jitterMs; }
+    void setChecksum(uint32_t checksum) { m_checksum = checksum; }
+    void setTelemetry(const Telemetry& telemetry) { m_telemetry = telemetry; }
+    void setUid(const TeensyUid& teensyUid) { m_teensyUid = teensyUid; }
+
+    // Attach to / detach from the MidiDeviceManager singleton via its send hook
+    void connect();
+    void disconnect();
+
+    // Called with every outgoing message from the host
+    void receiveFromHost(const juce::MidiMessage& message);
+
+private:
+    struct PendingReply {
+        int64_t           dueTicks;
+        juce::MidiMessage message;
+    };
+
+    double    m_delayMs  = 1.0;
+    double    m_jitterMs = 0.0;
+    uint32_t  m_checksum = 0;
+    Telemetry m_telemetry = {0.0f, 0.0f, 0.0f, 0.0f};
+    TeensyUid m_teensyUid;
+    Fuses     m_fuses;
+
+    juce::CriticalSection    m_queueLock;
+    std::deque<PendingReply> m_pendingReplies;
+    int64_t                  m_lastDueTicks = 0;
+    juce::WaitableEvent      m_wakeEvent;
+    std::mt19937             m_rng;
+
+    void run() override;
+    void m_queueReply(const uint8_t* payload, size_t payloadSize);
+};
+
+// Drives the MidiDeviceManager against a LoopbackPedal and measures the request/reply round trip.
+// The benchmark thread must not be the message thread since replies are processed there. The
+// manager's keep-alive and telemetry pings are suspended during run() and restored afterwards.
+//
+// Replies are matched to requests in order, so after a timeout the benchmark abandons every request in
+// flight and ignores replies for another timeoutMs before sending again. Otherwise a late reply would
+// be matched to a later request and skew every latency after it.
+class MidiLinkBenchmark
+{
+public:
+    enum class RequestType : unsigned {
+        PING = 0,
+        UID,
+        FUSES
+    };
+
+    struct Config {
+        RequestType requestType   = RequestType::PING;
+        unsigned    numMessages   = 1000;
+        unsigned    maxInFlight   = 1;    // 1 measures pure latency, larger values measure sustained throughput
+        double      replyDelayMs  = 1.0;
+        double      replyJitterMs = 0.0;
+        unsigned    timeoutMs     = 1000;
+    };
+
+    struct Result {
+        unsigned numSent      = 0;
+        unsigned numReceived  = 0;
+        unsigned numTimeouts  = 0;
+        unsigned numAbandoned = 0; // in flight when another request timed out, their replies aren't measured
+        double   minMs  = 0.0;
+        double   meanMs = 0.0;
+        double   p50Ms  = 0.0;
+        double   p99Ms  = 0.0;
+        double   p999Ms = 0.0;
+        double   maxMs  = 0.0;
+        double   messagesPerSec = 0.0;
+
+        std::string toString() const;
+    };
+
+    MidiLinkBenchmark() = default;
+    ~MidiLinkBenchmark() = default;
+
+    Result run(const Config& config);
+
+    static double getPercentile(std::vector<double>& sortedSamplesMs, double percentile);
+
+private:
+    juce::CriticalSection m_lock;
+    juce::WaitableEvent   m_replyEvent;
+    std::deque<int64_t>   m_sendTicks;
+    std::vector<double>   m_latenciesMs;
+    bool                  m_isSettling = false; // ignoring replies after a timeout
+    MidiDeviceManager::SysExMessageType m_expectedReply = MidiDeviceManager::SysExMessageType::HARDWARE_PONG;
+
+    void m_sendRequest(RequestType requestType);
+    void m_replyReceived(MidiDeviceManager::SysExMessageType type);
+    void m_settleAfterTimeout(unsigned timeoutMs, Result& result);
+};
+
+}
@@ -0,0 +1,154 @@
+/*
+ * OfflineResampler.cpp
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include "Util/ErrorMessage.h"
+#include "Util/r8b/CDSPResampler.h"
+#include "OfflineResampler.h"
+
+namespace stride {
+
+namespace {
+
+constexpr int    RESAMPLER_BLOCK_SIZE = 4096;
+constexpr size_t PREROLL_MARGIN       = 64; // input samples on top of the resampler's look-ahead
+
+struct Chunk {
+    unsigned channel;
+    size_t   inFirst;    // where the resampler starts, the pre-roll ahead of the chunk
+    size_t   numDiscard; // outputs of the pre-roll
+    size_t   outStart;
+    size_t   numOut;
+};
+
+// Runs the resampler from inFirst, feeding zeros past the end of the input like oneshot() does, until the
+// chunk's outputs after the pre-roll are filled
+void resampleChunk(r8b::CDSPResampler& resampler, const double* in, size_t inLength, const Chunk& chunk, double* out)
+{
+    std::vector<double> zeros;
+    size_t inPos      = chunk.inFirst;
+    size_t numDiscard = chunk.numDiscard;
+    size_t numOut     = chunk.numOut;
+    out += chunk.outStart;
+
+    while (numOut > 0) {
+        double* ip;
+        int numIn;
+        if (inPos < inLength) {
+            numIn = (int)std::min(inLength - inPos, (size_t)RESAMPLER_BLOCK_SIZE);
+            ip    = const_cast<double*>(in + inPos); // not written to, as in oneshot()
+            inPos += numIn;
+        } else {
+            if (zeros.empty()) { zeros.resize(RESAMPLER_BLOCK_SIZE, 0.0); }
+            numIn = RESAMPLER_BLOCK_SIZE;
+            ip    = zeros.data();
+        }
+
+        double* op;
+        size_t numWritten = (size_t)resampler.process(ip, numIn, op);
+        const size_t numSkipped = std::min(numDiscard, numWritten);
+        numDiscard -= numSkipped;
+        numWritten  = std::min(numWritten - numSkipped, numOut);
+        std::copy(op + numSkipped, op + numSkipped + numWritten, out);
+        out    += numWritten;
+        numOut -= numWritten;
+    }
+    resampler.clear();
+}
+
+}
+
+OfflineResampler::OfflineResampler()
+: OfflineResampler(Config())
+{
+}
+
+OfflineResampler::OfflineResampler(const Config& config)
+: m_config(config)
+{
+    m_config.chunkSize = std::max(m_config.chunkSize, (size_t)1);
+
+    // The chunks need start positions that are whole in both rates
+    double gcd;
+    if (r8b::findGCD(m_config.srcSampleRate, m_config.dstSampleRate, gcd) && (gcd >= 1.0)) {
+        const double inPeriod  = m_config.srcSampleRate / gcd;
+        const double outPeriod = m_config.dstSampleRate / gcd;
+        if ((inPeriod == std::floor(inPeriod)) && (outPeriod == std::floor(outPeriod))) {
+            m_inPeriod  = (size_t)inPeriod;
+            m_outPeriod = (size_t)outPeriod;
+        }
+    }
+
+    if (isParallel()) {
+        // The filters are linear phase, so the history an output needs matches the look-ahead
+        r8b::CDSPResampler24 resampler(m_config.srcSampleRate, m_config.dstSampleRate, RESAMPLER_BLOCK_SIZE,
+                                       m_config.reqTransBand, m_config.useFloatFFT);
+        const size_t lookAhead = (size_t)resampler.getInLenBeforeOutPos(0) + PREROLL_MARGIN;
+        m_preroll = (lookAhead + m_inPeriod - 1) / m_inPeriod * m_inPeriod;
+    } else {
+        warningMessage("OfflineResampler::OfflineResampler(): no whole-number ratio between " + std::to_string(m_config.srcSampleRate) +
+                       " and " + std::to_string(m_config.dstSampleRate) + ", resampling serially");
+    }
+}
+
+size_t OfflineResampler::getOutputLength(size_t inLength) const
+{
+    return (size_t)std::ceil(inLength * m_config.dstSampleRate / m_config.srcSampleRate);
+}
+
+void OfflineResampler::process(const double* const* in, unsigned numChannels, size_t inLength, double* const* out, size_t outLength) const
+{
+    if ((numChannels == 0) || (outLength == 0)) { return; }
+
+    // Without a period each channel is a single chunk
+    size_t chunkIn  = inLength;
+    size_t chunkOut = outLength;
+    if (isParallel()) {
+        chunkIn  = (m_config.chunkSize + m_inPeriod - 1) / m_inPeriod * m_inPeriod;
+        chunkOut = chunkIn / m_inPeriod * m_outPeriod;
+    }
+
+    std::vector<Chunk> chunks;
+    for (unsigned channel=0; channel < numChannels; channel++) {
+        for (size_t outStart=0, inStart=0; outStart < outLength; outStart += chunkOut, inStart += chunkIn) {
+            const size_t preroll    = std::min(inStart, m_preroll);
+            const size_t numDiscard = isParallel() ? preroll / m_inPeriod * m_outPeriod : 0;
+            chunks.push_back({channel, inStart - preroll, numDiscard, outStart, std::min(chunkOut, outLength - outStart)});
+        }
+    }
+
+    unsigned numThreads = m_config.numThreads ? m_config.numThreads : std::thread::hardware_concurrency();
+    numThreads = std::max(1U, std::min(numThreads, (unsigned)chunks.size()));
+
+    // Each thread keeps one resampler for all of its chunks
+    std::atomic<size_t> nextChunk { 0 };
+    auto work = [&]() {
+        r8b::CDSPResampler24 resampler(m_config.srcSampleRate, m_config.dstSampleRate, RESAMPLER_BLOCK_SIZE,
+                                       m_config.reqTransBand, m_config.useFloatFFT);
+        for (size_t i=nextChunk++; i < chunks.size(); i=nextChunk++) {
+            resampleChunk(resampler, in[chunks[i].channel], inLength, chunks[i], out[chunks[i].channel]);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned threadIndex=1; threadIndex < numThreads; threadIndex++) { threads.emplace_back(work); }
+    work();
+    for (auto& thread : threads) { thread.join(); }
+}
+
+std::vector<double> OfflineResampler::process(const std::vector<double>& in) const
+{
+    std::vector<double> out(getOutputLength(in.size()));
+    const double* inChannel  = in.data();
+    double*       outChannel = out.data();
+    process(&inChannel, 1, in.size(), &outChannel, out.size());
+    return out;
+}
+
+}
@@ -0,0 +1,62 @@
+/*
+ * OfflineResampler.h
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace stride {
+
+// Resamples whole signals that are already in memory, e.g. long recordings, by splitting them into chunks
+// that are processed on a pool of threads. Each chunk starts its own CDSPResampler24 a pre-roll ahead of
+// the chunk, long enough to cover the filters, and discards the output of the pre-roll. Chunks start on
+// whole periods of the rate ratio so every chunk's outputs fall on the same positions as the serial run.
+//
+// The result matches CDSPResampler24::oneshot() over the whole signal to within MAX_ERROR of full scale.
+// It is not bit-exact as the FFT blocks and the interpolator's position updates fall on different samples.
+// Rate pairs without a whole-number ratio (e.g. 44100 * 1.001 to 48000) have no such period and are
+// processed serially.
+class OfflineResampler
+{
+public:
+    struct Config {
+        double   srcSampleRate = 44100.0;
+        double   dstSampleRate = 48000.0;
+        double   reqTransBand  = 2.0;
+        bool     useFloatFFT   = false;  // pffft, only with R8B_PFFFT_RUNTIME
+        unsigned numThreads    = 0;      // 0 uses one thread per CPU
+        size_t   chunkSize     = 262144; // input samples per chunk, rounded up to whole periods of the ratio
+    };
+
+    static constexpr double MAX_ERROR = 1e-9; // double FFT, the float FFT path is around 1e-6
+
+    OfflineResampler();
+    explicit OfflineResampler(const Config& config);
+    virtual ~OfflineResampler() = default;
+
+    // Length of the output for inLength input samples, the same as IrLibrary uses
+    size_t getOutputLength(size_t inLength) const;
+
+    // Resamples numChannels planar channels of inLength samples into outLength samples each. Blocks until
+    // all chunks of all channels are done.
+    void process(const double* const* in, unsigned numChannels, size_t inLength, double* const* out, size_t outLength) const;
+
+    std::vector<double> process(const std::vector<double>& in) const;
+
+    bool isParallel() const { return m_inPeriod > 0; }
+    size_t getPreroll() const { return m_preroll; }
+    const Config& getConfig() const { return m_config; }
+
+private:
+    Config m_config;
+    size_t m_inPeriod  = 0; // input and output samples per whole period of the ratio, 0 when there is none
+    size_t m_outPeriod = 0;
+    size_t m_preroll   = 0; // input samples, whole periods
+};
+
+}
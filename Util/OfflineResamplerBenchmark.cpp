@@ -0,0 +1,121 @@
+/*
+ * OfflineResamplerBenchmark.cpp
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include "Util/OfflineResampler.h"
+#include "Util/SpectrumAnalyzer.h"
+#include "Util/r8b/CDSPResampler.h"
+#include "OfflineResamplerBenchmark.h"
+
+namespace stride {
+
+namespace {
+
+constexpr int BLOCK_SIZE = 1024;
+
+}
+
+std::vector<OfflineResamplerBenchmark::OfflineResult> OfflineResamplerBenchmark::runOfflineChunks(unsigned maxThreads, double signalSecs)
+{
+    static const double RATE_PAIRS[][2] = {
+        {44100.0, 48000.0}, {48000.0, 44100.0}, {96000.0, 48000.0}, {44100.0, 96000.0}
+    };
+
+    std::vector<OfflineResult> results;
+    for (auto& ratePair : RATE_PAIRS) {
+        const double srcRate = ratePair[0];
+        const double dstRate = ratePair[1];
+
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<double> dist(-1.0, 1.0);
+        std::vector<double> input((size_t)(srcRate * signalSecs));
+        for (auto& sample : input) { sample = dist(rng); }
+
+        OfflineResampler::Config config;
+        config.srcSampleRate = srcRate;
+        config.dstSampleRate = dstRate;
+
+        std::vector<double> reference(OfflineResampler(config).getOutputLength(input.size()));
+        auto start = std::chrono::steady_clock::now();
+        {
+            r8b::CDSPResampler24 resampler(srcRate, dstRate, BLOCK_SIZE);
+            resampler.oneshot(input.data(), (int)input.size(), reference.data(), (int)reference.size());
+        }
+        const double serialSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        for (unsigned numThreads=1; numThreads <= maxThreads; numThreads *= 2) {
+            config.numThreads = numThreads;
+            OfflineResampler resampler(config);
+            start = std::chrono::steady_clock::now();
+            const std::vector<double> output = resampler.process(input);
+            const double elapsedSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            OfflineResult result;
+            result.srcRate     = srcRate;
+            result.dstRate     = dstRate;
+            result.numThreads  = numThreads;
+            result.nsPerSample = elapsedSecs * 1e9 / input.size();
+            result.speedup     = serialSecs / elapsedSecs;
+            result.maxError    = 0.0;
+            for (size_t i=0; i < output.size(); i++) { result.maxError = std::max(result.maxError, std::fabs(output[i] - reference[i])); }
+            results.push_back(result);
+        }
+    }
+    return results;
+}
+
+std::vector<OfflineResamplerBenchmark::SpectralResult> OfflineResamplerBenchmark::runSpectral(double signalSecs)
+{
+    static const double RATE_PAIRS[][2] = { {44100.0, 48000.0}, {48000.0, 44100.0}, {48000.0, 96000.0}, {96000.0, 48000.0} };
+    constexpr double TONE_HZ    = 997.0; // not a whole fraction of any of the rates
+    constexpr double TONE_LEVEL = 0.891; // -1 dB
+    constexpr double LOW_HZ     = 20.0;
+    constexpr double HIGH_HZ    = 20000.0;
+
+    std::vector<SpectralResult> results;
+    for (auto& ratePair : RATE_PAIRS) {
+        const double srcRate = ratePair[0];
+        const double dstRate = ratePair[1];
+
+        OfflineResampler::Config resamplerConfig;
+        resamplerConfig.srcSampleRate = srcRate;
+        resamplerConfig.dstSampleRate = dstRate;
+        const OfflineResampler resampler(resamplerConfig);
+
+        std::vector<double> tone((size_t)(signalSecs * srcRate));
+        for (size_t i=0; i < tone.size(); i++) { tone[i] = TONE_LEVEL * std::sin(R8B_2PI * TONE_HZ * i / srcRate); }
+        const std::vector<double> resampledTone  = resampler.process(tone);
+        const std::vector<double> resampledSweep = resampler.process(SpectrumAnalyzer::makeSweep(srcRate, LOW_HZ, HIGH_HZ, signalSecs));
+        const std::vector<double> referenceSweep = SpectrumAnalyzer::makeSweep(dstRate, LOW_HZ, HIGH_HZ, signalSecs);
+
+        SpectrumAnalyzer::Config analyzerConfig;
+        analyzerConfig.sampleRate = dstRate;
+        const SpectrumAnalyzer analyzer(analyzerConfig);
+
+        auto start = std::chrono::steady_clock::now();
+        const SpectrumAnalyzer::ThdnResult thdn = analyzer.thdn(resampledTone.data(), resampledTone.size(), TONE_HZ, LOW_HZ, HIGH_HZ);
+        const SpectrumAnalyzer::FrequencyResponse response =
+            analyzer.frequencyResponse(referenceSweep.data(), resampledSweep.data(), std::min(referenceSweep.size(), resampledSweep.size()),
+                                       LOW_HZ, HIGH_HZ);
+        const double analysisSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        SpectralResult result;
+        result.srcRate          = srcRate;
+        result.dstRate          = dstRate;
+        result.thdnDb           = thdn.thdnDb;
+        result.noiseDb          = thdn.noiseDb;
+        result.passBandRippleDb = response.getRippleDb(LOW_HZ, HIGH_HZ);
+        result.minCoherence     = response.coherence.empty() ? 0.0 : *std::min_element(response.coherence.begin(), response.coherence.end());
+        result.analysisSecs     = analysisSecs;
+        results.push_back(result);
+    }
+    return results;
+}
+
+}
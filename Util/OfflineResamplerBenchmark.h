@@ -0,0 +1,46 @@
+/*
+ * OfflineResamplerBenchmark.h
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+
+#pragma once
+
+#include <vector>
+
+namespace stride {
+
+// Threading speedup and measured quality of the OfflineResampler
+class OfflineResamplerBenchmark
+{
+public:
+    struct OfflineResult {
+        double   srcRate;
+        double   dstRate;
+        unsigned numThreads;
+        double   nsPerSample;     // per input sample, wall time
+        double   speedup;         // against the serial oneshot()
+        double   maxError;        // against the serial oneshot(), relative to full scale
+    };
+
+    struct SpectralResult {
+        double   srcRate;
+        double   dstRate;
+        double   thdnDb;            // 997 Hz tone at -1 dB through the 24-bit resampler, 20 Hz to 20 kHz
+        double   noiseDb;           // of the same, harmonics excluded
+        double   passBandRippleDb;  // of a sweep, 20 Hz to 20 kHz
+        double   minCoherence;      // of the sweep over the same band
+        double   analysisSecs;      // wall time of the SpectrumAnalyzer calls
+    };
+
+    // Resamples a long signal with OfflineResampler on 1, 2, 4... up to maxThreads threads and compares it
+    // with a single resampler over the whole signal
+    static std::vector<OfflineResult> runOfflineChunks(unsigned maxThreads = 8, double signalSecs = 60.0);
+
+    // Measures the 24-bit OfflineResampler with SpectrumAnalyzer for common rate pairs, the sweep against
+    // the same sweep generated at the destination rate
+    static std::vector<SpectralResult> runSpectral(double signalSecs = 10.0);
+};
+
+}
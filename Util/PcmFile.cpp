@@ -0,0 +1,648 @@
+/*
+ * PcmFile.cpp
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+#include <cmath>
+#include <cstring>
+#include "Util/ErrorMessage.h"
+#include "Util/r8b/CDSPResampler.h"
+#include "PcmFile.h"
+
+namespace stride {
+
+namespace {
+
+constexpr int      RESAMPLER_BLOCK_SIZE   = 4096;
+constexpr uint16_t WAVE_FORMAT_PCM        = 0x0001;
+constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+constexpr uint32_t DS64_SIZE              = 28;      // ds64 chunk without a table, also the size of the JUNK placeholder
+constexpr uint64_t RIFF_MAX_BYTES         = 0xFFFFFFFFULL;
+constexpr uint32_t AIFC_VERSION_1         = 0xA2805140;
+
+// The GUID of WAVE_FORMAT_EXTENSIBLE sub-formats, after the format tag
+constexpr uint8_t KSDATAFORMAT_SUBTYPE_TAIL[14] = {0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71};
+
+uint16_t getLE16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+uint32_t getLE32(const uint8_t* p) { return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24); }
+uint64_t getLE64(const uint8_t* p) { return (uint64_t)getLE32(p) | ((uint64_t)getLE32(p + 4) << 32); }
+uint16_t getBE16(const uint8_t* p) { return (uint16_t)((p[0] << 8) | p[1]); }
+uint32_t getBE32(const uint8_t* p) { return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3]; }
+
+void putLE16(uint8_t* p, uint16_t value) { p[0] = (uint8_t)value; p[1] = (uint8_t)(value >> 8); }
+void putLE32(uint8_t* p, uint32_t value) { putLE16(p, (uint16_t)value); putLE16(p + 2, (uint16_t)(value >> 16)); }
+void putLE64(uint8_t* p, uint64_t value) { putLE32(p, (uint32_t)value); putLE32(p + 4, (uint32_t)(value >> 32)); }
+void putBE16(uint8_t* p, uint16_t value) { p[0] = (uint8_t)(value >> 8); p[1] = (uint8_t)value; }
+void putBE32(uint8_t* p, uint32_t value) { putBE16(p, (uint16_t)(value >> 16)); putBE16(p + 2, (uint16_t)value); }
+
+bool isChunk(const uint8_t* p, const char* id) { return std::memcmp(p, id, 4) == 0; }
+
+// AIFF stores the sample rate as an 80-bit IEEE extended float
+double getExtended(const uint8_t* p)
+{
+    const int      exponent = ((p[0] & 0x7F) << 8) | p[1];
+    const uint64_t mantissa = ((uint64_t)getBE32(p + 2) << 32) | getBE32(p + 6);
+    const double   value    = std::ldexp((double)mantissa, exponent - 16383 - 63);
+    return (p[0] & 0x80) ? -value : value;
+}
+
+void putExtended(uint8_t* p, double value)
+{
+    std::memset(p, 0, 10);
+    if (value <= 0.0) { return; }
+    int exponent;
+    const double   fraction = std::frexp(value, &exponent); // value = fraction * 2^exponent, fraction in [0.5, 1)
+    const uint64_t mantissa = (uint64_t)std::ldexp(fraction, 64);
+    putBE16(p, (uint16_t)(exponent - 1 + 16383));
+    putBE32(p + 2, (uint32_t)(mantissa >> 32));
+    putBE32(p + 6, (uint32_t)mantissa);
+}
+
+bool readBytes(juce::FileInputStream& stream, void* dest, int numBytes)
+{
+    return stream.read(dest, numBytes) == numBytes;
+}
+
+////////////////
+// Sample codecs
+////////////////
+template <PcmSampleFormat SampleFormat, bool BigEndian>
+inline double decodeSample(const uint8_t* p)
+{
+    if constexpr (SampleFormat == PcmSampleFormat::INT16) {
+        const int16_t value = BigEndian ? (int16_t)getBE16(p) : (int16_t)getLE16(p);
+        return value * (1.0 / 32768.0);
+    } else if constexpr (SampleFormat == PcmSampleFormat::INT24) {
+        const int32_t value = BigEndian ? (int32_t)(((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8))
+                                        : (int32_t)(((uint32_t)p[2] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[0] << 8));
+        return (value >> 8) * (1.0 / 8388608.0);
+    } else if constexpr (SampleFormat == PcmSampleFormat::INT32) {
+        const int32_t value = BigEndian ? (int32_t)getBE32(p) : (int32_t)getLE32(p);
+        return value * (1.0 / 2147483648.0);
+    } else if constexpr (SampleFormat == PcmSampleFormat::FLOAT32) {
+        const uint32_t bits = BigEndian ? getBE32(p) : getLE32(p);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    } else {
+        const uint64_t bits = BigEndian ? (((uint64_t)getBE32(p) << 32) | getBE32(p + 4)) : getLE64(p);
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+}
+
+template <PcmSampleFormat SampleFormat, bool BigEndian>
+void decodeFrames(const uint8_t* data, unsigned frameSize, unsigned numChannels, unsigned numFrames, double* const* out, unsigned outOffset)
+{
+    const unsigned bytesPerSample = frameSize / numChannels;
+    for (unsigned channel=0; channel < numChannels; channel++) {
+        const uint8_t* p  = data + channel * bytesPerSample;
+        double*        op = out[channel] + outOffset;
+        for (unsigned i=0; i < numFrames; i++, p += frameSize) { op[i] = decodeSample<SampleFormat, BigEndian>(p); }
+    }
+}
+
+inline int32_t toInt(double value, double scale)
+{
+    return (int32_t)std::lrint(std::max(-scale, std::min(value * scale, scale - 1.0)));
+}
+
+template <PcmSampleFormat SampleFormat, bool BigEndian>
+inline void encodeSample(double value, uint8_t* p)
+{
+    if constexpr (SampleFormat == PcmSampleFormat::INT16) {
+        const uint16_t bits = (uint16_t)r8b::roundInt16(value * 32768.0); // as SampleConvert and CSampleConv
+        if (BigEndian) { putBE16(p, bits); } else { putLE16(p, bits); }
+    } else if constexpr (SampleFormat == PcmSampleFormat::INT24) {
+        const uint32_t bits = (uint32_t)toInt(value, 8388608.0);
+        if (BigEndian) { p[0] = (uint8_t)(bits >> 16); p[1] = (uint8_t)(bits >> 8); p[2] = (uint8_t)bits; }
+        else           { p[0] = (uint8_t)bits; p[1] = (uint8_t)(bits >> 8); p[2] = (uint8_t)(bits >> 16); }
+    } else if constexpr (SampleFormat == PcmSampleFormat::INT32) {
+        const uint32_t bits = (uint32_t)toInt(value, 2147483648.0);
+        if (BigEndian) { putBE32(p, bits); } else { putLE32(p, bits); }
+    } else if constexpr (SampleFormat == PcmSampleFormat::FLOAT32) {
+        const float floatValue = (float)value;
+        uint32_t bits;
+        std::memcpy(&bits, &floatValue, sizeof(bits));
+        if (BigEndian) { putBE32(p, bits); } else { putLE32(p, bits); }
+    } else {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        if (BigEndian) { putBE32(p, (uint32_t)(bits >> 32)); putBE32(p + 4, (uint32_t)bits); } else { putLE64(p, bits); }
+    }
+}
+
+template <PcmSampleFormat SampleFormat, bool BigEndian>
+void encodeFrames(const double* const* in, unsigned numChannels, unsigned inOffset, unsigned numFrames, uint8_t* data)
+{
+    const unsigned bytesPerSample = getBytesPerSample(SampleFormat);
+    const unsigned frameSize      = bytesPerSample * numChannels;
+    for (unsigned channel=0; channel < numChannels; channel++) {
+        const double* ip = in[channel] + inOffset;
+        uint8_t*      p  = data + channel * bytesPerSample;
+        for (unsigned i=0; i < numFrames; i++, p += frameSize) { encodeSample<SampleFormat, BigEndian>(ip[i], p); }
+    }
+}
+
+template <template <PcmSampleFormat, bool> class Codec, typename Fn>
+Fn getCodec(PcmSampleFormat sampleFormat, bool bigEndian)
+{
+    switch (sampleFormat) {
+    case PcmSampleFormat::INT16 :   return bigEndian ? Codec<PcmSampleFormat::INT16, true>::fn : Codec<PcmSampleFormat::INT16, false>::fn;
+    case PcmSampleFormat::INT24 :   return bigEndian ? Codec<PcmSampleFormat::INT24, true>::fn : Codec<PcmSampleFormat::INT24, false>::fn;
+    case PcmSampleFormat::INT32 :   return bigEndian ? Codec<PcmSampleFormat::INT32, true>::fn : Codec<PcmSampleFormat::INT32, false>::fn;
+    case PcmSampleFormat::FLOAT32 : return bigEndian ? Codec<PcmSampleFormat::FLOAT32, true>::fn : Codec<PcmSampleFormat::FLOAT32, false>::fn;
+    case PcmSampleFormat::FLOAT64 : return bigEndian ? Codec<PcmSampleFormat::FLOAT64, true>::fn : Codec<PcmSampleFormat::FLOAT64, false>::fn;
+    }
+    return nullptr;
+}
+
+template <PcmSampleFormat SampleFormat, bool BigEndian>
+struct Decoder { static constexpr auto fn = &decodeFrames<SampleFormat, BigEndian>; };
+
+template <PcmSampleFormat SampleFormat, bool BigEndian>
+struct Encoder { static constexpr auto fn = &encodeFrames<SampleFormat, BigEndian>; };
+
+}
+
+unsigned getBytesPerSample(PcmSampleFormat sampleFormat)
+{
+    switch (sampleFormat) {
+    case PcmSampleFormat::INT16 :   return 2;
+    case PcmSampleFormat::INT24 :   return 3;
+    case PcmSampleFormat::INT32 :   return 4;
+    case PcmSampleFormat::FLOAT32 : return 4;
+    case PcmSampleFormat::FLOAT64 : return 8;
+    }
+    return 0;
+}
+
+////////////////
+// PcmFileReader
+////////////////
+PcmFileReader::PcmFileReader(const juce::File& file)
+: m_file(file)
+{
+    juce::FileInputStream stream(file);
+    if (stream.failedToOpen()) {
+        errorMessage("PcmFileReader::PcmFileReader(): cannot open " + file.getFullPathName().toStdString());
+        return;
+    }
+
+    uint8_t header[12];
+    bool ok = false;
+    if (readBytes(stream, header, sizeof(header))) {
+        if ((isChunk(header, "RIFF") || isChunk(header, "RF64")) && isChunk(header + 8, "WAVE")) {
+            ok = m_parseWav(stream);
+        } else if (isChunk(header, "FORM") && (isChunk(header + 8, "AIFF") || isChunk(header + 8, "AIFC"))) {
+            ok = m_parseAiff(stream);
+        } else {
+            errorMessage("PcmFileReader::PcmFileReader(): not a WAV or AIFF file " + file.getFullPathName().toStdString());
+        }
+    }
+
+    if (ok) {
+        // Files that were not closed properly can have a data size past the end of the file
+        const uint64_t fileSize = (uint64_t)stream.getTotalLength();
+        m_numFrames = std::min(m_numFrames, (fileSize - std::min(fileSize, m_dataOffset)) / m_frameSize);
+        m_decode    = getCodec<Decoder, DecodeFn>(m_sampleFormat, m_bigEndian);
+    } else {
+        m_numChannels = 0;
+    }
+}
+
+bool PcmFileReader::m_parseWav(juce::FileInputStream& stream)
+{
+    m_fileType  = PcmFileType::WAV;
+    m_bigEndian = false;
+
+    uint64_t ds64DataSize = 0;
+    bool     hasFormat    = false;
+    uint8_t  chunkHeader[8];
+    while (readBytes(stream, chunkHeader, sizeof(chunkHeader))) {
+        const uint64_t chunkStart = (uint64_t)stream.getPosition();
+        uint64_t       chunkSize  = getLE32(chunkHeader + 4);
+
+        if (isChunk(chunkHeader, "ds64")) {
+            uint8_t ds64[DS64_SIZE];
+            if (!readBytes(stream, ds64, sizeof(ds64))) { break; }
+            ds64DataSize = getLE64(ds64 + 8);
+        } else if (isChunk(chunkHeader, "fmt ")) {
+            uint8_t fmt[40] = {};
+            if ((chunkSize < 16) || !readBytes(stream, fmt, (int)std::min(chunkSize, (uint64_t)sizeof(fmt)))) { break; }
+            uint16_t formatTag = getLE16(fmt);
+            if ((formatTag == WAVE_FORMAT_EXTENSIBLE) && (chunkSize >= 40)) { formatTag = getLE16(fmt + 24); }
+            m_numChannels = getLE16(fmt + 2);
+            m_sampleRate  = getLE32(fmt + 4);
+            m_frameSize   = getLE16(fmt + 12);
+            const unsigned bitsPerSample = getLE16(fmt + 14);
+
+            if ((formatTag == WAVE_FORMAT_PCM) && (bitsPerSample == 16)) { m_sampleFormat = PcmSampleFormat::INT16; }
+            else if ((formatTag == WAVE_FORMAT_PCM) && (bitsPerSample == 24)) { m_sampleFormat = PcmSampleFormat::INT24; }
+            else if ((formatTag == WAVE_FORMAT_PCM) && (bitsPerSample == 32)) { m_sampleFormat = PcmSampleFormat::INT32; }
+            else if ((formatTag == WAVE_FORMAT_IEEE_FLOAT) && (bitsPerSample == 32)) { m_sampleFormat = PcmSampleFormat::FLOAT32; }
+            else if ((formatTag == WAVE_FORMAT_IEEE_FLOAT) && (bitsPerSample == 64)) { m_sampleFormat = PcmSampleFormat::FLOAT64; }
+            else {
+                errorMessage("PcmFileReader: unsupported WAV format " + std::to_string(formatTag) + " with " +
+                             std::to_string(bitsPerSample) + " bits in " + m_file.getFullPathName().toStdString());
+                return false;
+            }
+            hasFormat = true;
+        } else if (isChunk(chunkHeader, "data")) {
+            if (!hasFormat) { break; }
+            if ((chunkSize == RIFF_MAX_BYTES) && (ds64DataSize > 0)) { chunkSize = ds64DataSize; }
+            m_dataOffset = chunkStart;
+            m_numFrames  = chunkSize / std::max(m_frameSize, 1U);
+            break;
+        }
+        stream.setPosition((juce::int64)(chunkStart + chunkSize + (chunkSize & 1)));
+    }
+
+    if (!hasFormat || (m_dataOffset == 0) || (m_numChannels == 0) ||
+        (m_frameSize != m_numChannels * getBytesPerSample(m_sampleFormat))) {
+        errorMessage("PcmFileReader: invalid WAV file " + m_file.getFullPathName().toStdString());
+        return false;
+    }
+    return true;
+}
+
+bool PcmFileReader::m_parseAiff(juce::FileInputStream& stream)
+{
+    m_fileType  = PcmFileType::AIFF;
+    m_bigEndian = true;
+
+    stream.setPosition(8);
+    uint8_t formType[4];
+    if (!readBytes(stream, formType, sizeof(formType))) { return false; }
+    const bool isAifc = isChunk(formType, "AIFC");
+
+    bool     hasFormat = false;
+    uint64_t numFrames = 0;
+    uint8_t  chunkHeader[8];
+    while (readBytes(stream, chunkHeader, sizeof(chunkHeader))) {
+        const uint64_t chunkStart = (uint64_t)stream.getPosition();
+        const uint64_t chunkSize  = getBE32(chunkHeader + 4);
+
+        if (isChunk(chunkHeader, "COMM")) {
+            uint8_t comm[22] = {};
+            if ((chunkSize < 18) || !readBytes(stream, comm, (int)std::min(chunkSize, (uint64_t)sizeof(comm)))) { break; }
+            m_numChannels = getBE16(comm);
+            numFrames     = getBE32(comm + 2);
+            const unsigned bitsPerSample = getBE16(comm + 6);
+            m_sampleRate  = getExtended(comm + 8);
+
+            const uint8_t* compression = (isAifc && (chunkSize >= 22)) ? comm + 18 : (const uint8_t*)"NONE";
+            if (isChunk(compression, "fl32") || isChunk(compression, "FL32")) { m_sampleFormat = PcmSampleFormat::FLOAT32; }
+            else if (isChunk(compression, "fl64") || isChunk(compression, "FL64")) { m_sampleFormat = PcmSampleFormat::FLOAT64; }
+            else if (isChunk(compression, "NONE") || isChunk(compression, "twos") || isChunk(compression, "sowt")) {
+                m_bigEndian = !isChunk(compression, "sowt");
+                if (bitsPerSample == 16) { m_sampleFormat = PcmSampleFormat::INT16; }
+                else if (bitsPerSample == 24) { m_sampleFormat = PcmSampleFormat::INT24; }
+                else if (bitsPerSample == 32) { m_sampleFormat = PcmSampleFormat::INT32; }
+                else {
+                    errorMessage("PcmFileReader: unsupported AIFF sample size " + std::to_string(bitsPerSample) + " in " +
+                                 m_file.getFullPathName().toStdString());
+                    return false;
+                }
+            } else {
+                errorMessage("PcmFileReader: unsupported AIFC compression " + std::string((const char*)compression, 4) + " in " +
+                             m_file.getFullPathName().toStdString());
+                return false;
+            }
+            m_frameSize = m_numChannels * getBytesPerSample(m_sampleFormat);
+            hasFormat   = true;
+        } else if (isChunk(chunkHeader, "SSND")) {
+            uint8_t ssnd[8];
+            if ((chunkSize < 8) || !readBytes(stream, ssnd, sizeof(ssnd))) { break; }
+            m_dataOffset = chunkStart + 8 + getBE32(ssnd);
+            if (hasFormat) { break; }
+        }
+        stream.setPosition((juce::int64)(chunkStart + chunkSize + (chunkSize & 1)));
+    }
+
+    if (!hasFormat || (m_dataOffset == 0) || (m_numChannels == 0)) {
+        errorMessage("PcmFileReader: invalid AIFF file " + m_file.getFullPathName().toStdString());
+        return false;
+    }
+    m_numFrames = numFrames;
+    return true;
+}
+
+const uint8_t* PcmFileReader::m_mapFrames(uint64_t frame, unsigned& numFrames)
+{
+    const uint64_t start = m_dataOffset + frame * m_frameSize;
+    if (!m_map || (start < m_mapStart) || (start + m_frameSize > m_mapEnd)) {
+        const uint64_t dataEnd = m_dataOffset + m_numFrames * m_frameSize;
+        const uint64_t end     = std::min(dataEnd, start + std::max(MAP_WINDOW_BYTES, (size_t)m_frameSize));
+        m_map.reset();
+        m_map = std::make_unique<juce::MemoryMappedFile>(m_file, juce::Range<juce::int64>((juce::int64)start, (juce::int64)end),
+                                                         juce::MemoryMappedFile::readOnly);
+        if (!m_map->getData()) {
+            errorMessage("PcmFileReader: cannot map " + m_file.getFullPathName().toStdString());
+            m_map.reset();
+            return nullptr;
+        }
+        // The mapping starts on a page boundary at or before the requested start
+        m_mapStart = (uint64_t)m_map->getRange().getStart();
+        m_mapEnd   = (uint64_t)m_map->getRange().getEnd();
+    }
+
+    numFrames = (unsigned)std::min((uint64_t)numFrames, (m_mapEnd - start) / m_frameSize);
+    return static_cast<const uint8_t*>(m_map->getData()) + (start - m_mapStart);
+}
+
+unsigned PcmFileReader::read(double* const* out, unsigned numFrames)
+{
+    unsigned numRead = 0;
+    while ((numRead < numFrames) && (m_position < m_numFrames)) {
+        unsigned numMapped = (unsigned)std::min((uint64_t)(numFrames - numRead), m_numFrames - m_position);
+        const uint8_t* data = m_mapFrames(m_position, numMapped);
+        if (!data) { break; }
+        m_decode(data, m_frameSize, m_numChannels, numMapped, out, numRead);
+        numRead    += numMapped;
+        m_position += numMapped;
+    }
+    return numRead;
+}
+
+////////////////
+// PcmFileWriter
+////////////////
+PcmFileWriter::PcmFileWriter(const juce::File& file, const Format& format)
+: juce::Thread("PcmFileWriter"),
+  m_format(format),
+  m_file(file),
+  m_pending(-1),
+  m_failed(false)
+{
+    m_format.numChannels  = std::max(m_format.numChannels, 1U);
+    m_format.bufferFrames = std::max(m_format.bufferFrames, 1U);
+    m_frameSize = m_format.numChannels * getBytesPerSample(m_format.sampleFormat);
+    m_encode    = getCodec<Encoder, EncodeFn>(m_format.sampleFormat, m_format.fileType == PcmFileType::AIFF);
+    for (auto& buffer : m_buffers) { buffer.resize((size_t)m_format.bufferFrames * m_frameSize); }
+
+    m_stream = std::make_unique<juce::FileOutputStream>(file);
+    if (m_stream->failedToOpen()) {
+        errorMessage("PcmFileWriter::PcmFileWriter(): cannot open " + file.getFullPathName().toStdString());
+        m_stream.reset();
+        return;
+    }
+    // FileOutputStream appends to an existing file
+    m_stream->setPosition(0);
+    m_stream->truncate();
+
+    // Sizes are filled in by finish()
+    if (!m_writeHeader(0)) {
+        errorMessage("PcmFileWriter::PcmFileWriter(): cannot write " + file.getFullPathName().toStdString());
+        m_stream.reset();
+        return;
+    }
+    startThread();
+}
+
+PcmFileWriter::~PcmFileWriter()
+{
+    finish();
+}
+
+bool PcmFileWriter::write(const double* const* in, unsigned numFrames)
+{
+    if (!isValid() || m_finished || m_failed) { return false; }
+
+    if ((m_format.fileType == PcmFileType::AIFF) && (m_headerSize + (m_numFrames + numFrames) * m_frameSize > RIFF_MAX_BYTES)) {
+        errorMessage("PcmFileWriter::write(): AIFF files are limited to 4 GB " + m_file.getFullPathName().toStdString());
+        m_failed = true;
+        return false;
+    }
+
+    const size_t bufferSize = m_buffers[0].size();
+    for (unsigned offset=0; offset < numFrames; ) {
+        const unsigned blockFrames = (unsigned)std::min((size_t)(numFrames - offset), (bufferSize - m_bufferFill) / m_frameSize);
+        m_encode(in, m_format.numChannels, offset, blockFrames, m_buffers[m_current].data() + m_bufferFill);
+        m_bufferFill += (size_t)blockFrames * m_frameSize;
+        offset       += blockFrames;
+        if (m_bufferFill == bufferSize) { m_handOff(); }
+    }
+    m_numFrames += numFrames;
+    return !m_failed;
+}
+
+bool PcmFileWriter::finish()
+{
+    if (!isValid() || m_finished) { return !m_failed; }
+    m_finished = true;
+
+    if (m_bufferFill > 0) { m_handOff(); }
+    m_waitForPending();
+    signalThreadShouldExit();
+    m_bufferReady.signal();
+    stopThread(-1);
+
+    const uint64_t dataBytes = m_numFrames * m_frameSize;
+    bool ok = !m_failed;
+    if (dataBytes & 1) {
+        const uint8_t pad = 0;
+        ok = ok && m_stream->write(&pad, 1);
+    }
+    ok = ok && m_writeHeader(dataBytes);
+    m_stream->flush();
+    ok = ok && !m_stream->getStatus().failed();
+    m_stream.reset();
+
+    if (!ok) {
+        errorMessage("PcmFileWriter::finish(): write failed " + m_file.getFullPathName().toStdString());
+        m_failed = true;
+    }
+    return ok;
+}
+
+void PcmFileWriter::run()
+{
+    while (!threadShouldExit()) {
+        m_bufferReady.wait(-1);
+        const int pending = m_pending.load();
+        if (pending >= 0) {
+            if (!m_stream->write(m_buffers[pending].data(), m_pendingSize)) { m_failed = true; }
+            m_pending = -1;
+            m_bufferDone.signal();
+        }
+    }
+}
+
+void PcmFileWriter::m_handOff()
+{
+    m_waitForPending();
+    m_pendingSize = m_bufferFill;
+    m_pending     = m_current;
+    m_bufferReady.signal();
+    m_current    ^= 1;
+    m_bufferFill  = 0;
+}
+
+void PcmFileWriter::m_waitForPending()
+{
+    while (m_pending.load() >= 0) { m_bufferDone.wait(-1); }
+}
+
+bool PcmFileWriter::m_writeHeader(uint64_t dataBytes)
+{
+    const bool     isFloat        = (m_format.sampleFormat == PcmSampleFormat::FLOAT32) || (m_format.sampleFormat == PcmSampleFormat::FLOAT64);
+    const unsigned bytesPerSample = getBytesPerSample(m_format.sampleFormat);
+    const uint64_t padBytes       = dataBytes & 1;
+    std::vector<uint8_t> header;
+    auto append = [&header](const void* data, size_t numBytes) {
+        header.insert(header.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + numBytes);
+    };
+
+    if (m_format.fileType == PcmFileType::WAV) {
+        // A JUNK chunk holds the place of the ds64 chunk in case the file has to become RF64 (EBU Tech 3306)
+        const bool     isExtensible = (m_format.numChannels > 2);
+        const uint32_t fmtSize      = isExtensible ? 40 : 16;
+        const size_t   headerSize   = 12 + (8 + DS64_SIZE) + (8 + fmtSize) + 8;
+        const uint64_t riffSize     = headerSize - 8 + dataBytes + padBytes;
+        const bool     isRf64       = (riffSize > RIFF_MAX_BYTES);
+
+        uint8_t riff[12];
+        std::memcpy(riff, isRf64 ? "RF64" : "RIFF", 4);
+        putLE32(riff + 4, isRf64 ? (uint32_t)RIFF_MAX_BYTES : (uint32_t)riffSize);
+        std::memcpy(riff + 8, "WAVE", 4);
+        append(riff, sizeof(riff));
+
+        uint8_t ds64[8 + DS64_SIZE] = {};
+        std::memcpy(ds64, isRf64 ? "ds64" : "JUNK", 4);
+        putLE32(ds64 + 4, DS64_SIZE);
+        if (isRf64) {
+            putLE64(ds64 + 8, riffSize);
+            putLE64(ds64 + 16, dataBytes);
+            putLE64(ds64 + 24, m_numFrames);
+        }
+        append(ds64, sizeof(ds64));
+
+        uint8_t fmt[8 + 40] = {};
+        const uint16_t formatTag = isFloat ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM;
+        std::memcpy(fmt, "fmt ", 4);
+        putLE32(fmt + 4, fmtSize);
+        putLE16(fmt + 8, isExtensible ? WAVE_FORMAT_EXTENSIBLE : formatTag);
+        putLE16(fmt + 10, (uint16_t)m_format.numChannels);
+        putLE32(fmt + 12, (uint32_t)std::lrint(m_format.sampleRate));
+        putLE32(fmt + 16, (uint32_t)std::lrint(m_format.sampleRate) * m_frameSize);
+        putLE16(fmt + 20, (uint16_t)m_frameSize);
+        putLE16(fmt + 22, (uint16_t)(bytesPerSample * 8));
+        if (isExtensible) {
+            putLE16(fmt + 24, 22);
+            putLE16(fmt + 26, (uint16_t)(bytesPerSample * 8));
+            putLE32(fmt + 28, 0); // no speaker positions
+            putLE16(fmt + 32, formatTag);
+            std::memcpy(fmt + 34, KSDATAFORMAT_SUBTYPE_TAIL, sizeof(KSDATAFORMAT_SUBTYPE_TAIL));
+        }
+        append(fmt, 8 + fmtSize);
+
+        uint8_t data[8];
+        std::memcpy(data, "data", 4);
+        putLE32(data + 4, isRf64 ? (uint32_t)RIFF_MAX_BYTES : (uint32_t)dataBytes);
+        append(data, sizeof(data));
+    } else {
+        // Float samples need AIFC, with the compression type and an empty name padded to an even length
+        const uint32_t commSize   = isFloat ? 24 : 18;
+        const size_t   headerSize = 12 + (isFloat ? 12 : 0) + (8 + commSize) + 16;
+        const uint64_t formSize   = headerSize - 8 + dataBytes + padBytes;
+
+        uint8_t form[12];
+        std::memcpy(form, "FORM", 4);
+        putBE32(form + 4, (uint32_t)formSize);
+        std::memcpy(form + 8, isFloat ? "AIFC" : "AIFF", 4);
+        append(form, sizeof(form));
+
+        if (isFloat) {
+            uint8_t fver[12];
+            std::memcpy(fver, "FVER", 4);
+            putBE32(fver + 4, 4);
+            putBE32(fver + 8, AIFC_VERSION_1);
+            append(fver, sizeof(fver));
+        }
+
+        uint8_t comm[8 + 24] = {};
+        std::memcpy(comm, "COMM", 4);
+        putBE32(comm + 4, commSize);
+        putBE16(comm + 8, (uint16_t)m_format.numChannels);
+        putBE32(comm + 10, (uint32_t)m_numFrames);
+        putBE16(comm + 14, (uint16_t)(bytesPerSample * 8));
+        putExtended(comm + 16, m_format.sampleRate);
+        if (isFloat) { std::memcpy(comm + 26, (m_format.sampleFormat == PcmSampleFormat::FLOAT32) ? "fl32" : "fl64", 4); }
+        append(comm, 8 + commSize);
+
+        uint8_t ssnd[16] = {};
+        std::memcpy(ssnd, "SSND", 4);
+        putBE32(ssnd + 4, (uint32_t)(8 + dataBytes));
+        append(ssnd, sizeof(ssnd));
+    }
+
+    m_headerSize = header.size();
+    const juce::int64 position = m_stream->getPosition();
+    bool ok = m_stream->setPosition(0) && m_stream->write(header.data(), header.size());
+    if (position > (juce::int64)header.size()) { ok = ok && m_stream->setPosition(position); }
+    return ok;
+}
+
+////////////////
+// resamplePcmFile
+////////////////
+bool resamplePcmFile(const juce::File& input, const juce::File& output, double dstSampleRate, PcmFileType fileType, PcmSampleFormat sampleFormat)
+{
+    PcmFileReader reader(input);
+    if (!reader.isValid()) { return false; }
+
+    PcmFileWriter::Format format;
+    format.fileType     = fileType;
+    format.sampleFormat = sampleFormat;
+    format.sampleRate   = dstSampleRate;
+    format.numChannels  = reader.getNumChannels();
+    PcmFileWriter writer(output, format);
+    if (!writer.isValid()) { return false; }
+
+    const unsigned numChannels = reader.getNumChannels();
+    std::vector<std::vector<double>> inBuffers(numChannels, std::vector<double>(RESAMPLER_BLOCK_SIZE));
+    std::vector<double*> inPtrs(numChannels);
+    std::vector<double*> outPtrs(numChannels);
+    for (unsigned channel=0; channel < numChannels; channel++) { inPtrs[channel] = inBuffers[channel].data(); }
+
+    if (reader.getSampleRate() == dstSampleRate) {
+        while (unsigned numFrames = reader.read(inPtrs.data(), RESAMPLER_BLOCK_SIZE)) {
+            if (!writer.write(inPtrs.data(), numFrames)) { return false; }
+        }
+        return writer.finish();
+    }
+
+    std::vector<std::unique_ptr<r8b::CDSPResampler24>> resamplers;
+    for (unsigned channel=0; channel < numChannels; channel++) {
+        resamplers.emplace_back(new r8b::CDSPResampler24(reader.getSampleRate(), dstSampleRate, RESAMPLER_BLOCK_SIZE));
+    }
+
+    // Past the end of the input the resamplers are fed zeros until the output length is reached, as in oneshot()
+    const uint64_t outLength = (uint64_t)std::ceil(reader.getNumFrames() * dstSampleRate / reader.getSampleRate());
+    bool isZero = false;
+    for (uint64_t outPos=0; outPos < outLength; ) {
+        unsigned numIn = reader.read(inPtrs.data(), RESAMPLER_BLOCK_SIZE);
+        if (numIn == 0) {
+            if (!isZero) {
+                for (auto& buffer : inBuffers) { std::fill(buffer.begin(), buffer.end(), 0.0); }
+                isZero = true;
+            }
+            numIn = RESAMPLER_BLOCK_SIZE;
+        }
+
+        int numOut = 0;
+        for (unsigned channel=0; channel < numChannels; channel++) {
+            numOut = resamplers[channel]->process(inPtrs[channel], (int)numIn, outPtrs[channel]);
+        }
+        numOut = (int)std::min((uint64_t)numOut, outLength - outPos);
+        if (!writer.write(outPtrs.data(), (unsigned)numOut)) { return false; }
+        outPos += numOut;
+    }
+    return writer.finish();
+}
+
+}
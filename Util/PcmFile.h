@@ -0,0 +1,147 @@
+/*
+ * PcmFile.h
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <JuceHeader.h>
+
+namespace stride {
+
+enum class PcmFileType : unsigned {
+    WAV = 0, // RIFF, switched to RF64 when the data outgrows 4 GB
+    AIFF     // AIFF for integer samples, AIFC for float
+};
+
+enum class PcmSampleFormat : unsigned {
+    INT16 = 0,
+    INT24,
+    INT32,
+    FLOAT32,
+    FLOAT64
+};
+
+unsigned getBytesPerSample(PcmSampleFormat sampleFormat);
+
+// Streams the frames of an uncompressed WAV, RF64, AIFF or AIFC file. The sample data is memory-mapped one
+// window at a time, so files of any size are read in constant memory, and decoded straight into planar
+// double buffers of whatever block size the caller processes.
+class PcmFileReader
+{
+public:
+    static constexpr size_t MAP_WINDOW_BYTES = 16 << 20;
+
+    explicit PcmFileReader(const juce::File& file);
+    virtual ~PcmFileReader() = default;
+
+    bool            isValid() const { return m_numChannels > 0; }
+    PcmFileType     getFileType() const { return m_fileType; }
+    PcmSampleFormat getSampleFormat() const { return m_sampleFormat; }
+    double          getSampleRate() const { return m_sampleRate; }
+    unsigned        getNumChannels() const { return m_numChannels; }
+    uint64_t        getNumFrames() const { return m_numFrames; }
+
+    uint64_t getPosition() const { return m_position; }
+    void     setPosition(uint64_t frame) { m_position = std::min(frame, m_numFrames); }
+
+    // Decodes up to numFrames frames from the current position into getNumChannels() planar buffers,
+    // returns the number of frames read, 0 at the end of the file
+    unsigned read(double* const* out, unsigned numFrames);
+
+private:
+    using DecodeFn = void (*)(const uint8_t* data, unsigned frameSize, unsigned numChannels, unsigned numFrames,
+                              double* const* out, unsigned outOffset);
+
+    juce::File      m_file;
+    DecodeFn        m_decode       = nullptr;
+    PcmFileType     m_fileType     = PcmFileType::WAV;
+    PcmSampleFormat m_sampleFormat = PcmSampleFormat::INT16;
+    bool            m_bigEndian    = false;
+    double          m_sampleRate   = 0.0;
+    unsigned        m_numChannels  = 0;
+    unsigned        m_frameSize    = 0; // bytes
+    uint64_t        m_numFrames    = 0;
+    uint64_t        m_dataOffset   = 0; // file offset of the first frame
+    uint64_t        m_position     = 0;
+
+    std::unique_ptr<juce::MemoryMappedFile> m_map;
+    uint64_t m_mapStart = 0; // file offsets covered by m_map
+    uint64_t m_mapEnd   = 0;
+
+    bool m_parseWav(juce::FileInputStream& stream);
+    bool m_parseAiff(juce::FileInputStream& stream);
+    const uint8_t* m_mapFrames(uint64_t frame, unsigned& numFrames);
+};
+
+// Writes frames to a WAV or AIFF file from a background thread. The caller's frames are encoded into one of
+// two buffers while the thread writes the other, so write() only blocks when the disk falls a full buffer
+// behind and memory use stays constant however long the file gets.
+class PcmFileWriter : private juce::Thread
+{
+public:
+    struct Format {
+        PcmFileType     fileType     = PcmFileType::WAV;
+        PcmSampleFormat sampleFormat = PcmSampleFormat::INT24;
+        double          sampleRate   = 48000.0;
+        unsigned        numChannels  = 2;
+        unsigned        bufferFrames = 65536; // per buffer, two are allocated
+    };
+
+    PcmFileWriter(const juce::File& file, const Format& format);
+    virtual ~PcmFileWriter();
+
+    bool isValid() const { return m_stream != nullptr; }
+    const Format& getFormat() const { return m_format; }
+    uint64_t getNumFrames() const { return m_numFrames; }
+
+    // Encodes numFrames frames from numChannels planar buffers, clipping at full scale. Returns false once
+    // a write has failed.
+    bool write(const double* const* in, unsigned numFrames);
+
+    // Writes the remaining frames and the final sizes into the header, called by the destructor if needed.
+    // Returns false if any write failed.
+    bool finish();
+
+private:
+    using EncodeFn = void (*)(const double* const* in, unsigned numChannels, unsigned inOffset, unsigned numFrames,
+                              uint8_t* data);
+
+    Format     m_format;
+    juce::File m_file;
+    EncodeFn   m_encode     = nullptr;
+    unsigned   m_frameSize  = 0;
+    size_t     m_headerSize = 0;
+    uint64_t   m_numFrames  = 0;
+    bool       m_finished   = false;
+    std::unique_ptr<juce::FileOutputStream> m_stream;
+
+    // m_buffers[m_current] is filled by the caller, m_pending is the buffer the thread is writing or -1
+    std::vector<uint8_t>  m_buffers[2];
+    size_t                m_bufferFill = 0; // bytes
+    int                   m_current    = 0;
+    std::atomic<int>      m_pending;
+    size_t                m_pendingSize = 0;
+    std::atomic<bool>     m_failed;
+    juce::WaitableEvent   m_bufferReady;
+    juce::WaitableEvent   m_bufferDone;
+
+    void run() override;
+    void m_handOff();
+    void m_waitForPending();
+    bool m_writeHeader(uint64_t dataBytes);
+};
+
+// Streams a file through one CDSPResampler24 per channel into a new file at dstSampleRate, in constant
+// memory. The output has the same length in time as the input.
+bool resamplePcmFile(const juce::File& input, const juce::File& output, double dstSampleRate,
+                     PcmFileType fileType = PcmFileType::WAV, PcmSampleFormat sampleFormat = PcmSampleFormat::INT24);
+
+}
@@ -0,0 +1,89 @@
+/*
+ * PcmFileBenchmark.cpp
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <utility>
+#include <JuceHeader.h>
+#include "Util/PcmFile.h"
+#include "PcmFileBenchmark.h"
+
+namespace stride {
+
+namespace {
+
+constexpr int FILE_BLOCK_SIZE = 4096;
+
+}
+
+std::vector<PcmFileBenchmark::FileStreamingResult> PcmFileBenchmark::runFileStreaming(const std::string& directory, double signalSecs)
+{
+    static const std::pair<PcmSampleFormat, const char*> SAMPLE_FORMATS[] = {
+        {PcmSampleFormat::INT16, "int16"}, {PcmSampleFormat::INT24, "int24"}, {PcmSampleFormat::FLOAT32, "float32"}
+    };
+    constexpr double   SAMPLE_RATE  = 48000.0;
+    constexpr unsigned NUM_CHANNELS = 2;
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<double> dist(-0.5, 0.5);
+    std::vector<std::vector<double>> block(NUM_CHANNELS, std::vector<double>(FILE_BLOCK_SIZE));
+    std::vector<double*> blockPtrs;
+    for (auto& channel : block) {
+        for (auto& sample : channel) { sample = dist(rng); }
+        blockPtrs.push_back(channel.data());
+    }
+    const uint64_t numFrames = (uint64_t)(signalSecs * SAMPLE_RATE);
+
+    std::vector<FileStreamingResult> results;
+    auto addResult = [&](const char* stage, const char* sampleFormat, double fileBytes, double elapsedSecs) {
+        FileStreamingResult result;
+        result.stage          = stage;
+        result.sampleFormat   = sampleFormat;
+        result.mbPerSec       = fileBytes / elapsedSecs * 1e-6;
+        result.realtimeFactor = signalSecs / elapsedSecs;
+        results.push_back(result);
+    };
+
+    for (auto& sampleFormat : SAMPLE_FORMATS) {
+        const juce::File file   = juce::File(directory).getChildFile(std::string("PcmFileBenchmark_") + sampleFormat.second + ".wav");
+        const juce::File output = juce::File(directory).getChildFile(std::string("PcmFileBenchmark_") + sampleFormat.second + "_44k.wav");
+        const double fileBytes  = (double)numFrames * NUM_CHANNELS * getBytesPerSample(sampleFormat.first);
+
+        auto start = std::chrono::steady_clock::now();
+        {
+            PcmFileWriter::Format format;
+            format.sampleFormat = sampleFormat.first;
+            format.sampleRate   = SAMPLE_RATE;
+            format.numChannels  = NUM_CHANNELS;
+            PcmFileWriter writer(file, format);
+            for (uint64_t frame=0; frame < numFrames; frame += FILE_BLOCK_SIZE) {
+                writer.write(blockPtrs.data(), (unsigned)std::min(numFrames - frame, (uint64_t)FILE_BLOCK_SIZE));
+            }
+            if (!writer.finish()) { return results; }
+        }
+        addResult("write", sampleFormat.second, fileBytes, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+        start = std::chrono::steady_clock::now();
+        {
+            PcmFileReader reader(file);
+            while (reader.read(blockPtrs.data(), FILE_BLOCK_SIZE) > 0) {}
+        }
+        addResult("read", sampleFormat.second, fileBytes, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+        start = std::chrono::steady_clock::now();
+        const bool resampled = resamplePcmFile(file, output, 44100.0, PcmFileType::WAV, sampleFormat.first);
+        if (resampled) {
+            addResult("resample", sampleFormat.second, fileBytes, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        file.deleteFile();
+        output.deleteFile();
+    }
+    return results;
+}
+
+}
@@ -0,0 +1,31 @@
+/*
+ * PcmFileBenchmark.h
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace stride {
+
+// Streaming throughput of PcmFileWriter, PcmFileReader and resamplePcmFile()
+class PcmFileBenchmark
+{
+public:
+    struct FileStreamingResult {
+        std::string stage;          // "write", "read" or "resample" (read, resample to 44.1k and write)
+        std::string sampleFormat;   // of the 48k stereo WAV file, "int16", "int24" or "float32"
+        double      mbPerSec;       // of the 48k file
+        double      realtimeFactor; // seconds of audio per second
+    };
+
+    // Writes, reads and resamples signalSecs of stereo audio through PcmFileWriter and PcmFileReader in the
+    // given directory. The files are deleted afterwards. Reads are likely to come from the OS file cache.
+    static std::vector<FileStreamingResult> runFileStreaming(const std::string& directory, double signalSecs = 600.0);
+};
+
+}
@@ -0,0 +1,119 @@
+/*
+ * PeakMeterStream.cpp
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+#include <algorithm>
+#include <cstring>
+#include "PeakMeterStream.h"
+
+namespace stride {
+
+PeakMeterStream::PeakMeterStream(RequestSender sender)
+: m_requestSender(sender), m_requestOutstanding(false), m_requestSentMs(0),
+  m_numDeferredRequests(0), m_numTimedOutRequests(0), m_sequence(0)
+{
+    memset((void*)m_frames, 0, sizeof(m_frames));
+}
+
+int PeakMeterStream::subscribe(unsigned numMeters, unsigned rateHz)
+{
+    int subscriptionId = m_nextSubscriptionId++;
+    m_subscriptions[subscriptionId] = { std::min(numMeters, MAX_NUM_PEAK_METERS), std::min(std::max(rateHz, 1U), MAX_RATE_HZ) };
+    m_updatePolling();
+    return subscriptionId;
+}
+
+void PeakMeterStream::unsubscribe(int subscriptionId)
+{
+    m_subscriptions.erase(subscriptionId);
+    m_updatePolling();
+}
+
+void PeakMeterStream::m_updatePolling()
+{
+    if (m_subscriptions.empty()) {
+        stopTimer();
+        m_numMetersRequested = 0;
+        m_requestOutstanding.store(false, std::memory_order_relaxed);
+        return;
+    }
+
+    unsigned numMeters = 0;
+    unsigned rateHz    = 0;
+    for (auto& entry : m_subscriptions) {
+        numMeters = std::max(numMeters, entry.second.numMeters);
+        rateHz    = std::max(rateHz,    entry.second.rateHz);
+    }
+    m_numMetersRequested = numMeters;
+    startTimerHz((int)rateHz);
+}
+
+void PeakMeterStream::timerCallback()
+{
+    if (!m_requestSender || (m_numMetersRequested == 0)) { return; }
+
+    uint32_t nowMs = juce::Time::getMillisecondCounter();
+    if (m_requestOutstanding.load(std::memory_order_acquire)) {
+        // Don't pile up requests on a slow link, wait for the reply or give up on it
+        if ((nowMs - m_requestSentMs.load(std::memory_order_relaxed)) < REPLY_TIMEOUT_MS) {
+            m_numDeferredRequests.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        m_numTimedOutRequests.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (m_requestSender(m_numMetersRequested)) {
+        m_requestSentMs.store(nowMs, std::memory_order_relaxed);
+        m_requestOutstanding.store(true, std::memory_order_release);
+    } else {
+        m_requestOutstanding.store(false, std::memory_order_release);
+        m_numDeferredRequests.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void PeakMeterStream::publishFrame(const float* peaks, unsigned numMeters)
+{
+    if (!peaks) { return; }
+    numMeters = std::min(numMeters, MAX_NUM_PEAK_METERS);
+
+    // Mark the write in progress before touching the buffer. The release fence keeps the buffer writes
+    // from becoming visible ahead of the odd sequence, so a reader still copying this buffer from two
+    // publishes ago sees the sequence change and retries.
+    const uint64_t sequence   = m_sequence.load(std::memory_order_relaxed);
+    const uint64_t generation = sequence >> 1;
+    m_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    PeakMeterFrame& frame = m_frames[(generation + 1) & 0x1];
+    std::memcpy(frame.peaks, peaks, numMeters * sizeof(float));
+    frame.numMeters   = numMeters;
+    frame.frameNumber = generation + 1;
+    frame.timeMs      = juce::Time::getMillisecondCounterHiRes();
+    m_sequence.store(sequence + 2, std::memory_order_release);
+
+    m_requestOutstanding.store(false, std::memory_order_release);
+}
+
+bool PeakMeterStream::getLatestFrame(PeakMeterFrame& frame) const
+{
+    constexpr unsigned MAX_RETRIES = 8;
+
+    for (unsigned retry=0; retry < MAX_RETRIES; retry++) {
+        // While the sequence is odd the writer is filling the back buffer, the front one is still whole
+        uint64_t sequenceBefore = m_sequence.load(std::memory_order_acquire);
+        uint64_t generation     = sequenceBefore >> 1;
+        if (generation == 0) { return false; }
+
+        std::memcpy((void*)&frame, (const void*)&m_frames[generation & 0x1], sizeof(PeakMeterFrame));
+
+        // The next publish goes to the back buffer, but the one after that may already be rewriting
+        // the buffer we copied, so only accept the copy if no write started or finished meanwhile.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_sequence.load(std::memory_order_relaxed) == sequenceBefore) { return true; }
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,85 @@
+/*
+ * PeakMeterStream.h
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <JuceHeader.h>
+
+namespace stride {
+
+constexpr unsigned MAX_NUM_PEAK_METERS = 16;
+
+struct PeakMeterFrame {
+    float    peaks[MAX_NUM_PEAK_METERS];
+    unsigned numMeters;
+    uint64_t frameNumber;
+    double   timeMs;
+};
+
+// Subscription based peak meter streaming for one direction (inputs or outputs). Subscribers ask for a
+// number of meters at a target rate, the stream polls the pedal at the highest requested rate for the
+// largest requested meter count. Replies are published into a double buffer that any thread can read
+// without locking. Subscribe and unsubscribe from the message thread.
+//
+// Back-pressure: only one request is outstanding at a time, and the request sender may defer a request
+// (e.g. while control updates are being sent) so meter traffic never starves control traffic.
+class PeakMeterStream : private juce::Timer
+{
+public:
+    using RequestSender = std::function<bool(unsigned numMeters)>; // returns false if the request was deferred
+
+    static constexpr unsigned MAX_RATE_HZ           = 60;
+    static constexpr unsigned REPLY_TIMEOUT_MS      = 250;
+
+    explicit PeakMeterStream(RequestSender sender);
+    virtual ~PeakMeterStream() { stopTimer(); }
+
+    int  subscribe(unsigned numMeters, unsigned rateHz); // returns a subscription ID
+    void unsubscribe(int subscriptionId);
+    bool hasSubscribers() const { return !m_subscriptions.empty(); }
+
+    // Writer side, called when a reply is decoded
+    void publishFrame(const float* peaks, unsigned numMeters);
+
+    // Reader side, lock free. Returns false if no frame has been received yet.
+    bool getLatestFrame(PeakMeterFrame& frame) const;
+
+    unsigned getNumDeferredRequests() const { return m_numDeferredRequests.load(std::memory_order_relaxed); }
+    unsigned getNumTimedOutRequests() const { return m_numTimedOutRequests.load(std::memory_order_relaxed); }
+
+private:
+    struct Subscription {
+        unsigned numMeters;
+        unsigned rateHz;
+    };
+
+    RequestSender               m_requestSender;
+    std::map<int, Subscription> m_subscriptions;
+    int      m_nextSubscriptionId = 1;
+    unsigned m_numMetersRequested = 0;
+
+    std::atomic<bool>     m_requestOutstanding;
+    std::atomic<uint32_t> m_requestSentMs;
+    std::atomic<unsigned> m_numDeferredRequests;
+    std::atomic<unsigned> m_numTimedOutRequests;
+
+    // Seqlock over the double buffer: the sequence is odd while the writer fills buffer (generation + 1) & 1,
+    // where generation = sequence / 2, and even once it's published. Readers copy buffer generation & 1 and
+    // keep the copy only if the sequence didn't change meanwhile.
+    PeakMeterFrame        m_frames[2];
+    std::atomic<uint64_t> m_sequence;
+
+    void m_updatePolling();
+    void timerCallback() override;
+
+    JUCE_DECLARE_NON_COPYABLE (PeakMeterStream)
+};
+
+}
@@ -0,0 +1,564 @@
+/*
+ * PedalSession.cpp
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <set>
+#include "Util/ErrorMessage.h"
+#include "PedalSession.h"
+
+#if JUCE_MAC
+#include <CoreMIDI/CoreMIDI.h>
+#endif
+
+namespace stride {
+
+using SysExMessageType = MidiDeviceManager::SysExMessageType;
+
+namespace {
+
+// The part of a MIDI port's identifier shared by the input and output ports of one USB device, empty when
+// the platform's identifiers don't carry it
+std::string getMidiDeviceKey(const juce::MidiDeviceInfo& info)
+{
+#if JUCE_WINDOWS
+    // Device interface paths, "\\?\usb#vid_16c0&pid_0485&mi_00#7&1a2b3c4d&0&0000#{class guid}..."
+    // The input and output interfaces of a device differ only in the class GUID at the end
+    const juce::String identifier = info.identifier.toLowerCase();
+    const int guidStart = identifier.lastIndexOf("#{");
+    return (guidStart > 0) ? identifier.substring(0, guidStart).toStdString() : std::string();
+#elif JUCE_LINUX
+    // ALSA "client-port", all of a device's ports belong to one client
+    const int separator = info.identifier.indexOfChar('-');
+    return (separator > 0) ? info.identifier.substring(0, separator).toStdString() : std::string();
+#elif JUCE_MAC
+    // CoreMIDI endpoint unique IDs, use the unique ID of the device owning the endpoint
+    MIDIObjectRef endpoint = 0;
+    MIDIObjectType type;
+    if (MIDIObjectFindByUniqueID((MIDIUniqueID)info.identifier.getIntValue(), &endpoint, &type) != noErr) { return {}; }
+    MIDIEntityRef entity = 0;
+    MIDIDeviceRef device = 0;
+    SInt32 deviceId = 0;
+    if ((MIDIEndpointGetEntity((MIDIEndpointRef)endpoint, &entity) != noErr) ||
+        (MIDIEntityGetDevice(entity, &device) != noErr) ||
+        (MIDIObjectGetIntegerProperty(device, kMIDIPropertyUniqueID, &deviceId) != noErr)) {
+        return {};
+    }
+    return std::to_string(deviceId);
+#else
+    juce::ignoreUnused(info);
+    return {};
+#endif
+}
+
+// Shared with the jobs, which may outlive runOnAllSessions() after a timeout
+struct SessionJobState {
+    MultiPedalManager::SessionJob job;
+    std::atomic<unsigned>         numRemaining { 0 };
+    std::atomic<unsigned>         numSucceeded { 0 };
+    juce::WaitableEvent           allDone;
+};
+
+// Counts the job down when it's destroyed, which the thread pool also does to jobs it removes before they
+// run, e.g. in MultiPedalManager::stop()
+struct SessionJobToken {
+    explicit SessionJobToken(std::shared_ptr<SessionJobState> statePtr) : state(std::move(statePtr)) {}
+    ~SessionJobToken() { if (--state->numRemaining == 0) { state->allDone.signal(); } }
+    SessionJobToken(const SessionJobToken&) = delete;
+    SessionJobToken& operator=(const SessionJobToken&) = delete;
+
+    std::shared_ptr<SessionJobState> state;
+};
+
+}
+
+/////////////////////////////////////////////////////
+// LatencyStats
+/////////////////////////////////////////////////////
+void LatencyStats::add(double latencyMs)
+{
+    if (count == 0) {
+        minMs = maxMs = meanMs = latencyMs;
+    } else {
+        minMs  = std::min(minMs, latencyMs);
+        maxMs  = std::max(maxMs, latencyMs);
+        meanMs = meanMs + (latencyMs - meanMs) / (count + 1);
+    }
+    lastMs = latencyMs;
+    count++;
+}
+
+/////////////////////////////////////////////////////
+// PedalSession
+/////////////////////////////////////////////////////
+PedalSession::PedalSession(const juce::MidiDeviceInfo& inputInfo, const juce::MidiDeviceInfo& outputInfo)
+: juce::Thread("PedalSession " + inputInfo.identifier), m_inputInfo(inputInfo), m_outputInfo(outputInfo)
+{
+    memset((void*)&m_teensyUid.uid[0], 0xff, UID_SIZE_BYTES);
+    memset((void*)&m_fuses, 0, sizeof(m_fuses));
+}
+
+PedalSession::~PedalSession()
+{
+    close();
+}
+
+bool PedalSession::open(juce::MidiInputCallback* callback)
+{
+    if (isOpen()) { return true; }
+
+    m_outDevice = juce::MidiOutput::openDevice(m_outputInfo.identifier);
+    m_inDevice  = juce::MidiInput::openDevice(m_inputInfo.identifier, callback);
+    if (!m_outDevice || !m_inDevice) {
+        errorMessage("PedalSession::open(): failed to open " + m_inputInfo.name.toStdString() + " (" + m_inputInfo.identifier.toStdString() + ")");
+        m_inDevice  = nullptr;
+        m_outDevice = nullptr;
+        return false;
+    }
+
+    m_inDevice->start();
+    startThread();
+    return true;
+}
+
+void PedalSession::close()
+{
+    signalThreadShouldExit();
+    m_queueEvent.signal();
+    stopThread(1000);
+
+    if (m_inDevice) {
+        m_inDevice->stop();
+        m_inDevice = nullptr;
+    }
+    m_outDevice = nullptr;
+
+    const juce::ScopedLock lock (m_stateLock);
+    m_connected = false;
+}
+
+bool PedalSession::isOpen() const
+{
+    return m_inDevice && m_outDevice;
+}
+
+void PedalSession::enqueue(const juce::MidiMessage& message)
+{
+    {
+        const juce::ScopedLock lock (m_queueLock);
+        m_outgoingQueue.push_back(message);
+    }
+    m_queueEvent.signal();
+}
+
+void PedalSession::run()
+{
+    while (!threadShouldExit()) {
+        std::deque<juce::MidiMessage> messages;
+        {
+            const juce::ScopedLock lock (m_queueLock);
+            messages.swap(m_outgoingQueue);
+        }
+
+        for (auto& message : messages) {
+            if (threadShouldExit() || !m_outDevice) { break; }
+            m_outDevice->sendMessageNow(message);
+        }
+
+        if (messages.empty()) { m_queueEvent.wait(100); }
+    }
+}
+
+void PedalSession::sendRequestPing()
+{
+    {
+        const juce::ScopedLock lock (m_stateLock);
+        m_waitingForPong = true;
+        m_pingSendTicks.push_back(juce::Time::getHighResolutionTicks());
+    }
+    enqueue(MidiDeviceManager::createSysExMessage(SysExMessageType::HARDWARE_PING, nullptr, 0));
+}
+
+void PedalSession::sendRequestUid()
+{
+    enqueue(MidiDeviceManager::createSysExMessage(SysExMessageType::REQUEST_UID, nullptr, 0));
+}
+
+void PedalSession::sendRequestFuses()
+{
+    enqueue(MidiDeviceManager::createSysExMessage(SysExMessageType::REQUEST_FUSES, nullptr, 0));
+}
+
+void PedalSession::sendWriteEUIDH(const uint8_t* fuseData)
+{
+    m_sendWriteFuse(SysExMessageType::WRITE_EUIDH, fuseData);
+}
+
+void PedalSession::sendWriteDevicePBKH(const uint8_t* fuseData)
+{
+    m_sendWriteFuse(SysExMessageType::WRITE_DEVICE_PBKH, fuseData);
+}
+
+void PedalSession::sendWriteDevelPBKH(const uint8_t* fuseData)
+{
+    m_sendWriteFuse(SysExMessageType::WRITE_DEVEL_PBKH, fuseData);
+}
+
+void PedalSession::sendWriteConfig(const uint8_t* fuseData)
+{
+    m_sendWriteFuse(SysExMessageType::WRITE_CONFIG, fuseData);
+}
+
+void PedalSession::sendLockFuses(uint32_t fuseMask)
+{
+    enqueue(MidiDeviceManager::createSysExMessage(SysExMessageType::LOCK_FUSES, (const uint8_t*)&fuseMask, LOCK_FUSES_SIZE_BYTES));
+}
+
+void PedalSession::m_sendWriteFuse(SysExMessageType type, const uint8_t* fuseData)
+{
+    if (!fuseData) { return; }
+    enqueue(MidiDeviceManager::createSysExMessage(type, fuseData, FUSE_WRITE_SIZE_BYTES));
+}
+
+bool PedalSession::requestUidAndWait(int timeoutMs)
+{
+    m_uidEvent.reset();
+    sendRequestUid();
+    return m_uidEvent.wait(timeoutMs);
+}
+
+bool PedalSession::requestFusesAndWait(int timeoutMs)
+{
+    m_fusesEvent.reset();
+    sendRequestFuses();
+    return m_fusesEvent.wait(timeoutMs);
+}
+
+bool PedalSession::pingAndWait(int timeoutMs)
+{
+    m_pongEvent.reset();
+    sendRequestPing();
+    return m_pongEvent.wait(timeoutMs);
+}
+
+void PedalSession::handleIncomingMessage(const juce::MidiMessage& message)
+{
+    // This is called on the MIDI thread
+    SysExMessageType type;
+    std::vector<uint8_t> payload;
+    if (!MidiDeviceManager::decodeSysExMessage(message, type, payload)) { return; }
+
+    switch (type) {
+    case SysExMessageType::HARDWARE_PONG :
+    {
+        if (payload.size() != REPLY_PONG_SYSEX_SIZE - SYSEX_TYPE_SIZE_BYTES) {
+            errorMessage("PedalSession::handleIncomingMessage(): pong wrong size, received " + std::to_string(payload.size()));
+            return;
+        }
+        const juce::ScopedLock lock (m_stateLock);
+        std::memcpy((void*)&m_presetChecksum, payload.data(), PRESET_CHECKSUM_SIZE);
+        std::memcpy((void*)&m_telemetry, payload.data() + PRESET_CHECKSUM_SIZE, TELEMETRY_SIZE);
+        if (!m_pingSendTicks.empty()) {
+            int64_t elapsedTicks = juce::Time::getHighResolutionTicks() - m_pingSendTicks.front();
+            m_pingSendTicks.pop_front();
+            m_pingLatency.add(juce::Time::highResolutionTicksToSeconds(elapsedTicks) * 1000.0);
+        }
+        m_waitingForPong = false;
+        m_connected      = true;
+        m_pongEvent.signal();
+    }
+    break;
+
+    case SysExMessageType::REPLY_UID :
+    {
+        if (payload.size() != REPLY_UID_SYSEX_SIZE - SYSEX_TYPE_SIZE_BYTES) {
+            errorMessage("PedalSession::handleIncomingMessage(): UID wrong size, received " + std::to_string(payload.size()));
+            return;
+        }
+        const juce::ScopedLock lock (m_stateLock);
+        std::memcpy((void*)&m_teensyUid.uid[0], payload.data(), UID_SIZE_BYTES);
+        m_hasUid = true;
+        m_uidEvent.signal();
+    }
+    break;
+
+    case SysExMessageType::REPLY_FUSES :
+    {
+        if (payload.size() != REPLY_FUSES_SYSEX_SIZE - SYSEX_TYPE_SIZE_BYTES) {
+            errorMessage("PedalSession::handleIncomingMessage(): fuses wrong size, received " + std::to_string(payload.size()));
+            return;
+        }
+        const juce::ScopedLock lock (m_stateLock);
+        std::memcpy((void*)&m_fuses.configLow, payload.data(), FUSES_SIZE_BYTES);
+        m_hasFuses = true;
+        m_fusesEvent.signal();
+    }
+    break;
+
+    default :
+        break;
+    }
+
+    if (m_sysExCallback) { m_sysExCallback(*this, type); }
+}
+
+bool PedalSession::checkKeepAlive()
+{
+    const juce::ScopedLock lock (m_stateLock);
+    if (m_waitingForPong) {
+        // no reply to the previous ping
+        m_connected = false;
+        m_pingSendTicks.clear();
+    }
+    return m_connected;
+}
+
+bool PedalSession::hasUid() const
+{
+    const juce::ScopedLock lock (m_stateLock);
+    return m_hasUid;
+}
+
+TeensyUid PedalSession::getUid() const
+{
+    const juce::ScopedLock lock (m_stateLock);
+    return m_teensyUid;
+}
+
+bool PedalSession::hasFuses() const
+{
+    const juce::ScopedLock lock (m_stateLock);
+    return m_hasFuses;
+}
+
+Fuses PedalSession::getFuses() const
+{
+    const juce::ScopedLock lock (m_stateLock);
+    return m_fuses;
+}
+
+bool PedalSession::isConnected() const
+{
+    const juce::ScopedLock lock (m_stateLock);
+    return m_connected;
+}
+
+uint32_t PedalSession::getPresetChecksum() const
+{
+    const juce::ScopedLock lock (m_stateLock);
+    return m_presetChecksum;
+}
+
+Telemetry PedalSession::getTelemetry() const
+{
+    const juce::ScopedLock lock (m_stateLock);
+    return m_telemetry;
+}
+
+LatencyStats PedalSession::getPingLatencyStats() const
+{
+    const juce::ScopedLock lock (m_stateLock);
+    return m_pingLatency;
+}
+
+unsigned PedalSession::getQueuedMessageCount() const
+{
+    const juce::ScopedLock lock (m_queueLock);
+    return (unsigned)m_outgoingQueue.size();
+}
+
+/////////////////////////////////////////////////////
+// MultiPedalManager
+/////////////////////////////////////////////////////
+JUCE_IMPLEMENT_SINGLETON(MultiPedalManager)
+
+MultiPedalManager::MultiPedalManager()
+{
+}
+
+MultiPedalManager::~MultiPedalManager()
+{
+    stop();
+    clearSingletonInstance();
+}
+
+void MultiPedalManager::start()
+{
+    m_isStarted = true;
+    scanDevices();
+    startTimer(m_KEEP_ALIVE_TIMER_MS);
+}
+
+void MultiPedalManager::stop()
+{
+    m_isStarted = false;
+    stopTimer();
+    m_threadPool.removeAllJobs(true, 2000);
+
+    std::unordered_map<std::string, PedalSession::Ptr> sessions;
+    {
+        const juce::ScopedLock lock (m_sessionLock);
+        sessions.swap(m_sessions);
+    }
+    for (auto& entry : sessions) { entry.second->close(); }
+}
+
+void MultiPedalManager::scanDevices()
+{
+    // Pair each Teensy input with the output on the same USB device. MIDI inputs and outputs aren't
+    // enumerated in a matching order, so with identical pedals plugged in, pairing by name alone
+    // could send commands to one pedal and read the replies from another.
+    juce::Array<juce::MidiDeviceInfo> inputs;
+    juce::Array<juce::MidiDeviceInfo> outputs;
+
+    for (auto& info : juce::MidiInput::getAvailableDevices()) {
+        if (info.name.contains("Teensy")) { inputs.add(info); }
+    }
+    for (auto& info : juce::MidiOutput::getAvailableDevices()) {
+        if (info.name.contains("Teensy")) { outputs.add(info); }
+    }
+
+    std::unordered_map<std::string, std::pair<juce::MidiDeviceInfo, juce::MidiDeviceInfo>> pluggedPairs;
+    std::set<std::string> ambiguousNames;
+    for (auto& input : inputs) {
+        const std::string inputKey = getMidiDeviceKey(input);
+        juce::Array<juce::MidiDeviceInfo> candidates;
+        for (auto& output : outputs) {
+            if (!inputKey.empty()) {
+                // Same device, and the same name to tell apart the ports of a multi-cable device
+                if ((getMidiDeviceKey(output) == inputKey) && (output.name == input.name)) { candidates.add(output); }
+            } else if (output.name == input.name) {
+                candidates.add(output);
+            }
+        }
+
+        // Without a device key the names must be unique to pair safely
+        int numInputsWithName = 0;
+        for (auto& other : inputs) {
+            if (other.name == input.name) { numInputsWithName++; }
+        }
+        if ((candidates.size() != 1) || (inputKey.empty() && (numInputsWithName != 1))) {
+            if (!candidates.isEmpty()) { ambiguousNames.insert(input.name.toStdString()); }
+            continue;
+        }
+        pluggedPairs[input.identifier.toStdString()] = { input, candidates[0] };
+    }
+
+    if (ambiguousNames != m_ambiguousNames) {
+        m_ambiguousNames = ambiguousNames;
+        for (auto& name : ambiguousNames) {
+            warningMessage("MultiPedalManager::scanDevices(): can't tell which output belongs to which input for " +
+                           name + ", not opening them");
+        }
+    }
+
+    std::vector<PedalSession::Ptr> unpluggedSessions;
+    std::vector<PedalSession::Ptr> newSessions;
+    {
+        const juce::ScopedLock lock (m_sessionLock);
+        for (auto it = m_sessions.begin(); it != m_sessions.end();) {
+            auto pair = pluggedPairs.find(it->first);
+            if ((pair == pluggedPairs.end()) || !(pair->second.second == it->second->getOutputInfo())) {
+                unpluggedSessions.push_back(it->second);
+                it = m_sessions.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        for (auto& pair : pluggedPairs) {
+            if (m_sessions.count(pair.first)) { continue; }
+            PedalSession::Ptr session = new PedalSession(pair.second.first, pair.second.second);
+            m_sessions[pair.first] = session;
+            newSessions.push_back(session);
+        }
+    }
+
+    for (auto& session : unpluggedSessions) { session->close(); }
+    for (auto& session : newSessions) {
+        if (session->open(this)) {
+            session->sendRequestPing();
+            session->sendRequestUid();
+        }
+    }
+}
+
+juce::ReferenceCountedArray<PedalSession> MultiPedalManager::getSessions() const
+{
+    juce::ReferenceCountedArray<PedalSession> sessions;
+    const juce::ScopedLock lock (m_sessionLock);
+    for (auto& entry : m_sessions) { sessions.add(entry.second); }
+    return sessions;
+}
+
+PedalSession::Ptr MultiPedalManager::findSession(const std::string& inputIdentifier) const
+{
+    const juce::ScopedLock lock (m_sessionLock);
+    auto it = m_sessions.find(inputIdentifier);
+    return (it != m_sessions.end()) ? it->second : nullptr;
+}
+
+size_t MultiPedalManager::getNumSessions() const
+{
+    const juce::ScopedLock lock (m_sessionLock);
+    return m_sessions.size();
+}
+
+unsigned MultiPedalManager::runOnAllSessions(SessionJob job, int timeoutMs)
+{
+    // Blocking the message thread would also stall the MIDI callbacks the jobs usually wait for
+    jassert(!juce::MessageManager::getInstance()->isThisTheMessageThread());
+    if (juce::MessageManager::getInstance()->isThisTheMessageThread()) {
+        errorMessage("MultiPedalManager::runOnAllSessions(): must not be called from the message thread");
+        return 0;
+    }
+
+    auto sessions = getSessions();
+    if (sessions.isEmpty() || !job) { return 0; }
+
+    auto statePtr = std::make_shared<SessionJobState>();
+    statePtr->job = std::move(job);
+    statePtr->numRemaining = (unsigned)sessions.size();
+
+    for (auto& session : sessions) {
+        PedalSession::Ptr sessionPtr = session;
+        auto tokenPtr = std::make_shared<SessionJobToken>(statePtr);
+        m_threadPool.addJob([sessionPtr, tokenPtr]() {
+            SessionJobState& state = *tokenPtr->state;
+            if (sessionPtr->isOpen() && state.job(*sessionPtr)) { state.numSucceeded++; }
+        });
+    }
+
+    if (!statePtr->allDone.wait(timeoutMs)) {
+        warningMessage("MultiPedalManager::runOnAllSessions(): " + std::to_string(statePtr->numRemaining.load()) +
+                       " of " + std::to_string(sessions.size()) + " jobs still running after " +
+                       std::to_string(timeoutMs) + " ms");
+    }
+    return statePtr->numSucceeded.load();
+}
+
+void MultiPedalManager::handleIncomingMidiMessage(juce::MidiInput* source, const juce::MidiMessage& message)
+{
+    // This is called on the MIDI thread, route to the session owning the input
+    if (!source || !message.isSysEx()) { return; }
+    PedalSession::Ptr session = findSession(source->getIdentifier().toStdString());
+    if (session) { session->handleIncomingMessage(message); }
+}
+
+void MultiPedalManager::timerCallback()
+{
+    if (!m_isStarted) { return; }
+    scanDevices();
+
+    for (auto& session : getSessions()) {
+        session->checkKeepAlive();
+        session->sendRequestPing();
+    }
+}
+
+}
@@ -0,0 +1,165 @@
+/*
+ * PedalSession.h
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <JuceHeader.h>
+#include "Util/MidiDeviceManager.h"
+
+namespace stride {
+
+struct LatencyStats {
+    unsigned count  = 0;
+    double   lastMs = 0.0;
+    double   minMs  = 0.0;
+    double   maxMs  = 0.0;
+    double   meanMs = 0.0;
+
+    void add(double latencyMs);
+};
+
+// One connected pedal. Owns its MIDI input/output pair, the state learnt from the pedal (UID, fuses,
+// sync state, telemetry) and an outgoing message queue drained by its own sender thread so several
+// pedals can be driven in parallel. Incoming SysEx is decoded on the MIDI thread, so callbacks are
+// made on the MIDI thread too.
+class PedalSession : public juce::ReferenceCountedObject,
+                     private juce::Thread
+{
+public:
+    using Ptr           = juce::ReferenceCountedObjectPtr<PedalSession>;
+    using SysExCallback = std::function<void(PedalSession&, MidiDeviceManager::SysExMessageType)>;
+
+    PedalSession(const juce::MidiDeviceInfo& inputInfo, const juce::MidiDeviceInfo& outputInfo);
+    virtual ~PedalSession();
+
+    bool open(juce::MidiInputCallback* callback);
+    void close();
+    bool isOpen() const;
+
+    const juce::MidiDeviceInfo& getInputInfo()  const { return m_inputInfo; }
+    const juce::MidiDeviceInfo& getOutputInfo() const { return m_outputInfo; }
+    std::string getInputIdentifier() const { return m_inputInfo.identifier.toStdString(); }
+
+    // Outgoing, queued and sent from the session's sender thread
+    void enqueue(const juce::MidiMessage& message);
+    void sendRequestPing();
+    void sendRequestUid();
+    void sendRequestFuses();
+    void sendWriteEUIDH(const uint8_t* fuseData);
+    void sendWriteDevicePBKH(const uint8_t* fuseData);
+    void sendWriteDevelPBKH(const uint8_t* fuseData);
+    void sendWriteConfig(const uint8_t* fuseData);
+    void sendLockFuses(uint32_t fuseMask);
+
+    // Blocking request helpers for provisioning jobs, don't call these from the MIDI thread
+    bool requestUidAndWait(int timeoutMs);
+    bool requestFusesAndWait(int timeoutMs);
+    bool pingAndWait(int timeoutMs);
+
+    // Incoming, called by the manager on the MIDI thread
+    void handleIncomingMessage(const juce::MidiMessage& message);
+    void registerSysExCallback(SysExCallback callback) { m_sysExCallback = callback; }
+
+    // State
+    bool         hasUid() const;
+    TeensyUid    getUid() const;
+    bool         hasFuses() const;
+    Fuses        getFuses() const;
+    bool         isConnected() const;
+    bool         checkKeepAlive(); // called once per keep-alive period, returns the connected state
+    uint32_t     getPresetChecksum() const;
+    Telemetry    getTelemetry() const;
+    LatencyStats getPingLatencyStats() const;
+    unsigned     getQueuedMessageCount() const;
+
+private:
+    juce::MidiDeviceInfo m_inputInfo;
+    juce::MidiDeviceInfo m_outputInfo;
+    std::unique_ptr<juce::MidiInput>  m_inDevice;
+    std::unique_ptr<juce::MidiOutput> m_outDevice;
+
+    juce::CriticalSection m_stateLock;
+    TeensyUid    m_teensyUid;
+    Fuses        m_fuses;
+    bool         m_hasUid   = false;
+    bool         m_hasFuses = false;
+    bool         m_waitingForPong = false;
+    bool         m_connected      = false;
+    uint32_t     m_presetChecksum = 0;
+    Telemetry    m_telemetry      = {0.0f, 0.0f, 0.0f, 0.0f};
+    std::deque<int64_t> m_pingSendTicks;
+    LatencyStats m_pingLatency;
+
+    juce::WaitableEvent m_uidEvent;
+    juce::WaitableEvent m_fusesEvent;
+    juce::WaitableEvent m_pongEvent;
+
+    juce::CriticalSection         m_queueLock;
+    std::deque<juce::MidiMessage> m_outgoingQueue;
+    juce::WaitableEvent           m_queueEvent;
+
+    SysExCallback m_sysExCallback = nullptr;
+
+    void run() override;
+    void m_sendWriteFuse(MidiDeviceManager::SysExMessageType type, const uint8_t* fuseData);
+
+    JUCE_DECLARE_NON_COPYABLE (PedalSession)
+};
+
+// Drives any number of pedals at once. Each Teensy input/output pair becomes a PedalSession, incoming
+// SysEx is routed to the session owning the source input, and jobs (e.g. provisioning) can be run
+// across all sessions in parallel. Don't use together with the MidiDeviceManager singleton since both
+// open the Teensy devices.
+class MultiPedalManager : private juce::MidiInputCallback,
+                          private juce::Timer
+{
+public:
+    using SessionJob = std::function<bool(PedalSession&)>;
+
+    MultiPedalManager();
+    virtual ~MultiPedalManager();
+
+    void start();
+    void stop();
+
+    // Enumerate Teensy devices, opening sessions for new pedals and closing unplugged ones
+    void scanDevices();
+
+    juce::ReferenceCountedArray<PedalSession> getSessions() const;
+    PedalSession::Ptr findSession(const std::string& inputIdentifier) const;
+    size_t getNumSessions() const;
+
+    // Runs the job on every session in parallel, blocks until all complete or timeoutMs passes. Returns
+    // the number of jobs that succeeded by then. Not for the message thread.
+    unsigned runOnAllSessions(SessionJob job, int timeoutMs = m_JOB_TIMEOUT_MS);
+
+    JUCE_DECLARE_SINGLETON (MultiPedalManager, true)
+
+private:
+    static constexpr unsigned m_KEEP_ALIVE_TIMER_MS = 1000;
+    static constexpr unsigned m_MAX_PARALLEL_JOBS   = 8;
+    static constexpr int      m_JOB_TIMEOUT_MS      = 60000;
+
+    juce::CriticalSection m_sessionLock;
+    std::unordered_map<std::string, PedalSession::Ptr> m_sessions; // keyed by input identifier
+    juce::ThreadPool m_threadPool { (int)m_MAX_PARALLEL_JOBS };
+    bool m_isStarted = false;
+    std::set<std::string> m_ambiguousNames; // Teensy names with inputs that couldn't be paired, last warned about
+
+    void handleIncomingMidiMessage(juce::MidiInput* source, const juce::MidiMessage& message) override;
+    void timerCallback() override;
+
+    JUCE_DECLARE_NON_COPYABLE (MultiPedalManager)
+};
+
+}
@@ -0,0 +1,289 @@
+/*
+ * ResamplerBenchmark.cpp
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <JuceHeader.h>
+#include "Util/ErrorMessage.h"
+#include "Util/HalfBandBenchmark.h"
+#include "Util/SampleConvertBenchmark.h"
+#include "Util/r8b/CDSPHBDownsampler.h"
+#include "Util/r8b/CDSPResampler.h"
+#include "ResamplerBenchmark.h"
+
+namespace stride {
+
+namespace {
+
+constexpr int PROCESSOR_CHECK_SAMPLES = 16384; // input samples between clock reads
+constexpr int FFT_MIN_LEN_BITS        = 8;
+constexpr int FFT_MAX_LEN_BITS        = 16;
+
+// Feeds a block to process() repeatedly, returns ns per input sample
+double timeProcessor(r8b::CDSPProcessor& processor, int blockSize, double seconds)
+{
+    std::vector<double> inBlock(blockSize);
+    std::vector<double> outBlock(std::max(processor.getMaxOutLen(blockSize), 1));
+    for (int i=0; i < blockSize; i++) { inBlock[i] = std::sin(i * 0.1); }
+    const unsigned numCalls = std::max(1, PROCESSOR_CHECK_SAMPLES / blockSize);
+
+    size_t numSamples = 0;
+    double elapsedSecs = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    while (elapsedSecs < seconds) {
+        for (unsigned i=0; i < numCalls; i++) {
+            double* op = outBlock.data();
+            processor.process(inBlock.data(), blockSize, op);
+        }
+        numSamples += (size_t)numCalls * blockSize;
+        elapsedSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return elapsedSecs * 1e9 / numSamples;
+}
+
+// Ordered forward and inverse transforms, returns ns per real sample
+double timeFFT(int lenBits, bool isFloat, double seconds)
+{
+    r8b::CDSPRealFFTKeeper fft(lenBits, isFloat);
+    const int fftLen = 1 << lenBits;
+    r8b::CFixedBuffer<double> block(fftLen);
+    for (int i=0; i < fftLen; i++) { block[i] = std::sin(i * 0.1); }
+    const unsigned numCalls = std::max(1, PROCESSOR_CHECK_SAMPLES / fftLen);
+
+    size_t numSamples = 0;
+    double elapsedSecs = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    while (elapsedSecs < seconds) {
+        for (unsigned i=0; i < numCalls; i++) {
+            fft->forward(block);
+            fft->inverse(block);
+            for (int j=0; j < fftLen; j++) { block[j] *= fft->getInvMulConst(); }
+        }
+        numSamples += (size_t)numCalls * fftLen;
+        elapsedSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return elapsedSecs * 1e9 / numSamples;
+}
+
+const char* precisionName(bool useFloatFFT)
+{
+    return (R8B_FLOATFFT || useFloatFFT) ? "float" : "double";
+}
+
+// Float FFTs can only be chosen per object with the run-time pffft, otherwise the build decides
+std::vector<bool> getFFTPrecisions()
+{
+    return R8B_PFFFT_RUNTIME ? std::vector<bool> {false, true} : std::vector<bool> {false};
+}
+
+ResamplerBenchmark::ProcessorResult makeProcessorResult(const char* processor, const char* precision, double srcRate, double dstRate,
+                                                        int blockSize, double nsPerSample, int latency)
+{
+    ResamplerBenchmark::ProcessorResult result;
+    result.processor     = processor;
+    result.precision     = precision;
+    result.srcRate       = srcRate;
+    result.dstRate       = dstRate;
+    result.blockSize     = blockSize;
+    result.samplesPerSec = (nsPerSample > 0.0) ? 1e9 / nsPerSample : 0.0;
+    result.nsPerSample   = nsPerSample;
+    result.latency       = latency;
+    return result;
+}
+
+// JSON entries are matched between runs by name
+juce::var makeJsonEntry(const std::string& name, double nsPerSample)
+{
+    juce::DynamicObject* entryPtr = new juce::DynamicObject();
+    entryPtr->setProperty("name", juce::String(name));
+    entryPtr->setProperty("nsPerSample", nsPerSample);
+    return juce::var(entryPtr);
+}
+
+std::string rateName(double rate)
+{
+    return std::to_string((long long)std::lround(rate));
+}
+
+bool loadJson(const std::string& filename, juce::var& json)
+{
+    const juce::File file(filename);
+    if (!file.existsAsFile() || juce::JSON::parse(file.loadFileAsString(), json).failed() || !json.isObject()) {
+        errorMessage("ResamplerBenchmark::compareJson(): unable to read " + filename);
+        return false;
+    }
+    return true;
+}
+
+}
+
+ResamplerBenchmark::BuildConfig ResamplerBenchmark::getBuildConfig()
+{
+    BuildConfig config;
+    config.fastTiming       = R8B_FASTTIMING != 0;
+    config.floatFFT         = R8B_FLOATFFT != 0;
+    config.pffft            = R8B_PFFFT != 0;
+    config.pffftRuntime     = R8B_PFFFT_RUNTIME != 0;
+    config.filterCacheMax   = R8B_FILTER_CACHE_MAX;
+    config.doubleFFT        = R8B_IPP ? "ipp" : (R8B_PFFFT_DOUBLE ? "pffft-double" : "ooura");
+    config.hbKernelSet      = HalfBandBenchmark::getBestKernelSetName();
+    config.convertKernelSet = SampleConvertBenchmark::getBestKernelSetName();
+    return config;
+}
+
+std::vector<ResamplerBenchmark::ProcessorResult> ResamplerBenchmark::runProcessors(double secondsPerCase)
+{
+    static const double RATE_PAIRS[][2] = {
+        {44100.0, 48000.0}, {48000.0, 44100.0}, {48000.0, 96000.0}, {96000.0, 48000.0}, {44100.0, 96000.0}, {96000.0, 44100.0}
+    };
+    // At the interpolator, after the resampler's 2x oversampling
+    static const double INTERPOLATOR_RATE_PAIRS[][2] = { {88200.0, 96000.0}, {96000.0, 88200.0}, {176400.0, 48000.0} };
+    static const int BLOCK_SIZES[] = { 64, 1024 };
+    constexpr double HB_ATTEN       = 180.15; // as the 24-bit resampler
+    constexpr int    HB_STEEP_INDEX = 2;
+
+    std::vector<ProcessorResult> results;
+    auto addResult = [&](const char* processor, const char* precision, double srcRate, double dstRate, int blockSize,
+                         r8b::CDSPProcessor& dsp) {
+        results.push_back(makeProcessorResult(processor, precision, srcRate, dstRate, blockSize,
+                                              timeProcessor(dsp, blockSize, secondsPerCase), dsp.getInLenBeforeOutPos(0)));
+    };
+
+    for (auto& ratePair : RATE_PAIRS) {
+        for (int blockSize : BLOCK_SIZES) {
+            for (bool useFloatFFT : getFFTPrecisions()) {
+                const char* precision = precisionName(useFloatFFT);
+                r8b::CDSPResampler16   resampler16(ratePair[0], ratePair[1], blockSize, 2.0, useFloatFFT);
+                r8b::CDSPResampler16IR resampler16IR(ratePair[0], ratePair[1], blockSize, 2.0, useFloatFFT);
+                r8b::CDSPResampler24   resampler24(ratePair[0], ratePair[1], blockSize, 2.0, useFloatFFT);
+                addResult("CDSPResampler16", precision, ratePair[0], ratePair[1], blockSize, resampler16);
+                addResult("CDSPResampler16IR", precision, ratePair[0], ratePair[1], blockSize, resampler16IR);
+                addResult("CDSPResampler24", precision, ratePair[0], ratePair[1], blockSize, resampler24);
+            }
+        }
+    }
+
+    // A half-band low-pass, the filter of a 2x downsampling stage
+    for (int blockSize : BLOCK_SIZES) {
+        for (bool useFloatFFT : getFFTPrecisions()) {
+            r8b::CDSPFIRFilter& filter = r8b::CDSPFIRFilterCache::getLPFilter(0.5, 2.0, HB_ATTEN, r8b::fprLinearPhase, 1.0,
+                                                                              nullptr, useFloatFFT);
+            r8b::CDSPBlockConvolver convolver(filter, 1, 1); // releases the filter
+            addResult("CDSPBlockConvolver", precisionName(useFloatFFT), 48000.0, 48000.0, blockSize, convolver);
+        }
+    }
+
+    for (int blockSize : BLOCK_SIZES) {
+        r8b::CDSPHBUpsampler   upsampler(HB_ATTEN, HB_STEEP_INDEX, false, 0.0);
+        r8b::CDSPHBDownsampler downsampler(HB_ATTEN, HB_STEEP_INDEX, false, 0.0);
+        addResult("CDSPHBUpsampler", "double", 48000.0, 96000.0, blockSize, upsampler);
+        addResult("CDSPHBDownsampler", "double", 96000.0, 48000.0, blockSize, downsampler);
+
+        for (auto& ratePair : INTERPOLATOR_RATE_PAIRS) {
+            r8b::CDSPFracInterpolator interpolator(ratePair[0], ratePair[1], HB_ATTEN, false, 0.0);
+            addResult("CDSPFracInterpolator", "double", ratePair[0], ratePair[1], blockSize, interpolator);
+        }
+    }
+
+    for (int lenBits=FFT_MIN_LEN_BITS; lenBits <= FFT_MAX_LEN_BITS; lenBits += 2) {
+        for (bool isFloat : getFFTPrecisions()) {
+            results.push_back(makeProcessorResult("CDSPRealFFT", precisionName(isFloat), 0.0, 0.0, 1 << lenBits,
+                                                  timeFFT(lenBits, isFloat, secondsPerCase), 0));
+        }
+    }
+    return results;
+}
+
+bool ResamplerBenchmark::writeJson(const std::string& filename, const std::string& label, double secondsPerCase)
+{
+    const BuildConfig config = getBuildConfig();
+    juce::DynamicObject* configObjPtr = new juce::DynamicObject();
+    configObjPtr->setProperty("fastTiming", config.fastTiming);
+    configObjPtr->setProperty("floatFFT", config.floatFFT);
+    configObjPtr->setProperty("pffft", config.pffft);
+    configObjPtr->setProperty("pffftRuntime", config.pffftRuntime);
+    configObjPtr->setProperty("filterCacheMax", config.filterCacheMax);
+    configObjPtr->setProperty("doubleFFT", juce::String(config.doubleFFT));
+    configObjPtr->setProperty("hbKernelSet", juce::String(config.hbKernelSet));
+    configObjPtr->setProperty("convertKernelSet", juce::String(config.convertKernelSet));
+
+    juce::var processorArrayObj;
+    for (auto& result : runProcessors(secondsPerCase)) {
+        std::string name = result.processor + " " + result.precision + " ";
+        if (result.srcRate > 0.0) { name += rateName(result.srcRate) + "-" + rateName(result.dstRate) + " "; }
+        juce::var entry = makeJsonEntry(name + "block " + std::to_string(result.blockSize), result.nsPerSample);
+        juce::DynamicObject* entryPtr = entry.getDynamicObject();
+        entryPtr->setProperty("processor", juce::String(result.processor));
+        entryPtr->setProperty("precision", juce::String(result.precision));
+        entryPtr->setProperty("srcRate", result.srcRate);
+        entryPtr->setProperty("dstRate", result.dstRate);
+        entryPtr->setProperty("blockSize", result.blockSize);
+        entryPtr->setProperty("samplesPerSec", result.samplesPerSec);
+        entryPtr->setProperty("latency", result.latency);
+        processorArrayObj.append(entry);
+    }
+
+    juce::var hbKernelArrayObj;
+    for (auto& result : HalfBandBenchmark::runHBKernels(secondsPerCase)) {
+        const std::string name = std::string(result.isUpsampler ? "up " : "down ") + (result.isThird ? "third " : "half ") +
+                                 "steep " + std::to_string(result.steepIndex) + " " + std::to_string(result.taps) + " taps " +
+                                 result.kernelSet;
+        hbKernelArrayObj.append(makeJsonEntry(name, result.nsPerSample));
+    }
+
+    juce::var convertKernelArrayObj;
+    for (auto& result : SampleConvertBenchmark::runConvertKernels(secondsPerCase)) {
+        convertKernelArrayObj.append(makeJsonEntry(result.kernel + " " + result.kernelSet, result.nsPerSample));
+    }
+
+    juce::DynamicObject* jsonObjPtr = new juce::DynamicObject();
+    jsonObjPtr->setProperty("label", juce::String(label));
+    jsonObjPtr->setProperty("config", juce::var(configObjPtr));
+    jsonObjPtr->setProperty("processors", processorArrayObj);
+    jsonObjPtr->setProperty("hbKernels", hbKernelArrayObj);
+    jsonObjPtr->setProperty("convertKernels", convertKernelArrayObj);
+
+    if (!juce::File(filename).replaceWithText(juce::JSON::toString(juce::var(jsonObjPtr)))) {
+        errorMessage("ResamplerBenchmark::writeJson(): unable to write " + filename);
+        return false;
+    }
+    return true;
+}
+
+bool ResamplerBenchmark::compareJson(const std::string& baselineFilename, const std::string& currentFilename, double maxSlowdown)
+{
+    juce::var baseline, current;
+    if (!loadJson(baselineFilename, baseline) || !loadJson(currentFilename, current)) { return false; }
+
+    bool success = true;
+    for (const char* section : { "processors", "hbKernels", "convertKernels" }) {
+        std::map<std::string, double> baselineTimes;
+        if (auto* entries = baseline[section].getArray()) {
+            for (auto& entry : *entries) { baselineTimes[entry["name"].toString().toStdString()] = entry["nsPerSample"]; }
+        }
+
+        const juce::Array<juce::var>* entries = current[section].getArray();
+        if (!entries) { continue; }
+        for (auto& entry : *entries) {
+            const std::string name = entry["name"].toString().toStdString();
+            const double nsPerSample = entry["nsPerSample"];
+            auto it = baselineTimes.find(name);
+            if (it == baselineTimes.end()) {
+                warningMessage("ResamplerBenchmark::compareJson(): " + name + " is not in the baseline");
+                success = false;
+            } else if (nsPerSample > it->second * (1.0 + maxSlowdown)) {
+                warningMessage("ResamplerBenchmark::compareJson(): " + name + " takes " + std::to_string(nsPerSample) +
+                               " ns per sample, " + std::to_string(it->second) + " in the baseline");
+                success = false;
+            }
+        }
+    }
+    return success;
+}
+
+}
@@ -0,0 +1,61 @@
+/*
+ * ResamplerBenchmark.h
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace stride {
+
+// Timings of the r8b resamplers and their building blocks, tracked between builds through JSON files
+class ResamplerBenchmark
+{
+public:
+    struct ProcessorResult {
+        std::string processor;     // r8b class, "CDSPRealFFT" for the FFT backends
+        std::string precision;     // of the FFTs, "double" or "float"
+        double      srcRate;       // 0 for the FFT backends
+        double      dstRate;
+        int         blockSize;     // input samples per process() call, the transform length for the FFT backends
+        double      samplesPerSec; // input samples
+        double      nsPerSample;   // per input sample, a forward and inverse transform for the FFT backends
+        int         latency;       // input samples before the first output
+    };
+
+    // The r8b configuration the benchmarks were built with
+    struct BuildConfig {
+        bool        fastTiming;       // R8B_FASTTIMING
+        bool        floatFFT;         // R8B_FLOATFFT, every FFT in float precision
+        bool        pffft;            // R8B_PFFFT
+        bool        pffftRuntime;     // R8B_PFFFT_RUNTIME, float FFTs selectable per resampler
+        int         filterCacheMax;   // R8B_FILTER_CACHE_MAX
+        std::string doubleFFT;        // "ooura", "ipp" or "pffft-double"
+        std::string hbKernelSet;      // best of this CPU, "scalar", "simd" or "avx2"
+        std::string convertKernelSet;
+    };
+
+    static constexpr double MAX_SLOWDOWN = 0.1; // fraction of the baseline time allowed by compareJson()
+
+    static BuildConfig getBuildConfig();
+
+    // Times the 16, 16IR and 24-bit resamplers over a matrix of rate pairs, block sizes and FFT precisions,
+    // then the block convolver, half-band stages, fractional interpolator and FFT backends on their own.
+    static std::vector<ProcessorResult> runProcessors(double secondsPerCase = 0.1);
+
+    // Writes getBuildConfig() and the runProcessors(), HalfBandBenchmark::runHBKernels() and
+    // SampleConvertBenchmark::runConvertKernels() timings to a JSON
+    // file, labelled with e.g. the commit being measured. Returns false if the file can't be written.
+    static bool writeJson(const std::string& filename, const std::string& label = std::string(), double secondsPerCase = 0.1);
+
+    // Reports every case in the current file more than maxSlowdown slower than in the baseline file, or
+    // missing from it. Returns false if there are any, or if either file can't be read.
+    static bool compareJson(const std::string& baselineFilename, const std::string& currentFilename,
+                            double maxSlowdown = MAX_SLOWDOWN);
+};
+
+}
@@ -0,0 +1,670 @@
+/*
+ * SampleConvert.cpp
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+#include <algorithm>
+#include <cmath>
+#include "Effect/EffectFileData.h"
+#include "Util/r8b/r8bbase.h"
+#include "SampleConvert.h"
+
+namespace stride {
+
+namespace {
+
+constexpr float INT16_SCALE     = 32768.0f;
+constexpr float INT16_INV_SCALE = 1.0f / 32768.0f;
+constexpr float INT16_MIN_FLOAT = -32768.0f;
+constexpr float INT16_MAX_FLOAT = 32767.0f;
+constexpr float DITHER_SCALE    = 1.0f / 65536.0f;
+constexpr int   DITHER_OFFSET   = 65535;
+constexpr int   NUM_DITHER_LANES = 8;
+
+inline uint32_t xorshift(uint32_t x)
+{
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+// Triangular noise in (-1, 1) LSB, the sum of the two 16-bit halves of a generator output. Every step is
+// exact in float, so the vector kernels produce the same noise.
+inline float tpdf(uint32_t x)
+{
+    return (float)((int32_t)(x & 0xFFFF) + (int32_t)(x >> 16) - DITHER_OFFSET) * DITHER_SCALE;
+}
+
+struct Kernels {
+    void (*int16ToFloat)(const int16_t* in, float* out, size_t numSamples);
+    void (*floatToInt16)(const float* in, int16_t* out, size_t numSamples);
+    void (*floatToInt16Dither)(const float* in, int16_t* out, size_t numSamples, uint32_t* state); // numSamples multiple of 8
+    void (*floatToDouble)(const float* in, double* out, size_t numSamples);
+    void (*doubleToFloat)(const double* in, float* out, size_t numSamples);
+    void (*interleave2)(const float* left, const float* right, size_t numFrames, float* out);
+    void (*deinterleave2)(const float* in, size_t numFrames, float* left, float* right);
+    void (*interleave2Int16)(const int16_t* left, const int16_t* right, size_t numFrames, int16_t* out);
+    void (*deinterleave2Int16)(const int16_t* in, size_t numFrames, int16_t* left, int16_t* right);
+};
+
+////////////////
+// Scalar kernels, also the tails of the vector kernels
+////////////////
+void int16ToFloatScalar(const int16_t* in, float* out, size_t numSamples)
+{
+    for (size_t i=0; i < numSamples; i++) { out[i] = in[i] * INT16_INV_SCALE; }
+}
+
+void floatToInt16Scalar(const float* in, int16_t* out, size_t numSamples)
+{
+    for (size_t i=0; i < numSamples; i++) { out[i] = r8b::roundInt16(in[i] * INT16_SCALE); }
+}
+
+void floatToInt16DitherScalar(const float* in, int16_t* out, size_t numSamples, uint32_t* state)
+{
+    for (size_t i=0; i < numSamples; i++) {
+        uint32_t& lane = state[i % NUM_DITHER_LANES];
+        lane   = xorshift(lane);
+        out[i] = r8b::roundInt16(in[i] * INT16_SCALE + tpdf(lane));
+    }
+}
+
+void floatToDoubleScalar(const float* in, double* out, size_t numSamples)
+{
+    for (size_t i=0; i < numSamples; i++) { out[i] = in[i]; }
+}
+
+void doubleToFloatScalar(const double* in, float* out, size_t numSamples)
+{
+    for (size_t i=0; i < numSamples; i++) { out[i] = (float)in[i]; }
+}
+
+template <typename T>
+void interleave2Scalar(const T* left, const T* right, size_t numFrames, T* out)
+{
+    for (size_t i=0; i < numFrames; i++) {
+        out[2 * i]     = left[i];
+        out[2 * i + 1] = right[i];
+    }
+}
+
+template <typename T>
+void deinterleave2Scalar(const T* in, size_t numFrames, T* left, T* right)
+{
+    for (size_t i=0; i < numFrames; i++) {
+        left[i]  = in[2 * i];
+        right[i] = in[2 * i + 1];
+    }
+}
+
+const Kernels SCALAR_KERNELS = {
+    int16ToFloatScalar, floatToInt16Scalar, floatToInt16DitherScalar, floatToDoubleScalar, doubleToFloatScalar,
+    interleave2Scalar<float>, deinterleave2Scalar<float>, interleave2Scalar<int16_t>, deinterleave2Scalar<int16_t>
+};
+
+#if defined(R8B_SSE2)
+////////////////
+// SSE2 kernels
+////////////////
+inline __m128 clampInt16(__m128 value)
+{
+    return _mm_min_ps(_mm_max_ps(value, _mm_set1_ps(INT16_MIN_FLOAT)), _mm_set1_ps(INT16_MAX_FLOAT));
+}
+
+inline __m128i xorshift(__m128i x)
+{
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+    return _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+}
+
+inline __m128 tpdf(__m128i x)
+{
+    const __m128i sum = _mm_add_epi32(_mm_and_si128(x, _mm_set1_epi32(0xFFFF)), _mm_srli_epi32(x, 16));
+    return _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(sum, _mm_set1_epi32(DITHER_OFFSET))), _mm_set1_ps(DITHER_SCALE));
+}
+
+void int16ToFloatSSE2(const int16_t* in, float* out, size_t numSamples)
+{
+    const __m128 scale = _mm_set1_ps(INT16_INV_SCALE);
+    size_t i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        const __m128i x  = _mm_loadu_si128((const __m128i*)(in + i));
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    int16ToFloatScalar(in + i, out + i, numSamples - i);
+}
+
+void floatToInt16SSE2(const float* in, int16_t* out, size_t numSamples)
+{
+    const __m128 scale = _mm_set1_ps(INT16_SCALE);
+    size_t i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        const __m128i lo = _mm_cvtps_epi32(clampInt16(_mm_mul_ps(_mm_loadu_ps(in + i), scale)));
+        const __m128i hi = _mm_cvtps_epi32(clampInt16(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale)));
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(lo, hi));
+    }
+    floatToInt16Scalar(in + i, out + i, numSamples - i);
+}
+
+void floatToInt16DitherSSE2(const float* in, int16_t* out, size_t numSamples, uint32_t* state)
+{
+    const __m128 scale = _mm_set1_ps(INT16_SCALE);
+    __m128i state0 = _mm_loadu_si128((const __m128i*)state);
+    __m128i state1 = _mm_loadu_si128((const __m128i*)(state + 4));
+    for (size_t i=0; i < numSamples; i += 8) {
+        state0 = xorshift(state0);
+        state1 = xorshift(state1);
+        const __m128 lo = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(in + i), scale), tpdf(state0));
+        const __m128 hi = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale), tpdf(state1));
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(_mm_cvtps_epi32(clampInt16(lo)), _mm_cvtps_epi32(clampInt16(hi))));
+    }
+    _mm_storeu_si128((__m128i*)state, state0);
+    _mm_storeu_si128((__m128i*)(state + 4), state1);
+}
+
+void floatToDoubleSSE2(const float* in, double* out, size_t numSamples)
+{
+    size_t i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        const __m128 x = _mm_loadu_ps(in + i);
+        _mm_storeu_pd(out + i, _mm_cvtps_pd(x));
+        _mm_storeu_pd(out + i + 2, _mm_cvtps_pd(_mm_movehl_ps(x, x)));
+    }
+    floatToDoubleScalar(in + i, out + i, numSamples - i);
+}
+
+void doubleToFloatSSE2(const double* in, float* out, size_t numSamples)
+{
+    size_t i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        const __m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(in + i));
+        const __m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(in + i + 2));
+        _mm_storeu_ps(out + i, _mm_movelh_ps(lo, hi));
+    }
+    doubleToFloatScalar(in + i, out + i, numSamples - i);
+}
+
+void interleave2SSE2(const float* left, const float* right, size_t numFrames, float* out)
+{
+    size_t i = 0;
+    for (; i + 4 <= numFrames; i += 4) {
+        const __m128 l = _mm_loadu_ps(left + i);
+        const __m128 r = _mm_loadu_ps(right + i);
+        _mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(l, r));
+        _mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(l, r));
+    }
+    interleave2Scalar(left + i, right + i, numFrames - i, out + 2 * i);
+}
+
+void deinterleave2SSE2(const float* in, size_t numFrames, float* left, float* right)
+{
+    size_t i = 0;
+    for (; i + 4 <= numFrames; i += 4) {
+        const __m128 x = _mm_loadu_ps(in + 2 * i);
+        const __m128 y = _mm_loadu_ps(in + 2 * i + 4);
+        _mm_storeu_ps(left + i, _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(right + i, _mm_shuffle_ps(x, y, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    deinterleave2Scalar(in + 2 * i, numFrames - i, left + i, right + i);
+}
+
+void interleave2Int16SSE2(const int16_t* left, const int16_t* right, size_t numFrames, int16_t* out)
+{
+    size_t i = 0;
+    for (; i + 8 <= numFrames; i += 8) {
+        const __m128i l = _mm_loadu_si128((const __m128i*)(left + i));
+        const __m128i r = _mm_loadu_si128((const __m128i*)(right + i));
+        _mm_storeu_si128((__m128i*)(out + 2 * i), _mm_unpacklo_epi16(l, r));
+        _mm_storeu_si128((__m128i*)(out + 2 * i + 8), _mm_unpackhi_epi16(l, r));
+    }
+    interleave2Scalar(left + i, right + i, numFrames - i, out + 2 * i);
+}
+
+void deinterleave2Int16SSE2(const int16_t* in, size_t numFrames, int16_t* left, int16_t* right)
+{
+    size_t i = 0;
+    for (; i + 8 <= numFrames; i += 8) {
+        // The left samples are the low halves of each 32-bit frame, the right samples the high halves
+        const __m128i x = _mm_loadu_si128((const __m128i*)(in + 2 * i));
+        const __m128i y = _mm_loadu_si128((const __m128i*)(in + 2 * i + 8));
+        const __m128i l = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(x, 16), 16), _mm_srai_epi32(_mm_slli_epi32(y, 16), 16));
+        const __m128i r = _mm_packs_epi32(_mm_srai_epi32(x, 16), _mm_srai_epi32(y, 16));
+        _mm_storeu_si128((__m128i*)(left + i), l);
+        _mm_storeu_si128((__m128i*)(right + i), r);
+    }
+    deinterleave2Scalar(in + 2 * i, numFrames - i, left + i, right + i);
+}
+
+const Kernels SIMD_KERNELS = {
+    int16ToFloatSSE2, floatToInt16SSE2, floatToInt16DitherSSE2, floatToDoubleSSE2, doubleToFloatSSE2,
+    interleave2SSE2, deinterleave2SSE2, interleave2Int16SSE2, deinterleave2Int16SSE2
+};
+
+#elif defined(R8B_NEON)
+////////////////
+// NEON kernels
+////////////////
+inline int32x4_t toInt32(float32x4_t value)
+{
+    // maxnm/minnm return the number when one operand is NaN, the same as the scalar comparisons
+    value = vminnmq_f32(vmaxnmq_f32(value, vdupq_n_f32(INT16_MIN_FLOAT)), vdupq_n_f32(INT16_MAX_FLOAT));
+    return vcvtnq_s32_f32(value);
+}
+
+inline uint32x4_t xorshift(uint32x4_t x)
+{
+    x = veorq_u32(x, vshlq_n_u32(x, 13));
+    x = veorq_u32(x, vshrq_n_u32(x, 17));
+    return veorq_u32(x, vshlq_n_u32(x, 5));
+}
+
+inline float32x4_t tpdf(uint32x4_t x)
+{
+    const int32x4_t sum = vreinterpretq_s32_u32(vaddq_u32(vandq_u32(x, vdupq_n_u32(0xFFFF)), vshrq_n_u32(x, 16)));
+    return vmulq_n_f32(vcvtq_f32_s32(vsubq_s32(sum, vdupq_n_s32(DITHER_OFFSET))), DITHER_SCALE);
+}
+
+void int16ToFloatNEON(const int16_t* in, float* out, size_t numSamples)
+{
+    size_t i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        const int16x8_t x = vld1q_s16(in + i);
+        vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), INT16_INV_SCALE));
+        vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), INT16_INV_SCALE));
+    }
+    int16ToFloatScalar(in + i, out + i, numSamples - i);
+}
+
+void floatToInt16NEON(const float* in, int16_t* out, size_t numSamples)
+{
+    size_t i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        const int32x4_t lo = toInt32(vmulq_n_f32(vld1q_f32(in + i), INT16_SCALE));
+        const int32x4_t hi = toInt32(vmulq_n_f32(vld1q_f32(in + i + 4), INT16_SCALE));
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+    }
+    floatToInt16Scalar(in + i, out + i, numSamples - i);
+}
+
+void floatToInt16DitherNEON(const float* in, int16_t* out, size_t numSamples, uint32_t* state)
+{
+    uint32x4_t state0 = vld1q_u32(state);
+    uint32x4_t state1 = vld1q_u32(state + 4);
+    for (size_t i=0; i < numSamples; i += 8) {
+        state0 = xorshift(state0);
+        state1 = xorshift(state1);
+        // No fused multiply-add, the scalar code rounds the product and the sum separately
+        const float32x4_t lo = vaddq_f32(vmulq_n_f32(vld1q_f32(in + i), INT16_SCALE), tpdf(state0));
+        const float32x4_t hi = vaddq_f32(vmulq_n_f32(vld1q_f32(in + i + 4), INT16_SCALE), tpdf(state1));
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(toInt32(lo)), vqmovn_s32(toInt32(hi))));
+    }
+    vst1q_u32(state, state0);
+    vst1q_u32(state + 4, state1);
+}
+
+void floatToDoubleNEON(const float* in, double* out, size_t numSamples)
+{
+    size_t i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        const float32x4_t x = vld1q_f32(in + i);
+        vst1q_f64(out + i, vcvt_f64_f32(vget_low_f32(x)));
+        vst1q_f64(out + i + 2, vcvt_high_f64_f32(x));
+    }
+    floatToDoubleScalar(in + i, out + i, numSamples - i);
+}
+
+void doubleToFloatNEON(const double* in, float* out, size_t numSamples)
+{
+    size_t i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        vst1q_f32(out + i, vcvt_high_f32_f64(vcvt_f32_f64(vld1q_f64(in + i)), vld1q_f64(in + i + 2)));
+    }
+    doubleToFloatScalar(in + i, out + i, numSamples - i);
+}
+
+void interleave2NEON(const float* left, const float* right, size_t numFrames, float* out)
+{
+    size_t i = 0;
+    for (; i + 4 <= numFrames; i += 4) {
+        const float32x4x2_t x = {{vld1q_f32(left + i), vld1q_f32(right + i)}};
+        vst2q_f32(out + 2 * i, x);
+    }
+    interleave2Scalar(left + i, right + i, numFrames - i, out + 2 * i);
+}
+
+void deinterleave2NEON(const float* in, size_t numFrames, float* left, float* right)
+{
+    size_t i = 0;
+    for (; i + 4 <= numFrames; i += 4) {
+        const float32x4x2_t x = vld2q_f32(in + 2 * i);
+        vst1q_f32(left + i, x.val[0]);
+        vst1q_f32(right + i, x.val[1]);
+    }
+    deinterleave2Scalar(in + 2 * i, numFrames - i, left + i, right + i);
+}
+
+void interleave2Int16NEON(const int16_t* left, const int16_t* right, size_t numFrames, int16_t* out)
+{
+    size_t i = 0;
+    for (; i + 8 <= numFrames; i += 8) {
+        const int16x8x2_t x = {{vld1q_s16(left + i), vld1q_s16(right + i)}};
+        vst2q_s16(out + 2 * i, x);
+    }
+    interleave2Scalar(left + i, right + i, numFrames - i, out + 2 * i);
+}
+
+void deinterleave2Int16NEON(const int16_t* in, size_t numFrames, int16_t* left, int16_t* right)
+{
+    size_t i = 0;
+    for (; i + 8 <= numFrames; i += 8) {
+        const int16x8x2_t x = vld2q_s16(in + 2 * i);
+        vst1q_s16(left + i, x.val[0]);
+        vst1q_s16(right + i, x.val[1]);
+    }
+    deinterleave2Scalar(in + 2 * i, numFrames - i, left + i, right + i);
+}
+
+const Kernels SIMD_KERNELS = {
+    int16ToFloatNEON, floatToInt16NEON, floatToInt16DitherNEON, floatToDoubleNEON, doubleToFloatNEON,
+    interleave2NEON, deinterleave2NEON, interleave2Int16NEON, deinterleave2Int16NEON
+};
+
+#else
+const Kernels SIMD_KERNELS = SCALAR_KERNELS;
+#endif
+
+#if defined(R8B_AVX2)
+////////////////
+// AVX2 kernels, the int16 interleaving is memory bound and keeps the SSE2 kernels
+////////////////
+R8B_AVX2_FN inline __m256 clampInt16AVX2(__m256 value)
+{
+    return _mm256_min_ps(_mm256_max_ps(value, _mm256_set1_ps(INT16_MIN_FLOAT)), _mm256_set1_ps(INT16_MAX_FLOAT));
+}
+
+R8B_AVX2_FN inline __m256i xorshiftAVX2(__m256i x)
+{
+    x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 13));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 17));
+    return _mm256_xor_si256(x, _mm256_slli_epi32(x, 5));
+}
+
+R8B_AVX2_FN inline __m256 tpdfAVX2(__m256i x)
+{
+    const __m256i sum = _mm256_add_epi32(_mm256_and_si256(x, _mm256_set1_epi32(0xFFFF)), _mm256_srli_epi32(x, 16));
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(sum, _mm256_set1_epi32(DITHER_OFFSET))), _mm256_set1_ps(DITHER_SCALE));
+}
+
+// The two 128-bit lanes of packs_epi32 interleave the inputs, the permute puts them back in order
+R8B_AVX2_FN inline __m256i packInt16AVX2(__m256 lo, __m256 hi)
+{
+    const __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(clampInt16AVX2(lo)), _mm256_cvtps_epi32(clampInt16AVX2(hi)));
+    return _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+R8B_AVX2_FN void int16ToFloatAVX2(const int16_t* in, float* out, size_t numSamples)
+{
+    const __m256 scale = _mm256_set1_ps(INT16_INV_SCALE);
+    size_t i = 0;
+    for (; i + 16 <= numSamples; i += 16) {
+        const __m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(in + i)));
+        const __m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(in + i + 8)));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+        _mm256_storeu_ps(out + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+    }
+    int16ToFloatScalar(in + i, out + i, numSamples - i);
+}
+
+R8B_AVX2_FN void floatToInt16AVX2(const float* in, int16_t* out, size_t numSamples)
+{
+    const __m256 scale = _mm256_set1_ps(INT16_SCALE);
+    size_t i = 0;
+    for (; i + 16 <= numSamples; i += 16) {
+        const __m256 lo = _mm256_mul_ps(_mm256_loadu_ps(in + i), scale);
+        const __m256 hi = _mm256_mul_ps(_mm256_loadu_ps(in + i + 8), scale);
+        _mm256_storeu_si256((__m256i*)(out + i), packInt16AVX2(lo, hi));
+    }
+    floatToInt16Scalar(in + i, out + i, numSamples - i);
+}
+
+R8B_AVX2_FN void floatToInt16DitherAVX2(const float* in, int16_t* out, size_t numSamples, uint32_t* state)
+{
+    const __m256 scale = _mm256_set1_ps(INT16_SCALE);
+    __m256i lanes = _mm256_loadu_si256((const __m256i*)state);
+    size_t i = 0;
+    for (; i + 16 <= numSamples; i += 16) {
+        // Scaling by a power of two is exact, so a fused multiply-add would round the same as the scalar code
+        const __m256i lanesLo = xorshiftAVX2(lanes);
+        lanes = xorshiftAVX2(lanesLo);
+        const __m256 lo = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i), scale), tpdfAVX2(lanesLo));
+        const __m256 hi = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i + 8), scale), tpdfAVX2(lanes));
+        _mm256_storeu_si256((__m256i*)(out + i), packInt16AVX2(lo, hi));
+    }
+    if (i < numSamples) {
+        lanes = xorshiftAVX2(lanes);
+        const __m256  x      = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(in + i), scale), tpdfAVX2(lanes));
+        const __m256i packed = packInt16AVX2(x, x);
+        _mm_storeu_si128((__m128i*)(out + i), _mm256_castsi256_si128(packed));
+    }
+    _mm256_storeu_si256((__m256i*)state, lanes);
+}
+
+R8B_AVX2_FN void floatToDoubleAVX2(const float* in, double* out, size_t numSamples)
+{
+    size_t i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        _mm256_storeu_pd(out + i, _mm256_cvtps_pd(_mm_loadu_ps(in + i)));
+        _mm256_storeu_pd(out + i + 4, _mm256_cvtps_pd(_mm_loadu_ps(in + i + 4)));
+    }
+    floatToDoubleScalar(in + i, out + i, numSamples - i);
+}
+
+R8B_AVX2_FN void doubleToFloatAVX2(const double* in, float* out, size_t numSamples)
+{
+    size_t i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        _mm_storeu_ps(out + i, _mm256_cvtpd_ps(_mm256_loadu_pd(in + i)));
+        _mm_storeu_ps(out + i + 4, _mm256_cvtpd_ps(_mm256_loadu_pd(in + i + 4)));
+    }
+    doubleToFloatScalar(in + i, out + i, numSamples - i);
+}
+
+R8B_AVX2_FN void interleave2AVX2(const float* left, const float* right, size_t numFrames, float* out)
+{
+    size_t i = 0;
+    for (; i + 8 <= numFrames; i += 8) {
+        const __m256 l  = _mm256_loadu_ps(left + i);
+        const __m256 r  = _mm256_loadu_ps(right + i);
+        const __m256 lo = _mm256_unpacklo_ps(l, r); // frames 0, 1 and 4, 5
+        const __m256 hi = _mm256_unpackhi_ps(l, r); // frames 2, 3 and 6, 7
+        _mm256_storeu_ps(out + 2 * i, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(out + 2 * i + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+    interleave2Scalar(left + i, right + i, numFrames - i, out + 2 * i);
+}
+
+R8B_AVX2_FN void deinterleave2AVX2(const float* in, size_t numFrames, float* left, float* right)
+{
+    size_t i = 0;
+    for (; i + 8 <= numFrames; i += 8) {
+        const __m256 x  = _mm256_loadu_ps(in + 2 * i);
+        const __m256 y  = _mm256_loadu_ps(in + 2 * i + 8);
+        const __m256 lo = _mm256_permute2f128_ps(x, y, 0x20); // frames 0, 1 and 4, 5
+        const __m256 hi = _mm256_permute2f128_ps(x, y, 0x31); // frames 2, 3 and 6, 7
+        _mm256_storeu_ps(left + i, _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm256_storeu_ps(right + i, _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    deinterleave2Scalar(in + 2 * i, numFrames - i, left + i, right + i);
+}
+
+const Kernels AVX2_KERNELS = {
+    int16ToFloatAVX2, floatToInt16AVX2, floatToInt16DitherAVX2, floatToDoubleAVX2, doubleToFloatAVX2,
+    interleave2AVX2, deinterleave2AVX2, SIMD_KERNELS.interleave2Int16, SIMD_KERNELS.deinterleave2Int16
+};
+#else
+const Kernels AVX2_KERNELS = SIMD_KERNELS;
+#endif
+
+const Kernels& getKernels(SampleConvert::KernelSet kernelSet)
+{
+    switch (kernelSet) {
+    case SampleConvert::KernelSet::SCALAR : return SCALAR_KERNELS;
+    case SampleConvert::KernelSet::SIMD :   return SIMD_KERNELS;
+    case SampleConvert::KernelSet::AVX2 :   return AVX2_KERNELS;
+    }
+    return SCALAR_KERNELS;
+}
+
+// -1 when the best kernel set is used
+int& getKernelSetVar()
+{
+    static int kernelSet = -1;
+    return kernelSet;
+}
+
+const Kernels*& getKernelsVar()
+{
+    static const Kernels* kernels = &getKernels(SampleConvert::getBestKernelSet());
+    return kernels;
+}
+
+template <typename T>
+void interleaveGeneric(const T* const* in, unsigned numChannels, size_t numFrames, T* out)
+{
+    for (unsigned channel=0; channel < numChannels; channel++) {
+        const T* ip = in[channel];
+        T*       op = out + channel;
+        for (size_t i=0; i < numFrames; i++, op += numChannels) { *op = ip[i]; }
+    }
+}
+
+template <typename T>
+void deinterleaveGeneric(const T* in, unsigned numChannels, size_t numFrames, T* const* out)
+{
+    for (unsigned channel=0; channel < numChannels; channel++) {
+        const T* ip = in + channel;
+        T*       op = out[channel];
+        for (size_t i=0; i < numFrames; i++, ip += numChannels) { op[i] = *ip; }
+    }
+}
+
+}
+
+void SampleConvert::Dither::reset(uint32_t seed)
+{
+    // xorshift32 must not start at zero
+    for (int lane=0; lane < NUM_DITHER_LANES; lane++) {
+        m_state[lane] = xorshift(seed * 0x9E3779B9U + (uint32_t)lane * 0x85EBCA6BU) | 1;
+    }
+    m_lane = 0;
+}
+
+SampleConvert::KernelSet SampleConvert::getBestKernelSet()
+{
+    return r8b::isAVX2Available() ? KernelSet::AVX2 : KernelSet::SIMD;
+}
+
+SampleConvert::KernelSet SampleConvert::getKernelSet()
+{
+    const int kernelSet = getKernelSetVar();
+    return (kernelSet < 0) ? getBestKernelSet() : (KernelSet)kernelSet;
+}
+
+void SampleConvert::setKernelSet(KernelSet kernelSet)
+{
+    getKernelSetVar() = (int)std::min(kernelSet, getBestKernelSet());
+    getKernelsVar()   = &getKernels(getKernelSet());
+}
+
+void SampleConvert::resetKernelSet()
+{
+    getKernelSetVar() = -1;
+    getKernelsVar()   = &getKernels(getBestKernelSet());
+}
+
+void SampleConvert::int16ToFloat(const int16_t* in, float* out, size_t numSamples)
+{
+    getKernelsVar()->int16ToFloat(in, out, numSamples);
+}
+
+void SampleConvert::floatToInt16(const float* in, int16_t* out, size_t numSamples, Dither* dither)
+{
+    if (!dither) {
+        getKernelsVar()->floatToInt16(in, out, numSamples);
+        return;
+    }
+
+    // Scalar up to the next sample on lane 0, so the vector kernels start on whole groups of lanes
+    size_t i = 0;
+    for (; (i < numSamples) && (dither->m_lane != 0); i++) {
+        uint32_t& lane = dither->m_state[dither->m_lane];
+        lane   = xorshift(lane);
+        out[i] = r8b::roundInt16(in[i] * INT16_SCALE + tpdf(lane));
+        dither->m_lane = (dither->m_lane + 1) % NUM_DITHER_LANES;
+    }
+    if (dither->m_lane != 0) { return; }
+
+    const size_t numGroups = (numSamples - i) / NUM_DITHER_LANES * NUM_DITHER_LANES;
+    getKernelsVar()->floatToInt16Dither(in + i, out + i, numGroups, dither->m_state);
+    i += numGroups;
+
+    floatToInt16DitherScalar(in + i, out + i, numSamples - i, dither->m_state);
+    dither->m_lane = (unsigned)(numSamples - i);
+}
+
+void SampleConvert::floatToDouble(const float* in, double* out, size_t numSamples)
+{
+    getKernelsVar()->floatToDouble(in, out, numSamples);
+}
+
+void SampleConvert::doubleToFloat(const double* in, float* out, size_t numSamples)
+{
+    getKernelsVar()->doubleToFloat(in, out, numSamples);
+}
+
+void SampleConvert::interleave(const float* const* in, unsigned numChannels, size_t numFrames, float* out)
+{
+    if (numChannels == 2) { getKernelsVar()->interleave2(in[0], in[1], numFrames, out); }
+    else { interleaveGeneric(in, numChannels, numFrames, out); }
+}
+
+void SampleConvert::interleave(const int16_t* const* in, unsigned numChannels, size_t numFrames, int16_t* out)
+{
+    if (numChannels == 2) { getKernelsVar()->interleave2Int16(in[0], in[1], numFrames, out); }
+    else { interleaveGeneric(in, numChannels, numFrames, out); }
+}
+
+void SampleConvert::deinterleave(const float* in, unsigned numChannels, size_t numFrames, float* const* out)
+{
+    if (numChannels == 2) { getKernelsVar()->deinterleave2(in, numFrames, out[0], out[1]); }
+    else { deinterleaveGeneric(in, numChannels, numFrames, out); }
+}
+
+void SampleConvert::deinterleave(const int16_t* in, unsigned numChannels, size_t numFrames, int16_t* const* out)
+{
+    if (numChannels == 2) { getKernelsVar()->deinterleave2Int16(in, numFrames, out[0], out[1]); }
+    else { deinterleaveGeneric(in, numChannels, numFrames, out); }
+}
+
+bool SampleConvert::convert(StreamConvertMode mode, const void* in, void* out, size_t numSamples, Dither* dither)
+{
+    switch (mode) {
+    case StreamConvertMode::INT16_TO_FLOAT :
+        int16ToFloat(static_cast<const int16_t*>(in), static_cast<float*>(out), numSamples);
+        return true;
+    case StreamConvertMode::FLOAT_TO_INT16 :
+        floatToInt16(static_cast<const float*>(in), static_cast<int16_t*>(out), numSamples, dither);
+        return true;
+    case StreamConvertMode::NO_CONVERSION :
+        break;
+    }
+    return false;
+}
+
+}
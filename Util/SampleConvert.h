@@ -0,0 +1,70 @@
+/*
+ * SampleConvert.h
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace stride {
+
+enum class StreamConvertMode : unsigned; // Effect/EffectFileData.h
+
+// Sample format conversions for the boundaries between int16 and float effects, and between the float
+// streams and the double precision r8b processors. Each conversion has scalar, SSE2/NEON and AVX2 kernels;
+// the fastest set the CPU supports is used unless one is forced for testing. All kernel sets give
+// bit-identical results, including the dither noise.
+class SampleConvert
+{
+public:
+    enum class KernelSet : unsigned {
+        SCALAR = 0,
+        SIMD,       // SSE2 or NEON, chosen at compile-time, the same as SCALAR if neither is available
+        AVX2        // if supported by the CPU at run-time
+    };
+
+    // TPDF dither of +/-1 LSB for the conversions down to int16. Each stream needs its own, the noise
+    // continues from one call to the next.
+    class Dither
+    {
+    public:
+        explicit Dither(uint32_t seed = 1) { reset(seed); }
+        void reset(uint32_t seed);
+
+    private:
+        alignas(32) uint32_t m_state[8]; // xorshift32 generators, sample n uses m_state[n % 8]
+        unsigned m_lane = 0;             // of the next sample
+
+        friend class SampleConvert;
+    };
+
+    static KernelSet getBestKernelSet();
+    static KernelSet getKernelSet();
+    // Forces the kernel set of all later calls, sets the CPU doesn't support are replaced by the best one.
+    // Not thread-safe, for testing and benchmarking.
+    static void setKernelSet(KernelSet kernelSet);
+    static void resetKernelSet();
+
+    static void int16ToFloat(const int16_t* in, float* out, size_t numSamples);
+
+    // Rounds to nearest and saturates at the int16 range, after adding the dither noise if given
+    static void floatToInt16(const float* in, int16_t* out, size_t numSamples, Dither* dither = nullptr);
+
+    static void floatToDouble(const float* in, double* out, size_t numSamples);
+    static void doubleToFloat(const double* in, float* out, size_t numSamples);
+
+    static void interleave(const float* const* in, unsigned numChannels, size_t numFrames, float* out);
+    static void interleave(const int16_t* const* in, unsigned numChannels, size_t numFrames, int16_t* out);
+    static void deinterleave(const float* in, unsigned numChannels, size_t numFrames, float* const* out);
+    static void deinterleave(const int16_t* in, unsigned numChannels, size_t numFrames, int16_t* const* out);
+
+    // Converts a stream between connected effects, in and out point to int16_t or float samples as the mode
+    // says. Returns false for NO_CONVERSION, the samples can be passed on as they are.
+    static bool convert(StreamConvertMode mode, const void* in, void* out, size_t numSamples, Dither* dither = nullptr);
+};
+
+}
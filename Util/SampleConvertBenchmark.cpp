@@ -0,0 +1,132 @@
+/*
+ * SampleConvertBenchmark.cpp
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include "Util/SampleConvert.h"
+#include "SampleConvertBenchmark.h"
+
+namespace stride {
+
+namespace {
+
+constexpr int CONVERT_NUM_FRAMES = 4093; // odd, so the kernels' scalar tails run too
+
+const char* kernelSetName(SampleConvert::KernelSet kernelSet)
+{
+    switch (kernelSet) {
+    case SampleConvert::KernelSet::SCALAR : return "scalar";
+    case SampleConvert::KernelSet::SIMD   : return "simd";
+    case SampleConvert::KernelSet::AVX2   : return "avx2";
+    default                               : return "unknown";
+    }
+}
+
+struct ConvertCase {
+    const char*                          kernel;
+    std::function<void()>                process; // converts 2 * CONVERT_NUM_FRAMES samples
+    std::function<std::vector<double>()> output;
+};
+
+double timeConvert(const ConvertCase& convertCase, double seconds)
+{
+    size_t numSamples = 0;
+    double elapsedSecs = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    while (elapsedSecs < seconds) {
+        for (unsigned i=0; i < 64; i++) { convertCase.process(); }
+        numSamples += 64 * 2 * CONVERT_NUM_FRAMES;
+        elapsedSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return elapsedSecs * 1e9 / numSamples;
+}
+
+}
+
+std::string SampleConvertBenchmark::getBestKernelSetName()
+{
+    return kernelSetName(SampleConvert::getBestKernelSet());
+}
+
+std::vector<SampleConvertBenchmark::ConvertKernelResult> SampleConvertBenchmark::runConvertKernels(double secondsPerCase)
+{
+    constexpr size_t NUM_SAMPLES = 2 * CONVERT_NUM_FRAMES;
+
+    // Slightly past full scale so the saturation is exercised
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<double> dist(-1.05, 1.05);
+    std::uniform_int_distribution<int> intDist(-32768, 32767);
+    std::vector<double>  doubleIn(NUM_SAMPLES);
+    std::vector<float>   floatIn(NUM_SAMPLES);
+    std::vector<int16_t> int16In(NUM_SAMPLES);
+    for (size_t i=0; i < NUM_SAMPLES; i++) {
+        doubleIn[i] = dist(rng);
+        floatIn[i]  = (float)dist(rng);
+        int16In[i]  = (int16_t)intDist(rng);
+    }
+
+    std::vector<double>  doubleOut(NUM_SAMPLES);
+    std::vector<float>   floatOut(NUM_SAMPLES);
+    std::vector<int16_t> int16Out(NUM_SAMPLES);
+    const float*   floatInPtrs[2]  = {floatIn.data(), floatIn.data() + CONVERT_NUM_FRAMES};
+    const int16_t* int16InPtrs[2]  = {int16In.data(), int16In.data() + CONVERT_NUM_FRAMES};
+    float*         floatOutPtrs[2] = {floatOut.data(), floatOut.data() + CONVERT_NUM_FRAMES};
+    int16_t*       int16OutPtrs[2] = {int16Out.data(), int16Out.data() + CONVERT_NUM_FRAMES};
+    SampleConvert::Dither dither;
+
+    auto floatOutput  = [&]() { return std::vector<double>(floatOut.begin(), floatOut.end()); };
+    auto int16Output  = [&]() { return std::vector<double>(int16Out.begin(), int16Out.end()); };
+    auto doubleOutput = [&]() { return doubleOut; };
+
+    const ConvertCase CASES[] = {
+        {"int16ToFloat", [&]() { SampleConvert::int16ToFloat(int16In.data(), floatOut.data(), NUM_SAMPLES); }, floatOutput},
+        {"floatToInt16", [&]() { SampleConvert::floatToInt16(floatIn.data(), int16Out.data(), NUM_SAMPLES); }, int16Output},
+        // Split at an odd position, so the second call continues the dither mid-way through the lanes
+        {"floatToInt16Dither", [&]() {
+            dither.reset(1);
+            SampleConvert::floatToInt16(floatIn.data(), int16Out.data(), CONVERT_NUM_FRAMES, &dither);
+            SampleConvert::floatToInt16(floatIn.data() + CONVERT_NUM_FRAMES, int16Out.data() + CONVERT_NUM_FRAMES, CONVERT_NUM_FRAMES, &dither);
+        }, int16Output},
+        {"floatToDouble", [&]() { SampleConvert::floatToDouble(floatIn.data(), doubleOut.data(), NUM_SAMPLES); }, doubleOutput},
+        {"doubleToFloat", [&]() { SampleConvert::doubleToFloat(doubleIn.data(), floatOut.data(), NUM_SAMPLES); }, floatOutput},
+        {"interleave", [&]() { SampleConvert::interleave(floatInPtrs, 2, CONVERT_NUM_FRAMES, floatOut.data()); }, floatOutput},
+        {"deinterleave", [&]() { SampleConvert::deinterleave(floatIn.data(), 2, CONVERT_NUM_FRAMES, floatOutPtrs); }, floatOutput},
+        {"interleaveInt16", [&]() { SampleConvert::interleave(int16InPtrs, 2, CONVERT_NUM_FRAMES, int16Out.data()); }, int16Output},
+        {"deinterleaveInt16", [&]() { SampleConvert::deinterleave(int16In.data(), 2, CONVERT_NUM_FRAMES, int16OutPtrs); }, int16Output}
+    };
+
+    std::vector<ConvertKernelResult> results;
+    for (auto& convertCase : CASES) {
+        SampleConvert::setKernelSet(SampleConvert::KernelSet::SCALAR);
+        convertCase.process();
+        const std::vector<double> reference = convertCase.output();
+
+        for (unsigned ks=0; ks <= (unsigned)SampleConvert::getBestKernelSet(); ks++) {
+            const SampleConvert::KernelSet kernelSet = (SampleConvert::KernelSet)ks;
+            SampleConvert::setKernelSet(kernelSet);
+            convertCase.process();
+            const std::vector<double> output = convertCase.output();
+
+            double maxError = 0.0;
+            for (size_t i=0; i < output.size(); i++) { maxError = std::max(maxError, std::fabs(output[i] - reference[i])); }
+
+            ConvertKernelResult result;
+            result.kernel      = convertCase.kernel;
+            result.kernelSet   = kernelSetName(kernelSet);
+            result.maxError    = maxError;
+            result.nsPerSample = (secondsPerCase > 0.0) ? timeConvert(convertCase, secondsPerCase) : 0.0;
+            results.push_back(result);
+        }
+    }
+    SampleConvert::resetKernelSet();
+    return results;
+}
+
+}
@@ -0,0 +1,34 @@
+/*
+ * SampleConvertBenchmark.h
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace stride {
+
+// Correctness checks and timings of the SampleConvert kernel sets
+class SampleConvertBenchmark
+{
+public:
+    struct ConvertKernelResult {
+        std::string kernel;         // SampleConvert function, "floatToInt16Dither" with TPDF dither
+        std::string kernelSet;      // "scalar", "simd" or "avx2"
+        double      maxError;       // against the scalar kernels, in output units (LSBs for int16)
+        double      nsPerSample;    // per sample, all channels for the interleaving
+    };
+
+    // The best kernel set of this CPU, named as in the results
+    static std::string getBestKernelSetName();
+
+    // Runs every SampleConvert kernel set available on this CPU over a block of odd length, comparing
+    // against the scalar kernels, which should match exactly
+    static std::vector<ConvertKernelResult> runConvertKernels(double secondsPerCase = 0.05);
+};
+
+}
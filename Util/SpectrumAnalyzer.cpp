@@ -0,0 +1,426 @@
+/*
+ * SpectrumAnalyzer.cpp
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include "Util/ErrorMessage.h"
+#include "Util/r8b/CDSPRealFFT.h"
+#include "SpectrumAnalyzer.h"
+
+namespace stride {
+
+namespace {
+
+constexpr unsigned MIN_FFT_LEN_BITS = 8;
+constexpr unsigned MAX_FFT_LEN_BITS = 20;
+constexpr double   MAX_OVERLAP      = 0.9;
+constexpr double   SWEEP_FADE_SECS  = 0.01;
+constexpr double   FULL_SCALE_POWER = 0.5; // mean square of a full scale sine
+
+// Half the main lobe width of each window in bins, plus one for a tone between bins
+constexpr int WINDOW_HALF_WIDTHS[] = { 3, 5, 8, 6 };
+constexpr unsigned MAX_WINDOW_TERMS = 7;
+
+double powerToDb(double power)
+{
+    return 10.0 * std::log10(std::max(power, 1e-30));
+}
+
+std::vector<double> makeWindow(SpectrumAnalyzer::Window window, unsigned length)
+{
+    // Periodic forms, as the segments overlap
+    static const double COEFFS[][MAX_WINDOW_TERMS] = {
+        { 0.5, 0.5 },                                                            // Hann
+        { 0.35875, 0.48829, 0.14128, 0.01168 },                                  // Blackman-Harris
+        { 0.27105140069342, 0.43329793923448, 0.21812299954311, 0.06592544638803,
+          0.01081174209837, 0.00077658482522, 0.00001388721735 },               // 7-term Blackman-Harris
+        { 0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368 }        // flat top
+    };
+    const double* coeffs = COEFFS[(unsigned)window];
+
+    std::vector<double> values(length);
+    for (unsigned i=0; i < length; i++) {
+        const double phase = R8B_2PI * i / length;
+        double value = 0.0;
+        for (unsigned term=0; term < MAX_WINDOW_TERMS; term++) { value += ((term & 1) ? -coeffs[term] : coeffs[term]) * std::cos(term * phase); }
+        values[i] = value;
+    }
+    return values;
+}
+
+// The forward transforms leave DC, Nyquist, then the real and imaginary parts of the other bins, as floats
+// for the float FFTs. Ooura's imaginary parts have the opposite sign to the other backends.
+double getImagSign(const r8b::CDSPRealFFTKeeper& fft)
+{
+    return (fft->isFloat() || R8B_IPP || R8B_PFFFT_DOUBLE) ? 1.0 : -1.0;
+}
+
+void unpackSpectrum(const r8b::CDSPRealFFTKeeper& fft, const double* block, double* re, double* im)
+{
+    const int    numBins  = fft->getLen() / 2 + 1;
+    const double imagSign = getImagSign(fft);
+    const float* fblock   = reinterpret_cast<const float*>(block);
+    auto value = [&](int i) { return fft->isFloat() ? (double)fblock[i] : block[i]; };
+
+    re[0]           = value(0);
+    im[0]           = 0.0;
+    re[numBins - 1] = value(1);
+    im[numBins - 1] = 0.0;
+    for (int bin=1; bin < numBins - 1; bin++) {
+        re[bin] = value(2 * bin);
+        im[bin] = imagSign * value(2 * bin + 1);
+    }
+}
+
+void packSpectrum(const r8b::CDSPRealFFTKeeper& fft, const double* re, const double* im, double* block)
+{
+    const int    numBins  = fft->getLen() / 2 + 1;
+    const double imagSign = getImagSign(fft);
+    float*       fblock   = reinterpret_cast<float*>(block);
+    auto store = [&](int i, double value) {
+        if (fft->isFloat()) { fblock[i] = (float)value; }
+        else { block[i] = value; }
+    };
+
+    store(0, re[0]);
+    store(1, re[numBins - 1]);
+    for (int bin=1; bin < numBins - 1; bin++) {
+        store(2 * bin, re[bin]);
+        store(2 * bin + 1, imagSign * im[bin]);
+    }
+}
+
+// Each thread transforms its own segments and accumulates into its own sums
+struct SegmentWorker {
+    r8b::CDSPRealFFTKeeper    fft;
+    r8b::CFixedBuffer<double> block;
+    std::vector<double>       inRe, inIm, outRe, outIm;
+    std::vector<double>       inPower, crossRe, crossIm, outPower;
+
+    SegmentWorker(unsigned lenBits, bool useFloatFFT)
+    : fft((int)lenBits, useFloatFFT), block(1 << lenBits)
+    {
+        const size_t numBins = ((size_t)1 << lenBits) / 2 + 1;
+        for (auto* bins : { &inRe, &inIm, &outRe, &outIm, &inPower, &crossRe, &crossIm, &outPower }) { bins->resize(numBins, 0.0); }
+    }
+
+    // Windows the segment of the signal at start, zero outside the signal
+    void transform(const double* signal, size_t length, long long start, const std::vector<double>& window,
+                   std::vector<double>& re, std::vector<double>& im)
+    {
+        for (size_t i=0; i < window.size(); i++) {
+            const long long pos = start + (long long)i;
+            block[i] = ((pos >= 0) && (pos < (long long)length)) ? signal[pos] * window[i] : 0.0;
+        }
+        fft->forward(block);
+        unpackSpectrum(fft, block, re.data(), im.data());
+    }
+};
+
+// Calls process(worker, index) for every index, spread over the workers' threads
+template <typename Process>
+void forEachSegment(std::vector<std::unique_ptr<SegmentWorker>>& workers, size_t numSegments, Process process)
+{
+    std::atomic<size_t> nextSegment { 0 };
+    auto work = [&](SegmentWorker& worker) {
+        for (size_t i=nextSegment++; i < numSegments; i=nextSegment++) { process(worker, i); }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t workerIndex=1; workerIndex < workers.size(); workerIndex++) { threads.emplace_back(work, std::ref(*workers[workerIndex])); }
+    work(*workers[0]);
+    for (auto& thread : threads) { thread.join(); }
+}
+
+std::vector<std::unique_ptr<SegmentWorker>> makeWorkers(const SpectrumAnalyzer::Config& config, size_t numSegments)
+{
+    unsigned numThreads = config.numThreads ? config.numThreads : std::thread::hardware_concurrency();
+    numThreads = (unsigned)std::max((size_t)1, std::min((size_t)numThreads, numSegments));
+
+    std::vector<std::unique_ptr<SegmentWorker>> workers;
+    for (unsigned i=0; i < numThreads; i++) { workers.emplace_back(new SegmentWorker(config.fftLenBits, config.useFloatFFT)); }
+    return workers;
+}
+
+}
+
+double SpectrumAnalyzer::PowerSpectrum::getBandPower(double lowHz, double highHz) const
+{
+    if (psd.empty()) { return 0.0; }
+    const size_t lowBin  = (size_t)std::max(0.0, std::ceil(lowHz / binHz));
+    const size_t highBin = std::min((size_t)std::max(0.0, std::floor(highHz / binHz)), psd.size() - 1);
+
+    double power = 0.0;
+    for (size_t bin=lowBin; bin <= highBin; bin++) { power += psd[bin]; }
+    return power * binHz;
+}
+
+double SpectrumAnalyzer::FrequencyResponse::getRippleDb(double lowHz, double highHz) const
+{
+    double minGain = INFINITY, maxGain = -INFINITY;
+    for (size_t i=0; i < freqHz.size(); i++) {
+        if ((freqHz[i] < lowHz) || (freqHz[i] > highHz)) { continue; }
+        minGain = std::min(minGain, gainDb[i]);
+        maxGain = std::max(maxGain, gainDb[i]);
+    }
+    return (maxGain >= minGain) ? maxGain - minGain : 0.0;
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer()
+: SpectrumAnalyzer(Config())
+{
+}
+
+SpectrumAnalyzer::SpectrumAnalyzer(const Config& config)
+: m_config(config)
+{
+    m_config.fftLenBits = std::max(MIN_FFT_LEN_BITS, std::min(m_config.fftLenBits, MAX_FFT_LEN_BITS));
+    m_config.overlap    = std::max(0.0, std::min(m_config.overlap, MAX_OVERLAP));
+
+    const unsigned fftLen = getFFTLength();
+    m_hopSize = std::max(1U, (unsigned)std::lround(fftLen * (1.0 - m_config.overlap)));
+    m_window  = makeWindow(m_config.window, fftLen);
+    for (double value : m_window) {
+        m_windowSum   += value;
+        m_windowPower += value * value;
+    }
+}
+
+std::vector<double> SpectrumAnalyzer::makeSweep(double sampleRate, double startHz, double endHz, double seconds, double amplitude)
+{
+    const size_t length = (size_t)(seconds * sampleRate);
+    const double rate   = std::log(endHz / startHz) / seconds; // of the exponential, per second
+    const size_t fadeLength = std::min((size_t)(SWEEP_FADE_SECS * sampleRate), length / 2);
+
+    std::vector<double> sweep(length);
+    for (size_t i=0; i < length; i++) {
+        const double t = i / sampleRate;
+        sweep[i] = amplitude * std::sin(R8B_2PI * startHz / rate * (std::exp(rate * t) - 1.0));
+    }
+    for (size_t i=0; i < fadeLength; i++) {
+        const double gain = 0.5 - 0.5 * std::cos(R8B_PI * i / fadeLength);
+        sweep[i]              *= gain;
+        sweep[length - 1 - i] *= gain;
+    }
+    return sweep;
+}
+
+size_t SpectrumAnalyzer::m_getNumSegments(size_t length) const
+{
+    if (length < getFFTLength()) {
+        errorMessage("SpectrumAnalyzer: " + std::to_string(length) + " samples is shorter than the FFT length of " +
+                     std::to_string(getFFTLength()));
+        return 0;
+    }
+    return (length - getFFTLength()) / m_hopSize + 1;
+}
+
+SpectrumAnalyzer::Spectrogram SpectrumAnalyzer::stft(const double* in, size_t length) const
+{
+    Spectrogram spectrogram;
+    spectrogram.binHz     = m_config.sampleRate / getFFTLength();
+    spectrogram.hopSize   = m_hopSize;
+    spectrogram.numBins   = getFFTLength() / 2 + 1;
+    spectrogram.numFrames = m_getNumSegments(length);
+    if (spectrogram.numFrames == 0) { return spectrogram; }
+    spectrogram.levelDb.resize(spectrogram.numFrames * spectrogram.numBins);
+
+    // A sine of amplitude a centred on a bin gives a * m_windowSum / 2 there, the DC and Nyquist bins a * m_windowSum
+    auto workers = makeWorkers(m_config, spectrogram.numFrames);
+    forEachSegment(workers, spectrogram.numFrames, [&](SegmentWorker& worker, size_t frame) {
+        worker.transform(in, length, (long long)(frame * m_hopSize), m_window, worker.inRe, worker.inIm);
+        float* row = &spectrogram.levelDb[frame * spectrogram.numBins];
+        for (unsigned bin=0; bin < spectrogram.numBins; bin++) {
+            const double scale = ((bin == 0) || (bin == spectrogram.numBins - 1)) ? 1.0 : 2.0;
+            const double power = (worker.inRe[bin] * worker.inRe[bin] + worker.inIm[bin] * worker.inIm[bin]) * scale * scale /
+                                 (m_windowSum * m_windowSum);
+            row[bin] = (float)powerToDb(power);
+        }
+    });
+    return spectrogram;
+}
+
+void SpectrumAnalyzer::m_crossSpectra(const double* in, const double* out, size_t length, int delay,
+                                      std::vector<double>& inPower, std::vector<double>& crossRe, std::vector<double>& crossIm,
+                                      std::vector<double>& outPower, size_t& numSegments) const
+{
+    const size_t numBins = getFFTLength() / 2 + 1;
+    numSegments = m_getNumSegments(length);
+    for (auto* bins : { &inPower, &crossRe, &crossIm, &outPower }) { bins->assign(numBins, 0.0); }
+    if (numSegments == 0) { return; }
+
+    // A transfer function isn't biased by zeros, so the last segment runs past the end to cover the tail,
+    // e.g. the highest frequencies of a sweep
+    if (out && ((numSegments - 1) * m_hopSize + getFFTLength() < length)) { numSegments++; }
+
+    auto workers = makeWorkers(m_config, numSegments);
+    forEachSegment(workers, numSegments, [&](SegmentWorker& worker, size_t segment) {
+        const long long start = (long long)(segment * m_hopSize);
+        worker.transform(in, length, start, m_window, worker.inRe, worker.inIm);
+        if (out) { worker.transform(out, length, start + delay, m_window, worker.outRe, worker.outIm); }
+
+        for (size_t bin=0; bin < numBins; bin++) {
+            const double xr = worker.inRe[bin], xi = worker.inIm[bin];
+            worker.inPower[bin] += xr * xr + xi * xi;
+            if (!out) { continue; }
+
+            // conj(X) * Y
+            const double yr = worker.outRe[bin], yi = worker.outIm[bin];
+            worker.crossRe[bin]  += xr * yr + xi * yi;
+            worker.crossIm[bin]  += xr * yi - xi * yr;
+            worker.outPower[bin] += yr * yr + yi * yi;
+        }
+    });
+
+    for (auto& worker : workers) {
+        for (size_t bin=0; bin < numBins; bin++) {
+            inPower[bin]  += worker->inPower[bin];
+            crossRe[bin]  += worker->crossRe[bin];
+            crossIm[bin]  += worker->crossIm[bin];
+            outPower[bin] += worker->outPower[bin];
+        }
+    }
+}
+
+SpectrumAnalyzer::PowerSpectrum SpectrumAnalyzer::welch(const double* in, size_t length) const
+{
+    PowerSpectrum spectrum;
+    spectrum.binHz = m_config.sampleRate / getFFTLength();
+
+    std::vector<double> inPower, crossRe, crossIm, outPower;
+    m_crossSpectra(in, nullptr, length, 0, inPower, crossRe, crossIm, outPower, spectrum.numAverages);
+    if (spectrum.numAverages == 0) { return spectrum; }
+
+    // One-sided, so the bins other than DC and Nyquist count twice
+    const double scale = 1.0 / (spectrum.numAverages * m_config.sampleRate * m_windowPower);
+    spectrum.psd.resize(inPower.size());
+    for (size_t bin=0; bin < inPower.size(); bin++) {
+        const bool isEdge = (bin == 0) || (bin == inPower.size() - 1);
+        spectrum.psd[bin] = inPower[bin] * scale * (isEdge ? 1.0 : 2.0);
+    }
+    return spectrum;
+}
+
+SpectrumAnalyzer::ThdnResult SpectrumAnalyzer::thdn(const double* in, size_t length, double fundamentalHz, double lowHz, double highHz,
+                                                    unsigned maxHarmonic) const
+{
+    ThdnResult result;
+    const PowerSpectrum spectrum = welch(in, length);
+    if (spectrum.psd.empty()) { return result; }
+
+    const int numBins   = (int)spectrum.psd.size();
+    const int halfWidth = WINDOW_HALF_WIDTHS[(unsigned)m_config.window];
+    const int lowBin    = std::max(1, (int)std::ceil(lowHz / spectrum.binHz));
+    const int highBin   = std::min((int)std::floor(highHz / spectrum.binHz), numBins - 1);
+    std::vector<bool> claimed(numBins, false);
+
+    // Sums the bins around a tone that no earlier tone has claimed
+    auto tonePower = [&](int centre, double* centroidHz) {
+        double power = 0.0, moment = 0.0;
+        for (int bin=std::max(0, centre - halfWidth); bin <= std::min(numBins - 1, centre + halfWidth); bin++) {
+            if (claimed[bin]) { continue; }
+            claimed[bin] = true;
+            power  += spectrum.psd[bin];
+            moment += spectrum.psd[bin] * bin;
+        }
+        if (centroidHz) { *centroidHz = (power > 0.0) ? moment / power * spectrum.binHz : centre * spectrum.binHz; }
+        return power * spectrum.binHz;
+    };
+
+    // The peak nearest the requested frequency
+    const int requestedBin = std::min((int)std::lround(fundamentalHz / spectrum.binHz), numBins - 1);
+    int peakBin = requestedBin;
+    for (int bin=std::max(0, requestedBin - halfWidth); bin <= std::min(numBins - 1, requestedBin + halfWidth); bin++) {
+        if (spectrum.psd[bin] > spectrum.psd[peakBin]) { peakBin = bin; }
+    }
+    const double fundamentalPower = tonePower(peakBin, &result.fundamentalHz);
+
+    double residualPower = 0.0;
+    for (int bin=lowBin; bin <= highBin; bin++) {
+        if (!claimed[bin]) { residualPower += spectrum.psd[bin]; }
+    }
+    residualPower *= spectrum.binHz;
+
+    double harmonicPower = 0.0;
+    for (unsigned harmonic=2; harmonic <= maxHarmonic; harmonic++) {
+        const int bin = (int)std::lround(harmonic * result.fundamentalHz / spectrum.binHz);
+        if ((bin > highBin) || (bin >= numBins)) { break; }
+        const double power = tonePower(bin, nullptr);
+        harmonicPower += power;
+        result.harmonicsDb.push_back(powerToDb(power / fundamentalPower));
+    }
+
+    result.fundamentalDb = powerToDb(fundamentalPower / FULL_SCALE_POWER);
+    result.thdDb         = powerToDb(harmonicPower / fundamentalPower);
+    result.thdnDb        = powerToDb(residualPower / fundamentalPower);
+    result.noiseDb       = powerToDb(std::max(residualPower - harmonicPower, 0.0) / FULL_SCALE_POWER);
+    return result;
+}
+
+SpectrumAnalyzer::FrequencyResponse SpectrumAnalyzer::frequencyResponse(const double* in, const double* out, size_t length,
+                                                                        double startHz, double endHz, unsigned pointsPerOctave) const
+{
+    FrequencyResponse response;
+    const unsigned fftLen  = getFFTLength();
+    const size_t   numBins = fftLen / 2 + 1;
+    const double   binHz   = m_config.sampleRate / fftLen;
+
+    std::vector<double> inPower, crossRe, crossIm, outPower;
+    size_t numSegments;
+    m_crossSpectra(in, out, length, 0, inPower, crossRe, crossIm, outPower, numSegments);
+    if (numSegments == 0) { return response; }
+
+    // The averaged cross-spectrum transforms back to the cross-correlation, its peak is the bulk delay
+    {
+        r8b::CDSPRealFFTKeeper fft((int)m_config.fftLenBits, m_config.useFloatFFT);
+        r8b::CFixedBuffer<double> block(fftLen);
+        packSpectrum(fft, crossRe.data(), crossIm.data(), block);
+        fft->inverse(block);
+
+        // The inverse transforms always leave doubles
+        double peak = -1.0;
+        for (unsigned lag=0; lag < fftLen; lag++) {
+            const double value = std::fabs(block[lag]);
+            if (value > peak) {
+                peak = value;
+                response.delaySamples = (lag < fftLen / 2) ? (int)lag : (int)lag - (int)fftLen;
+            }
+        }
+    }
+    if (response.delaySamples != 0) {
+        m_crossSpectra(in, out, length, response.delaySamples, inPower, crossRe, crossIm, outPower, numSegments);
+    }
+
+    // Each point averages the spectra over its share of the octave, or takes the nearest bin when that's narrower
+    // than a bin
+    const double bandRatio = std::pow(2.0, 0.5 / std::max(pointsPerOctave, 1U));
+    const double endLimit  = std::min(endHz, m_config.sampleRate * 0.5);
+    for (double freq=startHz; freq <= endLimit * (1.0 + 1e-9); freq *= bandRatio * bandRatio) {
+        size_t lowBin  = (size_t)std::ceil(freq / bandRatio / binHz);
+        size_t highBin = std::min((size_t)std::floor(freq * bandRatio / binHz), numBins - 1);
+        if (lowBin > highBin) { lowBin = highBin = std::min((size_t)std::lround(freq / binHz), numBins - 1); }
+
+        double sxx = 0.0, syy = 0.0, sxyRe = 0.0, sxyIm = 0.0;
+        for (size_t bin=lowBin; bin <= highBin; bin++) {
+            sxx   += inPower[bin];
+            syy   += outPower[bin];
+            sxyRe += crossRe[bin];
+            sxyIm += crossIm[bin];
+        }
+        const double crossPower = sxyRe * sxyRe + sxyIm * sxyIm;
+
+        response.freqHz.push_back(freq);
+        response.gainDb.push_back(powerToDb(crossPower / std::max(sxx * sxx, 1e-300)));
+        response.phaseDeg.push_back(std::atan2(sxyIm, sxyRe) * 180.0 / R8B_PI);
+        response.coherence.push_back((sxx > 0.0) && (syy > 0.0) ? crossPower / (sxx * syy) : 0.0);
+    }
+    return response;
+}
+
+}
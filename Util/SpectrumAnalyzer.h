@@ -0,0 +1,114 @@
+/*
+ * SpectrumAnalyzer.h
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace stride {
+
+// Offline spectral measurements of captured or rendered audio, for checking an effect chain, resampler or
+// IR convolution on the host. Signals are split into overlapping windowed segments, transformed with the
+// r8b FFT and the segments are shared between a pool of threads, so captures of any length can be
+// measured. Results are summaries: levels are in dB relative to full scale (a sine of amplitude 1.0).
+class SpectrumAnalyzer
+{
+public:
+    enum class Window : unsigned {
+        HANN = 0,
+        BLACKMAN_HARRIS,   // 4-term, -92 dB sidelobes
+        BLACKMAN_HARRIS_7, // 7-term, -180 dB sidelobes, for THD+N of 24-bit and float paths
+        FLAT_TOP           // amplitude accurate to 0.01 dB between bins
+    };
+
+    struct Config {
+        double   sampleRate  = 48000.0;
+        unsigned fftLenBits  = 14;    // 16384 points, 2.9 Hz bins at 48k
+        double   overlap     = 0.5;   // of consecutive segments, 0 to 0.9
+        Window   window      = Window::BLACKMAN_HARRIS_7;
+        bool     useFloatFFT = false; // pffft, only with R8B_PFFFT_RUNTIME
+        unsigned numThreads  = 0;     // 0 uses one thread per CPU
+    };
+
+    struct Spectrogram {
+        double   binHz     = 0.0;
+        unsigned hopSize   = 0; // samples between frames
+        unsigned numBins   = 0; // fft length / 2 + 1
+        size_t   numFrames = 0;
+        std::vector<float> levelDb; // numFrames rows of numBins, the amplitude of a sine centred on the bin
+
+        float getLevelDb(size_t frame, unsigned bin) const { return levelDb[frame * numBins + bin]; }
+    };
+
+    struct PowerSpectrum {
+        double binHz       = 0.0;
+        size_t numAverages = 0;
+        std::vector<double> psd; // one-sided power spectral density, full scale squared per Hz
+
+        // Mean square of the signal between the frequencies, a full scale sine gives 0.5
+        double getBandPower(double lowHz, double highHz) const;
+    };
+
+    struct ThdnResult {
+        double fundamentalHz = 0.0; // at the spectrum peak nearest the requested frequency
+        double fundamentalDb = 0.0; // level of the fundamental
+        double thdDb         = 0.0; // power of the harmonics relative to the fundamental
+        double thdnDb        = 0.0; // power of everything else in the band relative to the fundamental
+        double noiseDb       = 0.0; // level of everything in the band but the fundamental and harmonics
+        std::vector<double> harmonicsDb; // 2nd, 3rd... relative to the fundamental
+    };
+
+    struct FrequencyResponse {
+        int delaySamples = 0;          // of the output against the input, removed before the estimate
+        std::vector<double> freqHz;    // log-spaced from startHz to endHz
+        std::vector<double> gainDb;
+        std::vector<double> phaseDeg;  // after removing the delay
+        std::vector<double> coherence; // 0 to 1, low where the output isn't a linear function of the input
+
+        // Largest difference between two points' gains, both between the frequencies
+        double getRippleDb(double lowHz, double highHz) const;
+    };
+
+    SpectrumAnalyzer();
+    explicit SpectrumAnalyzer(const Config& config);
+    virtual ~SpectrumAnalyzer() = default;
+
+    const Config& getConfig() const { return m_config; }
+    unsigned getFFTLength() const { return 1U << m_config.fftLenBits; }
+    unsigned getHopSize() const { return m_hopSize; }
+
+    // Exponential sine sweep, a good input for frequencyResponse(), with half-cosine fades at the ends
+    static std::vector<double> makeSweep(double sampleRate, double startHz, double endHz, double seconds, double amplitude = 0.5);
+
+    Spectrogram   stft(const double* in, size_t length) const;
+    PowerSpectrum welch(const double* in, size_t length) const;
+
+    // Measures a sine near fundamentalHz, harmonics and noise are limited to lowHz to highHz
+    ThdnResult thdn(const double* in, size_t length, double fundamentalHz, double lowHz = 20.0, double highHz = 20000.0,
+                    unsigned maxHarmonic = 10) const;
+
+    // Estimates the transfer function from in to out (the H1 estimate, averaged cross-spectrum over the
+    // input's spectrum), e.g. with a sweep from makeSweep() as the input. The impulse response should be
+    // shorter than the FFT length, the bulk delay between the signals is found and removed first.
+    FrequencyResponse frequencyResponse(const double* in, const double* out, size_t length, double startHz = 20.0,
+                                        double endHz = 20000.0, unsigned pointsPerOctave = 12) const;
+
+private:
+    Config              m_config;
+    unsigned            m_hopSize = 0;
+    std::vector<double> m_window;
+    double              m_windowSum   = 0.0; // coherent gain, for levels of sines
+    double              m_windowPower = 0.0; // sum of squares, for power spectral densities
+
+    size_t m_getNumSegments(size_t length) const;
+    void   m_crossSpectra(const double* in, const double* out, size_t length, int delay,
+                          std::vector<double>& inPower, std::vector<double>& crossRe, std::vector<double>& crossIm,
+                          std::vector<double>& outPower, size_t& numSegments) const;
+};
+
+}
@@ -0,0 +1,219 @@
+/*
+ * TelemetrySeries.cpp
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include "TelemetrySeries.h"
+
+namespace stride {
+
+static constexpr double MS_PER_SECOND = 1000.0;
+
+static void telemetryToFields(const Telemetry& telemetry, float* fields)
+{
+    std::memcpy(fields, (const void*)&telemetry, sizeof(Telemetry));
+}
+
+static Telemetry fieldsToTelemetry(const float* fields)
+{
+    Telemetry telemetry;
+    std::memcpy((void*)&telemetry, fields, sizeof(Telemetry));
+    return telemetry;
+}
+
+TelemetrySeries::TelemetrySeries()
+: m_writeCount(0)
+{
+    for (auto& bucket : m_buckets) {
+        bucket.sequence.store(0, std::memory_order_relaxed);
+        bucket.data.second = -1;
+        bucket.data.count  = 0;
+    }
+}
+
+void TelemetrySeries::clear()
+{
+    m_writeCount.store(0, std::memory_order_release);
+    for (auto& bucket : m_buckets) {
+        bucket.sequence.fetch_add(1, std::memory_order_acq_rel);
+        bucket.data.second = -1;
+        bucket.data.count  = 0;
+        bucket.sequence.fetch_add(1, std::memory_order_release);
+    }
+}
+
+void TelemetrySeries::append(const Telemetry& telemetry, double timeMs)
+{
+    uint64_t writeCount = m_writeCount.load(std::memory_order_relaxed);
+    Sample& sample = m_samples[writeCount & SAMPLE_MASK];
+    sample.timeMs    = timeMs;
+    sample.telemetry = telemetry;
+    // publish the sample
+    m_writeCount.store(writeCount + 1, std::memory_order_release);
+
+    m_updateBucket(telemetry, timeMs);
+}
+
+void TelemetrySeries::m_updateBucket(const Telemetry& telemetry, double timeMs)
+{
+    int64_t second = (int64_t)std::floor(timeMs / MS_PER_SECOND);
+    Bucket& bucket = m_buckets[(uint64_t)second % BUCKET_CAPACITY];
+
+    float fields[NUM_FIELDS];
+    telemetryToFields(telemetry, fields);
+
+    bucket.sequence.fetch_add(1, std::memory_order_acq_rel); // odd, update in progress
+    std::atomic_thread_fence(std::memory_order_release);
+
+    BucketData& data = bucket.data;
+    if (data.second != second) {
+        // bucket is being reused for a new second
+        data.second = second;
+        data.count  = 0;
+        for (unsigned i=0; i < NUM_FIELDS; i++) {
+            data.min[i] = std::numeric_limits<float>::max();
+            data.max[i] = std::numeric_limits<float>::lowest();
+            data.sum[i] = 0.0;
+        }
+    }
+
+    for (unsigned i=0; i < NUM_FIELDS; i++) {
+        data.min[i]  = std::min(data.min[i], fields[i]);
+        data.max[i]  = std::max(data.max[i], fields[i]);
+        data.sum[i] += fields[i];
+    }
+    data.count++;
+
+    bucket.sequence.fetch_add(1, std::memory_order_release); // even, update complete
+}
+
+bool TelemetrySeries::m_readBucket(unsigned index, BucketData& data) const
+{
+    constexpr unsigned MAX_RETRIES = 8;
+    const Bucket& bucket = m_buckets[index];
+
+    for (unsigned retry=0; retry < MAX_RETRIES; retry++) {
+        uint32_t sequenceBefore = bucket.sequence.load(std::memory_order_acquire);
+        if (sequenceBefore & 0x1) { continue; } // writer is mid-update
+
+        std::memcpy((void*)&data, (const void*)&bucket.data, sizeof(BucketData));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (bucket.sequence.load(std::memory_order_relaxed) == sequenceBefore) { return true; }
+    }
+    return false;
+}
+
+bool TelemetrySeries::getLatest(Sample& sample) const
+{
+    return getLatestSamples(&sample, 1) == 1;
+}
+
+size_t TelemetrySeries::getLatestSamples(Sample* samples, size_t maxSamples) const
+{
+    if (!samples || (maxSamples == 0)) { return 0; }
+
+    uint64_t writeCountBefore = m_writeCount.load(std::memory_order_acquire);
+    size_t numSamples = (size_t)std::min<uint64_t>(std::min<uint64_t>(maxSamples, SAMPLE_CAPACITY), writeCountBefore);
+    uint64_t firstIndex = writeCountBefore - numSamples;
+
+    for (size_t i=0; i < numSamples; i++) {
+        samples[i] = m_samples[(firstIndex + i) & SAMPLE_MASK];
+    }
+
+    // Any sample the writer may have overwritten while we were copying is discarded. The writer
+    // could be mid-way through the slot at writeCountAfter, which held index writeCountAfter - CAPACITY.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t writeCountAfter = m_writeCount.load(std::memory_order_relaxed);
+    uint64_t oldestValidIndex = (writeCountAfter + 1 > SAMPLE_CAPACITY) ? (writeCountAfter + 1 - SAMPLE_CAPACITY) : 0;
+
+    if (firstIndex < oldestValidIndex) {
+        size_t numInvalid = (size_t)std::min<uint64_t>(oldestValidIndex - firstIndex, numSamples);
+        std::memmove(samples, samples + numInvalid, (numSamples - numInvalid) * sizeof(Sample));
+        numSamples -= numInvalid;
+    }
+    return numSamples;
+}
+
+TelemetrySeries::Stats TelemetrySeries::getStats(Window window, double nowMs) const
+{
+    float  minFields[NUM_FIELDS];
+    float  maxFields[NUM_FIELDS];
+    double sumFields[NUM_FIELDS];
+    for (unsigned i=0; i < NUM_FIELDS; i++) {
+        minFields[i] = std::numeric_limits<float>::max();
+        maxFields[i] = std::numeric_limits<float>::lowest();
+        sumFields[i] = 0.0;
+    }
+    unsigned count = 0;
+
+    if (window == Window::ONE_SECOND) {
+        // Exact sliding window over the raw samples, read in place newest first so that polling doesn't
+        // allocate or copy the whole ring
+        const uint64_t writeCount   = m_writeCount.load(std::memory_order_acquire);
+        const uint64_t numAvailable = std::min<uint64_t>(writeCount, SAMPLE_CAPACITY);
+        const double   startMs      = nowMs - MS_PER_SECOND;
+
+        for (uint64_t n=0; n < numAvailable; n++) {
+            const uint64_t index = writeCount - 1 - n;
+            const Sample sample = m_samples[index & SAMPLE_MASK];
+
+            // As in getLatestSamples(), stop at the first sample the writer may have overwritten
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const uint64_t writeCountNow = m_writeCount.load(std::memory_order_relaxed);
+            if ((writeCountNow + 1 > SAMPLE_CAPACITY) && (index < writeCountNow + 1 - SAMPLE_CAPACITY)) { break; }
+
+            if (sample.timeMs <= startMs) { break; }
+            float fields[NUM_FIELDS];
+            telemetryToFields(sample.telemetry, fields);
+            for (unsigned i=0; i < NUM_FIELDS; i++) {
+                minFields[i] = std::min(minFields[i], fields[i]);
+                maxFields[i] = std::max(maxFields[i], fields[i]);
+                sumFields[i] += fields[i];
+            }
+            count++;
+        }
+    } else {
+        // Sliding window with one second granularity over the rollup buckets
+        unsigned numSeconds = (window == Window::ONE_MINUTE) ? 60 : BUCKET_CAPACITY;
+        int64_t nowSecond   = (int64_t)std::floor(nowMs / MS_PER_SECOND);
+
+        for (int64_t second = nowSecond - numSeconds + 1; second <= nowSecond; second++) {
+            if (second < 0) { continue; }
+            BucketData data;
+            if (!m_readBucket((unsigned)((uint64_t)second % BUCKET_CAPACITY), data)) { continue; }
+            if ((data.second != second) || (data.count == 0)) { continue; } // stale or empty bucket
+
+            for (unsigned i=0; i < NUM_FIELDS; i++) {
+                minFields[i] = std::min(minFields[i], data.min[i]);
+                maxFields[i] = std::max(maxFields[i], data.max[i]);
+                sumFields[i] += data.sum[i];
+            }
+            count += data.count;
+        }
+    }
+
+    Stats stats;
+    stats.count = count;
+    if (count == 0) {
+        Telemetry zero = {0.0f, 0.0f, 0.0f, 0.0f};
+        stats.min = stats.max = stats.mean = zero;
+        return stats;
+    }
+
+    float meanFields[NUM_FIELDS];
+    for (unsigned i=0; i < NUM_FIELDS; i++) {
+        meanFields[i] = (float)(sumFields[i] / count);
+    }
+    stats.min  = fieldsToTelemetry(minFields);
+    stats.max  = fieldsToTelemetry(maxFields);
+    stats.mean = fieldsToTelemetry(meanFields);
+    return stats;
+}
+
+}
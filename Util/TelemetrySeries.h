@@ -0,0 +1,93 @@
+/*
+ * TelemetrySeries.h
+ *
+ *  Created on: Oct. 19, 2026
+ *      Author: blackaddr
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <JuceHeader.h>
+
+namespace stride {
+
+struct Telemetry {
+    float cpuUtilization;
+    float ram0Usage;
+    float ram1Usage;
+    float temperature;
+};
+
+// Fixed size time series of pedal telemetry. There must be a single writer (the thread processing
+// incoming SysEx), any number of threads may read without locking. Raw samples are kept in a ring
+// buffer for short windows, and per-second rollup buckets are kept for up to an hour.
+class TelemetrySeries
+{
+public:
+    static constexpr unsigned SAMPLE_CAPACITY = 4096; // must be a power of 2
+    static constexpr unsigned BUCKET_CAPACITY = 3600; // one bucket per second
+
+    struct Sample {
+        double    timeMs;
+        Telemetry telemetry;
+    };
+
+    struct Stats {
+        Telemetry min;
+        Telemetry max;
+        Telemetry mean;
+        unsigned  count;
+    };
+
+    enum class Window : unsigned {
+        ONE_SECOND = 0,
+        ONE_MINUTE,
+        ONE_HOUR
+    };
+
+    TelemetrySeries();
+    ~TelemetrySeries() = default;
+
+    // Writer side
+    void append(const Telemetry& telemetry) { append(telemetry, juce::Time::getMillisecondCounterHiRes()); }
+    void append(const Telemetry& telemetry, double timeMs);
+    void clear();
+
+    // Reader side
+    bool   getLatest(Sample& sample) const;
+    size_t getLatestSamples(Sample* samples, size_t maxSamples) const; // copied oldest first, returns the count
+    Stats  getStats(Window window) const { return getStats(window, juce::Time::getMillisecondCounterHiRes()); }
+    Stats  getStats(Window window, double nowMs) const;
+    uint64_t getNumSamplesWritten() const { return m_writeCount.load(std::memory_order_acquire); }
+
+private:
+    static constexpr unsigned NUM_FIELDS  = sizeof(Telemetry) / sizeof(float);
+    static constexpr unsigned SAMPLE_MASK = SAMPLE_CAPACITY - 1;
+    static_assert((SAMPLE_CAPACITY & SAMPLE_MASK) == 0, "SAMPLE_CAPACITY must be a power of 2");
+
+    struct BucketData {
+        int64_t  second;
+        float    min[NUM_FIELDS];
+        float    max[NUM_FIELDS];
+        double   sum[NUM_FIELDS];
+        unsigned count;
+    };
+
+    struct Bucket {
+        std::atomic<uint32_t> sequence; // odd while the writer is updating the bucket
+        BucketData            data;
+    };
+
+    Sample                m_samples[SAMPLE_CAPACITY];
+    std::atomic<uint64_t> m_writeCount;
+    Bucket                m_buckets[BUCKET_CAPACITY];
+
+    void m_updateBucket(const Telemetry& telemetry, double timeMs);
+    bool m_readBucket(unsigned index, BucketData& data) const;
+
+    JUCE_DECLARE_NON_COPYABLE (TelemetrySeries)
+};
+
+}
@@ -0,0 +1,200 @@
+//$ nobt
+//$ nocpp
+
+/**
+ * @file CDSPAsyncResampler.h
+ *
+ * @brief Asynchronous sample rate converter class.
+ *
+ * This file includes the asynchronous sample rate converter (ASRC) which
+ * allows the conversion ratio to be changed continuously during processing,
+ * for bridging streams running from unrelated clocks.
+ *
+ * r8brain-free-src Copyright (c) 2013-2022 Aleksey Vaneev
+ * See the "LICENSE" file for license.
+ */
+
+#ifndef R8B_CDSPASYNCRESAMPLER_INCLUDED
+#define R8B_CDSPASYNCRESAMPLER_INCLUDED
+
+#include "CDSPBlockConvolver.h"
+#include "CDSPFracInterpolator.h"
+
+namespace r8b {
+
+/**
+ * @brief Asynchronous sample rate converter class.
+ *
+ * Class performs 2X upsampling with a linear-phase low-pass filter, followed
+ * by the fractional delay filter bank interpolation in the asynchronous mode
+ * (see the CDSPFracInterpolator::setDstSampleRate() function). The
+ * destination sample rate may deviate from its nominal value by up to
+ * CDSPFracInterpolator::getMaxAsyncDev(), which is enough to track any
+ * practical clock drift. Rate changes take effect at the next output sample
+ * and keep the interpolation phase continuous, so there are no clicks when
+ * the rate is steered by a control loop.
+ *
+ * The nominal destination sample rate should be larger than half of the
+ * source sample rate.
+ */
+
+class CDSPAsyncResampler : public CDSPProcessor
+{
+public:
+	/**
+	 * Constructor initializes the asynchronous resampler.
+	 *
+	 * @param SrcSampleRate Source signal's sample rate.
+	 * @param DstSampleRate Nominal destination signal's sample rate.
+	 * @param aMaxInLen The maximal planned length of the input buffer (in
+	 * samples) that will be passed to the resampler.
+	 * @param ReqTransBand Required transition band, in percent. See the
+	 * CDSPResampler class for details.
+	 * @param ReqAtten Required stop-band attenuation in decibel.
+	 */
+
+	CDSPAsyncResampler( const double SrcSampleRate,
+		const double DstSampleRate, const int aMaxInLen,
+		const double ReqTransBand = 2.0, const double ReqAtten = 206.91 )
+		: MaxInLen( aMaxInLen )
+	{
+		R8BASSERT( SrcSampleRate > 0.0 );
+		R8BASSERT( DstSampleRate * 2.0 > SrcSampleRate );
+		R8BASSERT( MaxInLen > 0 );
+
+		// When downsampling, the low-pass filter should cover the lowest
+		// destination sample rate that can be reached.
+
+		const double MinDstSampleRate = DstSampleRate *
+			( 1.0 - CDSPFracInterpolator :: getMaxAsyncDev() );
+
+		const double NormFreq = ( MinDstSampleRate > SrcSampleRate ? 0.5 :
+			0.5 * MinDstSampleRate / SrcSampleRate );
+
+		Conv = new CDSPBlockConvolver( CDSPFIRFilterCache :: getLPFilter(
+			NormFreq, ReqTransBand, ReqAtten, fprLinearPhase, 2.0 ), 2, 1,
+			0.0 );
+
+		Interp = new CDSPFracInterpolator( SrcSampleRate * 2.0,
+			DstSampleRate, ReqAtten, false, Conv -> getLatencyFrac(), true );
+
+		const int ConvOutLen = Conv -> getMaxOutLen( MaxInLen );
+		TmpBufs.alloc( ConvOutLen + Interp -> getMaxOutLen( ConvOutLen ));
+		OutBuf = &TmpBufs[ ConvOutLen ];
+		MaxOutLen = Interp -> getMaxOutLen( ConvOutLen );
+
+		R8BCONSOLE( "CDSPAsyncResampler: src=%.1f dst=%.1f len=%i tb=%.1f "
+			"att=%.2f\n", SrcSampleRate, DstSampleRate, aMaxInLen,
+			ReqTransBand, ReqAtten );
+	}
+
+	virtual ~CDSPAsyncResampler()
+	{
+		delete Interp;
+		delete Conv;
+	}
+
+	virtual int getInLenBeforeOutPos( const int ReqOutPos ) const
+	{
+		return( Conv -> getInLenBeforeOutPos(
+			Interp -> getInLenBeforeOutPos( ReqOutPos )));
+	}
+
+	virtual int getLatency() const
+	{
+		return( 0 );
+	}
+
+	virtual double getLatencyFrac() const
+	{
+		return( Interp -> getLatencyFrac() );
+	}
+
+	/**
+	 * @return This function ignores the supplied parameter and returns the
+	 * maximal output buffer length that depends on the MaxInLen supplied to
+	 * the constructor, at the highest reachable destination sample rate.
+	 */
+
+	virtual int getMaxOutLen( const int/* MaxInLen */) const
+	{
+		return( MaxOutLen );
+	}
+
+	/**
+	 * @return The current destination sample rate.
+	 */
+
+	double getDstSampleRate() const
+	{
+		return( Interp -> getDstSampleRate() );
+	}
+
+	/**
+	 * Function changes the destination sample rate. The new rate takes
+	 * effect at the next output sample. See the
+	 * CDSPFracInterpolator::setDstSampleRate() function for details.
+	 *
+	 * @param DstSampleRate New destination sample rate.
+	 */
+
+	void setDstSampleRate( const double DstSampleRate )
+	{
+		R8BRTSECTION;
+
+		Interp -> setDstSampleRate( DstSampleRate );
+	}
+
+	/**
+	 * Function clears the state of *this object, and restores the nominal
+	 * destination sample rate.
+	 */
+
+	virtual void clear()
+	{
+		R8BRTSECTION;
+
+		Conv -> clear();
+		Interp -> clear();
+	}
+
+	/**
+	 * Function performs sample rate conversion. See the
+	 * CDSPResampler::process() function for details.
+	 *
+	 * @param ip0 Input buffer.
+	 * @param l The number of samples available in the input buffer. Should
+	 * not exceed the MaxInLen supplied in the constructor.
+	 * @param[out] op0 This variable receives the pointer to the resampled
+	 * data, in *this object's internal buffer.
+	 * @return The number of samples available in the "op0" output buffer.
+	 */
+
+	virtual int process( double* ip0, int l, double*& op0 )
+	{
+		R8BRTSECTION;
+		R8BASSERT( l >= 0 && l <= MaxInLen );
+
+		double* op = &TmpBufs[ 0 ];
+		l = Conv -> process( ip0, l, op );
+
+		op0 = OutBuf;
+
+		return( Interp -> process( op, l, op0 ));
+	}
+
+private:
+	CDSPBlockConvolver* Conv; ///< 2X upsampling stage.
+	CDSPFracInterpolator* Interp; ///< Asynchronous interpolation stage.
+	int MaxInLen; ///< Maximal input length.
+	int MaxOutLen; ///< Maximal output length.
+	CFixedBuffer< double > TmpBufs; ///< Buffer containing the upsampled and
+		///< the output data.
+	double* OutBuf; ///< Output buffer, within TmpBufs.
+};
+
+// ---------------------------------------------------------------------------
+
+} // namespace r8b
+
+#endif // R8B_CDSPASYNCRESAMPLER_INCLUDED
@@ -158,7 +158,17 @@ public:
 
 		R8BASSERT( Latency >= 0 );
 
-		fftin = new CDSPRealFFTKeeper( fftinBits );
+		if( Filter -> isFloat() && ( fftinBits < CDSPRealFFT ::
+			getMinFloatLenBits() || fftoutBits <
+			CDSPRealFFT :: getMinFloatLenBits() ))
+		{
+			// "Float" FFT is unavailable for the shorter block, switch to the
+			// equivalent "double" filter.
+
+			Filter = &CDSPFIRFilterCache :: getDoubleLPFilter( *Filter );
+		}
+
+		fftin = new CDSPRealFFTKeeper( fftinBits, Filter -> isFloat() );
 
 		if( fftoutBits == fftinBits )
 		{
@@ -166,7 +176,7 @@ public:
 		}
 		else
 		{
-			ffto2 = new CDSPRealFFTKeeper( fftoutBits );
+			ffto2 = new CDSPRealFFTKeeper( fftoutBits, Filter -> isFloat() );
 			fftout = ffto2;
 		}
 
@@ -305,11 +315,14 @@ public:
 
 			if( UpShift > 0 )
 			{
-				#if R8B_FLOATFFT
+				if( (*fftin) -> isFloat() )
+				{
 					mirrorInputSpectrum( (float*) CurInput );
-				#else // R8B_FLOATFFT
+				}
+				else
+				{
 					mirrorInputSpectrum( CurInput );
-				#endif // R8B_FLOATFFT
+				}
 			}
 
 			if( Filter -> isZeroPhase() )
@@ -327,15 +340,20 @@ public:
 			{
 				const int z = BlockLen2 >> DownShift;
 
-				#if R8B_FLOATFFT
-					float* const kb = (float*) Filter -> getKernelBlock();
+				if( (*fftout) -> isFloat() )
+				{
+					const float* const kb =
+						(const float*) Filter -> getKernelBlock();
+
 					float* const p = (float*) CurInput;
-				#else // R8B_FLOATFFT
+					p[ 1 ] = kb[ z ] * p[ z ] - kb[ z + 1 ] * p[ z + 1 ];
+				}
+				else
+				{
 					const double* const kb = Filter -> getKernelBlock();
 					double* const p = CurInput;
-				#endif // R8B_FLOATFFT
-
-				p[ 1 ] = kb[ z ] * p[ z ] - kb[ z + 1 ] * p[ z + 1 ];
+					p[ 1 ] = kb[ z ] * p[ z ] - kb[ z + 1 ] * p[ z + 1 ];
+				}
 			}
 
 			(*fftout) -> inverse( CurInput );
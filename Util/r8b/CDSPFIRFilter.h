@@ -17,6 +17,8 @@
 
 #include "CDSPSincFilterGen.h"
 #include "CDSPRealFFT.h"
+#include "CDSPObjCache.h"
+#include "CDSPKernelStore.h"
 
 namespace r8b {
 
@@ -54,7 +56,7 @@ enum EDSPFilterPhaseResponse
  * obtained via the CDSPFilterCache::getLPFilter() static function.
  */
 
-class CDSPFIRFilter : public R8B_BASECLASS
+class CDSPFIRFilter : public CObjCacheEntry
 {
 	R8BNOCTOR( CDSPFIRFilter );
 
@@ -63,9 +65,7 @@ class CDSPFIRFilter : public R8B_BASECLASS
 public:
 	~CDSPFIRFilter()
 	{
-		R8BASSERT( RefCount == 0 );
-
-		delete Next;
+		R8BASSERT( RefCount <= 0 );
 	}
 
 	/**
@@ -169,6 +169,16 @@ public:
 		return( KernelBlock );
 	}
 
+	/**
+	 * @return "True" if kernel block of *this filter was transformed with
+	 * a "float" FFT object, and should be used with "float" FFT objects only.
+	 */
+
+	bool isFloat() const
+	{
+		return( IsFloat );
+	}
+
 	/**
 	 * This function should be called when the filter obtained via the
 	 * filter cache is no longer needed.
@@ -184,10 +194,13 @@ private:
 		///< by the user (positive value).
 	EDSPFilterPhaseResponse ReqPhase; ///< Required filter's phase response.
 	double ReqGain; ///< Required overall filter's gain.
-	CDSPFIRFilter* Next; ///< Next FIR filter in cache's list.
-	int RefCount; ///< The number of references made to *this FIR filter.
+	bool ReqFloat; ///< "True" if "float" FFT was requested.
+	const double* ExtAttenCorrs; ///< External attenuation correction table
+		///< the filter was built with.
 	bool IsZeroPhase; ///< "True" if kernel block of *this filter has
 		///< zero-phase response.
+	bool IsFloat; ///< "True" if kernel block was produced by a "float" FFT
+		///< object.
 	int Latency; ///< Filter's latency in samples (integer part).
 	double LatencyFrac; ///< Filter's latency in samples (fractional part).
 	int KernelLen; ///< Filter kernel length, in samples.
@@ -200,7 +213,6 @@ private:
 		///< Address-aligned.
 
 	CDSPFIRFilter()
-		: RefCount( 1 )
 	{
 	}
 
@@ -456,8 +468,40 @@ private:
 		const int BlockLen = 1 << BlockLenBits;
 
 		KernelBlock.alloc( BlockLen * 2 );
-		sinc.generateBand( &KernelBlock[ 0 ],
-			&CDSPSincFilterGen :: calcWindowKaiser );
+
+		// The time-domain kernel does not depend on the gain and on the FFT
+		// used, so it is kept in the kernel store followed by its latency.
+		// Filters built with an external correction table are not kept.
+
+		const double StoreKey[ 4 ] = { ReqNormFreq, ReqTransBand, ReqAtten,
+			(double) ReqPhase };
+
+		const bool UseStore = ( ExtAttenCorrs == NULL );
+		double KernelDelay = sinc.fl2;
+
+		if( UseStore && CDSPKernelStore :: load( kkFIRFilter, StoreKey,
+			sizeof( StoreKey ), &KernelBlock[ 0 ], KernelLen + 1 ))
+		{
+			KernelDelay = KernelBlock[ KernelLen ];
+		}
+		else
+		{
+			sinc.generateBand( &KernelBlock[ 0 ],
+				&CDSPSincFilterGen :: calcWindowKaiser );
+
+			if( ReqPhase != fprLinearPhase )
+			{
+				calcMinPhaseTransform( &KernelBlock[ 0 ], KernelLen, 16,
+					false, &KernelDelay );
+			}
+
+			if( UseStore )
+			{
+				KernelBlock[ KernelLen ] = KernelDelay;
+				CDSPKernelStore :: store( kkFIRFilter, StoreKey,
+					sizeof( StoreKey ), &KernelBlock[ 0 ], KernelLen + 1 );
+			}
+		}
 
 		if( ReqPhase == fprLinearPhase )
 		{
@@ -468,16 +512,12 @@ private:
 		else
 		{
 			IsZeroPhase = false;
-			double DCGroupDelay;
-
-			calcMinPhaseTransform( &KernelBlock[ 0 ], KernelLen, 16, false,
-				&DCGroupDelay );
-
-			Latency = (int) DCGroupDelay;
-			LatencyFrac = DCGroupDelay - Latency;
+			Latency = (int) KernelDelay;
+			LatencyFrac = KernelDelay - Latency;
 		}
 
-		CDSPRealFFTKeeper ffto( BlockLenBits + 1 );
+		CDSPRealFFTKeeper ffto( BlockLenBits + 1, ReqFloat );
+		IsFloat = ffto -> isFloat();
 
 		if( IsZeroPhase )
 		{
@@ -533,7 +573,10 @@ private:
  * @brief FIR filter cache class.
  *
  * Class that implements cache for calculated FIR filters. The required FIR
- * filter should be obtained via the getLPFilter() static function.
+ * filter should be obtained via the getLPFilter() static function. Lookups of
+ * cached filters do not lock, see the CObjCache class. Filters that are not
+ * cached are loaded from the CDSPKernelStore, if it is open, before they are
+ * designed.
  */
 
 class CDSPFIRFilterCache : public R8B_BASECLASS
@@ -550,9 +593,26 @@ public:
 
 	static int getObjCount()
 	{
-		R8BSYNC( StateSync );
+		return( Cache.getObjCount() );
+	}
+
+	/**
+	 * @return Cache statistics: hits, misses, evictions and the object
+	 * count.
+	 */
+
+	static CObjCacheStats getStats()
+	{
+		return( Cache.getStats() );
+	}
 
-		return( ObjCount );
+	/**
+	 * Function resets the hit, miss and eviction counters.
+	 */
+
+	static void resetStats()
+	{
+		Cache.resetStats();
 	}
 
 	/**
@@ -578,6 +638,10 @@ public:
 	 * @param ReqGain Required overall filter's gain (1.0 for unity gain).
 	 * @param AttenCorrs Attentuation correction table, to pass to the filter
 	 * generation function. For internal use.
+	 * @param ReqFloat "True" if the filter's kernel block should be produced
+	 * with a "float" FFT object, if available. Such filters should be used
+	 * with "float" FFT objects only, see the CDSPFIRFilter::isFloat()
+	 * function.
 	 * @see EDSPFilterPhaseResponse
 	 * @return A reference to a new or a previously calculated low-pass FIR
 	 * filter object with the required characteristics. A reference count is
@@ -588,7 +652,7 @@ public:
 	static CDSPFIRFilter& getLPFilter( const double ReqNormFreq,
 		const double ReqTransBand, const double ReqAtten,
 		const EDSPFilterPhaseResponse ReqPhase, const double ReqGain,
-		const double* const AttenCorrs = NULL )
+		const double* const AttenCorrs = NULL, const bool ReqFloat = false )
 	{
 		R8BASSERT( ReqNormFreq > 0.0 && ReqNormFreq <= 1.0 );
 		R8BASSERT( ReqTransBand >= CDSPFIRFilter :: getLPMinTransBand() );
@@ -597,93 +661,67 @@ public:
 		R8BASSERT( ReqAtten <= CDSPFIRFilter :: getLPMaxAtten() );
 		R8BASSERT( ReqGain > 0.0 );
 
-		R8BSYNC( StateSync );
+		uint32_t h = calcObjHash( &ReqNormFreq, sizeof( ReqNormFreq ));
+		h = calcObjHash( &ReqTransBand, sizeof( ReqTransBand ), h );
+		h = calcObjHash( &ReqAtten, sizeof( ReqAtten ), h );
+		h = calcObjHash( &ReqPhase, sizeof( ReqPhase ), h );
+		h = calcObjHash( &ReqGain, sizeof( ReqGain ), h );
+		h = calcObjHash( &ReqFloat, sizeof( ReqFloat ), h );
 
-		CDSPFIRFilter* PrevObj = NULL;
-		CDSPFIRFilter* CurObj = Objects;
-
-		while( CurObj != NULL )
-		{
-			if( CurObj -> ReqNormFreq == ReqNormFreq &&
-				CurObj -> ReqTransBand == ReqTransBand &&
-				CurObj -> ReqGain == ReqGain &&
-				CurObj -> ReqAtten == ReqAtten &&
-				CurObj -> ReqPhase == ReqPhase )
+		return( Cache.acquire( h, false,
+			[&]( const CDSPFIRFilter& f )
 			{
-				break;
-			}
-
-			if( CurObj -> Next == NULL && ObjCount >= R8B_FILTER_CACHE_MAX )
-			{
-				if( CurObj -> RefCount == 0 )
-				{
-					// Delete the last filter which is not used.
-
-					PrevObj -> Next = NULL;
-					delete CurObj;
-					ObjCount--;
-				}
-				else
-				{
-					// Move the last filter to the top of the list since it
-					// seems to be in use for a long time.
-
-					PrevObj -> Next = NULL;
-					CurObj -> Next = Objects.unkeep();
-					Objects = CurObj;
-				}
-
-				CurObj = NULL;
-				break;
-			}
-
-			PrevObj = CurObj;
-			CurObj = CurObj -> Next;
-		}
-
-		if( CurObj != NULL )
-		{
-			CurObj -> RefCount++;
-
-			if( PrevObj == NULL )
+				return( f.ReqNormFreq == ReqNormFreq &&
+					f.ReqTransBand == ReqTransBand &&
+					f.ReqGain == ReqGain &&
+					f.ReqAtten == ReqAtten &&
+					f.ReqPhase == ReqPhase &&
+					f.ReqFloat == ReqFloat );
+			},
+			[&]()
 			{
-				return( *CurObj );
-			}
+				CDSPFIRFilter* const f = new CDSPFIRFilter();
+				f -> ReqNormFreq = ReqNormFreq;
+				f -> ReqTransBand = ReqTransBand;
+				f -> ReqAtten = ReqAtten;
+				f -> ReqPhase = ReqPhase;
+				f -> ReqGain = ReqGain;
+				f -> ReqFloat = ReqFloat;
+				f -> ExtAttenCorrs = AttenCorrs;
+				f -> buildLPFilter( AttenCorrs );
+
+				return( f );
+			}));
+	}
 
-			// Remove the filter from the list temporarily.
+	/**
+	 * Function returns a "double" filter equivalent to the specified filter.
+	 * If the specified filter was requested as "float", its reference is
+	 * released, and a reference to a filter with the same characteristics,
+	 * but produced with the "double" FFT object, is returned instead.
+	 *
+	 * @param f Filter obtained via the getLPFilter() function.
+	 */
 
-			PrevObj -> Next = CurObj -> Next;
-		}
-		else
+	static CDSPFIRFilter& getDoubleLPFilter( CDSPFIRFilter& f )
+	{
+		if( !f.ReqFloat )
 		{
-			// Create a new filter object (with RefCount == 1) and build the
-			// filter kernel.
-
-			CurObj = new CDSPFIRFilter();
-			CurObj -> ReqNormFreq = ReqNormFreq;
-			CurObj -> ReqTransBand = ReqTransBand;
-			CurObj -> ReqAtten = ReqAtten;
-			CurObj -> ReqPhase = ReqPhase;
-			CurObj -> ReqGain = ReqGain;
-			ObjCount++;
-
-			CurObj -> buildLPFilter( AttenCorrs );
+			return( f );
 		}
 
-		// Insert the filter at the start of the list.
+		// The filter may be evicted once released, get its parameters first.
+
+		CDSPFIRFilter& df = getLPFilter( f.ReqNormFreq, f.ReqTransBand,
+			f.ReqAtten, f.ReqPhase, f.ReqGain, f.ExtAttenCorrs, false );
 
-		CurObj -> Next = Objects.unkeep();
-		Objects = CurObj;
+		f.unref();
 
-		return( *CurObj );
+		return( df );
 	}
 
 private:
-	static CSyncObject StateSync; ///< Cache state synchronizer.
-	static CPtrKeeper< CDSPFIRFilter* > Objects; ///< The chain of cached
-		///< objects.
-	static int ObjCount; ///< The number of objects currently preset in the
-		///< cache.
+	static CObjCache< CDSPFIRFilter > Cache; ///< Cached filters.
 };
 
 // ---------------------------------------------------------------------------
@@ -692,9 +730,7 @@ private:
 
 inline void CDSPFIRFilter :: unref()
 {
-	R8BSYNC( CDSPFIRFilterCache :: StateSync );
-
-	RefCount--;
+	CObjCache< CDSPFIRFilter > :: release( *this );
 }
 
 // ---------------------------------------------------------------------------
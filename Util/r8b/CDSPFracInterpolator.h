@@ -17,6 +17,8 @@
 
 #include "CDSPSincFilterGen.h"
 #include "CDSPProcessor.h"
+#include "CDSPObjCache.h"
+#include "CDSPKernelStore.h"
 
 namespace r8b {
 
@@ -34,7 +36,7 @@ namespace r8b {
  * "Kaiser" power-raised window function.
  */
 
-class CDSPFracDelayFilterBank : public R8B_BASECLASS
+class CDSPFracDelayFilterBank : public CObjCacheEntry
 {
 	R8BNOCTOR( CDSPFracDelayFilterBank );
 
@@ -64,8 +66,6 @@ public:
 		, InterpPoints( aInterpPoints )
 		, ReqAtten( aReqAtten )
 		, IsThird( aIsThird )
-		, Next( NULL )
-		, RefCount( 1 )
 	{
 		R8BASSERT( ElementSize >= 1 && ElementSize <= 4 );
 
@@ -94,7 +94,18 @@ public:
 			FilterFracs = InitFilterFracs;
 		}
 
-		Table.alloc( FilterSize * ( FilterFracs + InterpPoints ));
+		const int TableLen = FilterSize * ( FilterFracs + InterpPoints );
+		Table.alloc( TableLen );
+
+		const double StoreKey[ 6 ] = { (double) InitFilterFracs,
+			(double) FilterFracs, (double) ElementSize, (double) InterpPoints,
+			ReqAtten, (double) IsThird };
+
+		if( CDSPKernelStore :: load( kkFracDelayFilterBank, StoreKey,
+			sizeof( StoreKey ), Table, TableLen ))
+		{
+			return;
+		}
 
 		CDSPSincFilterGen sinc;
 		sinc.Len2 = FilterLen / 2;
@@ -182,16 +193,14 @@ public:
 			}
 		}
 
+		CDSPKernelStore :: store( kkFracDelayFilterBank, StoreKey,
+			sizeof( StoreKey ), Table, TableLen );
+
 		R8BCONSOLE( "CDSPFracDelayFilterBank: fracs=%i order=%i taps=%i "
 			"att=%.1f third=%i\n", FilterFracs, ElementSize - 1, FilterLen,
 			ReqAtten, (int) IsThird );
 	}
 
-	~CDSPFracDelayFilterBank()
-	{
-		delete Next;
-	}
-
 	/**
 	 * Function "rounds" the specified attenuation to the nearest effective
 	 * value.
@@ -259,9 +268,6 @@ private:
 	CFixedBuffer< double > Table; ///< The table of fractional delay filters
 		///< for all discrete fractional x = 0..1 sample positions, and
 		///< interpolation coefficients.
-	CDSPFracDelayFilterBank* Next; ///< Next filter bank in cache's list.
-	int RefCount; ///< The number of references made to *this filter bank.
-		///< Not considered for "static" filter bank objects.
 
 	/**
 	 * Function returns windowing function parameters for the specified
@@ -412,7 +418,8 @@ private:
 /**
  * @brief Fractional delay filter cache class.
  *
- * Class implements cache storage of fractional delay filter banks.
+ * Class implements cache storage of fractional delay filter banks. Lookups of
+ * cached filter banks do not lock, see the CObjCache class.
  */
 
 class CDSPFracDelayFilterBankCache : public R8B_BASECLASS
@@ -429,14 +436,33 @@ public:
 
 	static int getObjCount()
 	{
-		R8BSYNC( StateSync );
+		return( Cache.getObjCount() );
+	}
+
+	/**
+	 * @return Cache statistics: hits, misses, evictions and the object
+	 * count. Static filter banks are not included in the object count.
+	 */
+
+	static CObjCacheStats getStats()
+	{
+		return( Cache.getStats() );
+	}
 
-		return( ObjCount );
+	/**
+	 * Function resets the hit, miss and eviction counters.
+	 */
+
+	static void resetStats()
+	{
+		Cache.resetStats();
 	}
 
 	/**
 	 * Function calculates or returns reference to a previously calculated
-	 * (cached) fractional delay filter bank.
+	 * (cached) fractional delay filter bank. Filter banks that are not cached
+	 * are loaded from the CDSPKernelStore, if it is open, before they are
+	 * calculated.
 	 *
 	 * @param aFilterFracs The number of fractional delay positions to sample,
 	 * -1 - use default.
@@ -456,131 +482,31 @@ public:
 	{
 		CDSPFracDelayFilterBank :: roundReqAtten( ReqAtten, IsThird );
 
-		R8BSYNC( StateSync );
-
-		if( IsStatic )
-		{
-			CDSPFracDelayFilterBank* PrevObj = NULL;
-			CDSPFracDelayFilterBank* CurObj = StaticObjects;
-
-			while( CurObj != NULL )
-			{
-				if( CurObj -> InitFilterFracs == aFilterFracs &&
-					CurObj -> IsThird == IsThird &&
-					CurObj -> ElementSize == aElementSize &&
-					CurObj -> InterpPoints == aInterpPoints &&
-					CurObj -> ReqAtten == ReqAtten )
-				{
-					if( PrevObj != NULL )
-					{
-						// Move the object to the top of the list.
-
-						PrevObj -> Next = CurObj -> Next;
-						CurObj -> Next = StaticObjects.unkeep();
-						StaticObjects = CurObj;
-					}
-
-					return( *CurObj );
-				}
-
-				PrevObj = CurObj;
-				CurObj = CurObj -> Next;
-			}
-
-			// Create a new filter bank and build it.
+		uint32_t h = calcObjHash( &aFilterFracs, sizeof( aFilterFracs ));
+		h = calcObjHash( &aElementSize, sizeof( aElementSize ), h );
+		h = calcObjHash( &aInterpPoints, sizeof( aInterpPoints ), h );
+		h = calcObjHash( &ReqAtten, sizeof( ReqAtten ), h );
+		h = calcObjHash( &IsThird, sizeof( IsThird ), h );
 
-			CurObj = new CDSPFracDelayFilterBank( aFilterFracs, aElementSize,
-				aInterpPoints, ReqAtten, IsThird );
-
-			// Insert the bank at the start of the list.
-
-			CurObj -> Next = StaticObjects.unkeep();
-			StaticObjects = CurObj;
-
-			return( *CurObj );
-		}
-
-		CDSPFracDelayFilterBank* PrevObj = NULL;
-		CDSPFracDelayFilterBank* CurObj = Objects;
-
-		while( CurObj != NULL )
-		{
-			if( CurObj -> InitFilterFracs == aFilterFracs &&
-				CurObj -> IsThird == IsThird &&
-				CurObj -> ElementSize == aElementSize &&
-				CurObj -> InterpPoints == aInterpPoints &&
-				CurObj -> ReqAtten == ReqAtten )
+		return( Cache.acquire( h, IsStatic,
+			[&]( const CDSPFracDelayFilterBank& fb )
 			{
-				break;
-			}
-
-			if( CurObj -> Next == NULL && ObjCount >= R8B_FRACBANK_CACHE_MAX )
-			{
-				if( CurObj -> RefCount == 0 )
-				{
-					// Delete the last bank which is not used.
-
-					PrevObj -> Next = NULL;
-					delete CurObj;
-					ObjCount--;
-				}
-				else
-				{
-					// Move the last bank to the top of the list since it
-					// seems to be in use for a long time.
-
-					PrevObj -> Next = NULL;
-					CurObj -> Next = Objects.unkeep();
-					Objects = CurObj;
-				}
-
-				CurObj = NULL;
-				break;
-			}
-
-			PrevObj = CurObj;
-			CurObj = CurObj -> Next;
-		}
-
-		if( CurObj != NULL )
-		{
-			CurObj -> RefCount++;
-
-			if( PrevObj == NULL )
+				return( fb.InitFilterFracs == aFilterFracs &&
+					fb.IsThird == IsThird &&
+					fb.ElementSize == aElementSize &&
+					fb.InterpPoints == aInterpPoints &&
+					fb.ReqAtten == ReqAtten );
+			},
+			[&]()
 			{
-				return( *CurObj );
-			}
-
-			// Remove the bank from the list temporarily.
-
-			PrevObj -> Next = CurObj -> Next;
-		}
-		else
-		{
-			// Create a new filter bank (with RefCount == 1) and build it.
-
-			CurObj = new CDSPFracDelayFilterBank( aFilterFracs, aElementSize,
-				aInterpPoints, ReqAtten, IsThird );
-
-			ObjCount++;
-		}
-
-		// Insert the bank at the start of the list.
-
-		CurObj -> Next = Objects.unkeep();
-		Objects = CurObj;
-
-		return( *CurObj );
+				return( new CDSPFracDelayFilterBank( aFilterFracs,
+					aElementSize, aInterpPoints, ReqAtten, IsThird ));
+			}));
 	}
 
 private:
-	static CSyncObject StateSync; ///< Cache state synchronizer.
-	static CPtrKeeper< CDSPFracDelayFilterBank* > Objects; ///< The chain of
-		///< cached objects.
-	static CPtrKeeper< CDSPFracDelayFilterBank* > StaticObjects; ///< The
-		///< chain of static objects.
-	static int ObjCount; ///< The number of objects currently preset in the
-		///< Objects cache.
+	static CObjCache< CDSPFracDelayFilterBank > Cache; ///< Cached filter
+		///< banks, including the static ones.
 };
 
 // ---------------------------------------------------------------------------
@@ -589,9 +515,7 @@ private:
 
 inline void CDSPFracDelayFilterBank :: unref()
 {
-	R8BSYNC( CDSPFracDelayFilterBankCache :: StateSync );
-
-	RefCount--;
+	CObjCache< CDSPFracDelayFilterBank > :: release( *this );
 }
 
 /**
@@ -687,6 +611,8 @@ inline bool getWholeStepping( const double SSampleRate,
 
 class CDSPFracInterpolator : public CDSPProcessor
 {
+	friend class CDSPMultiFracInterpolator;
+
 public:
 	/**
 	 * Constructor initalizes the interpolator. It is important to call the
@@ -700,13 +626,18 @@ public:
 	 * @param PrevLatency Latency, in samples (any value >=0), which was left
 	 * in the output signal by a previous process. This latency will be
 	 * consumed completely.
+	 * @param aIsAsync "True" if the destination sample rate may be changed
+	 * during processing via the setDstSampleRate() function. In this mode
+	 * whole-number stepping is never used.
 	 */
 
 	CDSPFracInterpolator( const double aSrcSampleRate,
 		const double aDstSampleRate, const double ReqAtten,
-		const bool IsThird, const double PrevLatency )
+		const bool IsThird, const double PrevLatency,
+		const bool aIsAsync = false )
 		: SrcSampleRate( aSrcSampleRate )
 		, DstSampleRate( aDstSampleRate )
+		, NomDstSampleRate( aDstSampleRate )
 	#if R8B_FASTTIMING
 		, FracStep( aSrcSampleRate / aDstSampleRate )
 	#endif // R8B_FASTTIMING
@@ -716,6 +647,8 @@ public:
 		R8BASSERT( PrevLatency >= 0.0 );
 		R8BASSERT( BufLenBits >= 5 );
 
+		IsAsync = aIsAsync;
+
 		InitFracPos = PrevLatency;
 		Latency = (int) InitFracPos;
 		InitFracPos -= Latency;
@@ -731,14 +664,16 @@ public:
 
 	#else // R8B_FLTTEST
 
-		IsWhole = getWholeStepping( SrcSampleRate, DstSampleRate, InStep,
-			OutStep );
+		IsWhole = !aIsAsync && getWholeStepping( SrcSampleRate,
+			DstSampleRate, InStep, OutStep );
 
 		if( IsWhole )
 		{
 			const double spos = InitFracPos * OutStep;
 			InitFracPosW = (int) spos;
 			LatencyFrac = ( spos - InitFracPosW ) / InStep;
+			InStepInt = InStep / OutStep;
+			InStepRem = InStep - InStepInt * OutStep;
 
 			FilterBank = &CDSPFracDelayFilterBankCache :: getFilterBank(
 				OutStep, 1, 2, ReqAtten, IsThird, false );
@@ -826,7 +761,77 @@ public:
 	{
 		R8BASSERT( MaxInLen >= 0 );
 
-		return( (int) ceil( MaxInLen * DstSampleRate / SrcSampleRate ) + 1 );
+		const double MaxDstSampleRate = ( IsAsync ?
+			NomDstSampleRate * ( 1.0 + getMaxAsyncDev() ) : DstSampleRate );
+
+		return( (int) ceil( MaxInLen * MaxDstSampleRate / SrcSampleRate ) +
+			1 );
+	}
+
+	/**
+	 * @return The maximal relative deviation of the destination sample rate
+	 * from its nominal value, in the asynchronous mode.
+	 */
+
+	static double getMaxAsyncDev()
+	{
+		return( 0.01 );
+	}
+
+	/**
+	 * @return "True" if *this interpolator was created in the asynchronous
+	 * mode.
+	 */
+
+	bool isAsync() const
+	{
+		return( IsAsync );
+	}
+
+	/**
+	 * @return The current destination sample rate.
+	 */
+
+	double getDstSampleRate() const
+	{
+		return( DstSampleRate );
+	}
+
+	/**
+	 * Function changes the destination sample rate, in the asynchronous
+	 * mode. The interpolation phase is continuous across the change: the
+	 * current fractional position is kept and only the subsequent steps use
+	 * the new ratio. The rate is limited to the nominal rate passed to the
+	 * constructor +/- getMaxAsyncDev().
+	 *
+	 * @param aDstSampleRate New destination sample rate.
+	 */
+
+	void setDstSampleRate( const double aDstSampleRate )
+	{
+		R8BASSERT( IsAsync );
+
+		const double MaxDev = NomDstSampleRate * getMaxAsyncDev();
+
+		DstSampleRate = ( aDstSampleRate < NomDstSampleRate - MaxDev ?
+			NomDstSampleRate - MaxDev : ( aDstSampleRate >
+			NomDstSampleRate + MaxDev ? NomDstSampleRate + MaxDev :
+			aDstSampleRate ));
+
+	#if R8B_FASTTIMING
+
+		FracStep = SrcSampleRate / DstSampleRate;
+
+	#else // R8B_FASTTIMING
+
+		// Restart the resettable counter at the current position, so that
+		// the next step is the first one taken with the new ratio.
+
+		InCounter = 0;
+		InPosInt = 0;
+		InPosShift = InPosFrac * DstSampleRate / SrcSampleRate;
+
+	#endif // R8B_FASTTIMING
 	}
 
 	virtual void clear()
@@ -845,6 +850,15 @@ public:
 		}
 		else
 		{
+			if( IsAsync )
+			{
+				DstSampleRate = NomDstSampleRate;
+
+			#if R8B_FASTTIMING
+				FracStep = SrcSampleRate / DstSampleRate;
+			#endif // R8B_FASTTIMING
+			}
+
 			InPosFrac = InitFracPos;
 
 		#if !R8B_FASTTIMING
@@ -935,6 +949,8 @@ private:
 		///< protection for maximal filter length.
 	double SrcSampleRate; ///< Source sample rate.
 	double DstSampleRate; ///< Destination sample rate.
+	double NomDstSampleRate; ///< Nominal destination sample rate, as passed
+		///< to the constructor.
 	double InitFracPos; ///< Initial fractional position, in samples, in the
 		///< range [0; 1).
 	int InitFracPosW; ///< Initial fractional position for whole-number
@@ -950,6 +966,10 @@ private:
 	int InStep; ///< Input whole-number stepping.
 	int OutStep; ///< Output whole-number stepping (corresponds to filter bank
 		///< size).
+	int InStepInt; ///< Whole number of input samples per output sample,
+		///< InStep / OutStep.
+	int InStepRem; ///< Remainder of InStep / OutStep, the filter bank index
+		///< step.
 	int LatencyLeft; ///< Input latency left to remove.
 	int BufLeft; ///< The number of samples left in the buffer to process.
 	int WritePos; ///< The current buffer write position. Incremented together
@@ -971,13 +991,17 @@ private:
 	CDSPFracDelayFilterBank* FilterBank; ///< Filter bank in use, may be
 		///< whole-number stepping filter bank or static bank.
 	bool IsWhole; ///< "True" if whole-number stepping is in use.
+	bool IsAsync; ///< "True" if the asynchronous mode is in use.
 
 	typedef double*( CDSPFracInterpolator :: *CConvolveFn )( double* op ); ///<
 		///< Convolution function type.
 	CConvolveFn convfn; ///< Convolution function in use.
 
 	/**
-	 * Convolution function for 0th order resampling.
+	 * Convolution function for 0th order resampling. This is the polyphase
+	 * filter used with whole-number stepping: the filter bank holds one
+	 * filter per output phase, and the exact rational position is advanced
+	 * by the integer quotient and remainder of InStep / OutStep.
 	 *
 	 * @param[out] op Output buffer.
 	 * @return Advanced "op" value.
@@ -988,7 +1012,8 @@ private:
 	double* convolve0( double* op )
 	{
 		const CDSPFracDelayFilterBank& fb = *FilterBank;
-		const int istep = InStep;
+		const int iincr = InStepInt;
+		const int irem = InStepRem;
 		const int ostep = OutStep;
 		int fpos = InPosFracW;
 		int rpos = ReadPos;
@@ -1000,30 +1025,49 @@ private:
 			const double* const rp = Buf + rpos;
 			int i;
 
+		// Two accumulators halve the dependency chain of the additions.
+
 		#if defined( R8B_SSE2 ) && !defined( __INTEL_COMPILER )
 
 			__m128d s = _mm_setzero_pd();
+			__m128d s2 = _mm_setzero_pd();
 
-			for( i = 0; i < fltlen; i += 2 )
+			for( i = 0; i + 4 <= fltlen; i += 4 )
 			{
-				const __m128d m = _mm_mul_pd( _mm_load_pd( ftp + i ),
-					_mm_loadu_pd( rp + i ));
+				s = _mm_add_pd( s, _mm_mul_pd( _mm_load_pd( ftp + i ),
+					_mm_loadu_pd( rp + i )));
+
+				s2 = _mm_add_pd( s2, _mm_mul_pd( _mm_load_pd( ftp + i + 2 ),
+					_mm_loadu_pd( rp + i + 2 )));
+			}
 
-				s = _mm_add_pd( s, m );
+			if( fltlen & 2 )
+			{
+				s = _mm_add_pd( s, _mm_mul_pd( _mm_load_pd( ftp + i ),
+					_mm_loadu_pd( rp + i )));
 			}
 
+			s = _mm_add_pd( s, s2 );
 			_mm_storel_pd( op, _mm_add_pd( s, _mm_shuffle_pd( s, s, 1 )));
 
 		#elif defined( R8B_NEON )
 
 			float64x2_t s = vdupq_n_f64( 0.0 );
+			float64x2_t s2 = vdupq_n_f64( 0.0 );
 
-			for( i = 0; i < fltlen; i += 2 )
+			for( i = 0; i + 4 <= fltlen; i += 4 )
 			{
 				s = vmlaq_f64( s, vld1q_f64( ftp + i ), vld1q_f64( rp + i ));
+				s2 = vmlaq_f64( s2, vld1q_f64( ftp + i + 2 ),
+					vld1q_f64( rp + i + 2 ));
 			}
 
-			*op = vaddvq_f64( s );
+			if( fltlen & 2 )
+			{
+				s = vmlaq_f64( s, vld1q_f64( ftp + i ), vld1q_f64( rp + i ));
+			}
+
+			*op = vaddvq_f64( vaddq_f64( s, s2 ));
 
 		#else // SIMD
 
@@ -1040,9 +1084,13 @@ private:
 
 			op++;
 
-			fpos += istep;
-			const int PosIncr = fpos / ostep;
-			fpos -= PosIncr * ostep;
+			// Branchless, as the phase wrap does not follow a predictable
+			// pattern.
+
+			fpos += irem;
+			const int w = ( fpos >= ostep );
+			fpos -= ostep & -w;
+			const int PosIncr = iincr + w;
 
 			rpos = ( rpos + PosIncr ) & BufLenMask;
 			bl -= PosIncr;
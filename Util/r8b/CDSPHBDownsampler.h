@@ -56,6 +56,40 @@ public:
 			&CDSPHBDownsampler :: convolve13,
 			&CDSPHBDownsampler :: convolve14 };
 
+		static const CConvolveFn FltConvFnScalar[ 14 ] = {
+			&CDSPHBDownsampler :: convolve1Scalar,
+			&CDSPHBDownsampler :: convolve2Scalar,
+			&CDSPHBDownsampler :: convolve3Scalar,
+			&CDSPHBDownsampler :: convolve4Scalar,
+			&CDSPHBDownsampler :: convolve5Scalar,
+			&CDSPHBDownsampler :: convolve6Scalar,
+			&CDSPHBDownsampler :: convolve7Scalar,
+			&CDSPHBDownsampler :: convolve8Scalar,
+			&CDSPHBDownsampler :: convolve9Scalar,
+			&CDSPHBDownsampler :: convolve10Scalar,
+			&CDSPHBDownsampler :: convolve11Scalar,
+			&CDSPHBDownsampler :: convolve12Scalar,
+			&CDSPHBDownsampler :: convolve13Scalar,
+			&CDSPHBDownsampler :: convolve14Scalar };
+
+	#if defined( R8B_AVX2 )
+		static const CConvolveFn FltConvFnAVX2[ 14 ] = {
+			&CDSPHBDownsampler :: convolveAVX2< 1 >,
+			&CDSPHBDownsampler :: convolveAVX2< 2 >,
+			&CDSPHBDownsampler :: convolveAVX2< 3 >,
+			&CDSPHBDownsampler :: convolveAVX2< 4 >,
+			&CDSPHBDownsampler :: convolveAVX2< 5 >,
+			&CDSPHBDownsampler :: convolveAVX2< 6 >,
+			&CDSPHBDownsampler :: convolveAVX2< 7 >,
+			&CDSPHBDownsampler :: convolveAVX2< 8 >,
+			&CDSPHBDownsampler :: convolveAVX2< 9 >,
+			&CDSPHBDownsampler :: convolveAVX2< 10 >,
+			&CDSPHBDownsampler :: convolveAVX2< 11 >,
+			&CDSPHBDownsampler :: convolveAVX2< 12 >,
+			&CDSPHBDownsampler :: convolveAVX2< 13 >,
+			&CDSPHBDownsampler :: convolveAVX2< 14 >};
+	#endif // defined( R8B_AVX2 )
+
 		const double* fltp0;
 		int fltt;
 		double att;
@@ -76,7 +110,25 @@ public:
 		fltp = alignptr( FltBuf, 16 );
 		memcpy( fltp, fltp0, fltt * sizeof( fltp[ 0 ]));
 
-		convfn = FltConvFn[ fltt - 1 ];
+		KernelSet = getHBKernelSet();
+
+		switch( KernelSet )
+		{
+			case hbksScalar:
+				convfn = FltConvFnScalar[ fltt - 1 ];
+				break;
+
+		#if defined( R8B_AVX2 )
+			case hbksAVX2:
+				convfn = FltConvFnAVX2[ fltt - 1 ];
+				break;
+		#endif // defined( R8B_AVX2 )
+
+			default:
+				convfn = FltConvFn[ fltt - 1 ];
+				break;
+		}
+
 		fll = fltt;
 		fl2 = fltt - 1;
 		flo = fll + fl2;
@@ -90,12 +142,21 @@ public:
 
 		R8BASSERT( Latency >= 0 );
 
-		R8BCONSOLE( "CDSPHBDownsampler: taps=%i third=%i att=%.1f io=1/2\n",
-			fltt, (int) IsThird, att );
+		R8BCONSOLE( "CDSPHBDownsampler: taps=%i third=%i att=%.1f io=1/2 "
+			"ks=%i\n", fltt, (int) IsThird, att, (int) KernelSet );
 
 		clear();
 	}
 
+	/**
+	 * @return The half-band kernel set in use.
+	 */
+
+	EHBKernelSet getKernelSet() const
+	{
+		return( KernelSet );
+	}
+
 	virtual int getInLenBeforeOutPos( const int ReqOutPos ) const
 	{
 		return( flo + (int) (( Latency + LatencyFrac + ReqOutPos ) * 2.0 ));
@@ -271,6 +332,7 @@ private:
 		const double* const rp02, int rpos ); ///<
 		///< Convolution function type.
 	CConvolveFn convfn; ///< Convolution function in use.
+	EHBKernelSet KernelSet; ///< Kernel set "convfn" belongs to.
 
 #define R8BHBC1( fn ) \
 	static void fn( double* op, double* const opend, const double* const flt, \
@@ -289,8 +351,90 @@ private:
 
 #include "CDSPHBDownsampler.inc"
 
+#undef R8BHBC1
+
+	// Scalar kernels, always available as the reference implementation.
+
+#define R8BHBC1( fn ) \
+	static void fn ## Scalar( double* op, double* const opend, \
+		const double* const flt, const double* const rp01, \
+		const double* const rp02, int rpos ) \
+	{ \
+		while( op != opend ) \
+		{ \
+			const double* const rp1 = rp01 + rpos; \
+			const double* const rp = rp02 + rpos;
+
+#pragma push_macro( "R8B_SSE2" )
+#pragma push_macro( "R8B_NEON" )
+#undef R8B_SSE2
+#undef R8B_NEON
+
+#include "CDSPHBDownsampler.inc"
+
+#pragma pop_macro( "R8B_NEON" )
+#pragma pop_macro( "R8B_SSE2" )
+
 #undef R8BHBC1
 #undef R8BHBC2
+
+#if defined( R8B_AVX2 )
+
+	/**
+	 * AVX2+FMA convolution kernel, produces 4 output samples per iteration.
+	 * The ring buffers' overrun areas make reads past BufLen valid as long
+	 * as the 4 read positions do not wrap.
+	 *
+	 * @tparam fltt Filter's half-length, in taps.
+	 */
+
+	template< int fltt >
+	R8B_AVX2_FN static void convolveAVX2( double* op, double* const opend,
+		const double* const flt, const double* const rp01,
+		const double* const rp02, int rpos )
+	{
+		while( op != opend )
+		{
+			const double* const rp1 = rp01 + rpos;
+			const double* const rp = rp02 + rpos;
+
+			if( opend - op >= 4 && rpos <= BufLen - 4 )
+			{
+				__m256d s = _mm256_mul_pd( _mm256_broadcast_sd( flt ),
+					_mm256_add_pd( _mm256_loadu_pd( rp + 1 ),
+					_mm256_loadu_pd( rp )));
+
+				for( int i = 1; i < fltt; i++ )
+				{
+					s = _mm256_fmadd_pd( _mm256_broadcast_sd( flt + i ),
+						_mm256_add_pd( _mm256_loadu_pd( rp + i + 1 ),
+						_mm256_loadu_pd( rp - i )), s );
+				}
+
+				_mm256_storeu_pd( op,
+					_mm256_add_pd( _mm256_loadu_pd( rp1 ), s ));
+
+				rpos = ( rpos + 4 ) & BufLenMask;
+				op += 4;
+			}
+			else
+			{
+				double s = flt[ 0 ] * ( rp[ 1 ] + rp[ 0 ]);
+
+				for( int i = 1; i < fltt; i++ )
+				{
+					s += flt[ i ] * ( rp[ i + 1 ] + rp[ -i ]);
+				}
+
+				op[ 0 ] = rp1[ 0 ] + s;
+
+				rpos = ( rpos + 1 ) & BufLenMask;
+				op++;
+			}
+		}
+	}
+
+#endif // defined( R8B_AVX2 )
 };
 
 // ---------------------------------------------------------------------------
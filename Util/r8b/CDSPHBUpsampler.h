@@ -19,6 +19,73 @@
 
 namespace r8b {
 
+/**
+ * Half-band convolution kernel sets. The kernel set is selected when a
+ * half-band upsampler or downsampler object is constructed.
+ */
+
+enum EHBKernelSet
+{
+	hbksScalar = 0, ///< Portable scalar kernels.
+	hbksSIMD, ///< SSE2 or NEON kernels, chosen at compile-time; same as
+		///< hbksScalar if neither is available.
+	hbksAVX2 ///< AVX2+FMA kernels, if supported by the CPU at run-time.
+};
+
+/**
+ * @return The fastest half-band kernel set available on the current CPU.
+ */
+
+inline EHBKernelSet getBestHBKernelSet()
+{
+	return( isAVX2Available() ? hbksAVX2 : hbksSIMD );
+}
+
+/**
+ * @return Reference to the forced kernel set variable, -1 if not forced.
+ */
+
+inline int& getHBKernelSetVar()
+{
+	static int KernelSet = -1;
+
+	return( KernelSet );
+}
+
+/**
+ * @return The half-band kernel set used by newly-created objects.
+ */
+
+inline EHBKernelSet getHBKernelSet()
+{
+	const int ks = getHBKernelSetVar();
+
+	return( ks < 0 ? getBestHBKernelSet() : (EHBKernelSet) ks );
+}
+
+/**
+ * Function forces the half-band kernel set used by newly-created objects,
+ * for testing and benchmarking. Sets not available on the current CPU are
+ * replaced by the best available one. This function is not thread-safe and
+ * should not be called while resamplers are being created.
+ *
+ * @param ks Kernel set to use.
+ */
+
+inline void setHBKernelSet( const EHBKernelSet ks )
+{
+	getHBKernelSetVar() = min( ks, getBestHBKernelSet() );
+}
+
+/**
+ * Function restores automatic half-band kernel set selection.
+ */
+
+inline void resetHBKernelSet()
+{
+	getHBKernelSetVar() = -1;
+}
+
 /**
  * @brief Half-band upsampling class.
  *
@@ -582,6 +649,40 @@ public:
 			&CDSPHBUpsampler :: convolve11, &CDSPHBUpsampler :: convolve12,
 			&CDSPHBUpsampler :: convolve13, &CDSPHBUpsampler :: convolve14 };
 
+		static const CConvolveFn FltConvFnScalar[ 14 ] = {
+			&CDSPHBUpsampler :: convolve1Scalar,
+			&CDSPHBUpsampler :: convolve2Scalar,
+			&CDSPHBUpsampler :: convolve3Scalar,
+			&CDSPHBUpsampler :: convolve4Scalar,
+			&CDSPHBUpsampler :: convolve5Scalar,
+			&CDSPHBUpsampler :: convolve6Scalar,
+			&CDSPHBUpsampler :: convolve7Scalar,
+			&CDSPHBUpsampler :: convolve8Scalar,
+			&CDSPHBUpsampler :: convolve9Scalar,
+			&CDSPHBUpsampler :: convolve10Scalar,
+			&CDSPHBUpsampler :: convolve11Scalar,
+			&CDSPHBUpsampler :: convolve12Scalar,
+			&CDSPHBUpsampler :: convolve13Scalar,
+			&CDSPHBUpsampler :: convolve14Scalar };
+
+	#if defined( R8B_AVX2 )
+		static const CConvolveFn FltConvFnAVX2[ 14 ] = {
+			&CDSPHBUpsampler :: convolveAVX2< 1 >,
+			&CDSPHBUpsampler :: convolveAVX2< 2 >,
+			&CDSPHBUpsampler :: convolveAVX2< 3 >,
+			&CDSPHBUpsampler :: convolveAVX2< 4 >,
+			&CDSPHBUpsampler :: convolveAVX2< 5 >,
+			&CDSPHBUpsampler :: convolveAVX2< 6 >,
+			&CDSPHBUpsampler :: convolveAVX2< 7 >,
+			&CDSPHBUpsampler :: convolveAVX2< 8 >,
+			&CDSPHBUpsampler :: convolveAVX2< 9 >,
+			&CDSPHBUpsampler :: convolveAVX2< 10 >,
+			&CDSPHBUpsampler :: convolveAVX2< 11 >,
+			&CDSPHBUpsampler :: convolveAVX2< 12 >,
+			&CDSPHBUpsampler :: convolveAVX2< 13 >,
+			&CDSPHBUpsampler :: convolveAVX2< 14 >};
+	#endif // defined( R8B_AVX2 )
+
 		const double* fltp0;
 		int fltt;
 		double att;
@@ -600,7 +701,25 @@ public:
 		fltp = alignptr( FltBuf, 16 );
 		memcpy( fltp, fltp0, fltt * sizeof( fltp[ 0 ]));
 
-		convfn = FltConvFn[ fltt - 1 ];
+		KernelSet = getHBKernelSet();
+
+		switch( KernelSet )
+		{
+			case hbksScalar:
+				convfn = FltConvFnScalar[ fltt - 1 ];
+				break;
+
+		#if defined( R8B_AVX2 )
+			case hbksAVX2:
+				convfn = FltConvFnAVX2[ fltt - 1 ];
+				break;
+		#endif // defined( R8B_AVX2 )
+
+			default:
+				convfn = FltConvFn[ fltt - 1 ];
+				break;
+		}
+
 		fll = fltt - 1;
 		fl2 = fltt;
 		flo = fll + fl2;
@@ -623,11 +742,21 @@ public:
 		}
 
 		R8BCONSOLE( "CDSPHBUpsampler: sti=%i third=%i taps=%i att=%.1f "
-			"io=2/1\n", SteepIndex, (int) IsThird, fltt, att );
+			"io=2/1 ks=%i\n", SteepIndex, (int) IsThird, fltt, att,
+			(int) KernelSet );
 
 		clear();
 	}
 
+	/**
+	 * @return The half-band kernel set in use.
+	 */
+
+	EHBKernelSet getKernelSet() const
+	{
+		return( KernelSet );
+	}
+
 	virtual int getInLenBeforeOutPos( const int ReqOutPos ) const
 	{
 		return( fl2 + (int) (( Latency + LatencyFrac + ReqOutPos ) * 0.5 ));
@@ -664,7 +793,12 @@ public:
 		}
 
 		WritePos = 0;
-		ReadPos = flb; // Set "read" position to account for filter's latency.
+
+		// Set "read" position to account for filter's latency. With a 1-tap
+		// filter "flb" equals BufLen, which must wrap to 0, or the first
+		// cycle reads beyond the mirrored overrun area.
+
+		ReadPos = flb & BufLenMask;
 
 		memset( &Buf[ ReadPos ], 0, ( BufLen - flb ) * sizeof( Buf[ 0 ]));
 	}
@@ -766,6 +900,7 @@ private:
 		const double* const flt, const double* const rp0, int rpos ); ///<
 		///< Convolution function type.
 	CConvolveFn convfn; ///< Convolution function in use.
+	EHBKernelSet KernelSet; ///< Kernel set "convfn" belongs to.
 
 #define R8BHBC1( fn ) \
 	static void fn( double* op, double* const opend, const double* const flt, \
@@ -784,8 +919,93 @@ private:
 
 #include "CDSPHBUpsampler.inc"
 
+#undef R8BHBC1
+
+	// Scalar kernels, always available as the reference implementation.
+
+#define R8BHBC1( fn ) \
+	static void fn ## Scalar( double* op, double* const opend, \
+		const double* const flt, const double* const rp0, int rpos ) \
+	{ \
+		while( op != opend ) \
+		{ \
+			const double* const rp = rp0 + rpos; \
+			op[ 0 ] = rp[ 0 ];
+
+#pragma push_macro( "R8B_SSE2" )
+#pragma push_macro( "R8B_NEON" )
+#undef R8B_SSE2
+#undef R8B_NEON
+
+#include "CDSPHBUpsampler.inc"
+
+#pragma pop_macro( "R8B_NEON" )
+#pragma pop_macro( "R8B_SSE2" )
+
 #undef R8BHBC1
 #undef R8BHBC2
+
+#if defined( R8B_AVX2 )
+
+	/**
+	 * AVX2+FMA convolution kernel, produces 4 output sample pairs per
+	 * iteration. The ring buffer's overrun area makes reads past BufLen valid
+	 * as long as the 4 read positions do not wrap.
+	 *
+	 * @tparam fltt Filter's half-length, in taps.
+	 */
+
+	template< int fltt >
+	R8B_AVX2_FN static void convolveAVX2( double* op, double* const opend,
+		const double* const flt, const double* const rp0, int rpos )
+	{
+		while( op != opend )
+		{
+			const double* const rp = rp0 + rpos;
+
+			if( opend - op >= 8 && rpos <= BufLen - 4 )
+			{
+				__m256d s = _mm256_mul_pd( _mm256_broadcast_sd( flt ),
+					_mm256_add_pd( _mm256_loadu_pd( rp + 1 ),
+					_mm256_loadu_pd( rp )));
+
+				for( int i = 1; i < fltt; i++ )
+				{
+					s = _mm256_fmadd_pd( _mm256_broadcast_sd( flt + i ),
+						_mm256_add_pd( _mm256_loadu_pd( rp + i + 1 ),
+						_mm256_loadu_pd( rp - i )), s );
+				}
+
+				const __m256d e = _mm256_loadu_pd( rp );
+				const __m256d lo = _mm256_unpacklo_pd( e, s );
+				const __m256d hi = _mm256_unpackhi_pd( e, s );
+
+				_mm256_storeu_pd( op, _mm256_permute2f128_pd( lo, hi, 0x20 ));
+				_mm256_storeu_pd( op + 4,
+					_mm256_permute2f128_pd( lo, hi, 0x31 ));
+
+				rpos = ( rpos + 4 ) & BufLenMask;
+				op += 8;
+			}
+			else
+			{
+				double s = flt[ 0 ] * ( rp[ 1 ] + rp[ 0 ]);
+
+				for( int i = 1; i < fltt; i++ )
+				{
+					s += flt[ i ] * ( rp[ i + 1 ] + rp[ -i ]);
+				}
+
+				op[ 0 ] = rp[ 0 ];
+				op[ 1 ] = s;
+
+				rpos = ( rpos + 1 ) & BufLenMask;
+				op += 2;
+			}
+		}
+	}
+
+#endif // defined( R8B_AVX2 )
 };
 
 // ---------------------------------------------------------------------------
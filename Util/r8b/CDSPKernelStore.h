@@ -0,0 +1,833 @@
+//$ nobt
+//$ nocpp
+
+/**
+ * @file CDSPKernelStore.h
+ *
+ * @brief Persistent store of designed filter kernels.
+ *
+ * This file includes the on-disk store that keeps designed FIR filter kernels
+ * and fractional delay filter banks between application runs.
+ *
+ * r8brain-free-src Copyright (c) 2013-2022 Aleksey Vaneev
+ * See the "LICENSE" file for license.
+ */
+
+#ifndef R8B_CDSPKERNELSTORE_INCLUDED
+#define R8B_CDSPKERNELSTORE_INCLUDED
+
+#include <stdio.h>
+#include "CDSPObjCache.h"
+
+#if !defined( _WIN32 )
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif // !defined( _WIN32 )
+
+namespace r8b {
+
+/**
+ * Enumeration of kernel kinds kept in the kernel store.
+ */
+
+enum EDSPKernelKind
+{
+	kkFIRFilter = 1, ///< Low-pass FIR filter kernel, in time domain, before
+		///< gain normalization, followed by the filter's latency.
+	kkFracDelayFilterBank ///< Fractional delay filter bank's table.
+};
+
+/**
+ * @brief Kernel store statistics.
+ */
+
+struct CKernelStoreStats
+{
+	long long Loads; ///< The number of kernels read from the store.
+	long long Stores; ///< The number of designed kernels added to the store.
+	int KernelCount; ///< The number of kernels in the store now.
+};
+
+/**
+ * @brief Persistent filter kernel store class.
+ *
+ * The filter and filter bank caches consult this store before designing a
+ * kernel, and add the kernels they design to it. The store is inactive until
+ * the open() function is called, and the kernels designed since are written
+ * to disk by the save() function, usually called after the application has
+ * created its resamplers.
+ *
+ * The store file is memory-mapped on open. It begins with a header, followed
+ * by an array of records and then by the records' keys and kernel data. Each
+ * record holds the kernel's kind, its exact design parameters as the key, and
+ * a hash of its data which is verified on load. Kernel data is aligned to 64
+ * bytes within the file. The header records the byte order, the format
+ * version and the build options that affect kernel design; a file that does
+ * not match the current build, or that is damaged, is ignored and replaced on
+ * the next save.
+ */
+
+class CDSPKernelStore : public R8B_BASECLASS
+{
+	R8BNOCTOR( CDSPKernelStore );
+
+public:
+	/**
+	 * Function opens the kernel store file and maps its kernels. A file that
+	 * does not exist yet is created by the save() function. A previously
+	 * opened store is closed first, without saving.
+	 *
+	 * @param FilePath Path to the store file.
+	 * @return "True" if existing kernels were mapped from the file.
+	 */
+
+	static bool open( const char* const FilePath )
+	{
+		R8BSYNC( StateSync );
+
+		State.close();
+		const size_t l = strlen( FilePath );
+		State.FilePath.alloc( (int) l + 1 );
+		memcpy( &State.FilePath[ 0 ], FilePath, l + 1 );
+		State.IsOpen = true;
+
+		return( State.map() );
+	}
+
+	/**
+	 * Function writes all kernels, the mapped and the newly designed ones, to
+	 * the store file. The file is written under a temporary name unique to
+	 * the process and call, and then renamed, so other processes never see a
+	 * partially written file.
+	 *
+	 * @return "True" if the file was written, or if there were no new
+	 * kernels to write.
+	 */
+
+	static bool save()
+	{
+		R8BSYNC( StateSync );
+
+		if( !State.IsOpen )
+		{
+			return( false );
+		}
+
+		if( !State.IsDirty )
+		{
+			return( true );
+		}
+
+		return( State.save() );
+	}
+
+	/**
+	 * Function closes the store without saving. Kernels designed
+	 * afterwards are not stored.
+	 */
+
+	static void close()
+	{
+		R8BSYNC( StateSync );
+
+		State.close();
+	}
+
+	/**
+	 * @return "True" if the store is open.
+	 */
+
+	static bool isOpen()
+	{
+		R8BSYNC( StateSync );
+
+		return( State.IsOpen );
+	}
+
+	/**
+	 * Function copies a stored kernel to the specified buffer.
+	 *
+	 * @param Kind Kernel's kind.
+	 * @param Key Kernel's design parameters.
+	 * @param KeyLen The length of Key, in bytes.
+	 * @param[out] Data Output buffer, DataLen elements long.
+	 * @param DataLen Kernel's length, in "double" elements.
+	 * @return "True" if the kernel was found and copied.
+	 */
+
+	static bool load( const EDSPKernelKind Kind, const void* const Key,
+		const int KeyLen, double* const Data, const int DataLen )
+	{
+		R8BSYNC( StateSync );
+
+		if( !State.IsOpen )
+		{
+			return( false );
+		}
+
+		CEntry* const e = State.find( Kind, Key, KeyLen );
+
+		if( e == NULL || e -> DataLen != DataLen )
+		{
+			return( false );
+		}
+
+		if( !e -> IsVerified )
+		{
+			if( calcObjHash( e -> Data, DataLen * sizeof( double )) !=
+				e -> DataHash )
+			{
+				// Damaged kernel, let it be designed and stored anew.
+
+				State.deleteEntry( e );
+				return( false );
+			}
+
+			e -> IsVerified = true;
+		}
+
+		memcpy( Data, e -> Data, DataLen * sizeof( double ));
+		State.Loads++;
+
+		return( true );
+	}
+
+	/**
+	 * Function adds a designed kernel to the store, if the store is open.
+	 *
+	 * @param Kind Kernel's kind.
+	 * @param Key Kernel's design parameters.
+	 * @param KeyLen The length of Key, in bytes.
+	 * @param Data Kernel data.
+	 * @param DataLen Kernel's length, in "double" elements.
+	 */
+
+	static void store( const EDSPKernelKind Kind, const void* const Key,
+		const int KeyLen, const double* const Data, const int DataLen )
+	{
+		R8BSYNC( StateSync );
+
+		if( !State.IsOpen || State.find( Kind, Key, KeyLen ) != NULL )
+		{
+			return;
+		}
+
+		CEntry* const e = new CEntry();
+		e -> Kind = Kind;
+		e -> KeyLen = KeyLen;
+		e -> DataLen = DataLen;
+		e -> KeyHash = calcObjHash( Key, KeyLen );
+		e -> DataHash = calcObjHash( Data, DataLen * sizeof( double ));
+		e -> IsVerified = true;
+		e -> KeyBuf.alloc( KeyLen );
+		e -> DataBuf.alloc( DataLen );
+		memcpy( &e -> KeyBuf[ 0 ], Key, KeyLen );
+		memcpy( &e -> DataBuf[ 0 ], Data, DataLen * sizeof( double ));
+		e -> Key = &e -> KeyBuf[ 0 ];
+		e -> Data = &e -> DataBuf[ 0 ];
+		e -> Next = State.Entries;
+
+		State.Entries = e;
+		State.KernelCount++;
+		State.Stores++;
+		State.IsDirty = true;
+	}
+
+	/**
+	 * @return Store statistics.
+	 */
+
+	static CKernelStoreStats getStats()
+	{
+		R8BSYNC( StateSync );
+
+		CKernelStoreStats s;
+		s.Loads = State.Loads;
+		s.Stores = State.Stores;
+		s.KernelCount = State.KernelCount;
+
+		return( s );
+	}
+
+private:
+	static const uint32_t FileMagic = 0x4B423852; ///< "R8BK", little-endian.
+	static const uint32_t FileVersion = 1; ///< File format version.
+	static const int DataAlign = 64; ///< Kernel data alignment in the file.
+
+	/**
+	 * @brief Store file's header.
+	 */
+
+	struct CFileHeader
+	{
+		uint32_t Magic; ///< FileMagic.
+		uint32_t Version; ///< FileVersion.
+		uint32_t BuildFlags; ///< getBuildFlags() of the writing build.
+		uint32_t RecCount; ///< The number of records that follow.
+		uint64_t FileSize; ///< File's size, in bytes.
+		uint64_t Reserved[ 5 ]; ///< Zeros.
+	};
+
+	/**
+	 * @brief Store file's kernel record.
+	 */
+
+	struct CFileRecord
+	{
+		uint32_t Kind; ///< EDSPKernelKind.
+		uint32_t KeyHash; ///< Hash of the key.
+		uint32_t KeyLen; ///< Key's length, in bytes.
+		uint32_t DataLen; ///< Kernel's length, in "double" elements.
+		uint64_t KeyOffset; ///< Key's offset from the file's start.
+		uint64_t DataOffset; ///< Kernel data's offset from the file's start.
+		uint32_t DataHash; ///< Hash of the kernel data.
+		uint32_t Reserved; ///< Zero.
+	};
+
+	/**
+	 * @brief Kernel entry, either mapped from the file or newly designed.
+	 */
+
+	class CEntry : public R8B_BASECLASS
+	{
+		R8BNOCTOR( CEntry );
+
+	public:
+		CEntry()
+			: Next( NULL )
+			, IsMapped( false )
+			, Key( NULL )
+			, Data( NULL )
+		{
+		}
+
+		CEntry* Next; ///< Next entry in the list.
+		int Kind; ///< EDSPKernelKind.
+		int KeyLen; ///< Key's length, in bytes.
+		int DataLen; ///< Kernel's length, in "double" elements.
+		uint32_t KeyHash; ///< Hash of the key.
+		uint32_t DataHash; ///< Hash of the kernel data.
+		bool IsVerified; ///< "True" if DataHash was checked.
+		bool IsMapped; ///< "True" if Key and Data point into the mapped
+			///< file.
+		const uint8_t* Key; ///< Key, in KeyBuf or in the mapped file.
+		const double* Data; ///< Kernel data, in DataBuf or in the mapped
+			///< file.
+		CFixedBuffer< uint8_t > KeyBuf; ///< Key of a newly designed kernel.
+		CFixedBuffer< double > DataBuf; ///< Data of a newly designed kernel.
+	};
+
+	/**
+	 * @brief Store's state, its destructor unmaps the file on exit.
+	 */
+
+	class CState
+	{
+		R8BNOCTOR( CState );
+
+	public:
+		CFixedBuffer< char > FilePath; ///< Store file's path.
+		bool IsOpen; ///< "True" if the store is open.
+		bool IsDirty; ///< "True" if kernels were added since the last save.
+		CEntry* Entries; ///< All kernels.
+		int KernelCount; ///< The number of entries.
+		long long Loads; ///< Load counter.
+		long long Stores; ///< Store counter.
+		const uint8_t* MapData; ///< Mapped file, NULL if not mapped.
+		size_t MapSize; ///< Mapped file's size, in bytes.
+
+		CState()
+			: IsOpen( false )
+			, IsDirty( false )
+			, Entries( NULL )
+			, KernelCount( 0 )
+			, Loads( 0 )
+			, Stores( 0 )
+			, MapData( NULL )
+			, MapSize( 0 )
+		{
+		}
+
+		~CState()
+		{
+			close();
+		}
+
+		/**
+		 * Function deletes all entries and unmaps the file.
+		 */
+
+		void close()
+		{
+			deleteEntries( false );
+			unmap();
+
+			IsOpen = false;
+			IsDirty = false;
+		}
+
+		/**
+		 * Function returns the entry with the specified key, or NULL.
+		 */
+
+		CEntry* find( const int Kind, const void* const Key,
+			const int KeyLen ) const
+		{
+			const uint32_t h = calcObjHash( Key, KeyLen );
+			CEntry* e = Entries;
+
+			while( e != NULL )
+			{
+				if( e -> KeyHash == h && e -> Kind == Kind &&
+					e -> KeyLen == KeyLen &&
+					memcmp( e -> Key, Key, KeyLen ) == 0 )
+				{
+					return( e );
+				}
+
+				e = e -> Next;
+			}
+
+			return( NULL );
+		}
+
+		/**
+		 * Function removes the specified entry and deletes it.
+		 */
+
+		void deleteEntry( CEntry* const de )
+		{
+			CEntry** pe = &Entries;
+
+			while( *pe != de )
+			{
+				pe = &( *pe ) -> Next;
+			}
+
+			*pe = de -> Next;
+			delete de;
+			KernelCount--;
+			IsDirty = true;
+		}
+
+		/**
+		 * Function maps the store file and adds its records as entries.
+		 *
+		 * @return "True" if the file was mapped and is valid.
+		 */
+
+		bool map()
+		{
+			#if defined( _WIN32 )
+
+				const HANDLE f = CreateFileA( &FilePath[ 0 ], GENERIC_READ,
+					FILE_SHARE_READ, NULL, OPEN_EXISTING,
+					FILE_ATTRIBUTE_NORMAL, NULL );
+
+				if( f == INVALID_HANDLE_VALUE )
+				{
+					return( false );
+				}
+
+				LARGE_INTEGER fs;
+
+				if( GetFileSizeEx( f, &fs ) &&
+					fs.QuadPart >= (LONGLONG) sizeof( CFileHeader ))
+				{
+					const HANDLE m = CreateFileMappingA( f, NULL,
+						PAGE_READONLY, 0, 0, NULL );
+
+					if( m != NULL )
+					{
+						MapData = (const uint8_t*) MapViewOfFile( m,
+							FILE_MAP_READ, 0, 0, 0 );
+
+						MapSize = (size_t) fs.QuadPart;
+						CloseHandle( m );
+					}
+				}
+
+				CloseHandle( f );
+
+			#else // defined( _WIN32 )
+
+				const int f = ::open( &FilePath[ 0 ], O_RDONLY );
+
+				if( f == -1 )
+				{
+					return( false );
+				}
+
+				struct stat st;
+
+				if( fstat( f, &st ) == 0 &&
+					st.st_size >= (off_t) sizeof( CFileHeader ))
+				{
+					void* const p = mmap( NULL, (size_t) st.st_size,
+						PROT_READ, MAP_PRIVATE, f, 0 );
+
+					if( p != MAP_FAILED )
+					{
+						MapData = (const uint8_t*) p;
+						MapSize = (size_t) st.st_size;
+					}
+				}
+
+				::close( f );
+
+			#endif // defined( _WIN32 )
+
+			if( MapData == NULL )
+			{
+				return( false );
+			}
+
+			if( !addMappedEntries() )
+			{
+				deleteEntries( true );
+				unmap();
+
+				return( false );
+			}
+
+			return( true );
+		}
+
+		/**
+		 * Function writes all entries to the store file. The entries are
+		 * copied out of the mapped file, which is unmapped before it is
+		 * replaced.
+		 *
+		 * @return "True" on success.
+		 */
+
+		bool save()
+		{
+			// The temporary file's name is unique to this process and call,
+			// so concurrent saves of the same store by other processes or
+			// other store objects don't write into each other's file.
+
+			static std::atomic< unsigned > TmpCounter( 0 );
+
+			#if defined( _WIN32 )
+				const unsigned long pid = GetCurrentProcessId();
+			#else // defined( _WIN32 )
+				const unsigned long pid = (unsigned long) getpid();
+			#endif // defined( _WIN32 )
+
+			const int tl = (int) strlen( &FilePath[ 0 ]) + 48;
+			CFixedBuffer< char > TmpPath( tl );
+			snprintf( &TmpPath[ 0 ], tl, "%s.%lu.%u.tmp", &FilePath[ 0 ], pid,
+				TmpCounter.fetch_add( 1 ));
+
+			if( !write( &TmpPath[ 0 ]))
+			{
+				remove( &TmpPath[ 0 ]);
+				return( false );
+			}
+
+			// Make the entries own their data, so the file can be replaced
+			// and mapped anew.
+
+			CEntry* e = Entries;
+
+			while( e != NULL )
+			{
+				if( e -> IsMapped )
+				{
+					e -> KeyBuf.alloc( e -> KeyLen );
+					e -> DataBuf.alloc( e -> DataLen );
+					memcpy( &e -> KeyBuf[ 0 ], e -> Key, e -> KeyLen );
+					memcpy( &e -> DataBuf[ 0 ], e -> Data,
+						e -> DataLen * sizeof( double ));
+
+					e -> Key = &e -> KeyBuf[ 0 ];
+					e -> Data = &e -> DataBuf[ 0 ];
+					e -> IsMapped = false;
+				}
+
+				e = e -> Next;
+			}
+
+			unmap();
+
+			#if defined( _WIN32 )
+				const bool IsRenamed = ( MoveFileExA( &TmpPath[ 0 ],
+					&FilePath[ 0 ], MOVEFILE_REPLACE_EXISTING ) != 0 );
+			#else // defined( _WIN32 )
+				const bool IsRenamed = ( rename( &TmpPath[ 0 ],
+					&FilePath[ 0 ]) == 0 );
+			#endif // defined( _WIN32 )
+
+			if( !IsRenamed )
+			{
+				remove( &TmpPath[ 0 ]);
+				return( false );
+			}
+
+			IsDirty = false;
+
+			return( true );
+		}
+
+	private:
+		/**
+		 * Function validates the mapped file and adds its records as
+		 * entries that point into the mapping.
+		 *
+		 * @return "True" if the file is valid.
+		 */
+
+		bool addMappedEntries()
+		{
+			const CFileHeader& hdr = *(const CFileHeader*) MapData;
+
+			if( hdr.Magic != FileMagic || hdr.Version != FileVersion ||
+				hdr.BuildFlags != getBuildFlags() ||
+				hdr.FileSize != MapSize ||
+				hdr.RecCount > ( MapSize - sizeof( CFileHeader )) /
+				sizeof( CFileRecord ))
+			{
+				return( false );
+			}
+
+			const CFileRecord* const recs =
+				(const CFileRecord*) ( MapData + sizeof( CFileHeader ));
+
+			uint32_t i;
+
+			for( i = 0; i < hdr.RecCount; i++ )
+			{
+				const CFileRecord& r = recs[ i ];
+
+				if( r.KeyOffset > MapSize || r.KeyLen > MapSize - r.KeyOffset ||
+					r.DataOffset > MapSize || r.DataOffset % DataAlign != 0 ||
+					r.DataLen > ( MapSize - r.DataOffset ) / sizeof( double ))
+				{
+					return( false );
+				}
+
+				CEntry* const e = new CEntry();
+				e -> Kind = (int) r.Kind;
+				e -> KeyLen = (int) r.KeyLen;
+				e -> DataLen = (int) r.DataLen;
+				e -> KeyHash = r.KeyHash;
+				e -> DataHash = r.DataHash;
+				e -> IsVerified = false;
+				e -> IsMapped = true;
+				e -> Key = MapData + r.KeyOffset;
+				e -> Data = (const double*) ( MapData + r.DataOffset );
+				e -> Next = Entries;
+
+				Entries = e;
+				KernelCount++;
+			}
+
+			return( true );
+		}
+
+		/**
+		 * Function writes all entries to the specified file.
+		 *
+		 * @return "True" on success.
+		 */
+
+		bool write( const char* const Path ) const
+		{
+			FILE* const f = fopen( Path, "wb" );
+
+			if( f == NULL )
+			{
+				return( false );
+			}
+
+			CFileHeader hdr;
+			memset( &hdr, 0, sizeof( hdr ));
+			hdr.Magic = FileMagic;
+			hdr.Version = FileVersion;
+			hdr.BuildFlags = getBuildFlags();
+			hdr.RecCount = (uint32_t) KernelCount;
+
+			// Lay out the keys after the records, and the data after the
+			// keys.
+
+			uint64_t Offset = sizeof( CFileHeader ) +
+				sizeof( CFileRecord ) * (uint64_t) KernelCount;
+
+			const CEntry* e = Entries;
+
+			while( e != NULL )
+			{
+				Offset += e -> KeyLen;
+				e = e -> Next;
+			}
+
+			uint64_t KeyOffset = sizeof( CFileHeader ) +
+				sizeof( CFileRecord ) * (uint64_t) KernelCount;
+
+			const uint64_t DataStart = alignOffset( Offset );
+			uint64_t DataOffset = DataStart;
+			bool IsOk = true;
+
+			IsOk = IsOk && fseek( f, sizeof( CFileHeader ), SEEK_SET ) == 0;
+			e = Entries;
+
+			while( e != NULL )
+			{
+				CFileRecord r;
+				memset( &r, 0, sizeof( r ));
+				r.Kind = (uint32_t) e -> Kind;
+				r.KeyHash = e -> KeyHash;
+				r.KeyLen = (uint32_t) e -> KeyLen;
+				r.DataLen = (uint32_t) e -> DataLen;
+				r.KeyOffset = KeyOffset;
+				r.DataOffset = DataOffset;
+				r.DataHash = e -> DataHash;
+
+				IsOk = IsOk && fwrite( &r, sizeof( r ), 1, f ) == 1;
+				KeyOffset += e -> KeyLen;
+				DataOffset = alignOffset( DataOffset +
+					e -> DataLen * sizeof( double ));
+
+				e = e -> Next;
+			}
+
+			e = Entries;
+
+			while( e != NULL )
+			{
+				IsOk = IsOk && fwrite( e -> Key, 1, e -> KeyLen, f ) ==
+					(size_t) e -> KeyLen;
+
+				e = e -> Next;
+			}
+
+			static const uint8_t Zeros[ DataAlign ] = { 0 };
+			IsOk = IsOk && writePadding( f, Offset, DataStart, Zeros );
+			Offset = DataStart;
+			e = Entries;
+
+			while( e != NULL )
+			{
+				IsOk = IsOk && fwrite( e -> Data, sizeof( double ),
+					e -> DataLen, f ) == (size_t) e -> DataLen;
+
+				Offset += e -> DataLen * sizeof( double );
+				const uint64_t NextOffset = alignOffset( Offset );
+				IsOk = IsOk && writePadding( f, Offset, NextOffset, Zeros );
+				Offset = NextOffset;
+
+				e = e -> Next;
+			}
+
+			// The header is written last, so that a file truncated by a
+			// failed write is never accepted.
+
+			hdr.FileSize = Offset;
+			IsOk = IsOk && fseek( f, 0, SEEK_SET ) == 0;
+			IsOk = IsOk && fwrite( &hdr, sizeof( hdr ), 1, f ) == 1;
+
+			return( fclose( f ) == 0 && IsOk );
+		}
+
+		/**
+		 * Function deletes entries.
+		 *
+		 * @param OnlyMapped "True" if only the entries pointing into the
+		 * mapped file should be deleted.
+		 */
+
+		void deleteEntries( const bool OnlyMapped )
+		{
+			CEntry** pe = &Entries;
+
+			while( *pe != NULL )
+			{
+				CEntry* const e = *pe;
+
+				if( OnlyMapped && !e -> IsMapped )
+				{
+					pe = &e -> Next;
+				}
+				else
+				{
+					*pe = e -> Next;
+					delete e;
+					KernelCount--;
+				}
+			}
+		}
+
+		/**
+		 * Function unmaps the store file, if mapped.
+		 */
+
+		void unmap()
+		{
+			if( MapData == NULL )
+			{
+				return;
+			}
+
+			#if defined( _WIN32 )
+				UnmapViewOfFile( MapData );
+			#else // defined( _WIN32 )
+				munmap( (void*) MapData, MapSize );
+			#endif // defined( _WIN32 )
+
+			MapData = NULL;
+			MapSize = 0;
+		}
+
+		static uint64_t alignOffset( const uint64_t o )
+		{
+			return(( o + DataAlign - 1 ) & ~(uint64_t) ( DataAlign - 1 ));
+		}
+
+		static bool writePadding( FILE* const f, const uint64_t From,
+			const uint64_t To, const uint8_t* const Zeros )
+		{
+			return( To == From || fwrite( Zeros, 1, (size_t) ( To - From ),
+				f ) == (size_t) ( To - From ));
+		}
+	};
+
+	static CSyncObject StateSync; ///< Synchronizes all access to State.
+	static CState State; ///< Store's state.
+
+	/**
+	 * @return Build options that affect the designed kernels, recorded in
+	 * the store file's header.
+	 */
+
+	static uint32_t getBuildFlags()
+	{
+		uint32_t f = (uint32_t) sizeof( double );
+
+		#if R8B_IPP
+			f |= 0x100;
+		#endif // R8B_IPP
+
+		#if R8B_PFFFT_DOUBLE
+			f |= 0x200;
+		#endif // R8B_PFFFT_DOUBLE
+
+		#if R8B_FLOATFFT
+			f |= 0x400;
+		#endif // R8B_FLOATFFT
+
+		#if defined( R8B_SIMD_ISH )
+			f |= 0x800;
+		#endif // defined( R8B_SIMD_ISH )
+
+		return( f );
+	}
+};
+
+// ---------------------------------------------------------------------------
+
+} // namespace r8b
+
+#endif // R8B_CDSPKERNELSTORE_INCLUDED
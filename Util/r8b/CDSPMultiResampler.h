@@ -0,0 +1,1482 @@
+//$ nobt
+//$ nocpp
+
+/**
+ * @file CDSPMultiResampler.h
+ *
+ * @brief Multi-channel resampler class.
+ *
+ * This file includes the multi-channel resampler which accepts interleaved
+ * or planar buffers of double, float and 16-bit integer samples, and
+ * interpolates all channels in a single pass.
+ *
+ * r8brain-free-src Copyright (c) 2013-2022 Aleksey Vaneev
+ * See the "LICENSE" file for license.
+ */
+
+#ifndef R8B_CDSPMULTIRESAMPLER_INCLUDED
+#define R8B_CDSPMULTIRESAMPLER_INCLUDED
+
+#include "CDSPResampler.h"
+
+namespace r8b {
+
+/**
+ * @brief Sample format conversion helper.
+ *
+ * Converts samples of type T to and from the double type used by the
+ * resampler. Floating point samples are converted as-is, 16-bit integer
+ * samples are scaled to the [-1; 1) range, with rounding and clipping on
+ * output, see roundInt16().
+ *
+ * @tparam T Sample type.
+ */
+
+template< typename T >
+class CSampleConv
+{
+public:
+	static double toDouble( const T v )
+	{
+		return( (double) v );
+	}
+
+	static T fromDouble( const double v )
+	{
+		return( (T) v );
+	}
+};
+
+template<>
+class CSampleConv< int16_t >
+{
+public:
+	static double toDouble( const int16_t v )
+	{
+		return( v * ( 1.0 / 32768.0 ));
+	}
+
+	static int16_t fromDouble( const double v )
+	{
+		return( roundInt16( v * 32768.0 ));
+	}
+};
+
+/**
+ * @brief Multi-channel fractional delay interpolator class.
+ *
+ * Class performs the same interpolation as the CDSPFracInterpolator object
+ * it is constructed from, for several channels at once. The channels share
+ * the interpolation position, so the filter bank lookup, the interpolation
+ * between adjacent fractional delay filters and the position stepping are
+ * done once per output sample for all channels. The ring buffer holds the
+ * channels interleaved, so that each filter tap is applied to all channels
+ * with SIMD instructions. AVX2+FMA kernels are used if isAVX2Available().
+ *
+ * The prototype interpolator supplies the configuration and the filter
+ * bank, it should outlive *this object and should not be used for
+ * processing itself. The asynchronous mode is not supported.
+ */
+
+class CDSPMultiFracInterpolator : public R8B_BASECLASS
+{
+	R8BNOCTOR( CDSPMultiFracInterpolator );
+
+public:
+	/**
+	 * Constructor initializes the interpolator.
+	 *
+	 * @param aProto The prototype interpolator.
+	 * @param aChannelCount The number of channels, 1 or more.
+	 */
+
+	CDSPMultiFracInterpolator( const CDSPFracInterpolator& aProto,
+		const int aChannelCount )
+		: Proto( &aProto )
+		, ChannelCount( aChannelCount )
+		, ChannelStride(( aChannelCount + 1 ) & ~1 )
+	{
+		R8BASSERT( ChannelCount > 0 );
+		R8BASSERT( !Proto -> IsAsync );
+
+		Buf.alloc( BufFrames * ChannelStride );
+		FltBuf.alloc( Proto -> FilterLen );
+
+		static const CConvolveFn FltConvFn0[ 13 ] = {
+			&CDSPMultiFracInterpolator :: convolve0< 6 >,
+			&CDSPMultiFracInterpolator :: convolve0< 8 >,
+			&CDSPMultiFracInterpolator :: convolve0< 10 >,
+			&CDSPMultiFracInterpolator :: convolve0< 12 >,
+			&CDSPMultiFracInterpolator :: convolve0< 14 >,
+			&CDSPMultiFracInterpolator :: convolve0< 16 >,
+			&CDSPMultiFracInterpolator :: convolve0< 18 >,
+			&CDSPMultiFracInterpolator :: convolve0< 20 >,
+			&CDSPMultiFracInterpolator :: convolve0< 22 >,
+			&CDSPMultiFracInterpolator :: convolve0< 24 >,
+			&CDSPMultiFracInterpolator :: convolve0< 26 >,
+			&CDSPMultiFracInterpolator :: convolve0< 28 >,
+			&CDSPMultiFracInterpolator :: convolve0< 30 >
+		};
+
+		static const CConvolveFn FltConvFn2[ 13 ] = {
+			&CDSPMultiFracInterpolator :: convolve2< 6 >,
+			&CDSPMultiFracInterpolator :: convolve2< 8 >,
+			&CDSPMultiFracInterpolator :: convolve2< 10 >,
+			&CDSPMultiFracInterpolator :: convolve2< 12 >,
+			&CDSPMultiFracInterpolator :: convolve2< 14 >,
+			&CDSPMultiFracInterpolator :: convolve2< 16 >,
+			&CDSPMultiFracInterpolator :: convolve2< 18 >,
+			&CDSPMultiFracInterpolator :: convolve2< 20 >,
+			&CDSPMultiFracInterpolator :: convolve2< 22 >,
+			&CDSPMultiFracInterpolator :: convolve2< 24 >,
+			&CDSPMultiFracInterpolator :: convolve2< 26 >,
+			&CDSPMultiFracInterpolator :: convolve2< 28 >,
+			&CDSPMultiFracInterpolator :: convolve2< 30 >
+		};
+
+	#if defined( R8B_AVX2 )
+		static const CConvolveFn FltConvFn0AVX2[ 13 ] = {
+			&CDSPMultiFracInterpolator :: convolve0AVX2< 6 >,
+			&CDSPMultiFracInterpolator :: convolve0AVX2< 8 >,
+			&CDSPMultiFracInterpolator :: convolve0AVX2< 10 >,
+			&CDSPMultiFracInterpolator :: convolve0AVX2< 12 >,
+			&CDSPMultiFracInterpolator :: convolve0AVX2< 14 >,
+			&CDSPMultiFracInterpolator :: convolve0AVX2< 16 >,
+			&CDSPMultiFracInterpolator :: convolve0AVX2< 18 >,
+			&CDSPMultiFracInterpolator :: convolve0AVX2< 20 >,
+			&CDSPMultiFracInterpolator :: convolve0AVX2< 22 >,
+			&CDSPMultiFracInterpolator :: convolve0AVX2< 24 >,
+			&CDSPMultiFracInterpolator :: convolve0AVX2< 26 >,
+			&CDSPMultiFracInterpolator :: convolve0AVX2< 28 >,
+			&CDSPMultiFracInterpolator :: convolve0AVX2< 30 >
+		};
+
+		static const CConvolveFn FltConvFn2AVX2[ 13 ] = {
+			&CDSPMultiFracInterpolator :: convolve2AVX2< 6 >,
+			&CDSPMultiFracInterpolator :: convolve2AVX2< 8 >,
+			&CDSPMultiFracInterpolator :: convolve2AVX2< 10 >,
+			&CDSPMultiFracInterpolator :: convolve2AVX2< 12 >,
+			&CDSPMultiFracInterpolator :: convolve2AVX2< 14 >,
+			&CDSPMultiFracInterpolator :: convolve2AVX2< 16 >,
+			&CDSPMultiFracInterpolator :: convolve2AVX2< 18 >,
+			&CDSPMultiFracInterpolator :: convolve2AVX2< 20 >,
+			&CDSPMultiFracInterpolator :: convolve2AVX2< 22 >,
+			&CDSPMultiFracInterpolator :: convolve2AVX2< 24 >,
+			&CDSPMultiFracInterpolator :: convolve2AVX2< 26 >,
+			&CDSPMultiFracInterpolator :: convolve2AVX2< 28 >,
+			&CDSPMultiFracInterpolator :: convolve2AVX2< 30 >
+		};
+
+		if( isAVX2Available() )
+		{
+			convfn = ( Proto -> IsWhole ? FltConvFn0AVX2[ Proto -> fl2 - 3 ] :
+				FltConvFn2AVX2[ Proto -> fl2 - 3 ]);
+		}
+		else
+	#endif // defined( R8B_AVX2 )
+		{
+			convfn = ( Proto -> IsWhole ? FltConvFn0[ Proto -> fl2 - 3 ] :
+				FltConvFn2[ Proto -> fl2 - 3 ]);
+		}
+
+		clear();
+	}
+
+	/**
+	 * @return The distance between adjacent output frames, in samples. The
+	 * number of channels rounded up to an even value, the padding channels
+	 * are zero.
+	 */
+
+	int getChannelStride() const
+	{
+		return( ChannelStride );
+	}
+
+	/**
+	 * @return The maximal number of output frames a single process() call
+	 * may produce.
+	 *
+	 * @param MaxInLen The number of input frames.
+	 */
+
+	int getMaxOutLen( const int MaxInLen ) const
+	{
+		return( Proto -> getMaxOutLen( MaxInLen ));
+	}
+
+	/**
+	 * Function clears the state of *this object.
+	 */
+
+	void clear()
+	{
+		LatencyLeft = Proto -> Latency;
+		BufLeft = 0;
+		WritePos = 0;
+		ReadPos = Proto -> flb;
+
+		memset( &Buf[ 0 ], 0, BufFrames * ChannelStride * sizeof( Buf[ 0 ]));
+
+		if( Proto -> IsWhole )
+		{
+			InPosFracW = Proto -> InitFracPosW;
+		}
+		else
+		{
+			InPosFrac = Proto -> InitFracPos;
+
+		#if !R8B_FASTTIMING
+			InCounter = 0;
+			InPosInt = 0;
+			InPosShift = Proto -> InitFracPos * Proto -> DstSampleRate /
+				Proto -> SrcSampleRate;
+		#endif // !R8B_FASTTIMING
+		}
+	}
+
+	/**
+	 * Function performs the interpolation.
+	 *
+	 * @param ip Array of ChannelCount input buffer pointers.
+	 * @param l The number of input samples per channel.
+	 * @param[out] op0 Output buffer, getMaxOutLen( l ) * getChannelStride()
+	 * samples long. Receives the interpolated frames.
+	 * @return The number of frames written to "op0".
+	 */
+
+	int process( const double* const* const ip, int l, double* const op0 )
+	{
+		R8BASSERT( l >= 0 );
+
+		int ipos = 0;
+
+		if( LatencyLeft != 0 )
+		{
+			if( LatencyLeft >= l )
+			{
+				LatencyLeft -= l;
+				return( 0 );
+			}
+
+			l -= LatencyLeft;
+			ipos = LatencyLeft;
+			LatencyLeft = 0;
+		}
+
+		double* op = op0;
+
+		while( l > 0 )
+		{
+			// Copy new input frames to the ring buffer.
+
+			const int b = min( l, min( BufLen - WritePos,
+				Proto -> flb - BufLeft ));
+
+			writeFrames( ip, ipos, b, WritePos );
+			const int ec = Proto -> flo - WritePos;
+
+			if( ec > 0 )
+			{
+				writeFrames( ip, ipos, min( b, ec ), WritePos + BufLen );
+			}
+
+			ipos += b;
+			WritePos = ( WritePos + b ) & BufLenMask;
+			l -= b;
+			BufLeft += b;
+
+			// Produce as many output frames as possible.
+
+			op = ( *this.*convfn )( op );
+		}
+
+	#if !R8B_FASTTIMING
+
+		if( !Proto -> IsWhole && InCounter > 1000 )
+		{
+			InCounter = 0;
+			InPosInt = 0;
+			InPosShift = InPosFrac * Proto -> DstSampleRate /
+				Proto -> SrcSampleRate;
+		}
+
+	#endif // !R8B_FASTTIMING
+
+		return( (int) ( op - op0 ) / ChannelStride );
+	}
+
+private:
+	static const int BufLen = CDSPFracInterpolator :: BufLen; ///< The
+		///< length of the ring buffer, in frames.
+	static const int BufLenMask = CDSPFracInterpolator :: BufLenMask; ///<
+		///< Mask used for quick buffer position wrapping.
+	static const int BufFrames = (int) ( sizeof( CDSPFracInterpolator :: Buf ) /
+		sizeof( double )); ///< The length of the ring buffer, including
+		///< overrun protection, in frames.
+	const CDSPFracInterpolator* Proto; ///< The prototype interpolator.
+	int ChannelCount; ///< The number of channels.
+	int ChannelStride; ///< The distance between adjacent frames.
+	CFixedBuffer< double > Buf; ///< The ring buffer of interleaved frames.
+	CFixedBuffer< double > FltBuf; ///< The fractional delay filter of the
+		///< current output sample, interpolated from the filter bank.
+	int LatencyLeft; ///< Input latency left to remove.
+	int BufLeft; ///< The number of frames left in the buffer to process.
+	int WritePos; ///< The current buffer write position.
+	int ReadPos; ///< The current buffer read position.
+	int InPosFracW; ///< Interpolation position (fractional part) for
+		///< whole-number stepping.
+	double InPosFrac; ///< Interpolation position (fractional part).
+
+#if !R8B_FASTTIMING
+	int InCounter; ///< Interpolation step counter.
+	int InPosInt; ///< Interpolation position (integer part).
+	double InPosShift; ///< Interpolation position fractional shift.
+#endif // !R8B_FASTTIMING
+
+	typedef double*( CDSPMultiFracInterpolator :: *CConvolveFn )(
+		double* op ); ///< Convolution function type.
+	CConvolveFn convfn; ///< Convolution function in use.
+
+	/**
+	 * Function interleaves input samples into the ring buffer.
+	 *
+	 * @param ip Array of ChannelCount input buffer pointers.
+	 * @param ipos Position in the input buffers.
+	 * @param l The number of frames to write.
+	 * @param pos Position in the ring buffer.
+	 */
+
+	void writeFrames( const double* const* const ip, const int ipos,
+		const int l, const int pos )
+	{
+		int c;
+
+		for( c = 0; c < ChannelCount; c++ )
+		{
+			const double* const s = ip[ c ] + ipos;
+			double* d = &Buf[ pos * ChannelStride + c ];
+			int i;
+
+			for( i = 0; i < l; i++ )
+			{
+				*d = s[ i ];
+				d += ChannelStride;
+			}
+		}
+	}
+
+	/**
+	 * Function applies a filter to all channels.
+	 *
+	 * @param flt Filter, FilterLen taps.
+	 * @param rp Ring buffer's frame at the filter's first tap.
+	 * @param[out] op Output frame.
+	 * @tparam fltlen Filter length, in taps.
+	 */
+
+	template< int fltlen >
+	void convolveFrame( const double* const flt, const double* const rp,
+		double* const op ) const
+	{
+		const int cs = ChannelStride;
+		int c;
+		int i;
+
+		// Each pair of channels is a SIMD vector. Four taps are summed into
+		// separate accumulators, to shorten the dependency chain of the
+		// additions. FilterLen is always even.
+
+	#if defined( R8B_SSE2 )
+
+		for( c = 0; c < cs; c += 2 )
+		{
+			const double* p = rp + c;
+			__m128d s1 = _mm_setzero_pd();
+			__m128d s2 = _mm_setzero_pd();
+			__m128d s3 = _mm_setzero_pd();
+			__m128d s4 = _mm_setzero_pd();
+
+			for( i = 0; i + 4 <= fltlen; i += 4 )
+			{
+				s1 = _mm_add_pd( s1, _mm_mul_pd( _mm_set1_pd( flt[ i ]),
+					_mm_load_pd( p )));
+
+				s2 = _mm_add_pd( s2, _mm_mul_pd( _mm_set1_pd( flt[ i + 1 ]),
+					_mm_load_pd( p + cs )));
+
+				s3 = _mm_add_pd( s3, _mm_mul_pd( _mm_set1_pd( flt[ i + 2 ]),
+					_mm_load_pd( p + cs * 2 )));
+
+				s4 = _mm_add_pd( s4, _mm_mul_pd( _mm_set1_pd( flt[ i + 3 ]),
+					_mm_load_pd( p + cs * 3 )));
+
+				p += cs * 4;
+			}
+
+			if( fltlen & 2 )
+			{
+				s1 = _mm_add_pd( s1, _mm_mul_pd( _mm_set1_pd( flt[ i ]),
+					_mm_load_pd( p )));
+
+				s2 = _mm_add_pd( s2, _mm_mul_pd( _mm_set1_pd( flt[ i + 1 ]),
+					_mm_load_pd( p + cs )));
+			}
+
+			_mm_store_pd( op + c, _mm_add_pd( _mm_add_pd( s1, s2 ),
+				_mm_add_pd( s3, s4 )));
+		}
+
+	#elif defined( R8B_NEON )
+
+		for( c = 0; c < cs; c += 2 )
+		{
+			const double* p = rp + c;
+			float64x2_t s1 = vdupq_n_f64( 0.0 );
+			float64x2_t s2 = vdupq_n_f64( 0.0 );
+			float64x2_t s3 = vdupq_n_f64( 0.0 );
+			float64x2_t s4 = vdupq_n_f64( 0.0 );
+
+			for( i = 0; i + 4 <= fltlen; i += 4 )
+			{
+				s1 = vmlaq_f64( s1, vdupq_n_f64( flt[ i ]), vld1q_f64( p ));
+				s2 = vmlaq_f64( s2, vdupq_n_f64( flt[ i + 1 ]),
+					vld1q_f64( p + cs ));
+
+				s3 = vmlaq_f64( s3, vdupq_n_f64( flt[ i + 2 ]),
+					vld1q_f64( p + cs * 2 ));
+
+				s4 = vmlaq_f64( s4, vdupq_n_f64( flt[ i + 3 ]),
+					vld1q_f64( p + cs * 3 ));
+
+				p += cs * 4;
+			}
+
+			if( fltlen & 2 )
+			{
+				s1 = vmlaq_f64( s1, vdupq_n_f64( flt[ i ]), vld1q_f64( p ));
+				s2 = vmlaq_f64( s2, vdupq_n_f64( flt[ i + 1 ]),
+					vld1q_f64( p + cs ));
+			}
+
+			vst1q_f64( op + c, vaddq_f64( vaddq_f64( s1, s2 ),
+				vaddq_f64( s3, s4 )));
+		}
+
+	#else // SIMD
+
+		for( c = 0; c < cs; c++ )
+		{
+			const double* p = rp + c;
+			double s1 = 0.0;
+			double s2 = 0.0;
+
+			for( i = 0; i < fltlen; i += 2 )
+			{
+				s1 += flt[ i ] * p[ 0 ];
+				s2 += flt[ i + 1 ] * p[ cs ];
+				p += cs * 2;
+			}
+
+			op[ c ] = s1 + s2;
+		}
+
+	#endif // SIMD
+	}
+
+	/**
+	 * Convolution function for whole-number stepping, the polyphase filter.
+	 * See CDSPFracInterpolator::convolve0().
+	 *
+	 * @param[out] op Output buffer.
+	 * @return Advanced "op" value.
+	 * @tparam fltlen Filter length, in taps.
+	 */
+
+	template< int fltlen >
+	double* convolve0( double* op )
+	{
+		const CDSPFracDelayFilterBank& fb = *Proto -> FilterBank;
+		const int iincr = Proto -> InStepInt;
+		const int irem = Proto -> InStepRem;
+		const int ostep = Proto -> OutStep;
+		const int fl2 = Proto -> fl2;
+		int fpos = InPosFracW;
+		int rpos = ReadPos;
+		int bl = BufLeft - fl2;
+
+		while( bl > 0 )
+		{
+			convolveFrame< fltlen >( &fb[ fpos ], &Buf[ rpos * ChannelStride ],
+				op );
+
+			op += ChannelStride;
+
+			fpos += irem;
+			const int w = ( fpos >= ostep );
+			fpos -= ostep & -w;
+			const int PosIncr = iincr + w;
+
+			rpos = ( rpos + PosIncr ) & BufLenMask;
+			bl -= PosIncr;
+		}
+
+		BufLeft = bl + fl2;
+		ReadPos = rpos;
+		InPosFracW = fpos;
+
+		return( op );
+	}
+
+	/**
+	 * Convolution function for 2nd order resampling. The filter is
+	 * interpolated between the adjacent fractional delay filters once, into
+	 * FltBuf, then applied to all channels. See
+	 * CDSPFracInterpolator::convolve2().
+	 *
+	 * @param[out] op Output buffer.
+	 * @return Advanced "op" value.
+	 * @tparam fltlen Filter length, in taps.
+	 */
+
+	template< int fltlen >
+	double* convolve2( double* op )
+	{
+		const CDSPFracDelayFilterBank& fb = *Proto -> FilterBank;
+		const int fl2 = Proto -> fl2;
+		double* const flt = &FltBuf[ 0 ];
+		double fpos = InPosFrac;
+		int rpos = ReadPos;
+		int bl = BufLeft - fl2;
+
+		while( bl > 0 )
+		{
+			calcFilter< fltlen >( fb, fpos, flt );
+			convolveFrame< fltlen >( flt, &Buf[ rpos * ChannelStride ], op );
+			op += ChannelStride;
+
+			const int PosIncr = advance( fpos );
+			rpos = ( rpos + PosIncr ) & BufLenMask;
+			bl -= PosIncr;
+		}
+
+		BufLeft = bl + fl2;
+		ReadPos = rpos;
+		InPosFrac = fpos;
+
+		return( op );
+	}
+
+	/**
+	 * Function interpolates the fractional delay filter of the current
+	 * output sample from the filter bank.
+	 *
+	 * @param fb The filter bank.
+	 * @param fpos Interpolation position (fractional part).
+	 * @param[out] flt Filter, fltlen taps.
+	 * @tparam fltlen Filter length, in taps.
+	 */
+
+	template< int fltlen >
+	static void calcFilter( const CDSPFracDelayFilterBank& fb,
+		const double fpos, double* const flt )
+	{
+		double x = fpos * fb.getFilterFracs();
+		const int fti = (int) x; // Function table index.
+		x -= fti; // Coefficient for interpolation between adjacent
+			// fractional delay filters.
+		const double x2d = x * x;
+		const double* ftp = &fb[ fti ];
+		int i;
+
+	#if defined( R8B_SIMD_ISH )
+
+		// Filter points are shuffled in pairs, see
+		// CDSPFracDelayFilterBank::shuffle2_3().
+
+		for( i = 0; i < fltlen; i += 2 )
+		{
+			flt[ i ] = ftp[ 0 ] + ftp[ 2 ] * x + ftp[ 4 ] * x2d;
+			flt[ i + 1 ] = ftp[ 1 ] + ftp[ 3 ] * x + ftp[ 5 ] * x2d;
+			ftp += 6;
+		}
+
+	#else // SIMD
+
+		for( i = 0; i < fltlen; i++ )
+		{
+			flt[ i ] = ftp[ 0 ] + ftp[ 1 ] * x + ftp[ 2 ] * x2d;
+			ftp += 3;
+		}
+
+	#endif // SIMD
+	}
+
+	/**
+	 * Function advances the interpolation position of 2nd order resampling
+	 * by one output sample.
+	 *
+	 * @param[in,out] fpos Interpolation position (fractional part).
+	 * @return The number of input frames to advance the read position by.
+	 */
+
+	int advance( double& fpos )
+	{
+	#if R8B_FASTTIMING
+
+		fpos += Proto -> FracStep;
+		const int PosIncr = (int) fpos;
+		fpos -= PosIncr;
+
+	#else // R8B_FASTTIMING
+
+		InCounter++;
+		const double NextInPos = ( InCounter + InPosShift ) *
+			Proto -> SrcSampleRate / Proto -> DstSampleRate;
+
+		const int NextInPosInt = (int) NextInPos;
+		const int PosIncr = NextInPosInt - InPosInt;
+		InPosInt = NextInPosInt;
+		fpos = NextInPos - NextInPosInt;
+
+	#endif // R8B_FASTTIMING
+
+		return( PosIncr );
+	}
+
+#if defined( R8B_AVX2 )
+
+	/**
+	 * AVX2+FMA variant of the convolveFrame() function. Each group of four
+	 * channels is a vector. With two channels, a vector holds two taps
+	 * instead: the filter's taps are duplicated in-lane, so that each
+	 * matches its frame of the channel-interleaved ring buffer.
+	 *
+	 * @param flt Filter, FilterLen taps.
+	 * @param rp Ring buffer's frame at the filter's first tap.
+	 * @param[out] op Output frame.
+	 * @tparam fltlen Filter length, in taps.
+	 */
+
+	template< int fltlen >
+	R8B_AVX2_FN void convolveFrameAVX2( const double* const flt,
+		const double* const rp, double* const op ) const
+	{
+		const int cs = ChannelStride;
+		int c;
+		int i;
+
+		if( cs == 2 )
+		{
+			__m256d s1 = _mm256_setzero_pd();
+			__m256d s2 = _mm256_setzero_pd();
+			__m256d s3 = _mm256_setzero_pd();
+			__m256d s4 = _mm256_setzero_pd();
+
+			for( i = 0; i + 8 <= fltlen; i += 8 )
+			{
+				s1 = _mm256_fmadd_pd( _mm256_permute_pd( _mm256_broadcast_pd(
+					(const __m128d*) ( flt + i )), 12 ),
+					_mm256_loadu_pd( rp + i * 2 ), s1 );
+
+				s2 = _mm256_fmadd_pd( _mm256_permute_pd( _mm256_broadcast_pd(
+					(const __m128d*) ( flt + i + 2 )), 12 ),
+					_mm256_loadu_pd( rp + i * 2 + 4 ), s2 );
+
+				s3 = _mm256_fmadd_pd( _mm256_permute_pd( _mm256_broadcast_pd(
+					(const __m128d*) ( flt + i + 4 )), 12 ),
+					_mm256_loadu_pd( rp + i * 2 + 8 ), s3 );
+
+				s4 = _mm256_fmadd_pd( _mm256_permute_pd( _mm256_broadcast_pd(
+					(const __m128d*) ( flt + i + 6 )), 12 ),
+					_mm256_loadu_pd( rp + i * 2 + 12 ), s4 );
+			}
+
+			if( fltlen & 4 )
+			{
+				s1 = _mm256_fmadd_pd( _mm256_permute_pd( _mm256_broadcast_pd(
+					(const __m128d*) ( flt + i )), 12 ),
+					_mm256_loadu_pd( rp + i * 2 ), s1 );
+
+				s2 = _mm256_fmadd_pd( _mm256_permute_pd( _mm256_broadcast_pd(
+					(const __m128d*) ( flt + i + 2 )), 12 ),
+					_mm256_loadu_pd( rp + i * 2 + 4 ), s2 );
+
+				i += 4;
+			}
+
+			if( fltlen & 2 )
+			{
+				s3 = _mm256_fmadd_pd( _mm256_permute_pd( _mm256_broadcast_pd(
+					(const __m128d*) ( flt + i )), 12 ),
+					_mm256_loadu_pd( rp + i * 2 ), s3 );
+			}
+
+			const __m256d s = _mm256_add_pd( _mm256_add_pd( s1, s2 ),
+				_mm256_add_pd( s3, s4 ));
+
+			_mm_store_pd( op, _mm_add_pd( _mm256_castpd256_pd128( s ),
+				_mm256_extractf128_pd( s, 1 )));
+
+			return;
+		}
+
+		for( c = 0; c + 4 <= cs; c += 4 )
+		{
+			const double* p = rp + c;
+			__m256d s1 = _mm256_setzero_pd();
+			__m256d s2 = _mm256_setzero_pd();
+			__m256d s3 = _mm256_setzero_pd();
+			__m256d s4 = _mm256_setzero_pd();
+
+			for( i = 0; i + 4 <= fltlen; i += 4 )
+			{
+				s1 = _mm256_fmadd_pd( _mm256_broadcast_sd( flt + i ),
+					_mm256_loadu_pd( p ), s1 );
+
+				s2 = _mm256_fmadd_pd( _mm256_broadcast_sd( flt + i + 1 ),
+					_mm256_loadu_pd( p + cs ), s2 );
+
+				s3 = _mm256_fmadd_pd( _mm256_broadcast_sd( flt + i + 2 ),
+					_mm256_loadu_pd( p + cs * 2 ), s3 );
+
+				s4 = _mm256_fmadd_pd( _mm256_broadcast_sd( flt + i + 3 ),
+					_mm256_loadu_pd( p + cs * 3 ), s4 );
+
+				p += cs * 4;
+			}
+
+			if( fltlen & 2 )
+			{
+				s1 = _mm256_fmadd_pd( _mm256_broadcast_sd( flt + i ),
+					_mm256_loadu_pd( p ), s1 );
+
+				s2 = _mm256_fmadd_pd( _mm256_broadcast_sd( flt + i + 1 ),
+					_mm256_loadu_pd( p + cs ), s2 );
+			}
+
+			_mm256_storeu_pd( op + c, _mm256_add_pd( _mm256_add_pd( s1, s2 ),
+				_mm256_add_pd( s3, s4 )));
+		}
+
+		if( c < cs )
+		{
+			// The last pair of channels.
+
+			const double* p = rp + c;
+			__m128d s1 = _mm_setzero_pd();
+			__m128d s2 = _mm_setzero_pd();
+			__m128d s3 = _mm_setzero_pd();
+			__m128d s4 = _mm_setzero_pd();
+
+			for( i = 0; i + 4 <= fltlen; i += 4 )
+			{
+				s1 = _mm_fmadd_pd( _mm_set1_pd( flt[ i ]), _mm_load_pd( p ), s1 );
+				s2 = _mm_fmadd_pd( _mm_set1_pd( flt[ i + 1 ]),
+					_mm_load_pd( p + cs ), s2 );
+
+				s3 = _mm_fmadd_pd( _mm_set1_pd( flt[ i + 2 ]),
+					_mm_load_pd( p + cs * 2 ), s3 );
+
+				s4 = _mm_fmadd_pd( _mm_set1_pd( flt[ i + 3 ]),
+					_mm_load_pd( p + cs * 3 ), s4 );
+
+				p += cs * 4;
+			}
+
+			if( fltlen & 2 )
+			{
+				s1 = _mm_fmadd_pd( _mm_set1_pd( flt[ i ]), _mm_load_pd( p ), s1 );
+				s2 = _mm_fmadd_pd( _mm_set1_pd( flt[ i + 1 ]),
+					_mm_load_pd( p + cs ), s2 );
+			}
+
+			_mm_store_pd( op + c, _mm_add_pd( _mm_add_pd( s1, s2 ),
+				_mm_add_pd( s3, s4 )));
+		}
+	}
+
+#if defined( R8B_SIMD_ISH )
+
+	/**
+	 * AVX2+FMA stereo kernel of 2nd order resampling. The filter is
+	 * interpolated from the filter bank and applied in the same pass, a pair
+	 * of taps at a time, so that FltBuf is not used.
+	 *
+	 * @param fb The filter bank.
+	 * @param fpos Interpolation position (fractional part).
+	 * @param rp Ring buffer's frame at the filter's first tap.
+	 * @param[out] op Output frame.
+	 * @tparam fltlen Filter length, in taps.
+	 */
+
+	template< int fltlen >
+	R8B_AVX2_FN static void convolveStereo2AVX2(
+		const CDSPFracDelayFilterBank& fb, const double fpos,
+		const double* const rp, double* const op )
+	{
+		double x = fpos * fb.getFilterFracs();
+		const int fti = (int) x; // Function table index.
+		x -= fti; // Coefficient for interpolation between adjacent
+			// fractional delay filters.
+		const __m256d xv = _mm256_set1_pd( x );
+		const __m256d x2v = _mm256_set1_pd( x * x );
+		const double* ftp = &fb[ fti ];
+		__m256d s1 = _mm256_setzero_pd();
+		__m256d s2 = _mm256_setzero_pd();
+		__m256d s3 = _mm256_setzero_pd();
+		int i;
+
+		// Filter points are shuffled in pairs, see
+		// CDSPFracDelayFilterBank::shuffle2_3(). Each pair of interpolated
+		// taps is duplicated in-lane to match two stereo frames.
+
+		for( i = 0; i + 6 <= fltlen; i += 6 )
+		{
+			s1 = _mm256_fmadd_pd( _mm256_permute_pd( _mm256_fmadd_pd(
+				_mm256_broadcast_pd( (const __m128d*) ( ftp + 4 )), x2v,
+				_mm256_fmadd_pd( _mm256_broadcast_pd(
+				(const __m128d*) ( ftp + 2 )), xv, _mm256_broadcast_pd(
+				(const __m128d*) ftp ))), 12 ),
+				_mm256_loadu_pd( rp + i * 2 ), s1 );
+
+			s2 = _mm256_fmadd_pd( _mm256_permute_pd( _mm256_fmadd_pd(
+				_mm256_broadcast_pd( (const __m128d*) ( ftp + 10 )), x2v,
+				_mm256_fmadd_pd( _mm256_broadcast_pd(
+				(const __m128d*) ( ftp + 8 )), xv, _mm256_broadcast_pd(
+				(const __m128d*) ( ftp + 6 )))), 12 ),
+				_mm256_loadu_pd( rp + i * 2 + 4 ), s2 );
+
+			s3 = _mm256_fmadd_pd( _mm256_permute_pd( _mm256_fmadd_pd(
+				_mm256_broadcast_pd( (const __m128d*) ( ftp + 16 )), x2v,
+				_mm256_fmadd_pd( _mm256_broadcast_pd(
+				(const __m128d*) ( ftp + 14 )), xv, _mm256_broadcast_pd(
+				(const __m128d*) ( ftp + 12 )))), 12 ),
+				_mm256_loadu_pd( rp + i * 2 + 8 ), s3 );
+
+			ftp += 18;
+		}
+
+		for( ; i < fltlen; i += 2 )
+		{
+			s1 = _mm256_fmadd_pd( _mm256_permute_pd( _mm256_fmadd_pd(
+				_mm256_broadcast_pd( (const __m128d*) ( ftp + 4 )), x2v,
+				_mm256_fmadd_pd( _mm256_broadcast_pd(
+				(const __m128d*) ( ftp + 2 )), xv, _mm256_broadcast_pd(
+				(const __m128d*) ftp ))), 12 ),
+				_mm256_loadu_pd( rp + i * 2 ), s1 );
+
+			ftp += 6;
+		}
+
+		const __m256d s = _mm256_add_pd( _mm256_add_pd( s1, s2 ), s3 );
+
+		_mm_store_pd( op, _mm_add_pd( _mm256_castpd256_pd128( s ),
+			_mm256_extractf128_pd( s, 1 )));
+	}
+
+#endif // defined( R8B_SIMD_ISH )
+
+	/**
+	 * AVX2+FMA variant of the convolve0() function.
+	 *
+	 * @param[out] op Output buffer.
+	 * @return Advanced "op" value.
+	 * @tparam fltlen Filter length, in taps.
+	 */
+
+	template< int fltlen >
+	R8B_AVX2_FN double* convolve0AVX2( double* op )
+	{
+		const CDSPFracDelayFilterBank& fb = *Proto -> FilterBank;
+		const int iincr = Proto -> InStepInt;
+		const int irem = Proto -> InStepRem;
+		const int ostep = Proto -> OutStep;
+		const int fl2 = Proto -> fl2;
+		int fpos = InPosFracW;
+		int rpos = ReadPos;
+		int bl = BufLeft - fl2;
+
+		while( bl > 0 )
+		{
+			convolveFrameAVX2< fltlen >( &fb[ fpos ],
+				&Buf[ rpos * ChannelStride ], op );
+
+			op += ChannelStride;
+
+			fpos += irem;
+			const int w = ( fpos >= ostep );
+			fpos -= ostep & -w;
+			const int PosIncr = iincr + w;
+
+			rpos = ( rpos + PosIncr ) & BufLenMask;
+			bl -= PosIncr;
+		}
+
+		BufLeft = bl + fl2;
+		ReadPos = rpos;
+		InPosFracW = fpos;
+
+		return( op );
+	}
+
+	/**
+	 * AVX2+FMA variant of the convolve2() function.
+	 *
+	 * @param[out] op Output buffer.
+	 * @return Advanced "op" value.
+	 * @tparam fltlen Filter length, in taps.
+	 */
+
+	template< int fltlen >
+	R8B_AVX2_FN double* convolve2AVX2( double* op )
+	{
+		const CDSPFracDelayFilterBank& fb = *Proto -> FilterBank;
+		const int fl2 = Proto -> fl2;
+		double* const flt = &FltBuf[ 0 ];
+		double fpos = InPosFrac;
+		int rpos = ReadPos;
+		int bl = BufLeft - fl2;
+
+		while( bl > 0 )
+		{
+		#if defined( R8B_SIMD_ISH )
+			if( ChannelStride == 2 )
+			{
+				convolveStereo2AVX2< fltlen >( fb, fpos, &Buf[ rpos * 2 ], op );
+			}
+			else
+		#endif // defined( R8B_SIMD_ISH )
+			{
+				calcFilter< fltlen >( fb, fpos, flt );
+				convolveFrameAVX2< fltlen >( flt, &Buf[ rpos * ChannelStride ],
+					op );
+			}
+
+			op += ChannelStride;
+
+			const int PosIncr = advance( fpos );
+			rpos = ( rpos + PosIncr ) & BufLenMask;
+			bl -= PosIncr;
+		}
+
+		BufLeft = bl + fl2;
+		ReadPos = rpos;
+		InPosFrac = fpos;
+
+		return( op );
+	}
+
+#endif // defined( R8B_AVX2 )
+};
+
+/**
+ * @brief Multi-channel sample rate converter class.
+ *
+ * Class resamples several channels in lock-step, with a single set of
+ * parameters. Each channel has its own CDSPResampler object holding the
+ * state of its block convolution and half-band stages, whose filters are
+ * obtained from the library's global caches and so are shared by all
+ * channels. The fractional delay interpolation step, which takes a large
+ * share of the time when the ratio is not a small rational number (e.g. for
+ * asynchronous sources such as 44.1 to 47.999 kHz), is replaced by a single
+ * CDSPMultiFracInterpolator that steps all channels together, with the
+ * channels' samples interleaved so that SIMD operates across channels; the
+ * channels' own interpolators are left idle. Input and output samples are
+ * de-interleaved and converted on the fly, so no intermediate per-channel
+ * copies of the whole signal are required.
+ *
+ * All channels always produce the same number of output samples, since their
+ * resamplers have identical configurations and are fed in lock-step.
+ */
+
+class CDSPMultiResampler : public R8B_BASECLASS
+{
+	R8BNOCTOR( CDSPMultiResampler );
+
+public:
+	/**
+	 * Constructor initializes the multi-channel resampler. See the
+	 * r8b::CDSPResampler class for details of the resampling parameters.
+	 *
+	 * @param aChannelCount The number of channels, 1 or more.
+	 * @param SrcSampleRate Source signal's sample rate.
+	 * @param DstSampleRate Destination signal's sample rate.
+	 * @param aMaxInLen The maximal planned length of the input buffer (in
+	 * samples per channel) that will be passed to the process functions.
+	 * @param ReqTransBand Required transition band, in percent.
+	 * @param ReqAtten Required stop-band attenuation in decibel.
+	 * @param ReqPhase Required filter's phase response.
+	 * @param UseFloatFFT "True" if "float" FFT should be used by the block
+	 * convolution stages.
+	 */
+
+	CDSPMultiResampler( const int aChannelCount, const double SrcSampleRate,
+		const double DstSampleRate, const int aMaxInLen,
+		const double ReqTransBand = 2.0, const double ReqAtten = 206.91,
+		const EDSPFilterPhaseResponse ReqPhase = fprLinearPhase,
+		const bool UseFloatFFT = false )
+		: ChannelCount( aChannelCount )
+		, MaxInLen( aMaxInLen )
+		, Interp( NULL )
+		, HasPostSteps( false )
+	{
+		R8BASSERT( ChannelCount > 0 );
+		R8BASSERT( MaxInLen > 0 );
+
+		Resamplers.alloc( ChannelCount );
+		int i;
+
+		for( i = 0; i < ChannelCount; i++ )
+		{
+			Resamplers[ i ] = new CDSPResampler( SrcSampleRate, DstSampleRate,
+				MaxInLen, ReqTransBand, ReqAtten, ReqPhase, UseFloatFFT );
+		}
+
+		InterpStep = Resamplers[ 0 ] -> getInterpStep();
+
+		if( InterpStep < 0 || ChannelCount == 1 )
+		{
+			InBuf.alloc( MaxInLen );
+			memset( &InBuf[ 0 ], 0, MaxInLen * sizeof( InBuf[ 0 ]));
+			return;
+		}
+
+		Interp = new CDSPMultiFracInterpolator(
+			Resamplers[ 0 ] -> getInterpolator(), ChannelCount );
+
+		const int ml = Interp -> getMaxOutLen(
+			Resamplers[ 0 ] -> getMaxOutLenBefore( InterpStep ));
+
+		const int ms = ml * Interp -> getChannelStride();
+		HasPostSteps = ( InterpStep + 1 < Resamplers[ 0 ] -> getStepCount() );
+
+		// Touch the buffers, so that the first process() call does not page
+		// them in.
+
+		InBuf.alloc( MaxInLen * ChannelCount );
+		memset( &InBuf[ 0 ], 0, MaxInLen * ChannelCount *
+			sizeof( InBuf[ 0 ]));
+
+		ChanPtrs.alloc( ChannelCount );
+		MultiBuf.alloc( ms );
+		memset( &MultiBuf[ 0 ], 0, ms * sizeof( MultiBuf[ 0 ]));
+
+		if( HasPostSteps )
+		{
+			PostBuf.alloc( ml );
+			memset( &PostBuf[ 0 ], 0, ml * sizeof( PostBuf[ 0 ]));
+		}
+	}
+
+	~CDSPMultiResampler()
+	{
+		delete Interp;
+
+		int i;
+
+		for( i = 0; i < ChannelCount; i++ )
+		{
+			delete Resamplers[ i ];
+		}
+	}
+
+	/**
+	 * @return The number of channels.
+	 */
+
+	int getChannelCount() const
+	{
+		return( ChannelCount );
+	}
+
+	/**
+	 * @return "True" if the channels are interpolated together by a
+	 * CDSPMultiFracInterpolator, "false" if the conversion has no fractional
+	 * delay interpolation step, or there is a single channel.
+	 */
+
+	bool isInterpShared() const
+	{
+		return( Interp != NULL );
+	}
+
+	/**
+	 * @return The maximal number of output samples per channel a single
+	 * process call may produce.
+	 */
+
+	int getMaxOutLen() const
+	{
+		return( Resamplers[ 0 ] -> getMaxOutLen( MaxInLen ));
+	}
+
+	/**
+	 * @return The number of input samples per channel required to produce
+	 * at least the specified number of output samples, starting at the
+	 * cleared state.
+	 *
+	 * @param ReqOutSamples The number of output samples required.
+	 */
+
+	int getInputRequiredForOutput( const int ReqOutSamples ) const
+	{
+		return( Resamplers[ 0 ] -> getInputRequiredForOutput( ReqOutSamples ));
+	}
+
+	/**
+	 * Function clears the state of all channels.
+	 */
+
+	void clear()
+	{
+		R8BRTSECTION;
+
+		int i;
+
+		for( i = 0; i < ChannelCount; i++ )
+		{
+			Resamplers[ i ] -> clear();
+		}
+
+		if( Interp != NULL )
+		{
+			Interp -> clear();
+		}
+	}
+
+	/**
+	 * Function resamples an interleaved buffer.
+	 *
+	 * @param ip Interleaved input buffer, "l * ChannelCount" samples long.
+	 * @param l The number of samples per channel in the input buffer. Should
+	 * not exceed the MaxInLen supplied in the constructor.
+	 * @param[out] op Interleaved output buffer, at least
+	 * "getMaxOutLen() * ChannelCount" samples long.
+	 * @return The number of samples per channel written to "op".
+	 * @tparam Tin Input buffer's element type.
+	 * @tparam Tout Output buffer's element type.
+	 */
+
+	template< typename Tin, typename Tout >
+	int processInterleaved( const Tin* const ip, const int l,
+		Tout* const op )
+	{
+		R8BRTSECTION;
+		R8BASSERT( l >= 0 && l <= MaxInLen );
+
+		return( processFrames( [=]( const int c ) { return( ip + c ); },
+			ChannelCount, l, [=]( const int c ) { return( op + c ); },
+			ChannelCount ));
+	}
+
+	/**
+	 * Function resamples a planar buffer.
+	 *
+	 * @param ip Array of ChannelCount input buffer pointers, each "l"
+	 * samples long.
+	 * @param l The number of samples per channel in the input buffers.
+	 * Should not exceed the MaxInLen supplied in the constructor.
+	 * @param[out] op Array of ChannelCount output buffer pointers, each at
+	 * least getMaxOutLen() samples long.
+	 * @return The number of samples per channel written to "op".
+	 * @tparam Tin Input buffer's element type.
+	 * @tparam Tout Output buffer's element type.
+	 */
+
+	template< typename Tin, typename Tout >
+	int processPlanar( const Tin* const* const ip, const int l,
+		Tout* const* const op )
+	{
+		R8BRTSECTION;
+		R8BASSERT( l >= 0 && l <= MaxInLen );
+
+		return( processFrames( [=]( const int c ) { return( ip[ c ]); }, 1,
+			l, [=]( const int c ) { return( op[ c ]); }, 1 ));
+	}
+
+	/**
+	 * Function resamples a whole interleaved signal in the "one-shot" mode,
+	 * flushing the resampler with zeros after the input ends. The object is
+	 * cleared before and after the conversion.
+	 *
+	 * @param ip Interleaved input buffer, "iplen * ChannelCount" samples
+	 * long.
+	 * @param iplen Length of the input signal, in samples per channel.
+	 * @param[out] op Interleaved output buffer, "oplen * ChannelCount"
+	 * samples long.
+	 * @param oplen Length of the output signal, in samples per channel.
+	 * @tparam Tin Input buffer's element type.
+	 * @tparam Tout Output buffer's element type.
+	 */
+
+	template< typename Tin, typename Tout >
+	void oneshotInterleaved( const Tin* ip, int iplen, Tout* op, int oplen )
+	{
+		CFixedBuffer< Tout > Buf( getMaxOutLen() * ChannelCount );
+		CFixedBuffer< Tin > ZeroBuf( MaxInLen * ChannelCount );
+		memset( &ZeroBuf[ 0 ], 0, MaxInLen * ChannelCount * sizeof( Tin ));
+
+		clear();
+
+		while( oplen > 0 )
+		{
+			const int rc = ( iplen == 0 ? MaxInLen : min( iplen, MaxInLen ));
+			const Tin* const p = ( iplen == 0 ? &ZeroBuf[ 0 ] : ip );
+
+			if( iplen != 0 )
+			{
+				ip += rc * ChannelCount;
+				iplen -= rc;
+			}
+
+			const int wc = min( oplen,
+				processInterleaved( p, rc, &Buf[ 0 ]));
+
+			memcpy( op, &Buf[ 0 ], wc * ChannelCount * sizeof( Tout ));
+			op += wc * ChannelCount;
+			oplen -= wc;
+		}
+
+		clear();
+	}
+
+	/**
+	 * Function resamples a whole planar signal in the "one-shot" mode. See
+	 * the oneshotInterleaved() function for details.
+	 *
+	 * @param ip Array of ChannelCount input buffer pointers, each "iplen"
+	 * samples long.
+	 * @param iplen Length of the input signal, in samples per channel.
+	 * @param[out] op Array of ChannelCount output buffer pointers, each
+	 * "oplen" samples long.
+	 * @param oplen Length of the output signal, in samples per channel.
+	 * @tparam Tin Input buffer's element type.
+	 * @tparam Tout Output buffer's element type.
+	 */
+
+	template< typename Tin, typename Tout >
+	void oneshotPlanar( const Tin* const* const ip, const int iplen,
+		Tout* const* const op, const int oplen )
+	{
+		CFixedBuffer< Tin > ZeroBuf( MaxInLen );
+		memset( &ZeroBuf[ 0 ], 0, MaxInLen * sizeof( Tin ));
+		const Tin* const zp = &ZeroBuf[ 0 ];
+
+		clear();
+
+		int ipos = 0;
+		int opos = 0;
+
+		while( opos < oplen )
+		{
+			const int rc = ( ipos == iplen ? MaxInLen :
+				min( iplen - ipos, MaxInLen ));
+
+			const bool IsZero = ( ipos == iplen );
+			const int ip0 = ipos;
+			const int op0 = opos;
+
+			const int wc = processFrames(
+				[=]( const int c ) { return( IsZero ? zp : ip[ c ] + ip0 ); },
+				1, rc, [=]( const int c ) { return( op[ c ] + op0 ); }, 1,
+				oplen - opos );
+
+			if( !IsZero )
+			{
+				ipos += rc;
+			}
+
+			opos += wc;
+		}
+
+		clear();
+	}
+
+private:
+	int ChannelCount; ///< The number of channels.
+	int MaxInLen; ///< The maximal input length per channel.
+	CFixedBuffer< CDSPResampler* > Resamplers; ///< Per-channel resamplers.
+	CDSPMultiFracInterpolator* Interp; ///< The shared interpolation step,
+		///< NULL if not used.
+	int InterpStep; ///< Index of the interpolation step in the channels'
+		///< resamplers, -1 if none.
+	bool HasPostSteps; ///< "True" if the channels' resamplers have steps
+		///< following the interpolation step.
+	CFixedBuffer< double > InBuf; ///< Converted input, MaxInLen samples per
+		///< channel if Interp is used, a single channel otherwise.
+	CFixedBuffer< double* > ChanPtrs; ///< Per-channel inputs of the
+		///< interpolation step.
+	CFixedBuffer< double > MultiBuf; ///< Interleaved output of the
+		///< interpolation step.
+	CFixedBuffer< double > PostBuf; ///< Input of the steps following the
+		///< interpolation step, a single channel.
+
+	/**
+	 * Function converts input samples to double.
+	 *
+	 * @param ip Input pointer of the channel.
+	 * @param is Input stride, in samples.
+	 * @param l The number of input samples.
+	 * @param[out] p Output buffer.
+	 */
+
+	template< typename Tin >
+	static void convertIn( const Tin* ip, const int is, const int l,
+		double* const p )
+	{
+		int i;
+
+		for( i = 0; i < l; i++ )
+		{
+			p[ i ] = CSampleConv< Tin > :: toDouble( *ip );
+			ip += is;
+		}
+	}
+
+	/**
+	 * Function converts output samples from double.
+	 *
+	 * @param rp Output of the resampler.
+	 * @param rs Stride of the resampler's output, in samples.
+	 * @param l The number of output samples.
+	 * @param[out] op Output pointer of the channel.
+	 * @param os Output stride, in samples.
+	 */
+
+	template< typename Tout >
+	static void convertOut( const double* rp, const int rs, const int l,
+		Tout* op, const int os )
+	{
+		int i;
+
+		for( i = 0; i < l; i++ )
+		{
+			*op = CSampleConv< Tout > :: fromDouble( *rp );
+			rp += rs;
+			op += os;
+		}
+	}
+
+	/**
+	 * Function converts and resamples a single channel's input with the
+	 * channel's whole resampler, then converts and stores its output.
+	 *
+	 * @param c Channel index.
+	 * @param ip Input pointer of the channel.
+	 * @param is Input stride, in samples.
+	 * @param l The number of input samples.
+	 * @param op Output pointer of the channel.
+	 * @param os Output stride, in samples.
+	 * @param omax The maximal number of output samples to store.
+	 * @return The number of samples produced, limited by "omax".
+	 */
+
+	template< typename Tin, typename Tout >
+	int processChannel( const int c, const Tin* const ip, const int is,
+		const int l, Tout* const op, const int os, const int omax )
+	{
+		double* const p = &InBuf[ 0 ];
+		convertIn( ip, is, l, p );
+
+		double* rp;
+		const int ol = min( omax, Resamplers[ c ] -> process( p, l, rp ));
+		convertOut( rp, 1, ol, op, os );
+
+		return( ol );
+	}
+
+	/**
+	 * Function converts and resamples all channels, then converts and stores
+	 * their output.
+	 *
+	 * @param getIn Function returning the input pointer of a channel.
+	 * @param is Input stride, in samples.
+	 * @param l The number of input samples per channel.
+	 * @param getOut Function returning the output pointer of a channel.
+	 * @param os Output stride, in samples.
+	 * @param omax The maximal number of output samples per channel to store.
+	 * @return The number of samples per channel produced, limited by
+	 * "omax".
+	 */
+
+	template< class TInFn, class TOutFn >
+	int processFrames( const TInFn& getIn, const int is, const int l,
+		const TOutFn& getOut, const int os, const int omax = 0x7FFFFFFF )
+	{
+		int ol = 0;
+		int c;
+
+		if( Interp == NULL )
+		{
+			for( c = 0; c < ChannelCount; c++ )
+			{
+				ol = processChannel( c, getIn( c ), is, l, getOut( c ), os,
+					omax );
+			}
+
+			return( ol );
+		}
+
+		// The steps preceding the interpolation, per channel.
+
+		int il = 0;
+
+		for( c = 0; c < ChannelCount; c++ )
+		{
+			double* const p = &InBuf[ c * MaxInLen ];
+			convertIn( getIn( c ), is, l, p );
+
+			il = Resamplers[ c ] -> processSteps( 0, InterpStep, p, l,
+				ChanPtrs[ c ]);
+		}
+
+		// The interpolation, all channels at once.
+
+		const int cs = Interp -> getChannelStride();
+		const int ml = Interp -> process( &ChanPtrs[ 0 ], il, &MultiBuf[ 0 ]);
+
+		if( !HasPostSteps )
+		{
+			ol = min( omax, ml );
+
+			for( c = 0; c < ChannelCount; c++ )
+			{
+				convertOut( &MultiBuf[ c ], cs, ol, getOut( c ), os );
+			}
+
+			return( ol );
+		}
+
+		// The steps following the interpolation, per channel.
+
+		const int StepCount = Resamplers[ 0 ] -> getStepCount();
+		double* const p = &PostBuf[ 0 ];
+
+		for( c = 0; c < ChannelCount; c++ )
+		{
+			const double* mp = &MultiBuf[ c ];
+			int i;
+
+			for( i = 0; i < ml; i++ )
+			{
+				p[ i ] = *mp;
+				mp += cs;
+			}
+
+			double* rp;
+			ol = min( omax, Resamplers[ c ] -> processSteps( InterpStep + 1,
+				StepCount, p, ml, rp ));
+
+			convertOut( rp, 1, ol, getOut( c ), os );
+		}
+
+		return( ol );
+	}
+};
+
+// ---------------------------------------------------------------------------
+
+} // namespace r8b
+
+#endif // R8B_CDSPMULTIRESAMPLER_INCLUDED
@@ -0,0 +1,514 @@
+//$ nobt
+//$ nocpp
+
+/**
+ * @file CDSPObjCache.h
+ *
+ * @brief Sharded object cache class with lock-free lookup.
+ *
+ * This file includes the cache used to keep the calculated FIR filters and
+ * fractional delay filter banks.
+ *
+ * r8brain-free-src Copyright (c) 2013-2022 Aleksey Vaneev
+ * See the "LICENSE" file for license.
+ */
+
+#ifndef R8B_CDSPOBJCACHE_INCLUDED
+#define R8B_CDSPOBJCACHE_INCLUDED
+
+#include <atomic>
+#include "r8bbase.h"
+
+namespace r8b {
+
+/**
+ * @brief Object cache statistics.
+ */
+
+struct CObjCacheStats
+{
+	long long Hits; ///< The number of lookups that returned a cached object.
+	long long Misses; ///< The number of lookups that built a new object.
+	long long Evictions; ///< The number of objects removed from the cache.
+	int ObjCount; ///< The number of non-static objects in the cache now.
+};
+
+/**
+ * Function calculates the FNV-1a hash of the specified memory block. Can be
+ * chained by passing the previous result in "h".
+ *
+ * @param p Memory block.
+ * @param l Memory block's length, in bytes.
+ * @param h Initial hash value.
+ */
+
+inline uint32_t calcObjHash( const void* const p, const size_t l,
+	uint32_t h = 2166136261U )
+{
+	const uint8_t* const b = (const uint8_t*) p;
+	size_t i;
+
+	for( i = 0; i < l; i++ )
+	{
+		h = ( h ^ b[ i ]) * 16777619U;
+	}
+
+	return( h );
+}
+
+/**
+ * @brief Base class of the objects kept by the CObjCache class.
+ *
+ * Holds the object's reference count and the cache's bookkeeping. A
+ * negative reference count marks an object that has been evicted. The atomic
+ * members make the class non-copyable.
+ */
+
+class CObjCacheEntry : public R8B_BASECLASS
+{
+	template< class T > friend class CObjCache;
+
+public:
+	CObjCacheEntry()
+		: Next( NULL )
+		, RefCount( 1 )
+		, Hash( 0 )
+		, LastUse( 0 )
+		, IsStatic( false )
+		, RetiredNext( NULL )
+		, RetireEpoch( 0 )
+	{
+	}
+
+protected:
+	std::atomic< CObjCacheEntry* > Next; ///< Next object in shard's list.
+	std::atomic< int > RefCount; ///< The number of references made to *this
+		///< object. Not considered for "static" objects.
+	uint32_t Hash; ///< Hash of the parameters *this object was built with.
+	std::atomic< unsigned > LastUse; ///< Shard's use tick at the last lookup
+		///< of *this object.
+	bool IsStatic; ///< "True" if *this object is never evicted.
+	CObjCacheEntry* RetiredNext; ///< Next object in shard's retired list.
+	unsigned RetireEpoch; ///< Shard's epoch when *this object was evicted.
+};
+
+/**
+ * @brief Sharded object cache class.
+ *
+ * Objects are distributed over R8B_CACHE_SHARDS shards by the hash of their
+ * parameters. Each shard is a singly-linked list which is only modified
+ * while the shard's lock is held, and which is read without locking. A
+ * lookup that finds the object never locks, so threads that construct
+ * resamplers with the same parameters do not serialize. A lookup that misses
+ * locks only the shard, and builds the object while other shards remain
+ * available.
+ *
+ * Objects are evicted when the shard's number of non-static objects reaches
+ * its share of the cache size, the object that was looked up least recently
+ * among the unreferenced ones being removed. An evicted object is unlinked
+ * at once, but lock-free lookups that started before that may still be
+ * reading it, so it is kept on the shard's retired list and deleted by a
+ * miss, once the shard's epoch has advanced twice. The epoch advances
+ * when the lookups of the previous epoch have finished, eviction never waits
+ * for lookups.
+ *
+ * @tparam T Object type, derived from the CObjCacheEntry class.
+ */
+
+template< class T >
+class CObjCache
+{
+	R8BNOCTOR( CObjCache );
+
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param MaxObjCount The number of non-static objects kept in the cache
+	 * at most. The actual number can be higher if many different objects
+	 * are in use at the same time.
+	 */
+
+	CObjCache( const int MaxObjCount )
+		: ShardMax(( MaxObjCount + R8B_CACHE_SHARDS - 1 ) / R8B_CACHE_SHARDS )
+	{
+		if( ShardMax < 1 )
+		{
+			ShardMax = 1;
+		}
+	}
+
+	~CObjCache()
+	{
+		int i;
+
+		for( i = 0; i < R8B_CACHE_SHARDS; i++ )
+		{
+			CObjCacheEntry* e = Shards[ i ].Head.load();
+
+			while( e != NULL )
+			{
+				CObjCacheEntry* const n = e -> Next.load();
+				delete (T*) e;
+				e = n;
+			}
+
+			e = Shards[ i ].Retired;
+
+			while( e != NULL )
+			{
+				CObjCacheEntry* const n = e -> RetiredNext;
+				delete (T*) e;
+				e = n;
+			}
+		}
+	}
+
+	/**
+	 * Function returns a reference to a cached object, or builds a new one.
+	 * The object's reference count is incremented, and should be decremented
+	 * via the release() function after use.
+	 *
+	 * @param Hash Hash of the object's parameters.
+	 * @param IsStatic "True" if the object should never be evicted.
+	 * @param Match Function object that returns "true" if the supplied
+	 * "const T&" object has the required parameters.
+	 * @param Build Function object that returns a new "T*" object with the
+	 * required parameters.
+	 */
+
+	template< class TMatch, class TBuild >
+	T& acquire( const uint32_t Hash, const bool IsStatic, const TMatch& Match,
+		const TBuild& Build )
+	{
+		CShard& sh = Shards[ Hash % R8B_CACHE_SHARDS ];
+		T* obj = find( sh, Hash, IsStatic, Match );
+
+		if( obj != NULL )
+		{
+			sh.Hits.fetch_add( 1, std::memory_order_relaxed );
+			return( *obj );
+		}
+
+		R8BSYNC( sh.Sync );
+
+		// Another thread may have built the object while this thread was
+		// waiting.
+
+		obj = find( sh, Hash, IsStatic, Match );
+
+		if( obj != NULL )
+		{
+			sh.Hits.fetch_add( 1, std::memory_order_relaxed );
+			return( *obj );
+		}
+
+		sh.Misses.fetch_add( 1, std::memory_order_relaxed );
+
+		if( !IsStatic )
+		{
+			evict( sh );
+			sh.ObjCount++;
+		}
+
+		reclaim( sh );
+
+		obj = Build();
+		obj -> Hash = Hash;
+		obj -> IsStatic = IsStatic;
+		obj -> RefCount.store( 1, std::memory_order_relaxed );
+		obj -> LastUse.store( sh.Tick.fetch_add( 1,
+			std::memory_order_relaxed ), std::memory_order_relaxed );
+
+		obj -> Next.store( sh.Head.load( std::memory_order_relaxed ),
+			std::memory_order_relaxed );
+
+		sh.Head.store( obj, std::memory_order_release );
+
+		return( *obj );
+	}
+
+	/**
+	 * Function releases a reference obtained via the acquire() function.
+	 *
+	 * @param obj Object to release.
+	 */
+
+	static void release( CObjCacheEntry& obj )
+	{
+		obj.RefCount.fetch_sub( 1, std::memory_order_release );
+	}
+
+	/**
+	 * @return The number of non-static objects present in the cache now.
+	 */
+
+	int getObjCount() const
+	{
+		int c = 0;
+		int i;
+
+		for( i = 0; i < R8B_CACHE_SHARDS; i++ )
+		{
+			R8BSYNC( Shards[ i ].Sync );
+
+			c += Shards[ i ].ObjCount;
+		}
+
+		return( c );
+	}
+
+	/**
+	 * @return Cache statistics, summed over all shards.
+	 */
+
+	CObjCacheStats getStats() const
+	{
+		CObjCacheStats s;
+		s.Hits = 0;
+		s.Misses = 0;
+		s.Evictions = 0;
+		s.ObjCount = getObjCount();
+		int i;
+
+		for( i = 0; i < R8B_CACHE_SHARDS; i++ )
+		{
+			s.Hits += Shards[ i ].Hits.load( std::memory_order_relaxed );
+			s.Misses += Shards[ i ].Misses.load( std::memory_order_relaxed );
+			s.Evictions += Shards[ i ].Evictions.load(
+				std::memory_order_relaxed );
+		}
+
+		return( s );
+	}
+
+	/**
+	 * Function resets the hit, miss and eviction counters.
+	 */
+
+	void resetStats()
+	{
+		int i;
+
+		for( i = 0; i < R8B_CACHE_SHARDS; i++ )
+		{
+			Shards[ i ].Hits.store( 0, std::memory_order_relaxed );
+			Shards[ i ].Misses.store( 0, std::memory_order_relaxed );
+			Shards[ i ].Evictions.store( 0, std::memory_order_relaxed );
+		}
+	}
+
+private:
+	/**
+	 * @brief Cache shard, aligned to avoid false sharing between shards.
+	 */
+
+	struct alignas( 64 ) CShard
+	{
+		mutable CSyncObject Sync; ///< Synchronizes list modifications.
+		std::atomic< CObjCacheEntry* > Head; ///< The first object.
+		std::atomic< unsigned > Epoch; ///< Reader generation.
+		std::atomic< int > Readers[ 2 ]; ///< The number of lock-free lookups
+			///< in progress, by the parity of the epoch they started in.
+		CObjCacheEntry* Retired; ///< Evicted objects not yet deleted,
+			///< modified while Sync is held.
+		std::atomic< unsigned > Tick; ///< Lookup counter, for eviction.
+		std::atomic< long long > Hits; ///< Hit counter.
+		std::atomic< long long > Misses; ///< Miss counter.
+		std::atomic< long long > Evictions; ///< Eviction counter.
+		int ObjCount; ///< The number of non-static objects, modified while
+			///< Sync is held.
+
+		CShard()
+			: Head( NULL )
+			, Epoch( 0 )
+			, Retired( NULL )
+			, Tick( 0 )
+			, Hits( 0 )
+			, Misses( 0 )
+			, Evictions( 0 )
+			, ObjCount( 0 )
+		{
+			Readers[ 0 ].store( 0 );
+			Readers[ 1 ].store( 0 );
+		}
+	};
+
+	static const int DeadRefCount = -0x40000000; ///< Reference count that
+		///< marks an object being evicted, lookups ignore such objects.
+
+	CShard Shards[ R8B_CACHE_SHARDS ]; ///< Cache shards.
+	int ShardMax; ///< The number of non-static objects per shard, at most.
+
+	/**
+	 * Function searches the shard without locking, and increments the
+	 * reference count of the object found.
+	 *
+	 * @return The object found, or NULL.
+	 */
+
+	template< class TMatch >
+	T* find( CShard& sh, const uint32_t Hash, const bool IsStatic,
+		const TMatch& Match )
+	{
+		std::atomic< int >& rd = sh.Readers[ sh.Epoch.load() & 1 ];
+		rd.fetch_add( 1 );
+
+		T* Found = NULL;
+		CObjCacheEntry* e = sh.Head.load();
+
+		while( e != NULL )
+		{
+			if( e -> Hash == Hash && e -> IsStatic == IsStatic &&
+				Match( *(const T*) e ))
+			{
+				int rc = e -> RefCount.load( std::memory_order_relaxed );
+
+				while( rc >= 0 && !e -> RefCount.compare_exchange_weak( rc,
+					rc + 1, std::memory_order_acquire ))
+				{
+				}
+
+				if( rc >= 0 )
+				{
+					e -> LastUse.store( sh.Tick.fetch_add( 1,
+						std::memory_order_relaxed ), std::memory_order_relaxed );
+
+					Found = (T*) e;
+					break;
+				}
+			}
+
+			e = e -> Next.load();
+		}
+
+		rd.fetch_sub( 1 );
+
+		return( Found );
+	}
+
+	/**
+	 * Function evicts the least recently looked up unreferenced object, if
+	 * the shard is full. Should be called while shard's lock is held.
+	 */
+
+	void evict( CShard& sh )
+	{
+		if( sh.ObjCount < ShardMax )
+		{
+			return;
+		}
+
+		CObjCacheEntry* Prev = NULL;
+		CObjCacheEntry* Cand = NULL;
+		CObjCacheEntry* CandPrev = NULL;
+		CObjCacheEntry* e = sh.Head.load( std::memory_order_relaxed );
+
+		while( e != NULL )
+		{
+			if( !e -> IsStatic &&
+				e -> RefCount.load( std::memory_order_relaxed ) == 0 &&
+				( Cand == NULL || (int) ( e -> LastUse.load(
+				std::memory_order_relaxed ) - Cand -> LastUse.load(
+				std::memory_order_relaxed )) < 0 ))
+			{
+				Cand = e;
+				CandPrev = Prev;
+			}
+
+			Prev = e;
+			e = e -> Next.load( std::memory_order_relaxed );
+		}
+
+		int rc = 0;
+
+		if( Cand == NULL || !Cand -> RefCount.compare_exchange_strong( rc,
+			DeadRefCount, std::memory_order_acquire ))
+		{
+			// All objects are in use, or the candidate has just been looked
+			// up. Let the shard grow.
+
+			return;
+		}
+
+		CObjCacheEntry* const n = Cand -> Next.load( std::memory_order_relaxed );
+
+		if( CandPrev == NULL )
+		{
+			sh.Head.store( n );
+		}
+		else
+		{
+			CandPrev -> Next.store( n );
+		}
+
+		// Lookups that started before the unlinking may still hold the
+		// object's pointer, its deletion is deferred.
+
+		Cand -> RetireEpoch = sh.Epoch.load();
+		Cand -> RetiredNext = sh.Retired;
+		sh.Retired = Cand;
+
+		sh.ObjCount--;
+		sh.Evictions.fetch_add( 1, std::memory_order_relaxed );
+	}
+
+	/**
+	 * Function advances the shard's epoch as far as finished lookups allow,
+	 * and deletes the retired objects no lookup can still be reading. Should
+	 * be called while shard's lock is held, does not wait.
+	 *
+	 * A lookup counts itself in the Readers element of the epoch's parity it
+	 * read before loading the list head. The epoch advances from E to E + 1
+	 * only when no lookup of the parity of E - 1 is in progress, so after two
+	 * advances both counters have been seen at zero after an object's
+	 * unlinking: lookups that started earlier have finished, and the later
+	 * ones cannot reach the object.
+	 */
+
+	void reclaim( CShard& sh )
+	{
+		if( sh.Retired == NULL )
+		{
+			return;
+		}
+
+		int i;
+
+		for( i = 0; i < 2; i++ )
+		{
+			const unsigned ep = sh.Epoch.load();
+
+			if( sh.Readers[( ep - 1 ) & 1 ].load() != 0 )
+			{
+				break;
+			}
+
+			sh.Epoch.store( ep + 1 );
+		}
+
+		const unsigned ep = sh.Epoch.load();
+		CObjCacheEntry** pe = &sh.Retired;
+
+		while( *pe != NULL )
+		{
+			CObjCacheEntry* const e = *pe;
+
+			if( ep - e -> RetireEpoch >= 2 )
+			{
+				*pe = e -> RetiredNext;
+				delete (T*) e;
+			}
+			else
+			{
+				pe = &e -> RetiredNext;
+			}
+		}
+	}
+};
+
+// ---------------------------------------------------------------------------
+
+} // namespace r8b
+
+#endif // R8B_CDSPOBJCACHE_INCLUDED
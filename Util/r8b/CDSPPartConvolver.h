@@ -0,0 +1,628 @@
+//$ nobt
+//$ nocpp
+
+/**
+ * @file CDSPPartConvolver.h
+ *
+ * @brief Partitioned overlap-save convolution processor class.
+ *
+ * This file includes low-latency partitioned overlap-save convolution
+ * classes, suitable for long impulse responses, e.g. cabinet IRs.
+ *
+ * r8brain-free-src Copyright (c) 2013-2022 Aleksey Vaneev
+ * See the "LICENSE" file for license.
+ */
+
+#ifndef R8B_CDSPPARTCONVOLVER_INCLUDED
+#define R8B_CDSPPARTCONVOLVER_INCLUDED
+
+#include "CDSPRealFFT.h"
+
+namespace r8b {
+
+/**
+ * @brief Partition layout of a partitioned convolver.
+ *
+ * Describes how an impulse response is split into convolution stages. Each
+ * stage is a uniformly-partitioned overlap-save convolver with its own block
+ * length. In the uniform mode there is a single stage. In the non-uniform
+ * mode each next stage has a 4 times longer block and covers the impulse
+ * response segment that starts at (StageBlockLen - BlockLen), which aligns
+ * the stage's own latency with the overall latency of BlockLen samples
+ * without extra delay lines.
+ */
+
+class CDSPPartLayout
+{
+public:
+	static const int MaxStages = 8; ///< The maximal number of stages.
+	static const int StageGrowBits = 2; ///< Block length growth between
+		///< stages, expressed as Nth power of 2.
+	static const int StagePartCount = ( 1 << StageGrowBits ) - 1; ///< The
+		///< number of partitions in each non-final non-uniform stage.
+
+	int BlockLenBits; ///< Block length of the first stage (latency),
+		///< expressed as Nth power of 2.
+	int MaxIRLen; ///< The maximal supported impulse response length.
+	int StageCount; ///< The number of stages in use.
+	int StageBlockLenBits[ MaxStages ]; ///< Block length of each stage.
+	int StageIROffs[ MaxStages ]; ///< Impulse response offset of each stage.
+	int StageParts[ MaxStages ]; ///< The number of partitions of each stage.
+
+	CDSPPartLayout()
+		: BlockLenBits( 0 )
+		, MaxIRLen( 0 )
+		, StageCount( 0 )
+	{
+	}
+
+	/**
+	 * Constructor calculates the layout.
+	 *
+	 * @param aBlockLenBits Block length of the first stage, expressed as Nth
+	 * power of 2, in the range [4; 16] inclusive. Defines the latency.
+	 * @param aMaxIRLen The maximal impulse response length to support.
+	 * @param IsNonUniform "True" if the non-uniform layout should be used.
+	 * @param MaxBlockLenBits The maximal stage block length, expressed as Nth
+	 * power of 2. The last stage takes all remaining partitions at this
+	 * length.
+	 */
+
+	CDSPPartLayout( const int aBlockLenBits, const int aMaxIRLen,
+		const bool IsNonUniform, const int MaxBlockLenBits = 14 )
+		: BlockLenBits( aBlockLenBits )
+		, MaxIRLen( aMaxIRLen )
+		, StageCount( 0 )
+	{
+		R8BASSERT( BlockLenBits >= 4 && BlockLenBits <= 16 );
+		R8BASSERT( MaxIRLen > 0 );
+
+		const int BlockLen = 1 << BlockLenBits;
+
+		if( !IsNonUniform )
+		{
+			StageBlockLenBits[ 0 ] = BlockLenBits;
+			StageIROffs[ 0 ] = 0;
+			StageParts[ 0 ] = ( MaxIRLen + BlockLen - 1 ) >> BlockLenBits;
+			StageCount = 1;
+			return;
+		}
+
+		int sbits = BlockLenBits;
+		int offs = 0;
+
+		while( offs < MaxIRLen )
+		{
+			const int sl = 1 << sbits;
+			const int rem = ( MaxIRLen - offs + sl - 1 ) >> sbits;
+			const bool IsLast = ( sbits + StageGrowBits > MaxBlockLenBits ||
+				StageCount == MaxStages - 1 );
+
+			StageBlockLenBits[ StageCount ] = sbits;
+			StageIROffs[ StageCount ] = offs;
+			StageParts[ StageCount ] = ( IsLast ? rem :
+				min( rem, StagePartCount ));
+
+			offs += StageParts[ StageCount ] << sbits;
+			StageCount++;
+
+			if( IsLast )
+			{
+				break;
+			}
+
+			sbits += StageGrowBits;
+		}
+	}
+
+	/**
+	 * @param s Layout to compare with.
+	 * @return "True" if the layouts are identical.
+	 */
+
+	bool equals( const CDSPPartLayout& s ) const
+	{
+		if( BlockLenBits != s.BlockLenBits || StageCount != s.StageCount )
+		{
+			return( false );
+		}
+
+		int i;
+
+		for( i = 0; i < StageCount; i++ )
+		{
+			if( StageBlockLenBits[ i ] != s.StageBlockLenBits[ i ] ||
+				StageParts[ i ] != s.StageParts[ i ])
+			{
+				return( false );
+			}
+		}
+
+		return( true );
+	}
+};
+
+/**
+ * @brief Frequency-domain impulse response of a partitioned convolver.
+ *
+ * Holds the forward-transformed partitions of an impulse response for a
+ * given partition layout. Objects of this class are immutable after
+ * construction and can be shared by any number of convolvers using the same
+ * layout. Construction allocates memory and performs FFTs, and should be
+ * done outside the real-time processing thread.
+ */
+
+class CDSPPartKernel : public R8B_BASECLASS
+{
+	R8BNOCTOR( CDSPPartKernel );
+
+public:
+	/**
+	 * Constructor transforms the impulse response.
+	 *
+	 * @param aLayout Partition layout to use.
+	 * @param IR Impulse response.
+	 * @param aIRLen The length of the impulse response, in samples. Samples
+	 * beyond the layout's MaxIRLen are ignored.
+	 * @param Gain Gain to apply to the impulse response.
+	 */
+
+	CDSPPartKernel( const CDSPPartLayout& aLayout, const double* const IR,
+		const int aIRLen, const double Gain = 1.0 )
+		: Layout( aLayout )
+		, IRLen( min( aIRLen, aLayout.MaxIRLen ))
+		, IsFloat( false )
+	{
+		R8BASSERT( IRLen >= 0 );
+
+		int TotalLen = 0;
+		int s;
+
+		for( s = 0; s < Layout.StageCount; s++ )
+		{
+			StageOffs[ s ] = TotalLen;
+			TotalLen += Layout.StageParts[ s ] <<
+				( Layout.StageBlockLenBits[ s ] + 1 );
+		}
+
+		Spectra.alloc( TotalLen );
+
+		for( s = 0; s < Layout.StageCount; s++ )
+		{
+			const int sbits = Layout.StageBlockLenBits[ s ];
+			const int sl = 1 << sbits;
+			CDSPRealFFTKeeper ffto( sbits + 1 );
+			const double m = Gain * ffto -> getInvMulConst();
+			IsFloat = ffto -> isFloat();
+
+			ActiveParts[ s ] = 0;
+			int p;
+
+			for( p = 0; p < Layout.StageParts[ s ]; p++ )
+			{
+				double* const sp = &Spectra[ StageOffs[ s ] +
+					( p << ( sbits + 1 ))];
+
+				const int ir0 = Layout.StageIROffs[ s ] + ( p << sbits );
+				const int c = max( 0, min( sl, IRLen - ir0 ));
+				int i;
+
+				for( i = 0; i < c; i++ )
+				{
+					sp[ i ] = IR[ ir0 + i ] * m;
+				}
+
+				memset( &sp[ c ], 0, (( sl << 1 ) - c ) * sizeof( sp[ 0 ]));
+
+				if( c > 0 )
+				{
+					ffto -> forward( sp );
+					ActiveParts[ s ] = p + 1;
+				}
+			}
+		}
+
+		R8BCONSOLE( "CDSPPartKernel: ir_len=%i stages=%i\n", IRLen,
+			Layout.StageCount );
+	}
+
+	/**
+	 * @return Partition layout used by *this kernel.
+	 */
+
+	const CDSPPartLayout& getLayout() const
+	{
+		return( Layout );
+	}
+
+	/**
+	 * @return Impulse response length, in samples.
+	 */
+
+	int getIRLen() const
+	{
+		return( IRLen );
+	}
+
+private:
+	friend class CDSPPartConvolver;
+
+	CDSPPartLayout Layout; ///< Partition layout.
+	int IRLen; ///< Impulse response length, in samples.
+	bool IsFloat; ///< "True" if the spectra were produced by a "float" FFT
+		///< object and hold "float" values.
+	CFixedBuffer< double > Spectra; ///< Partition spectra of all stages.
+	int StageOffs[ CDSPPartLayout :: MaxStages ]; ///< Offset of each
+		///< stage's partitions in the Spectra buffer.
+	int ActiveParts[ CDSPPartLayout :: MaxStages ]; ///< The number of
+		///< non-zero partitions of each stage.
+};
+
+/**
+ * @brief Low-latency partitioned overlap-save convolution processor.
+ *
+ * The latency is equal to the first stage's block length. The input spectra
+ * history (frequency-domain delay line) is independent of the kernel, so the
+ * kernel can be swapped at any time. A swap is performed with a linear
+ * crossfade over each stage's next output block: both kernels are applied to
+ * the same input history, so no transient is produced. The setKernel() and
+ * process() functions do not allocate memory nor use locks.
+ *
+ * In the non-uniform mode all stages finish their blocks at the same time
+ * once per longest stage block, which makes the processing cost of such
+ * blocks higher than that of others.
+ */
+
+class CDSPPartConvolver : public R8B_BASECLASS
+{
+	R8BNOCTOR( CDSPPartConvolver );
+
+public:
+	/**
+	 * Constructor allocates all buffers for the specified layout.
+	 *
+	 * @param aLayout Partition layout.
+	 */
+
+	CDSPPartConvolver( const CDSPPartLayout& aLayout )
+		: Layout( aLayout )
+		, Kernel( NULL )
+	{
+		int s;
+
+		for( s = 0; s < Layout.StageCount; s++ )
+		{
+			CStage& st = Stages[ s ];
+			const int sbits = Layout.StageBlockLenBits[ s ];
+
+			st.BlockLen = 1 << sbits;
+			st.Parts = Layout.StageParts[ s ];
+			st.ffto.init( sbits + 1 );
+			st.InBuf.alloc( st.BlockLen * 2 );
+			st.OutBuf.alloc( st.BlockLen );
+			st.FDL.alloc( st.Parts * st.BlockLen * 2 );
+			st.Acc.alloc( st.BlockLen * 2 );
+			st.Acc2.alloc( st.BlockLen * 2 );
+		}
+
+		clear();
+	}
+
+	/**
+	 * @return Partition layout used by *this convolver.
+	 */
+
+	const CDSPPartLayout& getLayout() const
+	{
+		return( Layout );
+	}
+
+	/**
+	 * @return Latency of the output, in samples.
+	 */
+
+	int getLatency() const
+	{
+		return( 1 << Layout.BlockLenBits );
+	}
+
+	/**
+	 * @return "True" if a kernel swap crossfade is still in progress in any
+	 * of the stages. The previous kernel must be kept alive while this
+	 * function returns "true".
+	 */
+
+	bool isXFading() const
+	{
+		int s;
+
+		for( s = 0; s < Layout.StageCount; s++ )
+		{
+			if( Stages[ s ].IsXFading )
+			{
+				return( true );
+			}
+		}
+
+		return( false );
+	}
+
+	/**
+	 * Function sets a new kernel. The previous kernel is crossfaded out.
+	 * If a crossfade is already in progress in a stage, the kernel that was
+	 * set last is replaced without crossfading in that stage.
+	 *
+	 * @param k Kernel to use, NULL to produce silence. Its layout should be
+	 * equal to *this object's layout. The kernel should be kept alive while
+	 * it is in use.
+	 */
+
+	void setKernel( const CDSPPartKernel* const k )
+	{
+		R8BASSERT( k == NULL || k -> Layout.equals( Layout ));
+
+		int s;
+
+		for( s = 0; s < Layout.StageCount; s++ )
+		{
+			CStage& st = Stages[ s ];
+
+			if( !st.IsXFading && Kernel != k )
+			{
+				st.PrevKernel = Kernel;
+				st.IsXFading = true;
+			}
+		}
+
+		Kernel = k;
+	}
+
+	/**
+	 * @return The current kernel, may be NULL.
+	 */
+
+	const CDSPPartKernel* getKernel() const
+	{
+		return( Kernel );
+	}
+
+	/**
+	 * Function clears the input history and output buffers. Any crossfade
+	 * in progress is finished immediately.
+	 */
+
+	void clear()
+	{
+		int s;
+
+		for( s = 0; s < Layout.StageCount; s++ )
+		{
+			CStage& st = Stages[ s ];
+
+			memset( &st.InBuf[ 0 ], 0, st.BlockLen * 2 * sizeof( double ));
+			memset( &st.OutBuf[ 0 ], 0, st.BlockLen * sizeof( double ));
+			memset( &st.FDL[ 0 ], 0, st.Parts * st.BlockLen * 2 *
+				sizeof( double ));
+
+			st.FDLPos = 0;
+			st.Pos = 0;
+			st.PrevKernel = NULL;
+			st.IsXFading = false;
+		}
+	}
+
+	/**
+	 * Function performs convolution of the input samples. The output has
+	 * the same length as the input, delayed by getLatency() samples.
+	 *
+	 * @param ip Input samples.
+	 * @param[out] op Output samples, should not be equal to ip.
+	 * @param l The number of samples to process.
+	 */
+
+	void process( const double* const ip, double* const op, const int l )
+	{
+		R8BASSERT( ip != op );
+		R8BASSERT( l >= 0 );
+
+		int s;
+
+		for( s = 0; s < Layout.StageCount; s++ )
+		{
+			CStage& st = Stages[ s ];
+			int i = 0;
+
+			while( i < l )
+			{
+				const int c = min( l - i, st.BlockLen - st.Pos );
+				memcpy( &st.InBuf[ st.BlockLen + st.Pos ], ip + i,
+					c * sizeof( double ));
+
+				const double* const sp = &st.OutBuf[ st.Pos ];
+				double* const dp = op + i;
+				int j;
+
+				if( s == 0 )
+				{
+					memcpy( dp, sp, c * sizeof( double ));
+				}
+				else
+				{
+					for( j = 0; j < c; j++ )
+					{
+						dp[ j ] += sp[ j ];
+					}
+				}
+
+				st.Pos += c;
+				i += c;
+
+				if( st.Pos == st.BlockLen )
+				{
+					processBlock( s );
+					st.Pos = 0;
+				}
+			}
+		}
+	}
+
+private:
+	/**
+	 * @brief Single uniformly-partitioned stage.
+	 */
+
+	struct CStage
+	{
+		int BlockLen; ///< Block length of the stage.
+		int Parts; ///< The number of partitions (FDL length).
+		int FDLPos; ///< Position of the newest spectrum in the FDL.
+		int Pos; ///< Position within the current block.
+		CDSPRealFFTKeeper ffto; ///< FFT object, 2 * BlockLen.
+		CFixedBuffer< double > InBuf; ///< Previous and current input block.
+		CFixedBuffer< double > OutBuf; ///< Output block being read.
+		CFixedBuffer< double > FDL; ///< Frequency-domain delay line.
+		CFixedBuffer< double > Acc; ///< Spectrum accumulator.
+		CFixedBuffer< double > Acc2; ///< Spectrum accumulator for the
+			///< kernel being crossfaded out.
+		const CDSPPartKernel* PrevKernel; ///< Kernel being crossfaded out,
+			///< may be NULL (crossfade from silence).
+		bool IsXFading; ///< "True" if a crossfade is pending.
+	};
+
+	CDSPPartLayout Layout; ///< Partition layout.
+	CStage Stages[ CDSPPartLayout :: MaxStages ]; ///< Stages.
+	const CDSPPartKernel* Kernel; ///< Current kernel, may be NULL.
+
+	/**
+	 * Function multiplies two complex-valued data blocks and adds the
+	 * result to the output block.
+	 *
+	 * @param ip1 Input data block 1.
+	 * @param ip2 Input data block 2.
+	 * @param[in,out] op Output data block.
+	 * @param Len Block length.
+	 * @tparam T Sample type of the spectra, "float" if they were produced by
+	 * a "float" FFT object, whose forward() packs "float" values at the
+	 * start of the "double" buffer.
+	 */
+
+	template< typename T >
+	static void multiplyAddBlocks( const T* const ip1, const T* const ip2,
+		T* const op, const int Len )
+	{
+		op[ 0 ] += ip1[ 0 ] * ip2[ 0 ];
+		op[ 1 ] += ip1[ 1 ] * ip2[ 1 ];
+
+		int i = 2;
+
+		while( i < Len )
+		{
+			op[ i ] += ip1[ i ] * ip2[ i ] - ip1[ i + 1 ] * ip2[ i + 1 ];
+			op[ i + 1 ] += ip1[ i ] * ip2[ i + 1 ] + ip1[ i + 1 ] * ip2[ i ];
+			i += 2;
+		}
+	}
+
+	/**
+	 * Function accumulates the spectra of the kernel's partitions
+	 * multiplied by the FDL spectra, and performs the inverse FFT.
+	 *
+	 * @param st Stage.
+	 * @param s Stage index.
+	 * @param k Kernel to apply.
+	 * @param[out] acc Accumulator, receives the time-domain result.
+	 */
+
+	void accumulate( CStage& st, const int s, const CDSPPartKernel* const k,
+		double* const acc ) const
+	{
+		const int fl = st.BlockLen * 2;
+		const bool IsFloat = st.ffto -> isFloat();
+
+		memset( acc, 0, fl * ( IsFloat ? sizeof( float ) : sizeof( double )));
+
+		if( k != NULL )
+		{
+			R8BASSERT( k -> IsFloat == IsFloat );
+
+			const double* const kp = &k -> Spectra[ k -> StageOffs[ s ]];
+			const int ap = k -> ActiveParts[ s ];
+			int p;
+
+			for( p = 0; p < ap; p++ )
+			{
+				int fp = st.FDLPos + p;
+
+				if( fp >= st.Parts )
+				{
+					fp -= st.Parts;
+				}
+
+				if( IsFloat )
+				{
+					multiplyAddBlocks( (const float*) ( kp + p * fl ),
+						(const float*) &st.FDL[ fp * fl ], (float*) acc, fl );
+				}
+				else
+				{
+					multiplyAddBlocks( kp + p * fl, &st.FDL[ fp * fl ], acc,
+						fl );
+				}
+			}
+		}
+
+		st.ffto -> inverse( acc );
+	}
+
+	/**
+	 * Function processes a complete input block of a stage.
+	 *
+	 * @param s Stage index.
+	 */
+
+	void processBlock( const int s )
+	{
+		CStage& st = Stages[ s ];
+		const int bl = st.BlockLen;
+		const int fl = bl * 2;
+
+		// Transform the input frame into the newest FDL slot.
+
+		st.FDLPos = ( st.FDLPos == 0 ? st.Parts - 1 : st.FDLPos - 1 );
+		double* const fp = &st.FDL[ st.FDLPos * fl ];
+		memcpy( fp, &st.InBuf[ 0 ], fl * sizeof( double ));
+		st.ffto -> forward( fp );
+
+		memcpy( &st.InBuf[ 0 ], &st.InBuf[ bl ], bl * sizeof( double ));
+
+		accumulate( st, s, Kernel, &st.Acc[ 0 ]);
+		const double* const rp = &st.Acc[ bl ];
+		double* const op = &st.OutBuf[ 0 ];
+		int i;
+
+		if( !st.IsXFading )
+		{
+			memcpy( op, rp, bl * sizeof( double ));
+			return;
+		}
+
+		accumulate( st, s, st.PrevKernel, &st.Acc2[ 0 ]);
+		const double* const rp2 = &st.Acc2[ bl ];
+		const double gs = 1.0 / bl;
+
+		for( i = 0; i < bl; i++ )
+		{
+			const double g = ( i + 0.5 ) * gs;
+			op[ i ] = rp2[ i ] + ( rp[ i ] - rp2[ i ]) * g;
+		}
+
+		st.PrevKernel = NULL;
+		st.IsXFading = false;
+	}
+};
+
+// ---------------------------------------------------------------------------
+
+} // namespace r8b
+
+#endif // R8B_CDSPPARTCONVOLVER_INCLUDED
@@ -28,6 +28,10 @@
 	#include "fft4g.h"
 #endif // !R8B_IPP
 
+#if R8B_PFFFT_RUNTIME
+	#include "pffft.h"
+#endif // R8B_PFFFT_RUNTIME
+
 namespace r8b {
 
 /**
@@ -86,6 +90,29 @@ public:
 		return( Len );
 	}
 
+	/**
+	 * @return "True" if *this object stores transformed data as "float"
+	 * values (in the first half of the "double" buffers), either because
+	 * "float" FFT was selected globally, or because the PFFFT routines were
+	 * selected for *this object at run-time.
+	 */
+
+	bool isFloat() const
+	{
+		return( R8B_FLOATFFT || IsFloat );
+	}
+
+	/**
+	 * @return The minimal FFT length, expressed as Nth power of 2, for which
+	 * "float" PFFFT objects can be selected at run-time. Shorter objects
+	 * always use the default FFT.
+	 */
+
+	static int getMinFloatLenBits()
+	{
+		return( 5 );
+	}
+
 	/**
 	 * Function performs in-place forward FFT.
 	 *
@@ -95,6 +122,24 @@ public:
 
 	void forward( double* const p ) const
 	{
+	#if R8B_PFFFT_RUNTIME
+
+		if( IsFloat )
+		{
+			float* const fp = (float*) p;
+			int i;
+
+			for( i = 0; i < Len; i++ )
+			{
+				fp[ i ] = (float) p[ i ];
+			}
+
+			pffft_transform_ordered( fsetup, fp, fp, fwork, PFFFT_FORWARD );
+			return;
+		}
+
+	#endif // R8B_PFFFT_RUNTIME
+
 	#if R8B_FLOATFFT
 
 		float* const op = (float*) p;
@@ -135,6 +180,25 @@ public:
 
 	void inverse( double* const p ) const
 	{
+	#if R8B_PFFFT_RUNTIME
+
+		if( IsFloat )
+		{
+			float* const fp = (float*) p;
+			pffft_transform_ordered( fsetup, fp, fp, fwork, PFFFT_BACKWARD );
+
+			int i;
+
+			for( i = Len - 1; i >= 0; i-- )
+			{
+				p[ i ] = fp[ i ];
+			}
+
+			return;
+		}
+
+	#endif // R8B_PFFFT_RUNTIME
+
 	#if R8B_IPP
 
 		ippsFFTInv_PermToR_64f( p, p, SPtr, WorkBuffer );
@@ -182,6 +246,18 @@ public:
 	void multiplyBlocks( const double* const aip1, const double* const aip2,
 		double* const aop ) const
 	{
+	#if R8B_PFFFT_RUNTIME
+
+		if( IsFloat )
+		{
+			multiplyBlocksFloat( (const float*) aip1, (const float*) aip2,
+				(float*) aop );
+
+			return;
+		}
+
+	#endif // R8B_PFFFT_RUNTIME
+
 	#if R8B_FLOATFFT
 
 		const float* const ip1 = (const float*) aip1;
@@ -228,6 +304,18 @@ public:
 
 	void multiplyBlocks( const double* const aip, double* const aop ) const
 	{
+	#if R8B_PFFFT_RUNTIME
+
+		if( IsFloat )
+		{
+			multiplyBlocksFloat( (const float*) aip, (const float*) aop,
+				(float*) aop );
+
+			return;
+		}
+
+	#endif // R8B_PFFFT_RUNTIME
+
 	#if R8B_FLOATFFT
 
 		const float* const ip = (const float*) aip;
@@ -281,6 +369,16 @@ public:
 
 	void multiplyBlocksZP( const double* const aip, double* const aop ) const
 	{
+	#if R8B_PFFFT_RUNTIME
+
+		if( IsFloat )
+		{
+			multiplyBlocksZPFloat( (const float*) aip, (float*) aop );
+			return;
+		}
+
+	#endif // R8B_PFFFT_RUNTIME
+
 	#if R8B_FLOATFFT
 
 		const float* const ip = (const float*) aip;
@@ -387,16 +485,39 @@ public:
 
 	void convertToZP( double* const ap ) const
 	{
-	#if R8B_FLOATFFT
-
-		float* const p = (float*) ap;
+		if( isFloat() )
+		{
+			convertToZPT( (float*) ap );
+		}
+		else
+		{
+			convertToZPT( ap );
+		}
+	}
 
-	#else // R8B_FLOATFFT
+private:
+	int LenBits; ///< Length of FFT block (expressed as Nth power of 2).
+	int Len; ///< Length of FFT block (number of real values).
+	double InvMulConst; ///< Inverse FFT multiply constant.
+	CDSPRealFFT* Next; ///< Next object in a singly-linked list.
+	bool IsFloat; ///< "True" if PFFFT "float" routines were selected for
+		///< *this object at run-time.
 
-		double* const p = ap;
+	#if R8B_PFFFT_RUNTIME
+		PFFFT_Setup* fsetup; ///< PFFFT setup object, if IsFloat is "true".
+		CFixedBuffer< float > fwork; ///< PFFFT working buffer.
+	#endif // R8B_PFFFT_RUNTIME
 
-	#endif // R8B_FLOATFFT
+	/**
+	 * Function converts a forward-transformed block into "zero-phase" form.
+	 *
+	 * @param[in,out] p Block to transform.
+	 * @tparam T Block's element type.
+	 */
 
+	template< typename T >
+	void convertToZPT( T* const p ) const
+	{
 		int i = 2;
 
 		while( i < Len )
@@ -406,11 +527,98 @@ public:
 		}
 	}
 
-private:
-	int LenBits; ///< Length of FFT block (expressed as Nth power of 2).
-	int Len; ///< Length of FFT block (number of real values).
-	double InvMulConst; ///< Inverse FFT multiply constant.
-	CDSPRealFFT* Next; ///< Next object in a singly-linked list.
+	#if R8B_PFFFT_RUNTIME
+
+	/**
+	 * Function multiplies two complex-valued "float" data blocks. The output
+	 * block may be equal to the input block 2.
+	 *
+	 * @param ip1 Input data block 1.
+	 * @param ip2 Input data block 2.
+	 * @param[out] op Output data block.
+	 */
+
+	void multiplyBlocksFloat( const float* const ip1, const float* const ip2,
+		float* const op ) const
+	{
+		const float dc = ip1[ 0 ] * ip2[ 0 ];
+		const float ny = ip1[ 1 ] * ip2[ 1 ];
+		int i = 2;
+
+		while( i < Len )
+		{
+			const float re = ip1[ i ] * ip2[ i ] - ip1[ i + 1 ] * ip2[ i + 1 ];
+			op[ i + 1 ] = ip1[ i ] * ip2[ i + 1 ] + ip1[ i + 1 ] * ip2[ i ];
+			op[ i ] = re;
+			i += 2;
+		}
+
+		op[ 0 ] = dc;
+		op[ 1 ] = ny;
+	}
+
+	/**
+	 * Function multiplies a "float" data block by a "zero-phase" response
+	 * block, in-place.
+	 *
+	 * @param ip "Zero-phase" response block.
+	 * @param[in,out] op Data block.
+	 */
+
+	void multiplyBlocksZPFloat( const float* ip, float* op ) const
+	{
+	#if defined( R8B_SSE2 )
+
+		int c8 = Len >> 3;
+
+		while( c8 != 0 )
+		{
+			_mm_store_ps( op, _mm_mul_ps( _mm_load_ps( ip ),
+				_mm_load_ps( op )));
+
+			_mm_store_ps( op + 4, _mm_mul_ps( _mm_load_ps( ip + 4 ),
+				_mm_load_ps( op + 4 )));
+
+			ip += 8;
+			op += 8;
+			c8--;
+		}
+
+		int c = Len & 7;
+
+	#elif defined( R8B_NEON )
+
+		int c8 = Len >> 3;
+
+		while( c8 != 0 )
+		{
+			vst1q_f32( op, vmulq_f32( vld1q_f32( ip ), vld1q_f32( op )));
+			vst1q_f32( op + 4, vmulq_f32( vld1q_f32( ip + 4 ),
+				vld1q_f32( op + 4 )));
+
+			ip += 8;
+			op += 8;
+			c8--;
+		}
+
+		int c = Len & 7;
+
+	#else // SIMD
+
+		int c = Len;
+
+	#endif // SIMD
+
+		while( c != 0 )
+		{
+			*op *= *ip;
+			ip++;
+			op++;
+			c--;
+		}
+	}
+
+	#endif // R8B_PFFFT_RUNTIME
 
 	#if R8B_IPP
 		IppsFFTSpec_R_64f* SPtr; ///< Pointer to initialized data buffer
@@ -473,9 +681,11 @@ private:
 	 * @param aLenBits The length of FFT block (Nth power of 2), specifies the
 	 * number of real values in a block. Values from 1 to 30 inclusive are
 	 * supported.
+	 * @param aIsFloat "True" if PFFFT "float" routines should be used, if
+	 * available for the specified length.
 	 */
 
-	CDSPRealFFT( const int aLenBits )
+	CDSPRealFFT( const int aLenBits, const bool aIsFloat = false )
 		: LenBits( aLenBits )
 		, Len( 1 << aLenBits )
 	#if R8B_IPP
@@ -487,6 +697,8 @@ private:
 	#else // R8B_PFFFT_DOUBLE
 		, InvMulConst( 2.0 / Len )
 	#endif // R8B_IPP
+		, IsFloat( R8B_PFFFT_RUNTIME && aIsFloat &&
+			aLenBits >= getMinFloatLenBits() )
 	{
 	#if R8B_IPP
 
@@ -516,6 +728,20 @@ private:
 
 	#else // R8B_PFFFT_DOUBLE
 
+		#if R8B_PFFFT_RUNTIME
+
+		if( IsFloat )
+		{
+			InvMulConst = 1.0 / Len;
+			fsetup = pffft_new_setup( Len, PFFFT_REAL );
+			fwork.alloc( Len );
+			return;
+		}
+
+		fsetup = NULL;
+
+		#endif // R8B_PFFFT_RUNTIME
+
 		wi.alloc( (int) ceil( 2.0 + sqrt( (double) ( Len >> 1 ))));
 		wi[ 0 ] = 0;
 		wd.alloc( Len >> 1 );
@@ -529,6 +755,11 @@ private:
 			pffft_destroy_setup( setup );
 		#elif R8B_PFFFT_DOUBLE
 			pffftd_destroy_setup( setup );
+		#elif R8B_PFFFT_RUNTIME
+			if( fsetup != NULL )
+			{
+				pffft_destroy_setup( fsetup );
+			}
 		#endif // R8B_PFFFT_DOUBLE
 
 		delete Next;
@@ -560,9 +791,9 @@ public:
 	 * [1; 30] inclusive, specifies the number of real values in a FFT block.
 	 */
 
-	CDSPRealFFTKeeper( const int LenBits )
+	CDSPRealFFTKeeper( const int LenBits, const bool IsFloat = false )
 	{
-		Object = acquire( LenBits );
+		Object = acquire( LenBits, IsFloat );
 	}
 
 	~CDSPRealFFTKeeper()
@@ -590,13 +821,16 @@ public:
 	 *
 	 * @param LenBits The length of FFT block (Nth power of 2), in the range
 	 * [1; 30] inclusive, specifies the number of real values in a FFT block.
+	 * @param IsFloat "True" if PFFFT "float" routines should be used, if
+	 * available for the specified length.
 	 */
 
-	void init( const int LenBits )
+	void init( const int LenBits, const bool IsFloat = false )
 	{
 		if( Object != NULL )
 		{
-			if( Object -> LenBits == LenBits )
+			if( Object -> LenBits == LenBits &&
+				Object -> IsFloat == isFloatAvailable( LenBits, IsFloat ))
 			{
 				return;
 			}
@@ -604,7 +838,7 @@ public:
 			release( Object );
 		}
 
-		Object = acquire( LenBits );
+		Object = acquire( LenBits, IsFloat );
 	}
 
 	/**
@@ -626,26 +860,47 @@ private:
 	static CSyncObject StateSync; ///< FFTObjects synchronizer.
 	static CDSPRealFFT :: CObjKeeper FFTObjects[]; ///< Pool of FFT objects of
 		///< various lengths.
+	static CDSPRealFFT :: CObjKeeper FloatFFTObjects[]; ///< Pool of PFFFT
+		///< "float" FFT objects of various lengths.
+
+	/**
+	 * @return "True" if a "float" FFT object will be used for the specified
+	 * length and request.
+	 *
+	 * @param LenBits FFT block length (expressed as Nth power of 2).
+	 * @param IsFloat "True" if "float" FFT was requested.
+	 */
+
+	static bool isFloatAvailable( const int LenBits, const bool IsFloat )
+	{
+		return( R8B_PFFFT_RUNTIME && IsFloat &&
+			LenBits >= CDSPRealFFT :: getMinFloatLenBits() );
+	}
 
 	/**
 	 * Function acquires FFT object from the global pool.
 	 *
 	 * @param LenBits FFT block length (expressed as Nth power of 2).
+	 * @param IsFloat "True" if "float" FFT was requested.
 	 */
 
-	CDSPRealFFT* acquire( const int LenBits )
+	CDSPRealFFT* acquire( const int LenBits, const bool IsFloat )
 	{
 		R8BASSERT( LenBits > 0 && LenBits <= 30 );
 
+		const bool UseFloat = isFloatAvailable( LenBits, IsFloat );
+		CDSPRealFFT :: CObjKeeper* const Pool =
+			( UseFloat ? FloatFFTObjects : FFTObjects );
+
 		R8BSYNC( StateSync );
 
-		if( FFTObjects[ LenBits ] == NULL )
+		if( Pool[ LenBits ] == NULL )
 		{
-			return( new CDSPRealFFT( LenBits ));
+			return( new CDSPRealFFT( LenBits, UseFloat ));
 		}
 
-		CDSPRealFFT* ffto = FFTObjects[ LenBits ];
-		FFTObjects[ LenBits ] = ffto -> Next;
+		CDSPRealFFT* ffto = Pool[ LenBits ];
+		Pool[ LenBits ] = ffto -> Next;
 
 		return( ffto );
 	}
@@ -658,10 +913,13 @@ private:
 
 	void release( CDSPRealFFT* const ffto )
 	{
+		CDSPRealFFT :: CObjKeeper* const Pool =
+			( ffto -> IsFloat ? FloatFFTObjects : FFTObjects );
+
 		R8BSYNC( StateSync );
 
-		ffto -> Next = FFTObjects[ ffto -> LenBits ];
-		FFTObjects[ ffto -> LenBits ] = ffto;
+		ffto -> Next = Pool[ ffto -> LenBits ];
+		Pool[ ffto -> LenBits ] = ffto;
 	}
 };
 
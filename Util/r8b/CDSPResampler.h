@@ -41,6 +41,13 @@ namespace r8b {
  *
  * Use the CDSPResampler24 class for 24-bit resampling (including 32-bit
  * floating point resampling).
+ *
+ * The resampler is real-time safe after construction: all buffers are
+ * allocated and touched by the constructor, and the process() and clear()
+ * functions do not allocate memory and do not lock, provided the input
+ * length does not exceed the MaxInLen passed to the constructor. This can
+ * be verified in debug builds by enabling R8B_RTCHECK. Construction,
+ * destruction and the oneshot() function are not real-time safe.
  */
 
 class CDSPResampler : public CDSPProcessor
@@ -109,18 +116,31 @@ public:
 	 * stream may become fractionally delayed, depending on the minimum-phase
 	 * filter's actual fractional delay. Linear-phase filters do not have
 	 * fractional delay.
+	 * @param UseFloatFFT "True" if the block convolution stages should use
+	 * the "float" PFFFT routines instead of the default "double" FFT. Has
+	 * no effect unless R8B_PFFFT_RUNTIME is defined as 1 (off by default,
+	 * it requires "pffft.cpp"). This roughly halves the memory bandwidth and
+	 * doubles the SIMD width of the convolution at the expense of precision:
+	 * the output differs from the "double" path by -122 to -129 dBFS peak,
+	 * and the stop-band residual rises to -135 to -169 dB. Measured by
+	 * FFTBenchmark::runFFTBackends() with CDSPResampler24, 2% transition
+	 * band, on 2 s of full-scale white noise at the 44.1/48/96 kHz rate
+	 * pairs. The fractional delay interpolation and the half-band stages
+	 * always use "double" precision.
 	 * @see EDSPFilterPhaseResponse
 	 */
 
 	CDSPResampler( const double SrcSampleRate, const double DstSampleRate,
 		const int aMaxInLen, const double ReqTransBand = 2.0,
 		const double ReqAtten = 206.91,
-		const EDSPFilterPhaseResponse ReqPhase = fprLinearPhase )
+		const EDSPFilterPhaseResponse ReqPhase = fprLinearPhase,
+		const bool UseFloatFFT = false )
 		: StepCapacity( 0 )
 		, StepCount( 0 )
 		, MaxInLen( aMaxInLen )
 		, CurMaxOutLen( aMaxInLen )
 		, LatencyFrac( 0.0 )
+		, InterpStep( -1 )
 	{
 		R8BASSERT( SrcSampleRate > 0.0 );
 		R8BASSERT( DstSampleRate > 0.0 );
@@ -162,7 +182,8 @@ public:
 				addProcessor( new CDSPBlockConvolver(
 					CDSPFIRFilterCache :: getLPFilter(
 					1.0 / ( num > den ? num : den ), ReqTransBand,
-					ReqAtten, ReqPhase, num ), num, den, LatencyFrac ));
+					ReqAtten, ReqPhase, num, NULL, UseFloatFFT ), num, den,
+					LatencyFrac ));
 
 				createTmpBuffers();
 				return;
@@ -198,7 +219,8 @@ public:
 			{
 				addProcessor( new CDSPBlockConvolver(
 					CDSPFIRFilterCache :: getLPFilter( 1.0 / i, ReqTransBand,
-					ReqAtten, ReqPhase, i ), i, 1, LatencyFrac ));
+					ReqAtten, ReqPhase, i, NULL, UseFloatFFT ), i, 1,
+					LatencyFrac ));
 
 				const bool IsThird = ( i == 3 );
 
@@ -222,7 +244,8 @@ public:
 
 			addProcessor( new CDSPBlockConvolver(
 				CDSPFIRFilterCache :: getLPFilter( NormFreq, ReqTransBand,
-				ReqAtten, ReqPhase, 2.0 ), 2, 1, LatencyFrac ));
+				ReqAtten, ReqPhase, 2.0, NULL, UseFloatFFT ), 2, 1,
+				LatencyFrac ));
 
 			// Try intermediate interpolated resampling with subsequent 2X
 			// or 3X upsampling.
@@ -296,6 +319,7 @@ public:
 					num = 2;
 				}
 
+				InterpStep = StepCount;
 				addProcessor( new CDSPFracInterpolator( SrcSampleRate2 * div,
 					DstSampleRate, ReqAtten, false, LatencyFrac ));
 
@@ -310,7 +334,8 @@ public:
 
 				addProcessor( new CDSPBlockConvolver(
 					CDSPFIRFilterCache :: getLPFilter( 1.0 / num, tb,
-					ReqAtten, ReqPhase, num ), num, 1, LatencyFrac ));
+					ReqAtten, ReqPhase, num, NULL, UseFloatFFT ), num, 1,
+					LatencyFrac ));
 
 				const bool IsThird = ( num == 3 );
 
@@ -322,6 +347,7 @@ public:
 			}
 			else
 			{
+				InterpStep = StepCount;
 				addProcessor( new CDSPFracInterpolator( SrcSampleRate2,
 					DstSampleRate, ReqAtten, false, LatencyFrac ));
 			}
@@ -380,10 +406,12 @@ public:
 
 		addProcessor( new CDSPBlockConvolver(
 			CDSPFIRFilterCache :: getLPFilter( NormFreq, ReqTransBand,
-			ReqAtten, ReqPhase, FinGain ), 1, downf, LatencyFrac ));
+			ReqAtten, ReqPhase, FinGain, NULL, UseFloatFFT ), 1, downf,
+			LatencyFrac ));
 
 		if( UseInterp )
 		{
+			InterpStep = StepCount;
 			addProcessor( new CDSPFracInterpolator( SrcSampleRate,
 				DstSampleRate * SrcSRDiv, ReqAtten, IsThird, LatencyFrac ));
 		}
@@ -516,6 +544,8 @@ public:
 
 	virtual void clear()
 	{
+		R8BRTSECTION;
+
 		int i;
 
 		for( i = 0; i < StepCount; i++ )
@@ -554,12 +584,93 @@ public:
 
 	virtual int process( double* ip0, int l, double*& op0 )
 	{
-		R8BASSERT( l >= 0 );
+		R8BRTSECTION;
+		R8BASSERT( l >= 0 && l <= MaxInLen );
+
+		return( processSteps( 0, StepCount, ip0, l, op0 ));
+	}
+
+	/**
+	 * @return The number of processing steps.
+	 */
+
+	int getStepCount() const
+	{
+		return( StepCount );
+	}
+
+	/**
+	 * @return The index of the fractional delay interpolation step, -1 if
+	 * the conversion does not use one (whole-number and "power of 2"
+	 * ratios).
+	 */
+
+	int getInterpStep() const
+	{
+		return( InterpStep );
+	}
+
+	/**
+	 * @return The fractional delay interpolation step. Should only be called
+	 * if getInterpStep() does not return -1.
+	 */
+
+	const CDSPFracInterpolator& getInterpolator() const
+	{
+		R8BASSERT( InterpStep >= 0 );
+
+		return( *(const CDSPFracInterpolator*) Steps[ InterpStep ]);
+	}
+
+	/**
+	 * @return The maximal output length of the processing steps preceding
+	 * the specified step, for the MaxInLen supplied in the constructor.
+	 *
+	 * @param Last Index of the step, 0 to getStepCount(), inclusive.
+	 */
+
+	int getMaxOutLenBefore( const int Last ) const
+	{
+		R8BASSERT( Last >= 0 && Last <= StepCount );
+
+		int l = MaxInLen;
+		int i;
+
+		for( i = 0; i < Last; i++ )
+		{
+			l = Steps[ i ] -> getMaxOutLen( l );
+		}
+
+		return( l );
+	}
+
+	/**
+	 * Function runs a part of the processing steps, e.g. for a caller that
+	 * replaces one of the steps with its own. Running the steps 0 to
+	 * getStepCount() - 1 equals the process() function. The output pointer
+	 * and length limits are the same as those of the process() function.
+	 *
+	 * @param First Index of the first step to run.
+	 * @param Last Index of the step after the last one to run. If equal to
+	 * "First", "op0" receives "ip0".
+	 * @param ip0 Input buffer, the output of the step preceding "First".
+	 * @param l The number of samples available in the input buffer. Should
+	 * not exceed getMaxOutLenBefore( First ).
+	 * @param[out] op0 This variable receives the pointer to the output of
+	 * the step preceding "Last".
+	 * @return The number of samples available in the "op0" output buffer.
+	 */
+
+	int processSteps( const int First, const int Last, double* ip0, int l,
+		double*& op0 )
+	{
+		R8BRTSECTION;
+		R8BASSERT( First >= 0 && First <= Last && Last <= StepCount );
 
 		double* ip = ip0;
 		int i;
 
-		for( i = 0; i < StepCount; i++ )
+		for( i = First; i < Last; i++ )
 		{
 			double* op = TmpBufs[ i & 1 ];
 			l = Steps[ i ] -> process( ip, l, op );
@@ -659,6 +770,8 @@ private:
 	double LatencyFrac; ///< Current fractional latency. After object's
 		///< construction, equals to the remaining fractional latency in the
 		///< output.
+	int InterpStep; ///< Index of the fractional delay interpolation step, -1
+		///< if none.
 
 	/**
 	 * Function adds processor, updates MaxOutLen variable and adjusts length
@@ -704,6 +817,12 @@ private:
 		if( ol > 0 )
 		{
 			TmpBufAll.alloc( ol );
+
+			// Touch the buffer, so that the first process() call does not
+			// page it in.
+
+			memset( &TmpBufAll[ 0 ], 0, ol * sizeof( TmpBufAll[ 0 ]));
+
 			TmpBufs[ 0 ] = &TmpBufAll[ 0 ];
 			TmpBufs[ 1 ] = &TmpBufAll[ TmpBufCapacities[ 0 ]];
 		}
@@ -732,12 +851,14 @@ public:
 	 * @param aMaxInLen The maximal planned length of the input buffer (in
 	 * samples) that will be passed to the resampler.
 	 * @param ReqTransBand Required transition band, in percent.
+	 * @param UseFloatFFT "True" if "float" FFT should be used.
 	 */
 
 	CDSPResampler16( const double SrcSampleRate, const double DstSampleRate,
-		const int aMaxInLen, const double ReqTransBand = 2.0 )
+		const int aMaxInLen, const double ReqTransBand = 2.0,
+		const bool UseFloatFFT = false )
 		: CDSPResampler( SrcSampleRate, DstSampleRate, aMaxInLen, ReqTransBand,
-			136.45, fprLinearPhase )
+			136.45, fprLinearPhase, UseFloatFFT )
 	{
 	}
 };
@@ -763,12 +884,14 @@ public:
 	 * @param aMaxInLen The maximal planned length of the input buffer (in
 	 * samples) that will be passed to the resampler.
 	 * @param ReqTransBand Required transition band, in percent.
+	 * @param UseFloatFFT "True" if "float" FFT should be used.
 	 */
 
 	CDSPResampler16IR( const double SrcSampleRate, const double DstSampleRate,
-		const int aMaxInLen, const double ReqTransBand = 2.0 )
+		const int aMaxInLen, const double ReqTransBand = 2.0,
+		const bool UseFloatFFT = false )
 		: CDSPResampler( SrcSampleRate, DstSampleRate, aMaxInLen, ReqTransBand,
-			109.56, fprLinearPhase )
+			109.56, fprLinearPhase, UseFloatFFT )
 	{
 	}
 };
@@ -793,12 +916,14 @@ public:
 	 * @param aMaxInLen The maximal planned length of the input buffer (in
 	 * samples) that will be passed to the resampler.
 	 * @param ReqTransBand Required transition band, in percent.
+	 * @param UseFloatFFT "True" if "float" FFT should be used.
 	 */
 
 	CDSPResampler24( const double SrcSampleRate, const double DstSampleRate,
-		const int aMaxInLen, const double ReqTransBand = 2.0 )
+		const int aMaxInLen, const double ReqTransBand = 2.0,
+		const bool UseFloatFFT = false )
 		: CDSPResampler( SrcSampleRate, DstSampleRate, aMaxInLen, ReqTransBand,
-			180.15, fprLinearPhase )
+			180.15, fprLinearPhase, UseFloatFFT )
 	{
 	}
 };
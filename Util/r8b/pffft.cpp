@@ -161,6 +161,9 @@ typedef __m128 v4sf;
 #  define VTRANSPOSE4(x0,x1,x2,x3) _MM_TRANSPOSE4_PS(x0,x1,x2,x3)
 #  define VSWAPHL(a,b) _mm_shuffle_ps(b, a, _MM_SHUFFLE(3,2,1,0))
 #  define VALIGNED(ptr) ((((uintptr_t)(ptr)) & 0xF) == 0)
+#  if !defined(PFFFT_NO_AVX)
+#    define PFFFT_X86_WIDE // AVX2 and AVX-512 variants, see the end of this file
+#  endif
 
 /*
   ARM NEON support macros
@@ -284,789 +287,7 @@ void pffft_aligned_free(void *p) {
 
 int pffft_simd_size() { return SIMD_SZ; }
 
-/*
-  passf2 and passb2 has been merged here, fsign = -1 for passf2, +1 for passb2
-*/
-static NEVER_INLINE(void) passf2_ps(int ido, int l1, const v4sf *cc, v4sf *ch, const float *wa1, float fsign) {
-  int k, i;
-  int l1ido = l1*ido;
-  if (ido <= 2) {
-    for (k=0; k < l1ido; k += ido, ch += ido, cc+= 2*ido) {
-      ch[0]         = VADD(cc[0], cc[ido+0]);
-      ch[l1ido]     = VSUB(cc[0], cc[ido+0]);
-      ch[1]         = VADD(cc[1], cc[ido+1]);
-      ch[l1ido + 1] = VSUB(cc[1], cc[ido+1]);
-    }
-  } else {
-    for (k=0; k < l1ido; k += ido, ch += ido, cc += 2*ido) {
-      for (i=0; i<ido-1; i+=2) {
-        v4sf tr2 = VSUB(cc[i+0], cc[i+ido+0]);
-        v4sf ti2 = VSUB(cc[i+1], cc[i+ido+1]);
-        v4sf wr = LD_PS1(wa1[i]), wi = VMUL(LD_PS1(fsign), LD_PS1(wa1[i+1]));
-        ch[i]   = VADD(cc[i+0], cc[i+ido+0]);
-        ch[i+1] = VADD(cc[i+1], cc[i+ido+1]);
-        VCPLXMUL(tr2, ti2, wr, wi);
-        ch[i+l1ido]   = tr2;
-        ch[i+l1ido+1] = ti2;
-      }
-    }
-  }
-}
-
-/*
-  passf3 and passb3 has been merged here, fsign = -1 for passf3, +1 for passb3
-*/
-static NEVER_INLINE(void) passf3_ps(int ido, int l1, const v4sf *cc, v4sf *ch,
-                                    const float *wa1, const float *wa2, float fsign) {
-  static const float taur = -0.5f;
-  float taui = 0.866025403784439f*fsign;
-  int i, k;
-  v4sf tr2, ti2, cr2, ci2, cr3, ci3, dr2, di2, dr3, di3;
-  int l1ido = l1*ido;
-  float wr1, wi1, wr2, wi2;
-  assert(ido > 2);
-  for (k=0; k< l1ido; k += ido, cc+= 3*ido, ch +=ido) {
-    for (i=0; i<ido-1; i+=2) {
-      tr2 = VADD(cc[i+ido], cc[i+2*ido]);
-      cr2 = VADD(cc[i], SVMUL(taur,tr2));
-      ch[i]    = VADD(cc[i], tr2);
-      ti2 = VADD(cc[i+ido+1], cc[i+2*ido+1]);
-      ci2 = VADD(cc[i    +1], SVMUL(taur,ti2));
-      ch[i+1]  = VADD(cc[i+1], ti2);
-      cr3 = SVMUL(taui, VSUB(cc[i+ido], cc[i+2*ido]));
-      ci3 = SVMUL(taui, VSUB(cc[i+ido+1], cc[i+2*ido+1]));
-      dr2 = VSUB(cr2, ci3);
-      dr3 = VADD(cr2, ci3);
-      di2 = VADD(ci2, cr3);
-      di3 = VSUB(ci2, cr3);
-      wr1=wa1[i], wi1=fsign*wa1[i+1], wr2=wa2[i], wi2=fsign*wa2[i+1]; 
-      VCPLXMUL(dr2, di2, LD_PS1(wr1), LD_PS1(wi1));
-      ch[i+l1ido] = dr2; 
-      ch[i+l1ido + 1] = di2;
-      VCPLXMUL(dr3, di3, LD_PS1(wr2), LD_PS1(wi2));
-      ch[i+2*l1ido] = dr3;
-      ch[i+2*l1ido+1] = di3;
-    }
-  }
-} /* passf3 */
-
-static NEVER_INLINE(void) passf4_ps(int ido, int l1, const v4sf *cc, v4sf *ch,
-                                    const float *wa1, const float *wa2, const float *wa3, float fsign) {
-  /* isign == -1 for forward transform and +1 for backward transform */
-
-  int i, k;
-  v4sf ci2, ci3, ci4, cr2, cr3, cr4, ti1, ti2, ti3, ti4, tr1, tr2, tr3, tr4;
-  int l1ido = l1*ido;
-  if (ido == 2) {
-    for (k=0; k < l1ido; k += ido, ch += ido, cc += 4*ido) {
-      tr1 = VSUB(cc[0], cc[2*ido + 0]);
-      tr2 = VADD(cc[0], cc[2*ido + 0]);
-      ti1 = VSUB(cc[1], cc[2*ido + 1]);
-      ti2 = VADD(cc[1], cc[2*ido + 1]);
-      ti4 = VMUL(VSUB(cc[1*ido + 0], cc[3*ido + 0]), LD_PS1(fsign));
-      tr4 = VMUL(VSUB(cc[3*ido + 1], cc[1*ido + 1]), LD_PS1(fsign));
-      tr3 = VADD(cc[ido + 0], cc[3*ido + 0]);
-      ti3 = VADD(cc[ido + 1], cc[3*ido + 1]);
-
-      ch[0*l1ido + 0] = VADD(tr2, tr3);
-      ch[0*l1ido + 1] = VADD(ti2, ti3);
-      ch[1*l1ido + 0] = VADD(tr1, tr4);
-      ch[1*l1ido + 1] = VADD(ti1, ti4);
-      ch[2*l1ido + 0] = VSUB(tr2, tr3);
-      ch[2*l1ido + 1] = VSUB(ti2, ti3);        
-      ch[3*l1ido + 0] = VSUB(tr1, tr4);
-      ch[3*l1ido + 1] = VSUB(ti1, ti4);
-    }
-  } else {
-    for (k=0; k < l1ido; k += ido, ch+=ido, cc += 4*ido) {
-      for (i=0; i<ido-1; i+=2) {
-        float wr1, wi1, wr2, wi2, wr3, wi3;
-        tr1 = VSUB(cc[i + 0], cc[i + 2*ido + 0]);
-        tr2 = VADD(cc[i + 0], cc[i + 2*ido + 0]);
-        ti1 = VSUB(cc[i + 1], cc[i + 2*ido + 1]);
-        ti2 = VADD(cc[i + 1], cc[i + 2*ido + 1]);
-        tr4 = VMUL(VSUB(cc[i + 3*ido + 1], cc[i + 1*ido + 1]), LD_PS1(fsign));
-        ti4 = VMUL(VSUB(cc[i + 1*ido + 0], cc[i + 3*ido + 0]), LD_PS1(fsign));
-        tr3 = VADD(cc[i + ido + 0], cc[i + 3*ido + 0]);
-        ti3 = VADD(cc[i + ido + 1], cc[i + 3*ido + 1]);
-
-        ch[i] = VADD(tr2, tr3);
-        cr3    = VSUB(tr2, tr3);
-        ch[i + 1] = VADD(ti2, ti3);
-        ci3 = VSUB(ti2, ti3);
-
-        cr2 = VADD(tr1, tr4);
-        cr4 = VSUB(tr1, tr4);
-        ci2 = VADD(ti1, ti4);
-        ci4 = VSUB(ti1, ti4);
-        wr1=wa1[i], wi1=fsign*wa1[i+1];
-        VCPLXMUL(cr2, ci2, LD_PS1(wr1), LD_PS1(wi1));
-        wr2=wa2[i], wi2=fsign*wa2[i+1]; 
-        ch[i + l1ido] = cr2;
-        ch[i + l1ido + 1] = ci2;
-
-        VCPLXMUL(cr3, ci3, LD_PS1(wr2), LD_PS1(wi2));
-        wr3=wa3[i], wi3=fsign*wa3[i+1]; 
-        ch[i + 2*l1ido] = cr3;
-        ch[i + 2*l1ido + 1] = ci3;
-
-        VCPLXMUL(cr4, ci4, LD_PS1(wr3), LD_PS1(wi3));
-        ch[i + 3*l1ido] = cr4;
-        ch[i + 3*l1ido + 1] = ci4;
-      }
-    }
-  }
-} /* passf4 */
-
-/*
-  passf5 and passb5 has been merged here, fsign = -1 for passf5, +1 for passb5
-*/
-static NEVER_INLINE(void) passf5_ps(int ido, int l1, const v4sf *cc, v4sf *ch,
-                                    const float *wa1, const float *wa2, 
-                                    const float *wa3, const float *wa4, float fsign) {  
-  static const float tr11 = .309016994374947f;
-  const float ti11 = .951056516295154f*fsign;
-  static const float tr12 = -.809016994374947f;
-  const float ti12 = .587785252292473f*fsign;
-
-  /* Local variables */
-  int i, k;
-  v4sf ci2, ci3, ci4, ci5, di3, di4, di5, di2, cr2, cr3, cr5, cr4, ti2, ti3,
-    ti4, ti5, dr3, dr4, dr5, dr2, tr2, tr3, tr4, tr5;
-
-  float wr1, wi1, wr2, wi2, wr3, wi3, wr4, wi4;
-
-#define cc_ref(a_1,a_2) cc[(a_2-1)*ido + a_1 + 1]
-#define ch_ref(a_1,a_3) ch[(a_3-1)*l1*ido + a_1 + 1]
-
-  assert(ido > 2);
-  for (k = 0; k < l1; ++k, cc += 5*ido, ch += ido) {
-    for (i = 0; i < ido-1; i += 2) {
-      ti5 = VSUB(cc_ref(i  , 2), cc_ref(i  , 5));
-      ti2 = VADD(cc_ref(i  , 2), cc_ref(i  , 5));
-      ti4 = VSUB(cc_ref(i  , 3), cc_ref(i  , 4));
-      ti3 = VADD(cc_ref(i  , 3), cc_ref(i  , 4));
-      tr5 = VSUB(cc_ref(i-1, 2), cc_ref(i-1, 5));
-      tr2 = VADD(cc_ref(i-1, 2), cc_ref(i-1, 5));
-      tr4 = VSUB(cc_ref(i-1, 3), cc_ref(i-1, 4));
-      tr3 = VADD(cc_ref(i-1, 3), cc_ref(i-1, 4));
-      ch_ref(i-1, 1) = VADD(cc_ref(i-1, 1), VADD(tr2, tr3));
-      ch_ref(i  , 1) = VADD(cc_ref(i  , 1), VADD(ti2, ti3));
-      cr2 = VADD(cc_ref(i-1, 1), VADD(SVMUL(tr11, tr2),SVMUL(tr12, tr3)));
-      ci2 = VADD(cc_ref(i  , 1), VADD(SVMUL(tr11, ti2),SVMUL(tr12, ti3)));
-      cr3 = VADD(cc_ref(i-1, 1), VADD(SVMUL(tr12, tr2),SVMUL(tr11, tr3)));
-      ci3 = VADD(cc_ref(i  , 1), VADD(SVMUL(tr12, ti2),SVMUL(tr11, ti3)));
-      cr5 = VADD(SVMUL(ti11, tr5), SVMUL(ti12, tr4));
-      ci5 = VADD(SVMUL(ti11, ti5), SVMUL(ti12, ti4));
-      cr4 = VSUB(SVMUL(ti12, tr5), SVMUL(ti11, tr4));
-      ci4 = VSUB(SVMUL(ti12, ti5), SVMUL(ti11, ti4));
-      dr3 = VSUB(cr3, ci4);
-      dr4 = VADD(cr3, ci4);
-      di3 = VADD(ci3, cr4);
-      di4 = VSUB(ci3, cr4);
-      dr5 = VADD(cr2, ci5);
-      dr2 = VSUB(cr2, ci5);
-      di5 = VSUB(ci2, cr5);
-      di2 = VADD(ci2, cr5);
-      wr1=wa1[i], wi1=fsign*wa1[i+1], wr2=wa2[i], wi2=fsign*wa2[i+1]; 
-      wr3=wa3[i], wi3=fsign*wa3[i+1], wr4=wa4[i], wi4=fsign*wa4[i+1]; 
-      VCPLXMUL(dr2, di2, LD_PS1(wr1), LD_PS1(wi1));
-      ch_ref(i - 1, 2) = dr2;
-      ch_ref(i, 2)     = di2;
-      VCPLXMUL(dr3, di3, LD_PS1(wr2), LD_PS1(wi2));
-      ch_ref(i - 1, 3) = dr3;
-      ch_ref(i, 3)     = di3;
-      VCPLXMUL(dr4, di4, LD_PS1(wr3), LD_PS1(wi3));
-      ch_ref(i - 1, 4) = dr4;
-      ch_ref(i, 4)     = di4;
-      VCPLXMUL(dr5, di5, LD_PS1(wr4), LD_PS1(wi4));
-      ch_ref(i - 1, 5) = dr5;
-      ch_ref(i, 5)     = di5;
-    }
-  }
-#undef ch_ref
-#undef cc_ref
-}
-
-static NEVER_INLINE(void) radf2_ps(int ido, int l1, const v4sf * RESTRICT cc, v4sf * RESTRICT ch, const float *wa1) {
-  static const float minus_one = -1.f;
-  int i, k, l1ido = l1*ido;
-  for (k=0; k < l1ido; k += ido) {
-    v4sf a = cc[k], b = cc[k + l1ido];
-    ch[2*k] = VADD(a, b);
-    ch[2*(k+ido)-1] = VSUB(a, b);
-  }
-  if (ido < 2) return;
-  if (ido != 2) {
-    for (k=0; k < l1ido; k += ido) {
-      for (i=2; i<ido; i+=2) {
-        v4sf tr2 = cc[i - 1 + k + l1ido], ti2 = cc[i + k + l1ido];
-        v4sf br = cc[i - 1 + k], bi = cc[i + k];
-        VCPLXMULCONJ(tr2, ti2, LD_PS1(wa1[i - 2]), LD_PS1(wa1[i - 1])); 
-        ch[i + 2*k] = VADD(bi, ti2);
-        ch[2*(k+ido) - i] = VSUB(ti2, bi);
-        ch[i - 1 + 2*k] = VADD(br, tr2);
-        ch[2*(k+ido) - i -1] = VSUB(br, tr2);
-      }
-    }
-    if (ido % 2 == 1) return;
-  }
-  for (k=0; k < l1ido; k += ido) {
-    ch[2*k + ido] = SVMUL(minus_one, cc[ido-1 + k + l1ido]);
-    ch[2*k + ido-1] = cc[k + ido-1];
-  }
-} /* radf2 */
-
-
-static NEVER_INLINE(void) radb2_ps(int ido, int l1, const v4sf *cc, v4sf *ch, const float *wa1) {
-  static const float minus_two=-2;
-  int i, k, l1ido = l1*ido;
-  v4sf a,b,c,d, tr2, ti2;
-  for (k=0; k < l1ido; k += ido) {
-    a = cc[2*k]; b = cc[2*(k+ido) - 1];
-    ch[k] = VADD(a, b);
-    ch[k + l1ido] =VSUB(a, b);
-  }
-  if (ido < 2) return;
-  if (ido != 2) {
-    for (k = 0; k < l1ido; k += ido) {
-      for (i = 2; i < ido; i += 2) {
-        a = cc[i-1 + 2*k]; b = cc[2*(k + ido) - i - 1];
-        c = cc[i+0 + 2*k]; d = cc[2*(k + ido) - i + 0];
-        ch[i-1 + k] = VADD(a, b);
-        tr2 = VSUB(a, b);
-        ch[i+0 + k] = VSUB(c, d);
-        ti2 = VADD(c, d);
-        VCPLXMUL(tr2, ti2, LD_PS1(wa1[i - 2]), LD_PS1(wa1[i - 1]));
-        ch[i-1 + k + l1ido] = tr2;
-        ch[i+0 + k + l1ido] = ti2;
-      }
-    }
-    if (ido % 2 == 1) return;
-  }
-  for (k = 0; k < l1ido; k += ido) {
-    a = cc[2*k + ido-1]; b = cc[2*k + ido];
-    ch[k + ido-1] = VADD(a,a);
-    ch[k + ido-1 + l1ido] = SVMUL(minus_two, b);
-  }
-} /* radb2 */
-
-static void radf3_ps(int ido, int l1, const v4sf * RESTRICT cc, v4sf * RESTRICT ch,
-                     const float *wa1, const float *wa2) {
-  static const float taur = -0.5f;
-  static const float taui = 0.866025403784439f;
-  int i, k, ic;
-  v4sf ci2, di2, di3, cr2, dr2, dr3, ti2, ti3, tr2, tr3, wr1, wi1, wr2, wi2;
-  for (k=0; k<l1; k++) {
-    cr2 = VADD(cc[(k + l1)*ido], cc[(k + 2*l1)*ido]);
-    ch[3*k*ido] = VADD(cc[k*ido], cr2);
-    ch[(3*k+2)*ido] = SVMUL(taui, VSUB(cc[(k + l1*2)*ido], cc[(k + l1)*ido]));
-    ch[ido-1 + (3*k + 1)*ido] = VADD(cc[k*ido], SVMUL(taur, cr2));
-  }
-  if (ido == 1) return;
-  for (k=0; k<l1; k++) {
-    for (i=2; i<ido; i+=2) {
-      ic = ido - i;
-      wr1 = LD_PS1(wa1[i - 2]); wi1 = LD_PS1(wa1[i - 1]);
-      dr2 = cc[i - 1 + (k + l1)*ido]; di2 = cc[i + (k + l1)*ido];
-      VCPLXMULCONJ(dr2, di2, wr1, wi1);
-
-      wr2 = LD_PS1(wa2[i - 2]); wi2 = LD_PS1(wa2[i - 1]);
-      dr3 = cc[i - 1 + (k + l1*2)*ido]; di3 = cc[i + (k + l1*2)*ido];
-      VCPLXMULCONJ(dr3, di3, wr2, wi2);
-        
-      cr2 = VADD(dr2, dr3);
-      ci2 = VADD(di2, di3);
-      ch[i - 1 + 3*k*ido] = VADD(cc[i - 1 + k*ido], cr2);
-      ch[i + 3*k*ido] = VADD(cc[i + k*ido], ci2);
-      tr2 = VADD(cc[i - 1 + k*ido], SVMUL(taur, cr2));
-      ti2 = VADD(cc[i + k*ido], SVMUL(taur, ci2));
-      tr3 = SVMUL(taui, VSUB(di2, di3));
-      ti3 = SVMUL(taui, VSUB(dr3, dr2));
-      ch[i - 1 + (3*k + 2)*ido] = VADD(tr2, tr3);
-      ch[ic - 1 + (3*k + 1)*ido] = VSUB(tr2, tr3);
-      ch[i + (3*k + 2)*ido] = VADD(ti2, ti3);
-      ch[ic + (3*k + 1)*ido] = VSUB(ti3, ti2);
-    }
-  }
-} /* radf3 */
-
-
-static void radb3_ps(int ido, int l1, const v4sf *RESTRICT cc, v4sf *RESTRICT ch,
-                     const float *wa1, const float *wa2)
-{
-  static const float taur = -0.5f;
-  static const float taui = 0.866025403784439f;
-  static const float taui_2 = 0.866025403784439f*2;
-  int i, k, ic;
-  v4sf ci2, ci3, di2, di3, cr2, cr3, dr2, dr3, ti2, tr2;
-  for (k=0; k<l1; k++) {
-    tr2 = cc[ido-1 + (3*k + 1)*ido]; tr2 = VADD(tr2,tr2);
-    cr2 = VMADD(LD_PS1(taur), tr2, cc[3*k*ido]);
-    ch[k*ido] = VADD(cc[3*k*ido], tr2);
-    ci3 = SVMUL(taui_2, cc[(3*k + 2)*ido]);
-    ch[(k + l1)*ido] = VSUB(cr2, ci3);
-    ch[(k + 2*l1)*ido] = VADD(cr2, ci3);
-  }
-  if (ido == 1) return;
-  for (k=0; k<l1; k++) {
-    for (i=2; i<ido; i+=2) {
-      ic = ido - i;
-      tr2 = VADD(cc[i - 1 + (3*k + 2)*ido], cc[ic - 1 + (3*k + 1)*ido]);
-      cr2 = VMADD(LD_PS1(taur), tr2, cc[i - 1 + 3*k*ido]);
-      ch[i - 1 + k*ido] = VADD(cc[i - 1 + 3*k*ido], tr2);
-      ti2 = VSUB(cc[i + (3*k + 2)*ido], cc[ic + (3*k + 1)*ido]);
-      ci2 = VMADD(LD_PS1(taur), ti2, cc[i + 3*k*ido]);
-      ch[i + k*ido] = VADD(cc[i + 3*k*ido], ti2);
-      cr3 = SVMUL(taui, VSUB(cc[i - 1 + (3*k + 2)*ido], cc[ic - 1 + (3*k + 1)*ido]));
-      ci3 = SVMUL(taui, VADD(cc[i + (3*k + 2)*ido], cc[ic + (3*k + 1)*ido]));
-      dr2 = VSUB(cr2, ci3);
-      dr3 = VADD(cr2, ci3);
-      di2 = VADD(ci2, cr3);
-      di3 = VSUB(ci2, cr3);
-      VCPLXMUL(dr2, di2, LD_PS1(wa1[i-2]), LD_PS1(wa1[i-1]));
-      ch[i - 1 + (k + l1)*ido] = dr2;
-      ch[i + (k + l1)*ido] = di2;
-      VCPLXMUL(dr3, di3, LD_PS1(wa2[i-2]), LD_PS1(wa2[i-1]));
-      ch[i - 1 + (k + 2*l1)*ido] = dr3;
-      ch[i + (k + 2*l1)*ido] = di3;
-    }
-  }
-} /* radb3 */
-
-static NEVER_INLINE(void) radf4_ps(int ido, int l1, const v4sf *RESTRICT cc, v4sf * RESTRICT ch,
-                                   const float * RESTRICT wa1, const float * RESTRICT wa2, const float * RESTRICT wa3)
-{
-  static const float minus_hsqt2 = (float)-0.7071067811865475;
-  int i, k, l1ido = l1*ido;
-  {
-    const v4sf *RESTRICT cc_ = cc, * RESTRICT cc_end = cc + l1ido; 
-    v4sf * RESTRICT ch_ = ch;
-    while (cc < cc_end) {
-      // this loop represents between 25% and 40% of total radf4_ps cost !
-      v4sf a0 = cc[0], a1 = cc[l1ido];
-      v4sf a2 = cc[2*l1ido], a3 = cc[3*l1ido];
-      v4sf tr1 = VADD(a1, a3);
-      v4sf tr2 = VADD(a0, a2);
-      ch[2*ido-1] = VSUB(a0, a2);
-      ch[2*ido  ] = VSUB(a3, a1);
-      ch[0      ] = VADD(tr1, tr2);
-      ch[4*ido-1] = VSUB(tr2, tr1);
-      cc += ido; ch += 4*ido;
-    }
-    cc = cc_; ch = ch_;
-  }
-  if (ido < 2) return;
-  if (ido != 2) {
-    for (k = 0; k < l1ido; k += ido) {
-      const v4sf * RESTRICT pc = (v4sf*)(cc + 1 + k);
-      for (i=2; i<ido; i += 2, pc += 2) {
-        int ic = ido - i;
-        v4sf wr, wi, cr2, ci2, cr3, ci3, cr4, ci4;
-        v4sf tr1, ti1, tr2, ti2, tr3, ti3, tr4, ti4;
-
-        cr2 = pc[1*l1ido+0];
-        ci2 = pc[1*l1ido+1];
-        wr=LD_PS1(wa1[i - 2]);
-        wi=LD_PS1(wa1[i - 1]);
-        VCPLXMULCONJ(cr2,ci2,wr,wi);
-
-        cr3 = pc[2*l1ido+0];
-        ci3 = pc[2*l1ido+1];
-        wr = LD_PS1(wa2[i-2]); 
-        wi = LD_PS1(wa2[i-1]);
-        VCPLXMULCONJ(cr3, ci3, wr, wi);
-
-        cr4 = pc[3*l1ido];
-        ci4 = pc[3*l1ido+1];
-        wr = LD_PS1(wa3[i-2]); 
-        wi = LD_PS1(wa3[i-1]);
-        VCPLXMULCONJ(cr4, ci4, wr, wi);
-
-        /* at this point, on SSE, five of "cr2 cr3 cr4 ci2 ci3 ci4" should be loaded in registers */
-
-        tr1 = VADD(cr2,cr4);
-        tr4 = VSUB(cr4,cr2); 
-        tr2 = VADD(pc[0],cr3);
-        tr3 = VSUB(pc[0],cr3);
-        ch[i - 1 + 4*k] = VADD(tr1,tr2);
-        ch[ic - 1 + 4*k + 3*ido] = VSUB(tr2,tr1); // at this point tr1 and tr2 can be disposed
-        ti1 = VADD(ci2,ci4);
-        ti4 = VSUB(ci2,ci4);
-        ch[i - 1 + 4*k + 2*ido] = VADD(ti4,tr3);
-        ch[ic - 1 + 4*k + 1*ido] = VSUB(tr3,ti4); // dispose tr3, ti4
-        ti2 = VADD(pc[1],ci3);
-        ti3 = VSUB(pc[1],ci3);
-        ch[i + 4*k] = VADD(ti1, ti2);
-        ch[ic + 4*k + 3*ido] = VSUB(ti1, ti2);
-        ch[i + 4*k + 2*ido] = VADD(tr4, ti3);
-        ch[ic + 4*k + 1*ido] = VSUB(tr4, ti3);
-      }
-    }
-    if (ido % 2 == 1) return;
-  }
-  for (k=0; k<l1ido; k += ido) {
-    v4sf a = cc[ido-1 + k + l1ido], b = cc[ido-1 + k + 3*l1ido];
-    v4sf c = cc[ido-1 + k], d = cc[ido-1 + k + 2*l1ido];
-    v4sf ti1 = SVMUL(minus_hsqt2, VADD(a, b));
-    v4sf tr1 = SVMUL(minus_hsqt2, VSUB(b, a));
-    ch[ido-1 + 4*k] = VADD(tr1, c);
-    ch[ido-1 + 4*k + 2*ido] = VSUB(c, tr1);
-    ch[4*k + 1*ido] = VSUB(ti1, d); 
-    ch[4*k + 3*ido] = VADD(ti1, d); 
-  }
-} /* radf4 */
-
-
-static NEVER_INLINE(void) radb4_ps(int ido, int l1, const v4sf * RESTRICT cc, v4sf * RESTRICT ch,
-                                   const float * RESTRICT wa1, const float * RESTRICT wa2, const float *RESTRICT wa3)
-{
-  static const float minus_sqrt2 = (float)-1.414213562373095;
-  static const float two = 2.f;
-  int i, k, l1ido = l1*ido;
-  v4sf ci2, ci3, ci4, cr2, cr3, cr4, ti1, ti2, ti3, ti4, tr1, tr2, tr3, tr4;
-  {
-    const v4sf *RESTRICT cc_ = cc, * RESTRICT ch_end = ch + l1ido; 
-    v4sf *ch_ = ch;
-    while (ch < ch_end) {
-      v4sf a = cc[0], b = cc[4*ido-1];
-      v4sf c = cc[2*ido], d = cc[2*ido-1];
-      tr3 = SVMUL(two,d);
-      tr2 = VADD(a,b);
-      tr1 = VSUB(a,b);
-      tr4 = SVMUL(two,c);
-      ch[0*l1ido] = VADD(tr2, tr3);
-      ch[2*l1ido] = VSUB(tr2, tr3);
-      ch[1*l1ido] = VSUB(tr1, tr4);
-      ch[3*l1ido] = VADD(tr1, tr4);
-      
-      cc += 4*ido; ch += ido;
-    }
-    cc = cc_; ch = ch_;
-  }
-  if (ido < 2) return;
-  if (ido != 2) {
-    for (k = 0; k < l1ido; k += ido) {
-      const v4sf * RESTRICT pc = (v4sf*)(cc - 1 + 4*k);
-      v4sf * RESTRICT ph = (v4sf*)(ch + k + 1);
-      for (i = 2; i < ido; i += 2) {
-
-        tr1 = VSUB(pc[i], pc[4*ido - i]);
-        tr2 = VADD(pc[i], pc[4*ido - i]);
-        ti4 = VSUB(pc[2*ido + i], pc[2*ido - i]);
-        tr3 = VADD(pc[2*ido + i], pc[2*ido - i]);
-        ph[0] = VADD(tr2, tr3);
-        cr3 = VSUB(tr2, tr3);
-
-        ti3 = VSUB(pc[2*ido + i + 1], pc[2*ido - i + 1]);
-        tr4 = VADD(pc[2*ido + i + 1], pc[2*ido - i + 1]);
-        cr2 = VSUB(tr1, tr4);
-        cr4 = VADD(tr1, tr4);
-
-        ti1 = VADD(pc[i + 1], pc[4*ido - i + 1]);
-        ti2 = VSUB(pc[i + 1], pc[4*ido - i + 1]);
-
-        ph[1] = VADD(ti2, ti3); ph += l1ido;
-        ci3 = VSUB(ti2, ti3);
-        ci2 = VADD(ti1, ti4);
-        ci4 = VSUB(ti1, ti4);
-        VCPLXMUL(cr2, ci2, LD_PS1(wa1[i-2]), LD_PS1(wa1[i-1]));
-        ph[0] = cr2;
-        ph[1] = ci2; ph += l1ido;
-        VCPLXMUL(cr3, ci3, LD_PS1(wa2[i-2]), LD_PS1(wa2[i-1]));
-        ph[0] = cr3;
-        ph[1] = ci3; ph += l1ido;
-        VCPLXMUL(cr4, ci4, LD_PS1(wa3[i-2]), LD_PS1(wa3[i-1]));
-        ph[0] = cr4;
-        ph[1] = ci4; ph = ph - 3*l1ido + 2;
-      }
-    }
-    if (ido % 2 == 1) return;
-  }
-  for (k=0; k < l1ido; k+=ido) {
-    int i0 = 4*k + ido;
-    v4sf c = cc[i0-1], d = cc[i0 + 2*ido-1];
-    v4sf a = cc[i0+0], b = cc[i0 + 2*ido+0];
-    tr1 = VSUB(c,d);
-    tr2 = VADD(c,d);
-    ti1 = VADD(b,a);
-    ti2 = VSUB(b,a);
-    ch[ido-1 + k + 0*l1ido] = VADD(tr2,tr2);
-    ch[ido-1 + k + 1*l1ido] = SVMUL(minus_sqrt2, VSUB(ti1, tr1));
-    ch[ido-1 + k + 2*l1ido] = VADD(ti2, ti2);
-    ch[ido-1 + k + 3*l1ido] = SVMUL(minus_sqrt2, VADD(ti1, tr1));
-  }
-} /* radb4 */
-
-static void radf5_ps(int ido, int l1, const v4sf * RESTRICT cc, v4sf * RESTRICT ch, 
-                     const float *wa1, const float *wa2, const float *wa3, const float *wa4)
-{
-  static const float tr11 = .309016994374947f;
-  static const float ti11 = .951056516295154f;
-  static const float tr12 = -.809016994374947f;
-  static const float ti12 = .587785252292473f;
-
-  /* System generated locals */
-  int cc_offset, ch_offset;
-
-  /* Local variables */
-  int i, k, ic;
-  v4sf ci2, di2, ci4, ci5, di3, di4, di5, ci3, cr2, cr3, dr2, dr3, dr4, dr5,
-    cr5, cr4, ti2, ti3, ti5, ti4, tr2, tr3, tr4, tr5;
-  int idp2;
-
-
-#define cc_ref(a_1,a_2,a_3) cc[((a_3)*l1 + (a_2))*ido + a_1]
-#define ch_ref(a_1,a_2,a_3) ch[((a_3)*5 + (a_2))*ido + a_1]
-
-  /* Parameter adjustments */
-  ch_offset = 1 + ido * 6;
-  ch -= ch_offset;
-  cc_offset = 1 + ido * (1 + l1);
-  cc -= cc_offset;
-
-  /* Function Body */
-  for (k = 1; k <= l1; ++k) {
-    cr2 = VADD(cc_ref(1, k, 5), cc_ref(1, k, 2));
-    ci5 = VSUB(cc_ref(1, k, 5), cc_ref(1, k, 2));
-    cr3 = VADD(cc_ref(1, k, 4), cc_ref(1, k, 3));
-    ci4 = VSUB(cc_ref(1, k, 4), cc_ref(1, k, 3));
-    ch_ref(1, 1, k) = VADD(cc_ref(1, k, 1), VADD(cr2, cr3));
-    ch_ref(ido, 2, k) = VADD(cc_ref(1, k, 1), VADD(SVMUL(tr11, cr2), SVMUL(tr12, cr3)));
-    ch_ref(1, 3, k) = VADD(SVMUL(ti11, ci5), SVMUL(ti12, ci4));
-    ch_ref(ido, 4, k) = VADD(cc_ref(1, k, 1), VADD(SVMUL(tr12, cr2), SVMUL(tr11, cr3)));
-    ch_ref(1, 5, k) = VSUB(SVMUL(ti12, ci5), SVMUL(ti11, ci4));
-    //printf("pffft: radf5, k=%d ch_ref=%f, ci4=%f\n", k, ch_ref(1, 5, k), ci4);
-  }
-  if (ido == 1) {
-    return;
-  }
-  idp2 = ido + 2;
-  for (k = 1; k <= l1; ++k) {
-    for (i = 3; i <= ido; i += 2) {
-      ic = idp2 - i;
-      dr2 = LD_PS1(wa1[i-3]); di2 = LD_PS1(wa1[i-2]);
-      dr3 = LD_PS1(wa2[i-3]); di3 = LD_PS1(wa2[i-2]);
-      dr4 = LD_PS1(wa3[i-3]); di4 = LD_PS1(wa3[i-2]);
-      dr5 = LD_PS1(wa4[i-3]); di5 = LD_PS1(wa4[i-2]);
-      VCPLXMULCONJ(dr2, di2, cc_ref(i-1, k, 2), cc_ref(i, k, 2));
-      VCPLXMULCONJ(dr3, di3, cc_ref(i-1, k, 3), cc_ref(i, k, 3));
-      VCPLXMULCONJ(dr4, di4, cc_ref(i-1, k, 4), cc_ref(i, k, 4));
-      VCPLXMULCONJ(dr5, di5, cc_ref(i-1, k, 5), cc_ref(i, k, 5));
-      cr2 = VADD(dr2, dr5);
-      ci5 = VSUB(dr5, dr2);
-      cr5 = VSUB(di2, di5);
-      ci2 = VADD(di2, di5);
-      cr3 = VADD(dr3, dr4);
-      ci4 = VSUB(dr4, dr3);
-      cr4 = VSUB(di3, di4);
-      ci3 = VADD(di3, di4);
-      ch_ref(i - 1, 1, k) = VADD(cc_ref(i - 1, k, 1), VADD(cr2, cr3));
-      ch_ref(i, 1, k) = VSUB(cc_ref(i, k, 1), VADD(ci2, ci3));//
-      tr2 = VADD(cc_ref(i - 1, k, 1), VADD(SVMUL(tr11, cr2), SVMUL(tr12, cr3)));
-      ti2 = VSUB(cc_ref(i, k, 1), VADD(SVMUL(tr11, ci2), SVMUL(tr12, ci3)));//
-      tr3 = VADD(cc_ref(i - 1, k, 1), VADD(SVMUL(tr12, cr2), SVMUL(tr11, cr3)));
-      ti3 = VSUB(cc_ref(i, k, 1), VADD(SVMUL(tr12, ci2), SVMUL(tr11, ci3)));//
-      tr5 = VADD(SVMUL(ti11, cr5), SVMUL(ti12, cr4));
-      ti5 = VADD(SVMUL(ti11, ci5), SVMUL(ti12, ci4));
-      tr4 = VSUB(SVMUL(ti12, cr5), SVMUL(ti11, cr4));
-      ti4 = VSUB(SVMUL(ti12, ci5), SVMUL(ti11, ci4));
-      ch_ref(i - 1, 3, k) = VSUB(tr2, tr5);
-      ch_ref(ic - 1, 2, k) = VADD(tr2, tr5);
-      ch_ref(i, 3, k) = VADD(ti2, ti5);
-      ch_ref(ic, 2, k) = VSUB(ti5, ti2);
-      ch_ref(i - 1, 5, k) = VSUB(tr3, tr4);
-      ch_ref(ic - 1, 4, k) = VADD(tr3, tr4);
-      ch_ref(i, 5, k) = VADD(ti3, ti4);
-      ch_ref(ic, 4, k) = VSUB(ti4, ti3);
-    }
-  }
-#undef cc_ref
-#undef ch_ref
-} /* radf5 */
-
-static void radb5_ps(int ido, int l1, const v4sf *RESTRICT cc, v4sf *RESTRICT ch, 
-                  const float *wa1, const float *wa2, const float *wa3, const float *wa4)
-{
-  static const float tr11 = .309016994374947f;
-  static const float ti11 = .951056516295154f;
-  static const float tr12 = -.809016994374947f;
-  static const float ti12 = .587785252292473f;
-
-  int cc_offset, ch_offset;
-
-  /* Local variables */
-  int i, k, ic;
-  v4sf ci2, ci3, ci4, ci5, di3, di4, di5, di2, cr2, cr3, cr5, cr4, ti2, ti3,
-    ti4, ti5, dr3, dr4, dr5, dr2, tr2, tr3, tr4, tr5;
-  int idp2;
-
-#define cc_ref(a_1,a_2,a_3) cc[((a_3)*5 + (a_2))*ido + a_1]
-#define ch_ref(a_1,a_2,a_3) ch[((a_3)*l1 + (a_2))*ido + a_1]
-
-  /* Parameter adjustments */
-  ch_offset = 1 + ido * (1 + l1);
-  ch -= ch_offset;
-  cc_offset = 1 + ido * 6;
-  cc -= cc_offset;
-
-  /* Function Body */
-  for (k = 1; k <= l1; ++k) {
-    ti5 = VADD(cc_ref(1, 3, k), cc_ref(1, 3, k));
-    ti4 = VADD(cc_ref(1, 5, k), cc_ref(1, 5, k));
-    tr2 = VADD(cc_ref(ido, 2, k), cc_ref(ido, 2, k));
-    tr3 = VADD(cc_ref(ido, 4, k), cc_ref(ido, 4, k));
-    ch_ref(1, k, 1) = VADD(cc_ref(1, 1, k), VADD(tr2, tr3));
-    cr2 = VADD(cc_ref(1, 1, k), VADD(SVMUL(tr11, tr2), SVMUL(tr12, tr3)));
-    cr3 = VADD(cc_ref(1, 1, k), VADD(SVMUL(tr12, tr2), SVMUL(tr11, tr3)));
-    ci5 = VADD(SVMUL(ti11, ti5), SVMUL(ti12, ti4));
-    ci4 = VSUB(SVMUL(ti12, ti5), SVMUL(ti11, ti4));
-    ch_ref(1, k, 2) = VSUB(cr2, ci5);
-    ch_ref(1, k, 3) = VSUB(cr3, ci4);
-    ch_ref(1, k, 4) = VADD(cr3, ci4);
-    ch_ref(1, k, 5) = VADD(cr2, ci5);
-  }
-  if (ido == 1) {
-    return;
-  }
-  idp2 = ido + 2;
-  for (k = 1; k <= l1; ++k) {
-    for (i = 3; i <= ido; i += 2) {
-      ic = idp2 - i;
-      ti5 = VADD(cc_ref(i  , 3, k), cc_ref(ic  , 2, k));
-      ti2 = VSUB(cc_ref(i  , 3, k), cc_ref(ic  , 2, k));
-      ti4 = VADD(cc_ref(i  , 5, k), cc_ref(ic  , 4, k));
-      ti3 = VSUB(cc_ref(i  , 5, k), cc_ref(ic  , 4, k));
-      tr5 = VSUB(cc_ref(i-1, 3, k), cc_ref(ic-1, 2, k));
-      tr2 = VADD(cc_ref(i-1, 3, k), cc_ref(ic-1, 2, k));
-      tr4 = VSUB(cc_ref(i-1, 5, k), cc_ref(ic-1, 4, k));
-      tr3 = VADD(cc_ref(i-1, 5, k), cc_ref(ic-1, 4, k));
-      ch_ref(i - 1, k, 1) = VADD(cc_ref(i-1, 1, k), VADD(tr2, tr3));
-      ch_ref(i, k, 1) = VADD(cc_ref(i, 1, k), VADD(ti2, ti3));
-      cr2 = VADD(cc_ref(i-1, 1, k), VADD(SVMUL(tr11, tr2), SVMUL(tr12, tr3)));
-      ci2 = VADD(cc_ref(i  , 1, k), VADD(SVMUL(tr11, ti2), SVMUL(tr12, ti3)));
-      cr3 = VADD(cc_ref(i-1, 1, k), VADD(SVMUL(tr12, tr2), SVMUL(tr11, tr3)));
-      ci3 = VADD(cc_ref(i  , 1, k), VADD(SVMUL(tr12, ti2), SVMUL(tr11, ti3)));
-      cr5 = VADD(SVMUL(ti11, tr5), SVMUL(ti12, tr4));
-      ci5 = VADD(SVMUL(ti11, ti5), SVMUL(ti12, ti4));
-      cr4 = VSUB(SVMUL(ti12, tr5), SVMUL(ti11, tr4));
-      ci4 = VSUB(SVMUL(ti12, ti5), SVMUL(ti11, ti4));
-      dr3 = VSUB(cr3, ci4);
-      dr4 = VADD(cr3, ci4);
-      di3 = VADD(ci3, cr4);
-      di4 = VSUB(ci3, cr4);
-      dr5 = VADD(cr2, ci5);
-      dr2 = VSUB(cr2, ci5);
-      di5 = VSUB(ci2, cr5);
-      di2 = VADD(ci2, cr5);
-      VCPLXMUL(dr2, di2, LD_PS1(wa1[i-3]), LD_PS1(wa1[i-2]));
-      VCPLXMUL(dr3, di3, LD_PS1(wa2[i-3]), LD_PS1(wa2[i-2]));
-      VCPLXMUL(dr4, di4, LD_PS1(wa3[i-3]), LD_PS1(wa3[i-2]));
-      VCPLXMUL(dr5, di5, LD_PS1(wa4[i-3]), LD_PS1(wa4[i-2]));
-
-      ch_ref(i-1, k, 2) = dr2; ch_ref(i, k, 2) = di2;
-      ch_ref(i-1, k, 3) = dr3; ch_ref(i, k, 3) = di3;
-      ch_ref(i-1, k, 4) = dr4; ch_ref(i, k, 4) = di4;
-      ch_ref(i-1, k, 5) = dr5; ch_ref(i, k, 5) = di5;
-    }
-  }
-#undef cc_ref
-#undef ch_ref
-} /* radb5 */
-
-static NEVER_INLINE(v4sf *) rfftf1_ps(int n, const v4sf *input_readonly, v4sf *work1, v4sf *work2, 
-                                      const float *wa, const int *ifac) {  
-  v4sf *in  = (v4sf*)input_readonly;
-  v4sf *out = (in == work2 ? work1 : work2);
-  int nf = ifac[1], k1;
-  int l2 = n;
-  int iw = n-1;
-  assert(in != out && work1 != work2);
-  for (k1 = 1; k1 <= nf; ++k1) {
-    int kh = nf - k1;
-    int ip = ifac[kh + 2];
-    int l1 = l2 / ip;
-    int ido = n / l2;
-    iw -= (ip - 1)*ido;
-    switch (ip) {
-      case 5: {
-        int ix2 = iw + ido;
-        int ix3 = ix2 + ido;
-        int ix4 = ix3 + ido;
-        radf5_ps(ido, l1, in, out, &wa[iw], &wa[ix2], &wa[ix3], &wa[ix4]);
-      } break;
-      case 4: {
-        int ix2 = iw + ido;
-        int ix3 = ix2 + ido;
-        radf4_ps(ido, l1, in, out, &wa[iw], &wa[ix2], &wa[ix3]);
-      } break;
-      case 3: {
-        int ix2 = iw + ido;
-        radf3_ps(ido, l1, in, out, &wa[iw], &wa[ix2]);
-      } break;
-      case 2:
-        radf2_ps(ido, l1, in, out, &wa[iw]);
-        break;
-      default:
-        assert(0);
-        break;
-    }
-    l2 = l1;
-    if (out == work2) {
-      out = work1; in = work2;
-    } else {
-      out = work2; in = work1;
-    }
-  }
-  return in; /* this is in fact the output .. */
-} /* rfftf1 */
-
-static NEVER_INLINE(v4sf *) rfftb1_ps(int n, const v4sf *input_readonly, v4sf *work1, v4sf *work2, 
-                                      const float *wa, const int *ifac) {  
-  v4sf *in  = (v4sf*)input_readonly;
-  v4sf *out = (in == work2 ? work1 : work2);
-  int nf = ifac[1], k1;
-  int l1 = 1;
-  int iw = 0;
-  assert(in != out);
-  for (k1=1; k1<=nf; k1++) {
-    int ip = ifac[k1 + 1];
-    int l2 = ip*l1;
-    int ido = n / l2;
-    switch (ip) {
-      case 5: {
-        int ix2 = iw + ido;
-        int ix3 = ix2 + ido;
-        int ix4 = ix3 + ido;
-        radb5_ps(ido, l1, in, out, &wa[iw], &wa[ix2], &wa[ix3], &wa[ix4]);
-      } break;
-      case 4: {
-        int ix2 = iw + ido;
-        int ix3 = ix2 + ido;
-        radb4_ps(ido, l1, in, out, &wa[iw], &wa[ix2], &wa[ix3]);
-      } break;
-      case 3: {
-        int ix2 = iw + ido;
-        radb3_ps(ido, l1, in, out, &wa[iw], &wa[ix2]);
-      } break;
-      case 2:
-        radb2_ps(ido, l1, in, out, &wa[iw]);
-        break;
-      default:
-        assert(0);
-        break;
-    }
-    l1 = l2;
-    iw += (ip - 1)*ido;
-
-    if (out == work2) {
-      out = work1; in = work2;
-    } else {
-      out = work2; in = work1;
-    }
-  }
-  return in; /* this is in fact the output .. */
-}
+#include "pffft_passes.h"
 
 static int decompose(int n, int *ifac, const int *ntryh) {
   int nl = n, nf = 0, i, j = 0;
@@ -1167,56 +388,10 @@ void cffti1_ps(int n, float *wa, int *ifac)
 } /* cffti1 */
 
 
-v4sf *cfftf1_ps(int n, const v4sf *input_readonly, v4sf *work1, v4sf *work2, const float *wa, const int *ifac, int isign) {
-  v4sf *in  = (v4sf*)input_readonly;
-  v4sf *out = (in == work2 ? work1 : work2); 
-  int nf = ifac[1], k1;
-  int l1 = 1;
-  int iw = 0;
-  assert(in != out && work1 != work2);
-  for (k1=2; k1<=nf+1; k1++) {
-    int ip = ifac[k1];
-    int l2 = ip*l1;
-    int ido = n / l2;
-    int idot = ido + ido;
-    switch (ip) {
-      case 5: {
-        int ix2 = iw + idot;
-        int ix3 = ix2 + idot;
-        int ix4 = ix3 + idot;
-        passf5_ps(idot, l1, in, out, &wa[iw], &wa[ix2], &wa[ix3], &wa[ix4], (float)isign);
-      } break;
-      case 4: {
-        int ix2 = iw + idot;
-        int ix3 = ix2 + idot;
-        passf4_ps(idot, l1, in, out, &wa[iw], &wa[ix2], &wa[ix3], (float)isign);
-      } break;
-      case 2: {
-        passf2_ps(idot, l1, in, out, &wa[iw], (float)isign);
-      } break;
-      case 3: {
-        int ix2 = iw + idot;
-        passf3_ps(idot, l1, in, out, &wa[iw], &wa[ix2], (float)isign);
-      } break;
-      default:
-        assert(0);
-    }
-    l1 = l2;
-    iw += (ip - 1)*idot;
-    if (out == work2) {
-      out = work1; in = work2;
-    } else {
-      out = work2; in = work1;
-    }
-  }
-
-  return in; /* this is in fact the output .. */
-}
-
-
 struct PFFFT_Setup {
   int     N;
   int     Ncvec; // nb of complex simd vectors (N/4 if PFFFT_COMPLEX, N/8 if PFFFT_REAL)
+  int     simd_sz; // floats per simd vector: SIMD_SZ, or 8 / 16 for the AVX2 / AVX-512 variants
   int ifac[15];
   pffft_transform_t transform;
   v4sf *data; // allocated room for twiddle coefs
@@ -1224,56 +399,75 @@ struct PFFFT_Setup {
   float *twiddle; // points into 'data', N/4 elements
 };
 
-PFFFT_Setup *pffft_new_setup(int N, pffft_transform_t transform) {
-  PFFFT_Setup *s = (PFFFT_Setup*)malloc(sizeof(PFFFT_Setup));
+#if defined(PFFFT_X86_WIDE)
+static void pffft_wide_transform(PFFFT_Setup *setup, const float *input, float *output, float *work,
+                                 pffft_direction_t direction, int ordered);
+static void pffft_wide_zreorder(PFFFT_Setup *setup, const float *in, float *out, pffft_direction_t direction);
+static void pffft_wide_zconvolve_accumulate(PFFFT_Setup *s, const float *a, const float *b, float *ab, float scaling);
+#endif
+
+static PFFFT_Setup *new_setup(int N, pffft_transform_t transform, int simd_sz) {
+  PFFFT_Setup *s;
   int k, m;
-  /* unfortunately, the fft size must be a multiple of 16 for complex FFTs 
-     and 32 for real FFTs -- a lot of stuff would need to be rewritten to
-     handle other cases (or maybe just switch to a scalar fft, I don't know..) */
-  if (transform == PFFFT_REAL) { assert((N%(2*SIMD_SZ*SIMD_SZ))==0 && N>0); }
-  if (transform == PFFFT_COMPLEX) { assert((N%(SIMD_SZ*SIMD_SZ))==0 && N>0); }
+  if (simd_sz == SIMD_SZ) {
+    /* unfortunately, the fft size must be a multiple of 16 for complex FFTs 
+       and 32 for real FFTs -- a lot of stuff would need to be rewritten to
+       handle other cases (or maybe just switch to a scalar fft, I don't know..) */
+    if (transform == PFFFT_REAL) { assert((N%(2*SIMD_SZ*SIMD_SZ))==0 && N>0); }
+    if (transform == PFFFT_COMPLEX) { assert((N%(SIMD_SZ*SIMD_SZ))==0 && N>0); }
+  } else if (N <= 0 || (N % ((transform == PFFFT_REAL ? 2 : 1)*simd_sz*simd_sz)) != 0) {
+    return 0; // the same rule for the wider vectors: 128 / 64 for AVX, 512 / 256 for AVX-512
+  }
+  s = (PFFFT_Setup*)malloc(sizeof(PFFFT_Setup));
   //assert((N % 32) == 0);
   s->N = N;
   s->transform = transform;  
+  s->simd_sz = simd_sz;
   /* nb of complex simd vectors */
-  s->Ncvec = (transform == PFFFT_REAL ? N/2 : N)/SIMD_SZ;
-  s->data = (v4sf*)pffft_aligned_malloc(2*s->Ncvec * sizeof(v4sf));
+  s->Ncvec = (transform == PFFFT_REAL ? N/2 : N)/simd_sz;
+  s->data = (v4sf*)pffft_aligned_malloc(2*s->Ncvec*simd_sz * sizeof(float));
   s->e = (float*)s->data;
-  s->twiddle = (float*)(s->data + (2*s->Ncvec*(SIMD_SZ-1))/SIMD_SZ);  
+  s->twiddle = s->e + 2*s->Ncvec*(simd_sz-1);
 
   if (transform == PFFFT_REAL) {
     for (k=0; k < s->Ncvec; ++k) {
-      int i = k/SIMD_SZ;
-      int j = k%SIMD_SZ;
-      for (m=0; m < SIMD_SZ-1; ++m) {
+      int i = k/simd_sz;
+      int j = k%simd_sz;
+      for (m=0; m < simd_sz-1; ++m) {
         float A = -2*(float)M_PI*(m+1)*k / N;
-        s->e[(2*(i*3 + m) + 0) * SIMD_SZ + j] = cosf(A);
-        s->e[(2*(i*3 + m) + 1) * SIMD_SZ + j] = sinf(A);
+        s->e[(2*(i*(simd_sz-1) + m) + 0) * simd_sz + j] = cosf(A);
+        s->e[(2*(i*(simd_sz-1) + m) + 1) * simd_sz + j] = sinf(A);
       }
     }
-    rffti1_ps(N/SIMD_SZ, s->twiddle, s->ifac);
+    rffti1_ps(N/simd_sz, s->twiddle, s->ifac);
   } else {
     for (k=0; k < s->Ncvec; ++k) {
-      int i = k/SIMD_SZ;
-      int j = k%SIMD_SZ;
-      for (m=0; m < SIMD_SZ-1; ++m) {
+      int i = k/simd_sz;
+      int j = k%simd_sz;
+      for (m=0; m < simd_sz-1; ++m) {
         float A = -2*(float)M_PI*(m+1)*k / N;
-        s->e[(2*(i*3 + m) + 0)*SIMD_SZ + j] = cosf(A);
-        s->e[(2*(i*3 + m) + 1)*SIMD_SZ + j] = sinf(A);
+        s->e[(2*(i*(simd_sz-1) + m) + 0)*simd_sz + j] = cosf(A);
+        s->e[(2*(i*(simd_sz-1) + m) + 1)*simd_sz + j] = sinf(A);
       }
     }
-    cffti1_ps(N/SIMD_SZ, s->twiddle, s->ifac);
+    cffti1_ps(N/simd_sz, s->twiddle, s->ifac);
   }
 
   /* check that N is decomposable with allowed prime factors */
   for (k=0, m=1; k < s->ifac[1]; ++k) { m *= s->ifac[2+k]; }
-  if (m != N/SIMD_SZ) {
+  if (m != N/simd_sz) {
     pffft_destroy_setup(s); s = 0;
   }
 
   return s;
 }
 
+PFFFT_Setup *pffft_new_setup(int N, pffft_transform_t transform) {
+  return pffft_new_setup_simd(N, transform, 0);
+}
+
+int pffft_setup_simd_size(const PFFFT_Setup *s) { return s->simd_sz; }
+
 
 void pffft_destroy_setup(PFFFT_Setup *s) {
   pffft_aligned_free(s->data);
@@ -1321,6 +515,11 @@ void pffft_zreorder(PFFFT_Setup *setup, const float *in, float *out, pffft_direc
   const v4sf *vin = (const v4sf*)in;
   v4sf *vout = (v4sf*)out;
   assert(in != out);
+#if defined(PFFFT_X86_WIDE)
+  if (setup->simd_sz != SIMD_SZ) {
+    pffft_wide_zreorder(setup, in, out, direction); return;
+  }
+#endif
   if (setup->transform == PFFFT_REAL) {
     int k, dk = N/32;
     if (direction == PFFFT_FORWARD) {
@@ -1723,6 +922,11 @@ void pffft_zconvolve_accumulate(PFFFT_Setup *s, const float *a, const float *b,
 #endif
 
   assert(VALIGNED(a) && VALIGNED(b) && VALIGNED(ab));
+#if defined(PFFFT_X86_WIDE)
+  if (s->simd_sz != SIMD_SZ) {
+    pffft_wide_zconvolve_accumulate(s, a, b, ab, scaling); return;
+  }
+#endif
   ar = ((v4sf_union*)va)[0].f[0];
   ai = ((v4sf_union*)va)[1].f[0];
   br = ((v4sf_union*)vb)[0].f[0];
@@ -1892,10 +1096,227 @@ void pffft_zconvolve_accumulate_nosimd(PFFFT_Setup *s, const float *a, const flo
 
 #endif // defined(PFFFT_SIMD_DISABLE)
 
+#if defined(PFFFT_X86_WIDE)
+
+/*
+  AVX2+FMA (8 floats) and AVX-512 (16 floats) variants. The radix passes of
+  pffft_passes.h and the generic finalize / preprocess steps of pffft_wide.h
+  are compiled once more inside a namespace for each vector type, with the
+  target instruction set enabled for these functions only, so the rest of the
+  file still builds for SSE. pffft_new_setup picks the widest variant the cpu
+  supports and the transform size allows.
+*/
+
+#if defined(COMPILER_MSVC)
+#  include <intrin.h>
+#else
+#  include <immintrin.h>
+#  include <cpuid.h>
+#endif
+#include <string.h>
+
+#undef SIMD_SZ
+#undef VZERO
+#undef VMUL
+#undef VADD
+#undef VMADD
+#undef VSUB
+#undef LD_PS1
+#undef INTERLEAVE2
+#undef UNINTERLEAVE2
+#undef VALIGNED
+
+#if defined(__clang__)
+#  pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#elif defined(COMPILER_GCC)
+#  pragma GCC push_options
+#  pragma GCC target("avx2,fma")
+#endif
+
+namespace pffft_avx {
+
+typedef __m256 v4sf;
+#  define SIMD_SZ 8
+#  define VZERO() _mm256_setzero_ps()
+#  define VMUL(a,b) _mm256_mul_ps(a,b)
+#  define VADD(a,b) _mm256_add_ps(a,b)
+#  define VMADD(a,b,c) _mm256_fmadd_ps(a,b,c)
+#  define VSUB(a,b) _mm256_sub_ps(a,b)
+#  define LD_PS1(p) _mm256_set1_ps(p)
+#  define INTERLEAVE2(in1, in2, out1, out2) { v4sf lo__ = _mm256_unpacklo_ps(in1, in2), hi__ = _mm256_unpackhi_ps(in1, in2); \
+    out1 = _mm256_permute2f128_ps(lo__, hi__, 0x20); out2 = _mm256_permute2f128_ps(lo__, hi__, 0x31); }
+#  define UNINTERLEAVE2(in1, in2, out1, out2) { v4sf lo__ = _mm256_permute2f128_ps(in1, in2, 0x20), hi__ = _mm256_permute2f128_ps(in1, in2, 0x31); \
+    out1 = _mm256_shuffle_ps(lo__, hi__, _MM_SHUFFLE(2,0,2,0)); out2 = _mm256_shuffle_ps(lo__, hi__, _MM_SHUFFLE(3,1,3,1)); }
+#  define VREVERSE(a) _mm256_permutevar8x32_ps(a, _mm256_setr_epi32(7,6,5,4,3,2,1,0))
+#  define VLOADU(p) _mm256_loadu_ps(p)
+#  define VSTOREU(p,a) _mm256_storeu_ps(p,a)
+#  define VALIGNED(ptr) ((((uintptr_t)(ptr)) & 0x1F) == 0)
+
+static ALWAYS_INLINE(void) vtranspose8(v4sf *x) {
+  v4sf t0 = _mm256_unpacklo_ps(x[0], x[1]), t1 = _mm256_unpackhi_ps(x[0], x[1]);
+  v4sf t2 = _mm256_unpacklo_ps(x[2], x[3]), t3 = _mm256_unpackhi_ps(x[2], x[3]);
+  v4sf t4 = _mm256_unpacklo_ps(x[4], x[5]), t5 = _mm256_unpackhi_ps(x[4], x[5]);
+  v4sf t6 = _mm256_unpacklo_ps(x[6], x[7]), t7 = _mm256_unpackhi_ps(x[6], x[7]);
+  v4sf u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1,0,1,0)), u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3,2,3,2));
+  v4sf u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1,0,1,0)), u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3,2,3,2));
+  v4sf u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1,0,1,0)), u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3,2,3,2));
+  v4sf u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1,0,1,0)), u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3,2,3,2));
+  x[0] = _mm256_permute2f128_ps(u0, u4, 0x20); x[4] = _mm256_permute2f128_ps(u0, u4, 0x31);
+  x[1] = _mm256_permute2f128_ps(u1, u5, 0x20); x[5] = _mm256_permute2f128_ps(u1, u5, 0x31);
+  x[2] = _mm256_permute2f128_ps(u2, u6, 0x20); x[6] = _mm256_permute2f128_ps(u2, u6, 0x31);
+  x[3] = _mm256_permute2f128_ps(u3, u7, 0x20); x[7] = _mm256_permute2f128_ps(u3, u7, 0x31);
+}
+#  define VTRANSPOSE(x) vtranspose8(x)
+
+#include "pffft_passes.h"
+#include "pffft_wide.h"
+
+} // namespace pffft_avx
+
+#if defined(__clang__)
+#  pragma clang attribute pop
+#  pragma clang attribute push (__attribute__((target("avx512f,avx2,fma"))), apply_to = function)
+#elif defined(COMPILER_GCC)
+#  pragma GCC pop_options
+#  pragma GCC push_options
+#  pragma GCC target("avx512f,avx2,fma")
+#endif
+
+#undef SIMD_SZ
+#undef VZERO
+#undef VMUL
+#undef VADD
+#undef VMADD
+#undef VSUB
+#undef LD_PS1
+#undef INTERLEAVE2
+#undef UNINTERLEAVE2
+#undef VREVERSE
+#undef VLOADU
+#undef VSTOREU
+#undef VALIGNED
+
+namespace pffft_avx512 {
+
+typedef __m512 v4sf;
+#  define SIMD_SZ 16
+#  define VZERO() _mm512_setzero_ps()
+#  define VMUL(a,b) _mm512_mul_ps(a,b)
+#  define VADD(a,b) _mm512_add_ps(a,b)
+#  define VMADD(a,b,c) _mm512_fmadd_ps(a,b,c)
+#  define VSUB(a,b) _mm512_sub_ps(a,b)
+#  define LD_PS1(p) _mm512_set1_ps(p)
+#  define INTERLEAVE2(in1, in2, out1, out2) { \
+    v4sf tmp__ = _mm512_permutex2var_ps(in1, _mm512_setr_epi32(0,16,1,17,2,18,3,19,4,20,5,21,6,22,7,23), in2); \
+    out2 = _mm512_permutex2var_ps(in1, _mm512_setr_epi32(8,24,9,25,10,26,11,27,12,28,13,29,14,30,15,31), in2); out1 = tmp__; }
+#  define UNINTERLEAVE2(in1, in2, out1, out2) { \
+    v4sf tmp__ = _mm512_permutex2var_ps(in1, _mm512_setr_epi32(0,2,4,6,8,10,12,14,16,18,20,22,24,26,28,30), in2); \
+    out2 = _mm512_permutex2var_ps(in1, _mm512_setr_epi32(1,3,5,7,9,11,13,15,17,19,21,23,25,27,29,31), in2); out1 = tmp__; }
+#  define VREVERSE(a) _mm512_permutex2var_ps(a, _mm512_setr_epi32(15,14,13,12,11,10,9,8,7,6,5,4,3,2,1,0), a)
+#  define VLOADU(p) _mm512_loadu_ps(p)
+#  define VSTOREU(p,a) _mm512_storeu_ps(p,a)
+#  define VALIGNED(ptr) ((((uintptr_t)(ptr)) & 0x3F) == 0)
+
+#include "pffft_passes.h"
+#include "pffft_wide.h"
+
+} // namespace pffft_avx512
+
+#if defined(__clang__)
+#  pragma clang attribute pop
+#elif defined(COMPILER_GCC)
+#  pragma GCC pop_options
+#endif
+
+#undef SIMD_SZ
+#define SIMD_SZ 4 // back to the SSE vectors for the rest of this file
+
+static void pffft_wide_transform(PFFFT_Setup *setup, const float *input, float *output, float *work,
+                                 pffft_direction_t direction, int ordered) {
+  if (setup->simd_sz == 16) {
+    pffft_avx512::wide_transform_internal(setup, input, output, (pffft_avx512::v4sf*)work, direction, ordered);
+  } else {
+    pffft_avx::wide_transform_internal(setup, input, output, (pffft_avx::v4sf*)work, direction, ordered);
+  }
+}
+
+static void pffft_wide_zreorder(PFFFT_Setup *setup, const float *in, float *out, pffft_direction_t direction) {
+  if (setup->simd_sz == 16) pffft_avx512::wide_zreorder(setup, in, out, direction);
+  else pffft_avx::wide_zreorder(setup, in, out, direction);
+}
+
+static void pffft_wide_zconvolve_accumulate(PFFFT_Setup *s, const float *a, const float *b, float *ab, float scaling) {
+  if (s->simd_sz == 16) pffft_avx512::wide_zconvolve_accumulate(s, a, b, ab, scaling);
+  else pffft_avx::wide_zconvolve_accumulate(s, a, b, ab, scaling);
+}
+
+/* 16 if the cpu and os support AVX-512F, 8 for AVX2+FMA, SIMD_SZ otherwise */
+static int x86_simd_size() {
+  unsigned int ecx1, ebx7, xcr0;
+#if defined(COMPILER_MSVC)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) return SIMD_SZ;
+  __cpuid(info, 1); ecx1 = (unsigned int)info[2];
+  __cpuidex(info, 7, 0); ebx7 = (unsigned int)info[1];
+#else
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid_max(0, 0) < 7) return SIMD_SZ;
+  __cpuid(1, eax, ebx, ecx, edx); ecx1 = ecx;
+  __cpuid_count(7, 0, eax, ebx, ecx, edx); ebx7 = ebx;
+#endif
+  /* fma, osxsave and avx, then avx2 */
+  if ((ecx1 & 0x18001000) != 0x18001000 || (ebx7 & (1 << 5)) == 0) return SIMD_SZ;
+#if defined(COMPILER_MSVC)
+  xcr0 = (unsigned int)_xgetbv(0);
+#else
+  {
+    unsigned int xcr0h;
+    __asm__("xgetbv" : "=a"(xcr0), "=d"(xcr0h) : "c"(0));
+  }
+#endif
+  if ((xcr0 & 0x06) != 0x06) return SIMD_SZ; // ymm registers are not saved by the os
+  if ((ebx7 & (1 << 16)) != 0 && (xcr0 & 0xE6) == 0xE6) return 16;
+  return 8;
+}
+
+#endif // defined(PFFFT_X86_WIDE)
+
+int pffft_simd_size_max() {
+#if defined(PFFFT_X86_WIDE)
+  static const int simd_sz = x86_simd_size();
+  return simd_sz;
+#else
+  return SIMD_SZ;
+#endif
+}
+
+PFFFT_Setup *pffft_new_setup_simd(int N, pffft_transform_t transform, int max_simd_size) {
+  int simd_sz = pffft_simd_size_max();
+  for (; simd_sz > SIMD_SZ; simd_sz /= 2) {
+    if (max_simd_size <= 0 && transform == PFFFT_REAL && N < 4*simd_sz*simd_sz) continue;
+    if (max_simd_size <= 0 || simd_sz <= max_simd_size) {
+      PFFFT_Setup *s = new_setup(N, transform, simd_sz);
+      if (s) return s;
+    }
+  }
+  return new_setup(N, transform, SIMD_SZ);
+}
+
 void pffft_transform(PFFFT_Setup *setup, const float *input, float *output, float *work, pffft_direction_t direction) {
+#if defined(PFFFT_X86_WIDE)
+  if (setup->simd_sz != SIMD_SZ) {
+    pffft_wide_transform(setup, input, output, work, direction, 0); return;
+  }
+#endif
   pffft_transform_internal(setup, input, output, (v4sf*)work, direction, 0);
 }
 
 void pffft_transform_ordered(PFFFT_Setup *setup, const float *input, float *output, float *work, pffft_direction_t direction) {
+#if defined(PFFFT_X86_WIDE)
+  if (setup->simd_sz != SIMD_SZ) {
+    pffft_wide_transform(setup, input, output, work, direction, 1); return;
+  }
+#endif
   pffft_transform_internal(setup, input, output, (v4sf*)work, direction, 1);
 }
@@ -66,7 +66,8 @@
 
    - all (float*) pointers in the functions below are expected to
    have an "simd-compatible" alignment, that is 16 bytes on x86 and
-   powerpc CPUs.
+   powerpc CPUs -- 32 or 64 bytes when pffft_new_setup picked the AVX2
+   or AVX-512 code for the setup (see pffft_setup_simd_size).
   
    You can allocate such buffers with the functions
    pffft_aligned_malloc / pffft_aligned_free (or with stuff like
@@ -176,6 +177,26 @@ extern "C" {
   /* return 4 or 1 wether support SSE/Altivec instructions was enable when building pffft.c */
   int pffft_simd_size();
 
+  /* return 16 or 8 if the AVX-512 or AVX2+FMA code can be used on this
+     cpu, pffft_simd_size() otherwise */
+  int pffft_simd_size_max();
+
+  /*
+    same as pffft_new_setup, with vectors of at most max_simd_size floats
+    (0 for no limit). The wider vectors need N to be a multiple of
+    2*simd_size^2 for real transforms (simd_size^2 for complex ones), so
+    128 / 64 with AVX2 and 512 / 256 with AVX-512. With max_simd_size = 0,
+    as used by pffft_new_setup, real transforms also need N >= 4*simd_size^2
+    (256 with AVX2, 1024 with AVX-512) since the shorter ones are not faster
+    than the SSE code. Narrower vectors are used otherwise.
+    The results match the SSE code to float rounding, the z-domain layout
+    of pffft_transform is specific to the vector size though.
+  */
+  PFFFT_Setup *pffft_new_setup_simd(int N, pffft_transform_t transform, int max_simd_size);
+
+  /* return the number of floats per simd vector used by the setup */
+  int pffft_setup_simd_size(const PFFFT_Setup *setup);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,371 @@
+/*
+  PFFFT finalize / preprocess, reordering and convolution steps for vectors
+  of SIMD_SZ = 8 or 16 floats. pffft.cpp includes this file, after
+  pffft_passes.h, inside one namespace per wider x86 vector type.
+
+  The radix passes compute SIMD_SZ interleaved ffts of length L = N/SIMD_SZ
+  (complex) or L = N/SIMD_SZ real ffts, lane j holding the samples
+  x[j + k*SIMD_SZ]. With X_j(p) the transform of lane j, the transform of x is
+
+    X(p + m*L) = sum_j W^(j*p) X_j(p) exp(-2*pi*i*j*m/SIMD_SZ), W = exp(-2*pi*i/N)
+
+  so the finalize step transposes blocks of SIMD_SZ consecutive p's into
+  vectors holding one lane each, applies the twiddles W^(j*p) from setup->e
+  and performs a SIMD_SZ point dft across the vectors. The 4-wide code does
+  the same with a hand-written 4x4 matrix.
+
+  The z-domain layout produced by the forward transform is made of blocks of
+  SIMD_SZ complex vectors (re, im), block b holding p = b*SIMD_SZ .. +SIMD_SZ-1
+  in its lanes:
+  - complex transforms: vector pair m of the block holds X(p + m*L).
+  - real transforms: vector pair m < SIMD_SZ/2 holds X(p + m*L), vector pair
+    m >= SIMD_SZ/2 holds X((m - SIMD_SZ/2 + 1)*L - p). Lane 0 of block 0
+    (p = 0 and p = L/2 are purely real in each lane) holds X(0) + i*X(N/2),
+    then X(m*L) for m = 1 .. SIMD_SZ/2-1, then X(L/2 + m*L) for
+    m = 0 .. SIMD_SZ/2-1. X(0) and X(N/2) stay in lane 0 of the first two
+    vectors, as with the 4-wide code, so the convolution step is unchanged.
+
+  The includer defines v4sf, SIMD_SZ, the arithmetic macros, INTERLEAVE2,
+  UNINTERLEAVE2, VREVERSE (lanes in reverse order), VLOADU, VSTOREU and
+  VALIGNED, and optionally VTRANSPOSE(x) for a SIMD_SZ x SIMD_SZ in-place
+  transpose of the vectors x[0..SIMD_SZ-1].
+*/
+
+/* cos(pi*k/16), k = 0..31 -- every angle used by the SIMD_SZ point dft and the real
+   transform edge cases is a multiple of pi/16 for SIMD_SZ <= 16 */
+static const float wide_cos[32] = {
+  1.000000000f, 0.980785280f, 0.923879533f, 0.831469612f, 0.707106781f, 0.555570233f, 0.382683432f, 0.195090322f,
+  0.000000000f, -0.195090322f, -0.382683432f, -0.555570233f, -0.707106781f, -0.831469612f, -0.923879533f, -0.980785280f,
+  -1.000000000f, -0.980785280f, -0.923879533f, -0.831469612f, -0.707106781f, -0.555570233f, -0.382683432f, -0.195090322f,
+  0.000000000f, 0.195090322f, 0.382683432f, 0.555570233f, 0.707106781f, 0.831469612f, 0.923879533f, 0.980785280f
+};
+
+#if defined(__clang__)
+#  define UNROLL _Pragma("unroll")
+#elif defined(__GNUC__) && __GNUC__ >= 8
+#  define UNROLL _Pragma("GCC unroll 16")
+#else
+#  define UNROLL
+#endif
+#define WIDE_COS(k) wide_cos[(k) & 31]
+#define WIDE_SIN(k) wide_cos[((k) + 24) & 31]
+
+#ifndef VTRANSPOSE
+/* log2(SIMD_SZ) rounds of perfect shuffles: each round rotates the bits of the
+   row/column index of every element by one */
+static ALWAYS_INLINE(void) vtranspose(v4sf *x) {
+  v4sf y[SIMD_SZ];
+  int k, r;
+  UNROLL for (r=1; r < SIMD_SZ; r *= 2) {
+    UNROLL for (k=0; k < SIMD_SZ/2; ++k) {
+      INTERLEAVE2(x[k], x[k + SIMD_SZ/2], y[2*k], y[2*k + 1]);
+    }
+    UNROLL for (k=0; k < SIMD_SZ; ++k) x[k] = y[k];
+  }
+}
+#  define VTRANSPOSE(x) vtranspose(x)
+#endif
+
+/* SIMD_SZ point dft across the vectors r[], i[] (one dft per lane), in natural
+   order, exp(-2*pi*i*j*m/SIMD_SZ) for the forward direction */
+static ALWAYS_INLINE(void) vdft(v4sf *r, v4sf *i, int backward) {
+  v4sf xr[SIMD_SZ], xi[SIMD_SZ];
+  int j, k, len, b, n;
+  UNROLL for (k=0; k < SIMD_SZ; ++k) {
+    UNROLL for (b=0, j=k, n=1; n < SIMD_SZ; n *= 2, j >>= 1) b = (b << 1) | (j & 1);
+    xr[k] = r[b]; xi[k] = i[b];
+  }
+  UNROLL for (len=2; len <= SIMD_SZ; len *= 2) {
+    UNROLL for (j=0; j < SIMD_SZ; j += len) {
+      UNROLL for (k=0; k < len/2; ++k) {
+        v4sf ar = xr[j+k], ai = xi[j+k];
+        v4sf br = xr[j+k+len/2], bi = xi[j+k+len/2];
+        if (4*k == len) {
+          /* multiply by -i (forward) or +i (backward) */
+          v4sf t = br;
+          if (backward) { br = VSUB(VZERO(), bi); bi = t; }
+          else { br = bi; bi = VSUB(VZERO(), t); }
+        } else if (k != 0) {
+          int a = k*(32/len);
+          v4sf wr = LD_PS1(WIDE_COS(a));
+          v4sf wi = LD_PS1(backward ? WIDE_SIN(a) : -WIDE_SIN(a));
+          VCPLXMUL(br, bi, wr, wi);
+        }
+        xr[j+k] = VADD(ar, br); xi[j+k] = VADD(ai, bi);
+        xr[j+k+len/2] = VSUB(ar, br); xi[j+k+len/2] = VSUB(ai, bi);
+      }
+    }
+  }
+  UNROLL for (k=0; k < SIMD_SZ; ++k) { r[k] = xr[k]; i[k] = xi[k]; }
+}
+
+static NEVER_INLINE(void) pffft_cplx_finalize(int Ncvec, const v4sf *in, v4sf *out, const v4sf *e) {
+  int b, j, dk = Ncvec/SIMD_SZ; // number of SIMD_SZ x SIMD_SZ matrix blocks
+  assert(in != out);
+  for (b=0; b < dk; ++b, in += 2*SIMD_SZ, e += 2*(SIMD_SZ-1)) {
+    v4sf r[SIMD_SZ], i[SIMD_SZ];
+    UNROLL for (j=0; j < SIMD_SZ; ++j) { r[j] = in[2*j]; i[j] = in[2*j+1]; }
+    VTRANSPOSE(r);
+    VTRANSPOSE(i);
+    UNROLL for (j=1; j < SIMD_SZ; ++j) VCPLXMUL(r[j], i[j], e[2*j-2], e[2*j-1]);
+    vdft(r, i, 0);
+    UNROLL for (j=0; j < SIMD_SZ; ++j) { *out++ = r[j]; *out++ = i[j]; }
+  }
+}
+
+static NEVER_INLINE(void) pffft_cplx_preprocess(int Ncvec, const v4sf *in, v4sf *out, const v4sf *e) {
+  int b, j, dk = Ncvec/SIMD_SZ;
+  assert(in != out);
+  for (b=0; b < dk; ++b, out += 2*SIMD_SZ, e += 2*(SIMD_SZ-1)) {
+    v4sf r[SIMD_SZ], i[SIMD_SZ];
+    UNROLL for (j=0; j < SIMD_SZ; ++j) { r[j] = *in++; i[j] = *in++; }
+    vdft(r, i, 1);
+    UNROLL for (j=1; j < SIMD_SZ; ++j) VCPLXMULCONJ(r[j], i[j], e[2*j-2], e[2*j-1]);
+    VTRANSPOSE(r);
+    VTRANSPOSE(i);
+    UNROLL for (j=0; j < SIMD_SZ; ++j) { out[2*j] = r[j]; out[2*j+1] = i[j]; }
+  }
+}
+
+static NEVER_INLINE(void) pffft_real_finalize(int Ncvec, const v4sf *in, v4sf *out, const v4sf *e) {
+  int b, j, m, q, dk = Ncvec/SIMD_SZ;
+  /* fftpack order is f0r f1r f1i f2r f2i ... f(n-1)r f(n-1)i f(n)r */
+  const float *c = (const float*)&in[0], *d = (const float*)&in[2*Ncvec-1];
+  float *fout = (float*)out;
+  float xr, xi;
+  assert(in != out);
+  for (b=0; b < dk; ++b, e += 2*(SIMD_SZ-1)) {
+    v4sf r[SIMD_SZ], i[SIMD_SZ];
+    v4sf *o = out + 2*SIMD_SZ*b;
+    UNROLL for (j=0; j < SIMD_SZ; ++j) {
+      int p = b*SIMD_SZ + j;
+      if (p == 0) { r[j] = i[j] = VZERO(); } // f0r, fixed up below
+      else { r[j] = in[2*p-1]; i[j] = in[2*p]; }
+    }
+    VTRANSPOSE(r);
+    VTRANSPOSE(i);
+    UNROLL for (j=1; j < SIMD_SZ; ++j) VCPLXMUL(r[j], i[j], e[2*j-2], e[2*j-1]);
+    vdft(r, i, 0);
+    UNROLL for (m=0; m < SIMD_SZ/2; ++m) { o[2*m] = r[m]; o[2*m+1] = i[m]; }
+    UNROLL for (m=SIMD_SZ/2; m < SIMD_SZ; ++m) {
+      o[2*m] = r[3*SIMD_SZ/2-1-m]; o[2*m+1] = VSUB(VZERO(), i[3*SIMD_SZ/2-1-m]);
+    }
+  }
+
+  /* lane 0 of block 0, from the purely real f0r (c) and f(n)r (d) of each lane */
+  xr = xi = 0;
+  UNROLL for (q=0; q < SIMD_SZ; ++q) { xr += c[q]; xi += (q & 1) ? -c[q] : c[q]; }
+  fout[0] = xr; fout[SIMD_SZ] = xi;
+  UNROLL for (m=1; m < SIMD_SZ/2; ++m) {
+    xr = xi = 0;
+    UNROLL for (q=0; q < SIMD_SZ; ++q) {
+      int a = 2*q*m*(16/SIMD_SZ);
+      xr += c[q]*WIDE_COS(a); xi -= c[q]*WIDE_SIN(a);
+    }
+    fout[2*m*SIMD_SZ] = xr; fout[(2*m+1)*SIMD_SZ] = xi;
+  }
+  UNROLL for (m=0; m < SIMD_SZ/2; ++m) {
+    xr = xi = 0;
+    UNROLL for (q=0; q < SIMD_SZ; ++q) {
+      int a = q*(2*m+1)*(16/SIMD_SZ);
+      xr += d[q]*WIDE_COS(a); xi -= d[q]*WIDE_SIN(a);
+    }
+    fout[(SIMD_SZ + 2*m)*SIMD_SZ] = xr; fout[(SIMD_SZ + 2*m+1)*SIMD_SZ] = xi;
+  }
+}
+
+static NEVER_INLINE(void) pffft_real_preprocess(int Ncvec, const v4sf *in, v4sf *out, const v4sf *e) {
+  int b, j, m, q, dk = Ncvec/SIMD_SZ;
+  const float *fin = (const float*)in;
+  float *c = (float*)&out[0], *d = (float*)&out[2*Ncvec-1];
+  assert(in != out);
+  for (b=0; b < dk; ++b, e += 2*(SIMD_SZ-1)) {
+    v4sf r[SIMD_SZ], i[SIMD_SZ];
+    const v4sf *v = in + 2*SIMD_SZ*b;
+    UNROLL for (m=0; m < SIMD_SZ/2; ++m) { r[m] = v[2*m]; i[m] = v[2*m+1]; }
+    UNROLL for (m=SIMD_SZ/2; m < SIMD_SZ; ++m) {
+      r[3*SIMD_SZ/2-1-m] = v[2*m]; i[3*SIMD_SZ/2-1-m] = VSUB(VZERO(), v[2*m+1]);
+    }
+    vdft(r, i, 1);
+    UNROLL for (j=1; j < SIMD_SZ; ++j) VCPLXMULCONJ(r[j], i[j], e[2*j-2], e[2*j-1]);
+    VTRANSPOSE(r);
+    VTRANSPOSE(i);
+    UNROLL for (j=(b == 0 ? 1 : 0); j < SIMD_SZ; ++j) {
+      int p = b*SIMD_SZ + j;
+      out[2*p-1] = r[j]; out[2*p] = i[j];
+    }
+  }
+
+  /* f0r and f(n)r of each lane, from lane 0 of block 0 */
+  UNROLL for (q=0; q < SIMD_SZ; ++q) {
+    float x0 = fin[0] + ((q & 1) ? -fin[SIMD_SZ] : fin[SIMD_SZ]), xn = 0;
+    UNROLL for (m=1; m < SIMD_SZ/2; ++m) {
+      int a = 2*q*m*(16/SIMD_SZ);
+      x0 += 2*(fin[2*m*SIMD_SZ]*WIDE_COS(a) - fin[(2*m+1)*SIMD_SZ]*WIDE_SIN(a));
+    }
+    UNROLL for (m=0; m < SIMD_SZ/2; ++m) {
+      int a = q*(2*m+1)*(16/SIMD_SZ);
+      xn += 2*(fin[(SIMD_SZ + 2*m)*SIMD_SZ]*WIDE_COS(a) - fin[(SIMD_SZ + 2*m+1)*SIMD_SZ]*WIDE_SIN(a));
+    }
+    c[q] = x0; d[q] = xn;
+  }
+}
+
+static void wide_zreorder(PFFFT_Setup *setup, const float *in, float *out, pffft_direction_t direction) {
+  int b, m, Ncvec = setup->Ncvec, dk = Ncvec/SIMD_SZ;
+  const v4sf *vin = (const v4sf*)in;
+  v4sf *vout = (v4sf*)out;
+  assert(in != out);
+  if (setup->transform == PFFFT_REAL) {
+    int L = 2*Ncvec;
+    for (b=0; b < dk; ++b) {
+      UNROLL for (m=0; m < SIMD_SZ/2; ++m) {
+        int k = 2*(m*L + b*SIMD_SZ)/SIMD_SZ;
+        if (direction == PFFFT_FORWARD) {
+          INTERLEAVE2(vin[2*SIMD_SZ*b + 2*m], vin[2*SIMD_SZ*b + 2*m+1], vout[k], vout[k+1]);
+        } else {
+          UNINTERLEAVE2(vin[k], vin[k+1], vout[2*SIMD_SZ*b + 2*m], vout[2*SIMD_SZ*b + 2*m+1]);
+        }
+      }
+      /* the second half holds descending frequencies, lane 0 of block 0 excepted */
+      UNROLL for (m=SIMD_SZ/2; m < SIMD_SZ; ++m) {
+        int k = 2*((m - SIMD_SZ/2 + 1)*L - b*SIMD_SZ - SIMD_SZ + 1);
+        int k0 = 2*(L/2 + (m - SIMD_SZ/2)*L);
+        v4sf u0, u1;
+        if (direction == PFFFT_FORWARD) {
+          const v4sf *v = vin + 2*SIMD_SZ*b + 2*m;
+          INTERLEAVE2(VREVERSE(v[0]), VREVERSE(v[1]), u0, u1);
+          if (b != 0) {
+            VSTOREU(out + k, u0); VSTOREU(out + k + SIMD_SZ, u1);
+          } else {
+            float tmp[2*SIMD_SZ];
+            VSTOREU(tmp, u0); VSTOREU(tmp + SIMD_SZ, u1);
+            memcpy(out + k, tmp, 2*(SIMD_SZ-1)*sizeof(float));
+            out[k0] = tmp[2*SIMD_SZ-2]; out[k0+1] = tmp[2*SIMD_SZ-1];
+          }
+        } else {
+          if (b != 0) {
+            u0 = VLOADU(in + k); u1 = VLOADU(in + k + SIMD_SZ);
+          } else {
+            float tmp[2*SIMD_SZ];
+            memcpy(tmp, in + k, 2*(SIMD_SZ-1)*sizeof(float));
+            tmp[2*SIMD_SZ-2] = in[k0]; tmp[2*SIMD_SZ-1] = in[k0+1];
+            u0 = VLOADU(tmp); u1 = VLOADU(tmp + SIMD_SZ);
+          }
+          UNINTERLEAVE2(u0, u1, u0, u1);
+          vout[2*SIMD_SZ*b + 2*m] = VREVERSE(u0);
+          vout[2*SIMD_SZ*b + 2*m+1] = VREVERSE(u1);
+        }
+      }
+    }
+  } else {
+    int L = Ncvec;
+    for (b=0; b < dk; ++b) {
+      UNROLL for (m=0; m < SIMD_SZ; ++m) {
+        int k = 2*(m*L + b*SIMD_SZ)/SIMD_SZ;
+        if (direction == PFFFT_FORWARD) {
+          INTERLEAVE2(vin[2*SIMD_SZ*b + 2*m], vin[2*SIMD_SZ*b + 2*m+1], vout[k], vout[k+1]);
+        } else {
+          UNINTERLEAVE2(vin[k], vin[k+1], vout[2*SIMD_SZ*b + 2*m], vout[2*SIMD_SZ*b + 2*m+1]);
+        }
+      }
+    }
+  }
+}
+
+static void wide_transform_internal(PFFFT_Setup *setup, const float *finput, float *foutput, v4sf *scratch,
+                                  pffft_direction_t direction, int ordered) {
+  int k, Ncvec   = setup->Ncvec;
+  int nf_odd = (setup->ifac[1] & 1);
+
+  // temporary buffer is allocated on the stack if the scratch pointer is NULL
+  int stack_allocate = (scratch == 0 ? Ncvec*2 : 1);
+  VLA_ARRAY_ON_STACK(v4sf, scratch_on_stack, stack_allocate);
+
+  const v4sf *vinput = (const v4sf*)finput;
+  v4sf *voutput      = (v4sf*)foutput;
+  v4sf *buff[2]      = { voutput, scratch ? scratch : scratch_on_stack };
+  int ib = (nf_odd ^ ordered ? 1 : 0);
+
+  assert(VALIGNED(finput) && VALIGNED(foutput) && VALIGNED(buff[1]));
+
+  if (direction == PFFFT_FORWARD) {
+    ib = !ib;
+    if (setup->transform == PFFFT_REAL) {
+      ib = (rfftf1_ps(Ncvec*2, vinput, buff[ib], buff[!ib],
+                      setup->twiddle, &setup->ifac[0]) == buff[0] ? 0 : 1);
+      pffft_real_finalize(Ncvec, buff[ib], buff[!ib], (v4sf*)setup->e);
+    } else {
+      v4sf *tmp = buff[ib];
+      for (k=0; k < Ncvec; ++k) {
+        UNINTERLEAVE2(vinput[k*2], vinput[k*2+1], tmp[k*2], tmp[k*2+1]);
+      }
+      ib = (cfftf1_ps(Ncvec, buff[ib], buff[!ib], buff[ib],
+                      setup->twiddle, &setup->ifac[0], -1) == buff[0] ? 0 : 1);
+      pffft_cplx_finalize(Ncvec, buff[ib], buff[!ib], (v4sf*)setup->e);
+    }
+    if (ordered) {
+      wide_zreorder(setup, (float*)buff[!ib], (float*)buff[ib], PFFFT_FORWARD);
+    } else ib = !ib;
+  } else {
+    if (vinput == buff[ib]) {
+      ib = !ib; // may happen when finput == foutput
+    }
+    if (ordered) {
+      wide_zreorder(setup, (float*)vinput, (float*)buff[ib], PFFFT_BACKWARD);
+      vinput = buff[ib]; ib = !ib;
+    }
+    if (setup->transform == PFFFT_REAL) {
+      pffft_real_preprocess(Ncvec, vinput, buff[ib], (v4sf*)setup->e);
+      ib = (rfftb1_ps(Ncvec*2, buff[ib], buff[0], buff[1],
+                      setup->twiddle, &setup->ifac[0]) == buff[0] ? 0 : 1);
+    } else {
+      pffft_cplx_preprocess(Ncvec, vinput, buff[ib], (v4sf*)setup->e);
+      ib = (cfftf1_ps(Ncvec, buff[ib], buff[0], buff[1],
+                      setup->twiddle, &setup->ifac[0], +1) == buff[0] ? 0 : 1);
+      for (k=0; k < Ncvec; ++k) {
+        INTERLEAVE2(buff[ib][k*2], buff[ib][k*2+1], buff[ib][k*2], buff[ib][k*2+1]);
+      }
+    }
+  }
+
+  if (buff[ib] != voutput) {
+    /* extra copy required -- this situation should only happen when finput == foutput */
+    assert(finput==foutput);
+    for (k=0; k < Ncvec; ++k) {
+      v4sf a = buff[ib][2*k], b = buff[ib][2*k+1];
+      voutput[2*k] = a; voutput[2*k+1] = b;
+    }
+    ib = !ib;
+  }
+  assert(buff[ib] == voutput);
+}
+
+static void wide_zconvolve_accumulate(PFFFT_Setup *s, const float *a, const float *b, float *ab, float scaling) {
+  int i, Ncvec = s->Ncvec;
+  const v4sf * RESTRICT va = (const v4sf*)a;
+  const v4sf * RESTRICT vb = (const v4sf*)b;
+  v4sf * RESTRICT vab = (v4sf*)ab;
+  v4sf vscal = LD_PS1(scaling);
+  float ar = a[0], ai = a[SIMD_SZ], br = b[0], bi = b[SIMD_SZ];
+  float abr = ab[0], abi = ab[SIMD_SZ];
+
+  assert(VALIGNED(a) && VALIGNED(b) && VALIGNED(ab));
+  for (i=0; i < Ncvec; ++i) {
+    v4sf ar, ai, br, bi;
+    ar = va[2*i+0]; ai = va[2*i+1];
+    br = vb[2*i+0]; bi = vb[2*i+1];
+    VCPLXMUL(ar, ai, br, bi);
+    vab[2*i+0] = VMADD(ar, vscal, vab[2*i+0]);
+    vab[2*i+1] = VMADD(ai, vscal, vab[2*i+1]);
+  }
+  if (s->transform == PFFFT_REAL) {
+    ab[0] = abr + ar*br*scaling;
+    ab[SIMD_SZ] = abi + ai*bi*scaling;
+  }
+}
+
+#undef WIDE_COS
+#undef WIDE_SIN
+#undef VTRANSPOSE
+#undef UNROLL
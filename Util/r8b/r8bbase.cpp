@@ -25,14 +25,15 @@ namespace r8b {
 
 CSyncObject CDSPRealFFTKeeper :: StateSync;
 CDSPRealFFT :: CObjKeeper CDSPRealFFTKeeper :: FFTObjects[ 31 ];
+CDSPRealFFT :: CObjKeeper CDSPRealFFTKeeper :: FloatFFTObjects[ 31 ];
 
-CSyncObject CDSPFIRFilterCache :: StateSync;
-CPtrKeeper< CDSPFIRFilter* > CDSPFIRFilterCache :: Objects;
-int CDSPFIRFilterCache :: ObjCount = 0;
+CObjCache< CDSPFIRFilter > CDSPFIRFilterCache :: Cache(
+	R8B_FILTER_CACHE_MAX );
 
-CSyncObject CDSPFracDelayFilterBankCache :: StateSync;
-CPtrKeeper< CDSPFracDelayFilterBank* > CDSPFracDelayFilterBankCache :: Objects;
-CPtrKeeper< CDSPFracDelayFilterBank* > CDSPFracDelayFilterBankCache :: StaticObjects;
-int CDSPFracDelayFilterBankCache :: ObjCount = 0;
+CObjCache< CDSPFracDelayFilterBank > CDSPFracDelayFilterBankCache :: Cache(
+	R8B_FRACBANK_CACHE_MAX );
+
+CSyncObject CDSPKernelStore :: StateSync;
+CDSPKernelStore :: CState CDSPKernelStore :: State;
 
 } // namespace r8b
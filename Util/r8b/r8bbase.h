@@ -60,6 +60,7 @@
 #ifndef R8BBASE_INCLUDED
 #define R8BBASE_INCLUDED
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
@@ -86,6 +87,28 @@
 	#define R8B_SSE2
 	#define R8B_SIMD_ISH
 
+	#if !defined( R8B_NOAVX2 ) && ( defined( _MSC_VER ) || \
+		defined( __GNUC__ ) || defined( __clang__ ))
+
+		#if !defined( _MSC_VER )
+			#include <immintrin.h>
+			#include <cpuid.h>
+
+			#define R8B_AVX2_FN __attribute__(( target( "avx2,fma" )))
+		#else // !defined( _MSC_VER )
+			#define R8B_AVX2_FN
+		#endif // !defined( _MSC_VER )
+
+		/**
+		 * The R8B_AVX2 macro is defined if AVX2+FMA kernels are compiled in.
+		 * Such kernels are selected at run-time, only if the CPU supports
+		 * them, so the rest of the library is still compiled for SSE2. Define
+		 * R8B_NOAVX2 to disable them.
+		 */
+
+		#define R8B_AVX2
+	#endif // !defined( R8B_NOAVX2 )
+
 #elif defined( __aarch64__ ) || defined( __arm64 )
 
 	#include <arm_neon.h>
@@ -156,6 +179,86 @@ namespace r8b {
 		ClassName( const ClassName& ) { } \
 		ClassName& operator = ( const ClassName& ) { return( *this ); }
 
+/**
+ * @brief Real-time section marker class.
+ *
+ * An object of this class marks the calling thread as being inside a
+ * real-time section for the object's lifetime; sections can be nested. With
+ * R8B_RTCHECK enabled, the R8BRTCHECK macro reports memory allocation and
+ * thread-locking done inside such section. Otherwise the class does nothing.
+ * Objects of this class are best created via the R8BRTSECTION macro.
+ */
+
+class CRTSection
+{
+	R8BNOCTOR( CRTSection );
+
+public:
+	CRTSection()
+	{
+		#if R8B_RTCHECK
+			getDepth()++;
+		#endif // R8B_RTCHECK
+	}
+
+	~CRTSection()
+	{
+		#if R8B_RTCHECK
+			getDepth()--;
+		#endif // R8B_RTCHECK
+	}
+
+	/**
+	 * @return "True" if the calling thread is inside a real-time section.
+	 * Always "false" if R8B_RTCHECK is disabled.
+	 */
+
+	static bool isActive()
+	{
+		#if R8B_RTCHECK
+			return( getDepth() > 0 );
+		#else // R8B_RTCHECK
+			return( false );
+		#endif // R8B_RTCHECK
+	}
+
+private:
+	#if R8B_RTCHECK
+		/**
+		 * @return Reference to the calling thread's section nesting depth.
+		 */
+
+		static int& getDepth()
+		{
+			static thread_local int Depth = 0;
+			return( Depth );
+		}
+	#endif // R8B_RTCHECK
+};
+
+#if R8B_RTCHECK
+	/**
+	 * Macro marks the rest of the current scope as a real-time section.
+	 */
+
+	#define R8BRTSECTION :: r8b :: CRTSection RTSection
+
+	/**
+	 * Macro calls R8BRTVIOLATION if the calling thread is inside a real-time
+	 * section. Expands to a single statement, so it is safe in an unbraced
+	 * "if"/"else".
+	 *
+	 * @param What The operation being checked, a string.
+	 */
+
+	#define R8BRTCHECK( What ) \
+		do { if( :: r8b :: CRTSection :: isActive() ) { \
+			R8BRTVIOLATION( What ); } } while( 0 )
+#else // R8B_RTCHECK
+	#define R8BRTSECTION
+	#define R8BRTCHECK( What ) do { } while( 0 )
+#endif // R8B_RTCHECK
+
 /**
  * @brief The default base class for objects created on heap.
  *
@@ -183,6 +286,7 @@ public:
 
 	void* operator new( const size_t n )
 	{
+		R8BRTCHECK( "operator new" );
 		return( :: malloc( n ));
 	}
 
@@ -193,6 +297,7 @@ public:
 
 	void* operator new[]( const size_t n )
 	{
+		R8BRTCHECK( "operator new[]" );
 		return( :: malloc( n ));
 	}
 
@@ -204,6 +309,7 @@ public:
 
 	void operator delete( void* const p )
 	{
+		R8BRTCHECK( "operator delete" );
 		:: free( p );
 	}
 
@@ -215,6 +321,7 @@ public:
 
 	void operator delete[]( void* const p )
 	{
+		R8BRTCHECK( "operator delete[]" );
 		:: free( p );
 	}
 };
@@ -237,6 +344,7 @@ public:
 
 	static void* allocmem( const size_t Size )
 	{
+		R8BRTCHECK( "allocmem()" );
 		return( :: malloc( Size ));
 	}
 
@@ -250,6 +358,7 @@ public:
 
 	static void* reallocmem( void* const p, const size_t Size )
 	{
+		R8BRTCHECK( "reallocmem()" );
 		return( :: realloc( p, Size ));
 	}
 
@@ -261,6 +370,7 @@ public:
 
 	static void freemem( void* const p )
 	{
+		R8BRTCHECK( "freemem()" );
 		:: free( p );
 	}
 };
@@ -556,6 +666,8 @@ public:
 
 	void acquire()
 	{
+		R8BRTCHECK( "CSyncObject::acquire()" );
+
 		#if defined( _WIN32 )
 			EnterCriticalSection( &CritSec );
 		#else // defined( _WIN32 )
@@ -756,6 +868,75 @@ private:
 	double sincr; ///< Sine value increment.
 };
 
+/**
+ * Function checks at run-time if the CPU and the OS support AVX2 and FMA
+ * instructions. The result is obtained once and cached.
+ *
+ * @return "True" if AVX2+FMA kernels can be used.
+ */
+
+inline bool isAVX2Available()
+{
+#if defined( R8B_AVX2 )
+
+	static const bool IsAvail = []()
+	{
+	#if defined( _MSC_VER )
+		int Info[ 4 ];
+		__cpuid( Info, 0 );
+
+		if( Info[ 0 ] < 7 )
+		{
+			return( false );
+		}
+
+		__cpuid( Info, 1 );
+		const int ecx1 = Info[ 2 ];
+		__cpuidex( Info, 7, 0 );
+		const int ebx7 = Info[ 1 ];
+	#else // defined( _MSC_VER )
+		if( __get_cpuid_max( 0, NULL ) < 7 )
+		{
+			return( false );
+		}
+
+		unsigned int eax, ebx, ecx, edx;
+		__cpuid_count( 7, 0, eax, ebx, ecx, edx );
+		const unsigned int ebx7 = ebx;
+		__cpuid( 1, eax, ebx, ecx, edx );
+		const unsigned int ecx1 = ecx;
+	#endif // defined( _MSC_VER )
+
+		const bool HasFMA = ( ecx1 & ( 1 << 12 )) != 0;
+		const bool HasOSXSAVE = ( ecx1 & ( 1 << 27 )) != 0;
+		const bool HasAVX = ( ecx1 & ( 1 << 28 )) != 0;
+		const bool HasAVX2 = ( ebx7 & ( 1 << 5 )) != 0;
+
+		if( !HasFMA || !HasOSXSAVE || !HasAVX || !HasAVX2 )
+		{
+			return( false );
+		}
+
+		// Check that the OS saves YMM registers on context switch.
+
+	#if defined( _MSC_VER )
+		return(( _xgetbv( 0 ) & 6 ) == 6 );
+	#else // defined( _MSC_VER )
+		unsigned int xcr0, xcr0h;
+		__asm__( "xgetbv" : "=a"( xcr0 ), "=d"( xcr0h ) : "c"( 0 ));
+		return(( xcr0 & 6 ) == 6 );
+	#endif // defined( _MSC_VER )
+	}();
+
+	return( IsAvail );
+
+#else // defined( R8B_AVX2 )
+
+	return( false );
+
+#endif // defined( R8B_AVX2 )
+}
+
 /**
  * @param v Input value.
  * @return Calculated bit occupancy of the specified input value. Bit
@@ -1112,6 +1293,26 @@ inline double clampr( const double Value, const double minv,
 	}
 }
 
+/**
+ * Function rounds a sample value, already scaled to the 16-bit range, to the
+ * nearest 16-bit integer, with ties to even, as the SSE2 conversion
+ * instructions do. The value is clipped to the [-32768; 32767] range. The
+ * comparisons match the NaN handling of the SSE min/max instructions, so NaN
+ * produces -32768.
+ *
+ * @param s Scaled sample value.
+ * @return 16-bit integer sample.
+ * @tparam T Value's type, "float" or "double".
+ */
+
+template< typename T >
+inline int16_t roundInt16( const T s )
+{
+	const T c = ( s > (T) -32768.0 ? s : (T) -32768.0 );
+
+	return( (int16_t) lrint( c < (T) 32767.0 ? c : (T) 32767.0 ));
+}
+
 /**
  * @param x Value to square.
  * @return Squared value of the argument.
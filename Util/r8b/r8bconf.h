@@ -40,6 +40,33 @@
 	#define R8BCONSOLE( ... )
 #endif // !defined( R8BCONSOLE )
 
+#if !defined( R8B_RTCHECK )
+	/**
+	 * When defined as 1, enables the real-time tripwire, intended for debug
+	 * builds. Memory allocation and deallocation via the default
+	 * R8B_BASECLASS and R8B_MEMALLOCCLASS classes, and thread-locking via
+	 * the CSyncObject class, then call the R8BRTVIOLATION macro if they
+	 * happen inside a real-time section: the process() and clear() functions
+	 * of the resampler classes. Custom allocator classes can call the
+	 * R8BRTCHECK macro to take part.
+	 */
+
+	#define R8B_RTCHECK 0
+#endif // !defined( R8B_RTCHECK )
+
+#if !defined( R8BRTVIOLATION )
+	/**
+	 * Macro called by the real-time tripwire when a real-time section
+	 * allocates memory or locks. By default, prints a message and aborts.
+	 *
+	 * @param What The violating operation, a string.
+	 */
+
+	#define R8BRTVIOLATION( What ) \
+		( fprintf( stderr, "r8brain-free-src: %s in a real-time section\n", \
+		What ), abort() )
+#endif // !defined( R8BRTVIOLATION )
+
 #if !defined( R8B_BASECLASS )
 	/**
 	 * Macro defines the name of the class from which all classes that are
@@ -96,6 +123,17 @@
 	#define R8B_FRACBANK_CACHE_MAX 12
 #endif // !defined( R8B_FRACBANK_CACHE_MAX )
 
+#if !defined( R8B_CACHE_SHARDS )
+	/**
+	 * This macro specifies the number of shards the filter and filter bank
+	 * caches are split into. Lookups of cached objects never lock, building
+	 * a new object locks only a single shard. The cache size limits above
+	 * are divided between the shards.
+	 */
+
+	#define R8B_CACHE_SHARDS 8
+#endif // !defined( R8B_CACHE_SHARDS )
+
 #if !defined( R8B_FLTTEST )
 	/**
 	 * This macro, when equal to 1, enables fractional delay filter bank
@@ -193,4 +231,22 @@
 	#define R8B_FLOATFFT 0
 #endif // !defined( R8B_FLOATFFT )
 
+#if !defined( R8B_PFFFT_RUNTIME )
+	/**
+	 * When defined as 1, the bundled PFFFT "float" routines can be selected
+	 * per resampler object at run-time, while other objects keep using the
+	 * default double-precision FFT. This requires "pffft.cpp" to be compiled
+	 * into the project, so it is off by default and a project built from
+	 * "r8bbase.cpp" alone links as before; the UseFloatFFT arguments are
+	 * then ignored. Not available when another FFT backend or "float" FFT
+	 * was selected globally.
+	 */
+
+	#define R8B_PFFFT_RUNTIME 0
+#endif // !defined( R8B_PFFFT_RUNTIME )
+
+#if R8B_PFFFT_RUNTIME && ( R8B_IPP || R8B_FLOATFFT || R8B_PFFFT_DOUBLE )
+	#error r8brain-free-src: R8B_PFFFT_RUNTIME requires the default FFT.
+#endif // R8B_PFFFT_RUNTIME && ( R8B_IPP || R8B_FLOATFFT || R8B_PFFFT_DOUBLE )
+
 #endif // R8BCONF_INCLUDED